@@ -0,0 +1,115 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+// Benchmark of the graph coloring used for the compression of Jacobians and Hessians:
+// number of colors and time for each ordering, unidirectional and bidirectional
+// partitions and star coloring. Usage: coloring_benchmark [n]
+
+#include "casadi/core/matrix/sparsity.hpp"
+#include "casadi/core/profiling.hpp"
+#include "casadi/core/std_vector_tools.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+
+using namespace casadi;
+using namespace std;
+
+// Random pattern with about nz_per_col nonzeros per column
+Sparsity random_pattern(int nrow, int ncol, int nz_per_col, unsigned int seed) {
+  srand(seed);
+  vector<int> row, col;
+  for (int c=0; c<ncol; ++c) {
+    for (int k=0; k<nz_per_col; ++k) {
+      row.push_back(rand() % nrow);
+      col.push_back(c);
+    }
+  }
+  return Sparsity::triplet(nrow, ncol, row, col);
+}
+
+// Banded pattern with a dense first row and column, e.g. a problem with a global parameter
+Sparsity arrow_pattern(int n) {
+  vector<int> row, col;
+  for (int k=0; k<n; ++k) {
+    row.push_back(0);
+    col.push_back(k);
+    row.push_back(k);
+    col.push_back(0);
+  }
+  return Sparsity::banded(n, 2) + Sparsity::triplet(n, n, row, col);
+}
+
+// Print number of colors and time for a coloring
+void report(const string& pname, const string& method, int ncolors, double t) {
+  cout << setw(12) << pname << setw(24) << method << setw(10) << ncolors << " colors"
+       << setw(12) << setprecision(4) << t*1e3 << " ms" << endl;
+}
+
+int main(int argc, char* argv[]) {
+  int n = argc>1 ? atoi(argv[1]) : 100000;
+
+  vector<pair<string, Sparsity> > patterns;
+  patterns.push_back(make_pair("banded", Sparsity::banded(n, 5)));
+  patterns.push_back(make_pair("random", random_pattern(n, n, 5, 1)));
+  patterns.push_back(make_pair("arrow", arrow_pattern(n)));
+
+  const char* ordering_name[] = {"natural", "largest_first", "smallest_last",
+                                 "incidence_degree"};
+  for (int k=0; k<patterns.size(); ++k) {
+    const string& pname = patterns[k].first;
+    const Sparsity& a = patterns[k].second;
+    Sparsity at = a.T();
+    cout << pname << ": " << a.dimString() << ", " << a.nnz() << " nonzeros" << endl;
+
+    // Unidirectional colorings, forward and adjoint
+    for (int ordering=0; ordering<4; ++ordering) {
+      double t0 = getRealTime();
+      Sparsity D = a.unidirectionalColoring(at, numeric_limits<int>::max(), ordering);
+      report(pname, string("fwd ") + ordering_name[ordering], D.size2(), getRealTime()-t0);
+      t0 = getRealTime();
+      D = at.unidirectionalColoring(a, numeric_limits<int>::max(), ordering);
+      report(pname, string("adj ") + ordering_name[ordering], D.size2(), getRealTime()-t0);
+    }
+
+    // Bidirectional partition
+    double t0 = getRealTime();
+    Sparsity D1, D2;
+    a.bidirectionalColoring(D1, D2);
+    int nfwd = D1.isNull() ? 0 : D1.size2(), nadj = D2.isNull() ? 0 : D2.size2();
+    report(pname, "bidirectional", nfwd + nadj, getRealTime()-t0);
+
+    // Star coloring of the symmetric pattern A + A'
+    Sparsity h = a + at;
+    for (int ordering=0; ordering<4; ++ordering) {
+      t0 = getRealTime();
+      Sparsity D = h.starColoring(ordering);
+      report(pname, string("star ") + ordering_name[ordering], D.size2(), getRealTime()-t0);
+    }
+  }
+
+  return 0;
+}
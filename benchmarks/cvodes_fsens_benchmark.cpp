@@ -0,0 +1,107 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+// Benchmark of the forward sensitivities of CVodes: native sensitivity right hand sides,
+// all directions in one call, against the integration of the augmented ODE, for an
+// increasing number of directions. Usage: cvodes_fsens_benchmark [nx]
+
+#include "casadi/casadi.hpp"
+#include "casadi/core/profiling.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+
+using namespace casadi;
+using namespace std;
+
+// Chain of nx states with a parameter per state, coupled to their neighbours
+Function chain_ode(int nx, int np) {
+  SX x = SX::sym("x", nx);
+  SX p = SX::sym("p", np);
+  vector<SX> ode(nx);
+  for (int i=0; i<nx; ++i) {
+    SX xm = i>0 ? x(i-1) : SX(0);
+    SX xp = i<nx-1 ? x(i+1) : SX(0);
+    ode[i] = -(10+p(i % np))*x(i) + 5*sin(xm) + 5*xp/(1+x(i)*x(i));
+  }
+  SX quad = sum_square(x);
+  return SXFunction("ode", daeIn("x", x, "p", p), daeOut("ode", vertcat(ode), "quad", quad));
+}
+
+// Time the construction and evaluation of ns forward directions, one per parameter
+double run(const Function& f, int ns, bool native, const string& method, DMatrix& xf) {
+  Dict opts = make_dict("tf", 2.0, "fsens_native", native, "sensitivity_method", method,
+                        "abstol", 1e-10, "reltol", 1e-10);
+  // Sparse Newton matrix, the one of the augmented ODE would otherwise be dense
+  opts["linear_solver_type"] = "user_defined";
+  opts["linear_solver"] = "csparse";
+  Integrator I("I", "cvodes", f, opts);
+  int nx = I.input(INTEGRATOR_X0).nnz();
+
+  // Forward derivatives with identity seeds for the parameters
+  double t0 = getRealTime();
+  Function F = I.derForward(ns);
+  double t_create = getRealTime()-t0;
+  F.setInput(DMatrix::ones(nx, 1), INTEGRATOR_X0);
+  F.setInput(DMatrix::zeros(ns, 1), INTEGRATOR_P);
+  for (int d=0; d<ns; ++d) {
+    int ind = INTEGRATOR_NUM_IN + INTEGRATOR_NUM_OUT + d*INTEGRATOR_NUM_IN + INTEGRATOR_P;
+    F.input(ind).set(0.);
+    F.input(ind).data()[d] = 1;
+  }
+  t0 = getRealTime();
+  F.evaluate();
+  double t_eval = getRealTime()-t0;
+
+  // Collect the sensitivities column by column
+  xf = DMatrix::zeros(nx, ns);
+  for (int d=0; d<ns; ++d) xf(Slice(), d) = F.output(d*INTEGRATOR_NUM_OUT + INTEGRATOR_XF);
+
+  cout << setw(6) << ns << setw(12) << (native ? "native" : "augmented")
+       << setw(14) << method << setw(12) << setprecision(4) << t_create*1e3 << " ms"
+       << setw(12) << t_eval*1e3 << " ms" << endl;
+  return t_eval;
+}
+
+int main(int argc, char* argv[]) {
+  int nx = argc>1 ? atoi(argv[1]) : 50;
+  int ns_list[] = {5, 10, 20, 50};
+
+  cout << setw(6) << "ns" << setw(12) << "mode" << setw(14) << "method"
+       << setw(15) << "construction" << setw(15) << "evaluation" << endl;
+  for (int k=0; k<sizeof(ns_list)/sizeof(int); ++k) {
+    int ns = ns_list[k];
+    Function f = chain_ode(nx, ns);
+    DMatrix J_aug, J_sim, J_stg;
+    double t_aug = run(f, ns, false, "simultaneous", J_aug);
+    double t_sim = run(f, ns, true, "simultaneous", J_sim);
+    double t_stg = run(f, ns, true, "staggered", J_stg);
+    cout << "  speed-up " << setprecision(3) << t_aug/t_sim << " (simultaneous), "
+         << t_aug/t_stg << " (staggered), difference "
+         << norm_inf(J_sim-J_aug) << ", " << norm_inf(J_stg-J_aug) << endl;
+  }
+  return 0;
+}
@@ -0,0 +1,108 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+// Benchmark of the DPLE solvers: the native periodic Schur solver against the Kronecker
+// formulation, condensing to a DLE and SLICOT (if available), for dense random stable
+// systems. Problems with more than max_work n^3 K flops are skipped.
+// Usage: dple_benchmark [max_work]
+
+#include "casadi/casadi.hpp"
+#include "casadi/core/profiling.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+
+using namespace casadi;
+using namespace std;
+
+// Random matrix with Frobenius norm rho, hence stable for rho<1
+DMatrix random_matrix(int n, double rho) {
+  DMatrix A = DMatrix::zeros(n, n);
+  for (int i=0; i<n*n; ++i) A.data()[i] = rand()/static_cast<double>(RAND_MAX)-0.5;
+  return A*(rho/norm_F(A));
+}
+
+// Time a single evaluation, returns the relative residual of the solution
+double run(const string& solver, const Dict& opts, const vector<DMatrix>& A,
+           const vector<DMatrix>& V) {
+  int K = A.size();
+  int n = A[0].size1();
+  map<string, vector<Sparsity> > st;
+  st["a"] = vector<Sparsity>(K, Sparsity::dense(n, n));
+  st["v"] = st["a"];
+  DpleSolver f("f", solver, st, opts);
+  f.setInput(horzcat(A), DPLE_A);
+  f.setInput(horzcat(V), DPLE_V);
+  double t0 = getRealTime();
+  f.evaluate();
+  double t_eval = getRealTime()-t0;
+
+  // Residual of P_{k+1} = A_k P_k A_k' + V_k
+  vector<DMatrix> P = horzsplit(f.output(DPLE_P), n);
+  double res = 0, nrm = 0;
+  for (int k=0; k<K; ++k) {
+    res = max(res, norm_inf(P[(k+1)%K] - mul(mul(A[k], P[k]), A[k].T()) - V[k]).getValue());
+    nrm = max(nrm, norm_inf(P[k]).getValue());
+  }
+  cout << setw(6) << n << setw(6) << K << setw(24) << solver
+       << setw(12) << setprecision(4) << t_eval*1e3 << " ms" << setw(14) << res/nrm << endl;
+  return t_eval;
+}
+
+int main(int argc, char* argv[]) {
+  double max_work = argc>1 ? atof(argv[1]) : 2e9;
+  int n_list[] = {10, 20, 50, 100, 200, 500};
+  int K_list[] = {1, 10, 100};
+  srand(1);
+
+  cout << setw(6) << "n" << setw(6) << "K" << setw(24) << "solver"
+       << setw(15) << "evaluation" << setw(14) << "residual" << endl;
+  for (int i=0; i<sizeof(n_list)/sizeof(int); ++i) {
+    for (int j=0; j<sizeof(K_list)/sizeof(int); ++j) {
+      int n = n_list[i], K = K_list[j];
+      if (static_cast<double>(n)*n*n*K > max_work) continue;
+      vector<DMatrix> A(K), V(K);
+      for (int k=0; k<K; ++k) {
+        A[k] = random_matrix(n, 0.9);
+        DMatrix v = random_matrix(n, 1);
+        V[k] = mul(v, v.T());
+      }
+      run("periodic_schur", Dict(), A, V);
+      if (DpleSolver::hasPlugin("slicot")) {
+        run("slicot", make_dict("linear_solver", "csparse"), A, V);
+      }
+      // The Kronecker formulation has n^2 K unknowns, the condensed DLE n^2
+      if (n*n*K<=1000) {
+        run("simple", make_dict("linear_solver", "csparse"), A, V);
+      }
+      if (n<=20 && K>1) {
+        run("condensing.simple", make_dict("dle_solver_options",
+                                           make_dict("linear_solver", "csparse")), A, V);
+      }
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,155 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+// Benchmark of the FMI/XML parser: a JModelica-style model description with a chain of
+// n_state states, each with a free parameter bound by a binding equation, is written
+// and imported with DaeBuilder::parseFMI, reporting the throughput and the peak memory
+// usage. If the TinyXML plugin is available, the time and memory needed to only load the
+// document tree are reported for comparison (peak memory is measured for the process,
+// hence the DOM figure is measured last).
+// Usage: fmi_benchmark [n_state] [directory]
+
+#include "casadi/core/misc/dae_builder.hpp"
+#include "casadi/core/misc/xml_file_internal.hpp"
+#include "casadi/core/profiling.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <sys/resource.h>
+
+using namespace casadi;
+using namespace std;
+
+// Write a scalar variable, the qualified name is chain.<part><i>
+void write_variable(FILE* f, const char* name, const char* part, int i, int vr,
+                    const char* variability, const char* category) {
+  fprintf(f, "    <ScalarVariable name=\"%s\" valueReference=\"%d\" variability=\"%s\" "
+          "causality=\"internal\" alias=\"noAlias\">\n"
+          "      <Real relativeQuantity=\"false\" start=\"1.0\" free=\"false\" "
+          "initialGuess=\"0.0\" />\n"
+          "      <QualifiedName>\n"
+          "        <exp:QualifiedNamePart name=\"chain\"/>\n"
+          "        <exp:QualifiedNamePart name=\"%s%d\"/>\n"
+          "      </QualifiedName>\n"
+          "      <isLinear>true</isLinear>\n"
+          "      <VariableCategory>%s</VariableCategory>\n"
+          "    </ScalarVariable>\n", name, vr, variability, part, i, category);
+}
+
+// Write an identifier
+void write_identifier(FILE* f, const char* name, int i) {
+  fprintf(f, "<exp:Identifier><exp:QualifiedNamePart name=\"chain\"/>"
+          "<exp:QualifiedNamePart name=\"%s%d\"/></exp:Identifier>\n", name, i);
+}
+
+// Chained model: der(x_i) = -k_i*x_i + x_{i-1}, k_i = 1 + i/n
+void write_model(const string& filename, int n) {
+  FILE* f = fopen(filename.c_str(), "w");
+  fprintf(f, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+          "<jmodelicaModelDescription fmiVersion=\"1.0\" modelName=\"chain\">\n"
+          "  <ModelVariables>\n");
+  char name[100];
+  for (int i=0; i<n; ++i) {
+    snprintf(name, sizeof(name), "chain.x%d", i);
+    write_variable(f, name, "x", i, 3*i, "continuous", "state");
+    // Derivatives share the qualified name of the state (JModelica convention)
+    snprintf(name, sizeof(name), "der(chain.x%d)", i);
+    write_variable(f, name, "x", i, 3*i+1, "continuous", "derivative");
+    snprintf(name, sizeof(name), "chain.k%d", i);
+    write_variable(f, name, "k", i, 3*i+2, "parameter", "independentParameter");
+  }
+  fprintf(f, "  </ModelVariables>\n  <equ:BindingEquations>\n");
+  for (int i=0; i<n; ++i) {
+    fprintf(f, "    <equ:BindingEquation><equ:Parameter><exp:QualifiedNamePart name=\"chain\"/>"
+            "<exp:QualifiedNamePart name=\"k%d\"/></equ:Parameter>\n"
+            "      <equ:BindingExp><exp:RealLiteral>%.17g</exp:RealLiteral></equ:BindingExp>\n"
+            "    </equ:BindingEquation>\n", i, 1+i/static_cast<double>(n));
+  }
+  fprintf(f, "  </equ:BindingEquations>\n  <equ:DynamicEquations>\n");
+  for (int i=0; i<n; ++i) {
+    fprintf(f, "    <equ:Equation><exp:Sub>\n<exp:Der>");
+    write_identifier(f, "x", i);
+    fprintf(f, "</exp:Der>\n<exp:Add><exp:Mul><exp:Neg>");
+    write_identifier(f, "k", i);
+    fprintf(f, "</exp:Neg>");
+    write_identifier(f, "x", i);
+    fprintf(f, "</exp:Mul>");
+    if (i>0) {
+      write_identifier(f, "x", i-1);
+    } else {
+      fprintf(f, "<exp:RealLiteral>0</exp:RealLiteral>");
+    }
+    fprintf(f, "</exp:Add></exp:Sub></equ:Equation>\n");
+  }
+  fprintf(f, "  </equ:DynamicEquations>\n</jmodelicaModelDescription>\n");
+  fclose(f);
+}
+
+// Peak resident set size in MB
+double peak_memory() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss/1024.0;
+}
+
+int main(int argc, char* argv[]) {
+  int n = argc>1 ? atoi(argv[1]) : 200000;
+  string dir = argc>2 ? argv[2] : ".";
+  string filename = dir + "/fmi_benchmark.xml";
+  write_model(filename, n);
+
+  FILE* f = fopen(filename.c_str(), "rb");
+  fseek(f, 0, SEEK_END);
+  double mb = ftell(f)/1e6;
+  fclose(f);
+
+  // Streaming import
+  double mem0 = peak_memory();
+  double t0 = getRealTime();
+  {
+    DaeBuilder dae;
+    dae.parseFMI(filename);
+    double t = getRealTime()-t0;
+    cout << "parseFMI:     n_s = " << dae.s.size() << ", n_d = " << dae.d.size()
+         << ", " << mb << " MB in " << t << " s, " << mb/t << " MB/s, peak memory "
+         << peak_memory() << " MB (" << (peak_memory()-mem0) << " MB increase)" << endl;
+  }
+
+  // Loading the document tree only
+  if (XmlFileInternal::hasPlugin("tinyxml")) {
+    mem0 = peak_memory();
+    t0 = getRealTime();
+    XmlFile xml_file("tinyxml");
+    XmlNode document = xml_file.parse(filename);
+    double t = getRealTime()-t0;
+    cout << "tinyxml load: " << mb << " MB in " << t << " s, " << mb/t
+         << " MB/s, peak memory " << peak_memory() << " MB (" << (peak_memory()-mem0)
+         << " MB increase)" << endl;
+  }
+
+  remove(filename.c_str());
+  return 0;
+}
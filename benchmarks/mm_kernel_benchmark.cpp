@@ -0,0 +1,189 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+// Benchmark of the runtime kernels specialized to the structure of the factors,
+// against the generic sparse kernels that they replace in Multiplication and
+// Project. Usage: mm_kernel_benchmark [n] [nrep]
+
+#include "casadi/core/matrix/sparsity.hpp"
+#include "casadi/core/runtime/runtime.hpp"
+#include "casadi/core/profiling.hpp"
+#include "casadi/core/std_vector_tools.hpp"
+
+#include <cstdlib>
+#include <cmath>
+#include <iostream>
+#include <iomanip>
+
+using namespace casadi;
+using namespace std;
+
+// Nonzeros of a pattern, deterministic
+vector<double> values(const Sparsity& sp) {
+  vector<double> v(sp.nnz());
+  for (int k=0; k<v.size(); ++k) v[k] = sin(0.1*k);
+  return v;
+}
+
+// Random pattern with about nz_per_col nonzeros per column
+Sparsity random_pattern(int nrow, int ncol, int nz_per_col, unsigned int seed) {
+  srand(seed);
+  vector<int> row, col;
+  for (int c=0; c<ncol; ++c) {
+    for (int k=0; k<nz_per_col; ++k) {
+      row.push_back(rand() % nrow);
+      col.push_back(c);
+    }
+  }
+  return Sparsity::triplet(nrow, ncol, row, col);
+}
+
+// Time an operation, in ms per call
+double time_ms(void (*f)(void*), void* data, int nrep) {
+  double t0 = getRealTime();
+  for (int r=0; r<nrep; ++r) f(data);
+  return (getRealTime()-t0)/nrep*1e3;
+}
+
+// One product z <- z + x*y, with the generic and the specialized kernel
+struct Product {
+  string name;
+  Sparsity x, y, z;
+  vector<double> xv, yv, zv, w;
+  void (*special)(Product&);
+};
+
+void generic(void* data) {
+  Product& p = *static_cast<Product*>(data);
+  casadi_mm_sparse(getPtr(p.xv), p.x, getPtr(p.yv), p.y, getPtr(p.zv), p.z, getPtr(p.w));
+}
+
+void special(void* data) {
+  Product& p = *static_cast<Product*>(data);
+  p.special(p);
+}
+
+void ldiag(Product& p) {
+  casadi_mm_ldiag(getPtr(p.xv), getPtr(p.yv), p.y, getPtr(p.zv));
+}
+
+void rdiag(Product& p) {
+  casadi_mm_rdiag(getPtr(p.xv), p.x, getPtr(p.yv), getPtr(p.zv));
+}
+
+void dense_sparse(Product& p) {
+  casadi_mm_dense_sparse(getPtr(p.xv), p.x.size1(), getPtr(p.yv), p.y, getPtr(p.zv));
+}
+
+void band(Product& p) {
+  casadi_mm_band(getPtr(p.xv), p.x, getPtr(p.yv), p.y.size2(), getPtr(p.zv));
+}
+
+void densify(Product& p) {
+  casadi_densify(getPtr(p.xv), p.x, getPtr(p.zv));
+}
+
+void sparsify(Product& p) {
+  casadi_sparsify(getPtr(p.xv), getPtr(p.zv), p.z);
+}
+
+void project(void* data) {
+  Product& p = *static_cast<Product*>(data);
+  casadi_project(getPtr(p.xv), p.x, getPtr(p.zv), p.z, getPtr(p.w));
+}
+
+Product product(const string& name, const Sparsity& x, const Sparsity& y,
+                void (*f)(Product&)) {
+  Product p;
+  p.name = name;
+  p.x = x;
+  p.y = y;
+  p.z = x.patternProduct(y);
+  p.xv = values(x);
+  p.yv = values(y);
+  p.zv.resize(p.z.nnz(), 0);
+  p.w.resize(p.z.size1());
+  p.special = f;
+  return p;
+}
+
+Product conversion(const string& name, const Sparsity& x, const Sparsity& z,
+                   void (*f)(Product&)) {
+  Product p;
+  p.name = name;
+  p.x = x;
+  p.z = z;
+  p.xv = values(x);
+  p.zv.resize(z.nnz(), 0);
+  p.w.resize(z.size1());
+  p.special = f;
+  return p;
+}
+
+int main(int argc, char* argv[]) {
+  int n = argc>1 ? atoi(argv[1]) : 1000;
+  int nrep = argc>2 ? atoi(argv[2]) : 20;
+
+  // Block diagonal pattern with dense blocks
+  vector<Sparsity> blocks(n/10, Sparsity::dense(10, 10));
+  Sparsity blockdiag = diagcat(blocks);
+
+  vector<Product> products;
+  products.push_back(product("diag*sparse", Sparsity::diag(n), random_pattern(n, n, 10, 1),
+                             ldiag));
+  products.push_back(product("diag*dense", Sparsity::diag(n), Sparsity::dense(n, 20),
+                             ldiag));
+  products.push_back(product("sparse*diag", random_pattern(n, n, 10, 2), Sparsity::diag(n),
+                             rdiag));
+  products.push_back(product("dense*sparse", Sparsity::dense(20, n), random_pattern(n, n, 10, 3),
+                             dense_sparse));
+  products.push_back(product("banded*dense", Sparsity::banded(n, 5), Sparsity::dense(n, 20),
+                             band));
+  products.push_back(product("blockdiag*dense", blockdiag, Sparsity::dense(blockdiag.size2(), 20),
+                             band));
+  products.push_back(product("lower*dense", Sparsity::lower(n), Sparsity::dense(n, 20), band));
+  products.push_back(conversion("densify", random_pattern(n, n, 10, 4), Sparsity::dense(n, n),
+                                densify));
+  products.push_back(conversion("sparsify", Sparsity::dense(n, n), random_pattern(n, n, 10, 5),
+                                sparsify));
+
+  cout << setw(18) << "" << setw(14) << "generic" << setw(14) << "special" << endl;
+  for (int k=0; k<products.size(); ++k) {
+    Product& p = products[k];
+    bool conv = p.y.isNull();
+    double t_gen = time_ms(conv ? project : generic, &p, nrep);
+    vector<double> z_gen = p.zv;
+    fill(p.zv.begin(), p.zv.end(), 0);
+    double t_spec = time_ms(special, &p, nrep);
+
+    // Products accumulate: compare the sums over all repetitions
+    double err = 0;
+    for (int i=0; i<p.zv.size(); ++i) err = max(err, fabs(p.zv[i]-z_gen[i]));
+    cout << setw(18) << p.name << setw(11) << setprecision(4) << t_gen << " ms"
+         << setw(11) << setprecision(4) << t_spec << " ms" << setw(10) << setprecision(3)
+         << t_gen/t_spec << "x  err " << err << endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,182 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+// Benchmark of the NL-file parser: a chained test problem is written in text and
+// binary format and parsed, reporting the throughput and the peak memory usage.
+// The objective is a single deeply nested expression.
+// Usage: nl_benchmark [n_var] [directory]
+
+#include "casadi/core/misc/nlp_builder.hpp"
+#include "casadi/core/profiling.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <sys/resource.h>
+
+using namespace casadi;
+using namespace std;
+
+// Writes the content of an NL-file, either as text or with binary numbers
+class NlWriter {
+public:
+  NlWriter(const string& filename, bool binary) : binary_(binary) {
+    f_ = fopen(filename.c_str(), "wb");
+  }
+  ~NlWriter() { fclose(f_);}
+  void text(const char* s) { fputs(s, f_);}
+  void key(char c) { fputc(c, f_);}
+  void num(int i) {
+    if (binary_) {
+      fwrite(&i, sizeof(int), 1, f_);
+    } else {
+      fprintf(f_, "%d\n", i);
+    }
+  }
+  void num(double d) {
+    if (binary_) {
+      fwrite(&d, sizeof(double), 1, f_);
+    } else {
+      fprintf(f_, "%.17g\n", d);
+    }
+  }
+  void boundType(int t) {
+    if (binary_) {
+      fputc('0' + t, f_);
+    } else {
+      fprintf(f_, "%d ", t);
+    }
+  }
+private:
+  FILE* f_;
+  bool binary_;
+};
+
+// Chained problem: min sum_i (x_i - 1)^2, s.t. x_i^2*x_{i+1} - sin(x_{i+2}) + x_i = 0
+void write_problem(const string& filename, int n, bool binary) {
+  NlWriter w(filename, binary);
+  int m = n-2;
+  char line[200];
+  w.text(binary ? "b3 1 1 0\n" : "g3 1 1 0\n");
+  snprintf(line, sizeof(line), " %d %d 1 0 %d 0\n", n, m, m);
+  w.text(line);
+  for (int k=0; k<8; ++k) w.text(" 0 0 0\n");
+
+  // Constraint bodies, nonlinear part
+  for (int i=0; i<m; ++i) {
+    w.key('C'); w.num(i);
+    w.key('o'); w.num(1);
+    w.key('o'); w.num(2);
+    w.key('o'); w.num(5);
+    w.key('v'); w.num(i);
+    w.key('n'); w.num(2.0);
+    w.key('v'); w.num(i+1);
+    w.key('o'); w.num(41);
+    w.key('v'); w.num(i+2);
+  }
+
+  // Objective as a nested sum (depth n)
+  w.key('O'); w.num(0); w.num(0);
+  for (int i=0; i<n; ++i) {
+    if (i<n-1) {
+      w.key('o'); w.num(0);
+    }
+    w.key('o'); w.num(5);
+    w.key('o'); w.num(0);
+    w.key('v'); w.num(i);
+    w.key('n'); w.num(-1.0);
+    w.key('n'); w.num(2.0);
+  }
+
+  // Primal initial guess
+  w.key('x'); w.num(n);
+  for (int i=0; i<n; ++i) {
+    w.num(i);
+    w.num(0.5);
+  }
+
+  // Constraint bounds
+  w.key('r');
+  if (!binary) w.text("\n");
+  for (int i=0; i<m; ++i) {
+    w.boundType(4);
+    w.num(0.0);
+  }
+
+  // Variable bounds
+  w.key('b');
+  if (!binary) w.text("\n");
+  for (int i=0; i<n; ++i) {
+    w.boundType(0);
+    w.num(-10.0);
+    w.num(10.0);
+  }
+
+  // Jacobian column counts
+  w.key('k'); w.num(n-1);
+  for (int i=0; i<n-1; ++i) w.num(3*(i+1));
+
+  // Linear terms of the constraints
+  for (int i=0; i<m; ++i) {
+    w.key('J'); w.num(i); w.num(3);
+    w.num(i); w.num(1.0);
+    w.num(i+1); w.num(0.0);
+    w.num(i+2); w.num(0.0);
+  }
+}
+
+// Peak resident set size in MB
+double peak_memory() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss/1024.0;
+}
+
+int main(int argc, char* argv[]) {
+  int n = argc>1 ? atoi(argv[1]) : 200000;
+  string dir = argc>2 ? argv[2] : ".";
+
+  for (int binary=0; binary<2; ++binary) {
+    string filename = dir + (binary ? "/nl_benchmark_b.nl" : "/nl_benchmark_g.nl");
+    write_problem(filename, n, binary);
+
+    FILE* f = fopen(filename.c_str(), "rb");
+    fseek(f, 0, SEEK_END);
+    double mb = ftell(f)/1e6;
+    fclose(f);
+
+    double t0 = getRealTime();
+    NlpBuilder nl;
+    nl.parseNL(filename);
+    double t = getRealTime()-t0;
+
+    cout << (binary ? "binary" : "text  ") << ": n_var = " << nl.x.nnz()
+         << ", n_con = " << nl.g.nnz() << ", " << mb << " MB in " << t << " s, "
+         << mb/t << " MB/s, peak memory " << peak_memory() << " MB" << endl;
+    remove(filename.c_str());
+  }
+
+  return 0;
+}
@@ -0,0 +1,102 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+// Benchmark of the sparsity pattern operations used in the symbolic setup of
+// large Jacobians and Hessians: transpose, union and intersection, product,
+// slicing and erasing. Usage: sparsity_benchmark [n] [nrep]
+
+#include "casadi/core/matrix/sparsity.hpp"
+#include "casadi/core/profiling.hpp"
+#include "casadi/core/std_vector_tools.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+
+using namespace casadi;
+using namespace std;
+
+// Random pattern with about nz_per_col nonzeros per column
+Sparsity random_pattern(int nrow, int ncol, int nz_per_col, unsigned int seed) {
+  srand(seed);
+  vector<int> row, col;
+  for (int c=0; c<ncol; ++c) {
+    for (int k=0; k<nz_per_col; ++k) {
+      row.push_back(rand() % nrow);
+      col.push_back(c);
+    }
+  }
+  return Sparsity::triplet(nrow, ncol, row, col);
+}
+
+// Block diagonal pattern with dense blocks, e.g. a multiple shooting Jacobian
+Sparsity blockdiag_pattern(int nblock, int bs) {
+  vector<Sparsity> blocks(nblock, Sparsity::dense(bs, bs));
+  return diagcat(blocks);
+}
+
+// Time an operation, in ms per call
+#define TIME(NAME, EXPR) { \
+    double t0 = getRealTime(); \
+    for (int r=0; r<nrep; ++r) { EXPR; } \
+    double t = (getRealTime()-t0)/nrep; \
+    cout << setw(16) << pname << setw(16) << NAME << setw(12) << setprecision(4) \
+         << t*1e3 << " ms" << endl; \
+  }
+
+int main(int argc, char* argv[]) {
+  int n = argc>1 ? atoi(argv[1]) : 100000;
+  int nrep = argc>2 ? atoi(argv[2]) : 5;
+
+  // Representative patterns, about 10 nonzeros per column
+  vector<pair<string, pair<Sparsity, Sparsity> > > patterns;
+  patterns.push_back(make_pair("banded", make_pair(Sparsity::banded(n, 5),
+                                                   Sparsity::banded(n, 3))));
+  patterns.push_back(make_pair("random", make_pair(random_pattern(n, n, 10, 1),
+                                                   random_pattern(n, n, 10, 2))));
+  patterns.push_back(make_pair("blockdiag", make_pair(blockdiag_pattern(n/10, 10),
+                                                      Sparsity::banded(n/10*10, 2))));
+
+  // Slices: every other row and column
+  vector<int> rr, cc;
+  for (int i=0; i<n; i+=2) rr.push_back(i);
+  cc = rr;
+
+  vector<int> mapping;
+  vector<unsigned char> cmapping;
+  for (int k=0; k<patterns.size(); ++k) {
+    const string& pname = patterns[k].first;
+    const Sparsity& a = patterns[k].second.first;
+    const Sparsity& b = patterns[k].second.second;
+    cout << pname << ": " << a.dimString() << ", " << b.dimString() << endl;
+    TIME("transpose", a.transpose(mapping));
+    TIME("union", a.patternUnion(b, cmapping));
+    TIME("intersection", a.patternIntersection(b, cmapping));
+    TIME("product", a.patternProduct(b));
+    TIME("sub", a.sub(rr, cc, mapping));
+    TIME("erase", Sparsity e = a; e.erase(rr, cc));
+  }
+
+  return 0;
+}
@@ -0,0 +1,98 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#ifndef CASADI_CASADI_MUTEX_HPP
+#define CASADI_CASADI_MUTEX_HPP
+
+#ifdef USE_CXX11
+#include <mutex>
+#endif // USE_CXX11
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif // WITH_OPENMP
+
+/// \cond INTERNAL
+namespace casadi {
+
+  /** \brief Recursive lock protecting global data, e.g. caches
+
+      A std::recursive_mutex with C++11, an OpenMP nested lock otherwise.
+      Without either, no other threads are assumed and the lock does nothing.
+  */
+  class CasadiMutex {
+  public:
+    CasadiMutex() {
+#if !defined(USE_CXX11) && defined(WITH_OPENMP)
+      omp_init_nest_lock(&mutex_);
+#endif
+    }
+
+    ~CasadiMutex() {
+#if !defined(USE_CXX11) && defined(WITH_OPENMP)
+      omp_destroy_nest_lock(&mutex_);
+#endif
+    }
+
+    void lock() {
+#ifdef USE_CXX11
+      mutex_.lock();
+#elif defined(WITH_OPENMP)
+      omp_set_nest_lock(&mutex_);
+#endif
+    }
+
+    void unlock() {
+#ifdef USE_CXX11
+      mutex_.unlock();
+#elif defined(WITH_OPENMP)
+      omp_unset_nest_lock(&mutex_);
+#endif
+    }
+
+  private:
+    // Not copyable
+    CasadiMutex(const CasadiMutex&);
+    CasadiMutex& operator=(const CasadiMutex&);
+
+#ifdef USE_CXX11
+    std::recursive_mutex mutex_;
+#elif defined(WITH_OPENMP)
+    omp_nest_lock_t mutex_;
+#endif
+  };
+
+  /// Hold a lock for the lifetime of the object
+  class CasadiScopedLock {
+  public:
+    explicit CasadiScopedLock(CasadiMutex& mutex) : mutex_(mutex) { mutex_.lock();}
+    ~CasadiScopedLock() { mutex_.unlock();}
+  private:
+    CasadiMutex& mutex_;
+  };
+
+} // namespace casadi
+/// \endcond
+
+#endif // CASADI_CASADI_MUTEX_HPP
@@ -36,6 +36,8 @@ namespace casadi {
   bool CasadiOptions::purgeSeeds = false;
   bool CasadiOptions::allowed_internal_api = false;
   int CasadiOptions::optimized_num_dir = 64;
+  int CasadiOptions::derivative_cache_size = 0;
+  long CasadiOptions::jacobian_plan_cache_memory = 64*1024*1024;
 
   std::string CasadiOptions::casadipath = "";
 
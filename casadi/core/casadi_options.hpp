@@ -83,6 +83,20 @@ namespace casadi {
 
       static int optimized_num_dir;
 
+      /** \brief Number of derivative functions kept alive by a global cache
+      * Jacobian and directional derivative functions are normally only weakly referenced
+      * by the function that created them. The most recently used ones are kept alive
+      * until this number is exceeded. The cache is bounded by the number of functions rather
+      * than by memory, since derivative functions share their expressions with other functions.
+      * Default: 0 (disabled)
+      */
+      static int derivative_cache_size;
+
+      /** \brief Memory, in bytes, that may be used by the global cache of Jacobian plans
+      * Default: 64 MB
+      */
+      static long jacobian_plan_cache_memory;
+
 #endif //SWIG
       // Setter and getter for catch_errors_swig
       static void setCatchErrorsSwig(bool flag) { catch_errors_swig = flag; }
@@ -116,6 +130,12 @@ namespace casadi {
       static void setOptimizedNumDir(int n) { optimized_num_dir = n; }
       static int getOptimizedNumDir() { return optimized_num_dir; }
 
+      static void setDerivativeCacheSize(int n);
+      static int getDerivativeCacheSize() { return derivative_cache_size; }
+
+      static void setJacobianPlanCacheMemory(long n) { jacobian_plan_cache_memory = n; }
+      static long getJacobianPlanCacheMemory() { return jacobian_plan_cache_memory; }
+
   };
 
 } // namespace casadi
@@ -48,6 +48,7 @@
 #include "function/mx_function.hpp"
 #include "function/compiler.hpp"
 #include "function/external_function.hpp"
+#include "function/binary_function.hpp"
 #include "function/switch.hpp"
 #include "function/linear_solver.hpp"
 #include "function/nlp_solver.hpp"
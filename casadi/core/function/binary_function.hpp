@@ -0,0 +1,72 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#ifndef CASADI_BINARY_FUNCTION_HPP
+#define CASADI_BINARY_FUNCTION_HPP
+
+#include "sx_function.hpp"
+
+namespace casadi {
+
+/** \brief  Forward declaration of internal class */
+class BinaryFunctionInternal;
+
+  /** \brief  Function loaded from a binary file written by Function::save
+
+      The file contains the name, the input and output sparsity patterns and the
+      instruction tape of an SXFunction, including its constants. The file is
+      memory-mapped and numerical evaluation and sparsity propagation work directly
+      on the mapped tape, without copying or sorting. The symbolic expressions are
+      only reconstructed when needed, e.g. for calculating derivatives.
+
+      The format is versioned and uses the native byte order.
+  */
+  class CASADI_EXPORT BinaryFunction : public Function {
+  public:
+
+    /** \brief  Default constructor */
+    BinaryFunction();
+
+    /** \brief  Load a function from a file written by Function::save */
+    BinaryFunction(const std::string& name, const std::string& filename,
+                   const Dict& opts=Dict());
+
+    /** \brief  Reconstruct the symbolic expressions as an SXFunction */
+    SXFunction symbolic();
+
+    /** \brief  Access functions of the node */
+    BinaryFunctionInternal* operator->();
+
+    /** \brief  Const access functions of the node */
+    const BinaryFunctionInternal* operator->() const;
+
+    /// Check if a particular cast is allowed
+    static bool testCast(const SharedObjectNode* ptr);
+  };
+
+} // namespace casadi
+
+#endif // CASADI_BINARY_FUNCTION_HPP
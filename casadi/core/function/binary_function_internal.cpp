@@ -0,0 +1,463 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#include "binary_function_internal.hpp"
+#include "sx_function_internal.hpp"
+#include "../casadi_math.hpp"
+#include <fstream>
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif // _WIN32
+
+using namespace std;
+namespace casadi {
+
+  /// Magic string at the start of the file
+  static const char BINARY_FUNCTION_MAGIC[] = "casadibf";
+
+  /// Version of the file format
+  static const int BINARY_FUNCTION_VERSION = 1;
+
+  /// Byte order mark
+  static const int BINARY_FUNCTION_BOM = 0x01020304;
+
+  /// Alignment of the tape in the file
+  static const size_t BINARY_FUNCTION_ALIGN = 16;
+
+  /// Write an integer
+  static void writeInt(ostream& stream, int v) {
+    stream.write(reinterpret_cast<const char*>(&v), sizeof(int));
+  }
+
+  /// Write a string, preceded by its length
+  static void writeString(ostream& stream, const string& v) {
+    writeInt(stream, v.size());
+    stream.write(v.data(), v.size());
+  }
+
+  /// Write a sparsity pattern
+  static void writeSparsity(ostream& stream, const Sparsity& sp) {
+    writeInt(stream, sp.size1());
+    writeInt(stream, sp.size2());
+    stream.write(reinterpret_cast<const char*>(sp.colind()), (sp.size2()+1)*sizeof(int));
+    stream.write(reinterpret_cast<const char*>(sp.row()), sp.nnz()*sizeof(int));
+  }
+
+  /// \cond INTERNAL
+  /// Marks the operations handled by CASADI_MATH_FUN_BUILTIN_GEN
+  template<int I>
+  struct BinaryFunctionOpCheck {
+    static void fcn(bool x, bool y, bool& f, int n) { f = true;}
+  };
+  /// \endcond
+
+  /// Can an operation other than OP_CONST, OP_INPUT and OP_OUTPUT be evaluated from the tape
+  static bool isTapeOperation(int op) {
+    bool ok = false;
+    switch (op) {
+      CASADI_MATH_FUN_BUILTIN_GEN(BinaryFunctionOpCheck, false, false, ok, 1)
+    }
+    return ok;
+  }
+
+  /// Bounds checked reading of the file contents
+  class BinaryFunctionReader {
+  public:
+    BinaryFunctionReader(const char* data, size_t size) : data_(data), size_(size), pos_(0) {}
+
+    /// Read raw bytes, returns a pointer into the contents
+    const char* read(size_t n) {
+      casadi_assert_message(n<=size_-pos_, "BinaryFunction: Unexpected end of file");
+      const char* ret = data_ + pos_;
+      pos_ += n;
+      return ret;
+    }
+
+    /// Read an integer
+    int readInt() {
+      int v;
+      memcpy(&v, read(sizeof(int)), sizeof(int));
+      return v;
+    }
+
+    /// Read a nonnegative integer
+    int readSize() {
+      int v = readInt();
+      casadi_assert_message(v>=0, "BinaryFunction: Corrupt file");
+      return v;
+    }
+
+    /// Read a string
+    string readString() {
+      int n = readSize();
+      return string(read(n), n);
+    }
+
+    /// Read an integer vector of given length
+    vector<int> readInts(int n) {
+      vector<int> v(n);
+      if (n>0) memcpy(&v.front(), read(n*sizeof(int)), n*sizeof(int));
+      return v;
+    }
+
+    /// Read a sparsity pattern
+    Sparsity readSparsity() {
+      int nrow = readSize();
+      int ncol = readSize();
+      vector<int> colind = readInts(ncol+1);
+      casadi_assert_message(colind.front()==0, "BinaryFunction: Corrupt sparsity pattern");
+      for (int c=0; c<ncol; ++c) {
+        casadi_assert_message(colind[c]<=colind[c+1], "BinaryFunction: Corrupt sparsity pattern");
+      }
+      vector<int> row = readInts(colind.back());
+      for (int c=0; c<ncol; ++c) {
+        for (int k=colind[c]; k<colind[c+1]; ++k) {
+          casadi_assert_message(row[k]>=0 && row[k]<nrow && (k==colind[c] || row[k]>row[k-1]),
+                                "BinaryFunction: Corrupt sparsity pattern");
+        }
+      }
+      return Sparsity(nrow, ncol, colind, row);
+    }
+
+    /// Skip to the next multiple of n bytes
+    void align(size_t n) {
+      if (pos_%n) read(n - pos_%n);
+    }
+
+    /// Current position
+    size_t pos() const { return pos_;}
+
+  private:
+    const char* data_;
+    size_t size_, pos_;
+  };
+
+  BinaryFunctionInternal::BinaryFunctionInternal(const std::string& filename)
+    : filename_(filename), data_(0), size_(0), mapped_(false), alg_(0), n_alg_(0), n_w_(0) {
+#ifndef _WIN32
+    // Map the file into memory, read-only
+    int fd = open(filename.c_str(), O_RDONLY);
+    casadi_assert_message(fd>=0, "BinaryFunction: Cannot open \"" << filename << "\"");
+    struct stat st;
+    if (fstat(fd, &st)==0 && st.st_size>0) {
+      void* p = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (p!=MAP_FAILED) {
+        data_ = static_cast<const char*>(p);
+        size_ = st.st_size;
+        mapped_ = true;
+      }
+    }
+    close(fd);
+#endif // _WIN32
+
+    // Fall back to reading the file
+    if (!mapped_) {
+      ifstream file(filename.c_str(), ios::binary);
+      casadi_assert_message(file.good(), "BinaryFunction: Cannot open \"" << filename << "\"");
+      buffer_.assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+      data_ = buffer_.empty() ? 0 : &buffer_.front();
+      size_ = buffer_.size();
+    }
+
+    try {
+      // Header
+      BinaryFunctionReader r(data_, size_);
+      casadi_assert_message(memcmp(r.read(8), BINARY_FUNCTION_MAGIC, 8)==0,
+                            "BinaryFunction: \"" << filename << "\" is not a CasADi binary "
+                            "function file");
+      int version = r.readInt();
+      casadi_assert_message(version==BINARY_FUNCTION_VERSION,
+                            "BinaryFunction: Unsupported format version " << version);
+      casadi_assert_message(r.readInt()==BINARY_FUNCTION_BOM,
+                            "BinaryFunction: File written with a different byte order");
+      casadi_assert_message(r.readInt()==sizeof(ScalarAtomic),
+                            "BinaryFunction: File written on an incompatible platform");
+      int n_in = r.readSize();
+      int n_out = r.readSize();
+      n_w_ = r.readSize();
+      n_alg_ = r.readSize();
+
+      // Name, inputs and outputs
+      fname_ = r.readString();
+      ibuf_.resize(n_in);
+      ischeme_.resize(n_in);
+      for (int i=0; i<n_in; ++i) {
+        ischeme_[i] = r.readString();
+        input(i) = DMatrix::zeros(r.readSparsity());
+      }
+      obuf_.resize(n_out);
+      oscheme_.resize(n_out);
+      for (int i=0; i<n_out; ++i) {
+        oscheme_[i] = r.readString();
+        output(i) = DMatrix::zeros(r.readSparsity());
+      }
+
+      // The tape is used in place
+      r.align(BINARY_FUNCTION_ALIGN);
+      casadi_assert_message(n_alg_<=(size_-r.pos())/sizeof(ScalarAtomic),
+                            "BinaryFunction: Unexpected end of file");
+      alg_ = reinterpret_cast<const ScalarAtomic*>(r.read(n_alg_*sizeof(ScalarAtomic)));
+
+      // Make sure that all the indices in the tape are within bounds
+      for (int k=0; k<n_alg_; ++k) {
+        const ScalarAtomic& e = alg_[k];
+        bool ok;
+        switch (e.op) {
+        case OP_CONST:
+          ok = e.i0>=0 && e.i0<n_w_;
+          break;
+        case OP_INPUT:
+          ok = e.i0>=0 && e.i0<n_w_ && e.i1>=0 && e.i1<n_in && e.i2>=0
+            && e.i2<input(e.i1).nnz();
+          break;
+        case OP_OUTPUT:
+          ok = e.i0>=0 && e.i0<n_out && e.i1>=0 && e.i1<n_w_ && e.i2>=0
+            && e.i2<output(e.i0).nnz();
+          break;
+        case OP_PARAMETER:
+          ok = false;
+          break;
+        default:
+          casadi_assert_message(isTapeOperation(e.op),
+                                "BinaryFunction: Instruction " << k << " has operation "
+                                << e.op << ", which cannot be evaluated from the tape");
+          ok = e.i0>=0 && e.i0<n_w_ && e.i1>=0 && e.i1<n_w_ && e.i2>=0 && e.i2<n_w_;
+        }
+        casadi_assert_message(ok, "BinaryFunction: Corrupt instruction " << k);
+      }
+    } catch (exception& e) {
+#ifndef _WIN32
+      if (mapped_) munmap(const_cast<char*>(data_), size_);
+#endif // _WIN32
+      throw;
+    }
+
+    setOption("name", fname_);
+  }
+
+  BinaryFunctionInternal* BinaryFunctionInternal::clone() const {
+    return new BinaryFunctionInternal(filename_);
+  }
+
+  BinaryFunctionInternal::~BinaryFunctionInternal() {
+#ifndef _WIN32
+    if (mapped_) munmap(const_cast<char*>(data_), size_);
+#endif // _WIN32
+  }
+
+  void BinaryFunctionInternal::init() {
+    // Call the init function of the base class
+    FunctionInternal::init();
+
+    // Allocate work vectors
+    alloc_w(n_w_);
+    alloc();
+  }
+
+  void BinaryFunctionInternal::evalD(const double** arg, double** res, int* iw, double* w) {
+    // Evaluate the tape in place
+    const ScalarAtomic* end = alg_ + n_alg_;
+    for (const ScalarAtomic* it=alg_; it!=end; ++it) {
+      switch (it->op) {
+        CASADI_MATH_FUN_BUILTIN(w[it->i1], w[it->i2], w[it->i0])
+
+      case OP_CONST: w[it->i0] = it->d; break;
+      case OP_INPUT: w[it->i0] = arg[it->i1]==0 ? 0 : arg[it->i1][it->i2]; break;
+      case OP_OUTPUT:
+        if (res[it->i0]!=0) res[it->i0][it->i2] = w[it->i1];
+        break;
+      default:
+        casadi_error("BinaryFunctionInternal::evalD: Unknown operation" << it->op);
+      }
+    }
+  }
+
+  void BinaryFunctionInternal::spFwd(const bvec_t** arg, bvec_t** res, int* iw, bvec_t* w) {
+    const ScalarAtomic* end = alg_ + n_alg_;
+    for (const ScalarAtomic* it=alg_; it!=end; ++it) {
+      switch (it->op) {
+      case OP_CONST:
+        w[it->i0] = 0; break;
+      case OP_INPUT:
+        w[it->i0] = arg[it->i1]==0 ? 0 : arg[it->i1][it->i2]; break;
+      case OP_OUTPUT:
+        if (res[it->i0]!=0) res[it->i0][it->i2] = w[it->i1];
+        break;
+      default: // Unary or binary operation
+        w[it->i0] = w[it->i1] | w[it->i2]; break;
+      }
+    }
+  }
+
+  void BinaryFunctionInternal::spAdj(bvec_t** arg, bvec_t** res, int* iw, bvec_t* w) {
+    fill_n(w, n_w_, 0);
+    for (const ScalarAtomic* it=alg_+n_alg_; it!=alg_; ) {
+      --it;
+      bvec_t seed;
+      switch (it->op) {
+      case OP_CONST:
+        w[it->i0] = 0;
+        break;
+      case OP_INPUT:
+        if (arg[it->i1]!=0) arg[it->i1][it->i2] |= w[it->i0];
+        w[it->i0] = 0;
+        break;
+      case OP_OUTPUT:
+        if (res[it->i0]!=0) {
+          w[it->i1] |= res[it->i0][it->i2];
+          res[it->i0][it->i2] = 0;
+        }
+        break;
+      default: // Unary or binary operation
+        seed = w[it->i0];
+        w[it->i0] = 0;
+        w[it->i1] |= seed;
+        w[it->i2] |= seed;
+      }
+    }
+  }
+
+  SXFunction BinaryFunctionInternal::symbolic() {
+    if (symbolic_.isNull()) {
+      // Symbolic inputs
+      vector<SX> arg(nIn());
+      for (int i=0; i<arg.size(); ++i) {
+        arg[i] = SX::sym(ischeme_.at(i), input(i).sparsity());
+      }
+
+      // Outputs
+      vector<SX> res(nOut());
+      for (int i=0; i<res.size(); ++i) {
+        res[i] = SX::zeros(output(i).sparsity());
+      }
+
+      // Evaluate the tape symbolically
+      vector<SXElement> w(n_w_);
+      const ScalarAtomic* end = alg_ + n_alg_;
+      for (const ScalarAtomic* it=alg_; it!=end; ++it) {
+        switch (it->op) {
+        case OP_CONST: w[it->i0] = it->d; break;
+        case OP_INPUT: w[it->i0] = arg[it->i1].at(it->i2); break;
+        case OP_OUTPUT: res[it->i0].at(it->i2) = w[it->i1]; break;
+        default:
+          {
+            // Temporary, the result might overwrite the arguments
+            SXElement f;
+            switch (it->op) {
+              CASADI_MATH_FUN_BUILTIN(w[it->i1], w[it->i2], f)
+            }
+            w[it->i0] = f;
+          }
+        }
+      }
+      symbolic_ = SXFunction(fname_, arg, res,
+                             make_dict("input_scheme", ischeme_, "output_scheme", oscheme_));
+    }
+    return symbolic_;
+  }
+
+  Function BinaryFunctionInternal::getDerForward(const std::string& name, int nfwd, Dict& opts) {
+    return symbolic()->getDerForward(name, nfwd, opts);
+  }
+
+  Function BinaryFunctionInternal::getDerReverse(const std::string& name, int nadj, Dict& opts) {
+    return symbolic()->getDerReverse(name, nadj, opts);
+  }
+
+  Function BinaryFunctionInternal::getJacobian(const std::string& name, int iind, int oind,
+                                               bool compact, bool symmetric, const Dict& opts) {
+    return symbolic()->getJacobian(name, iind, oind, compact, symmetric, opts);
+  }
+
+  void BinaryFunctionInternal::save(const Function& f, const std::string& filename) {
+    // Get the expressions as an SXFunction, expanding if necessary
+    SXFunction sxf = shared_cast<SXFunction>(f);
+    if (sxf.isNull()) {
+      const BinaryFunctionInternal* b = dynamic_cast<const BinaryFunctionInternal*>(f.get());
+      if (b) {
+        sxf = const_cast<BinaryFunctionInternal*>(b)->symbolic();
+      } else {
+        sxf = SXFunction(f);
+      }
+    }
+    const SXFunctionInternal* n = sxf.operator->();
+    casadi_assert_message(n->free_vars_.empty(),
+                          "Function::save: Cannot save a function with free variables "
+                          << n->free_vars_);
+
+    ofstream file(filename.c_str(), ios::binary);
+    casadi_assert_message(file.good(), "Function::save: Cannot open \"" << filename << "\"");
+
+    // Header
+    file.write(BINARY_FUNCTION_MAGIC, 8);
+    writeInt(file, BINARY_FUNCTION_VERSION);
+    writeInt(file, BINARY_FUNCTION_BOM);
+    writeInt(file, sizeof(ScalarAtomic));
+    writeInt(file, n->nIn());
+    writeInt(file, n->nOut());
+    writeInt(file, n->sz_w());
+    writeInt(file, n->algorithm_.size());
+
+    // Name, inputs and outputs
+    writeString(file, n->name_);
+    for (int i=0; i<n->nIn(); ++i) {
+      writeString(file, n->ischeme_.at(i));
+      writeSparsity(file, n->input(i).sparsity());
+    }
+    for (int i=0; i<n->nOut(); ++i) {
+      writeString(file, n->oscheme_.at(i));
+      writeSparsity(file, n->output(i).sparsity());
+    }
+
+    // Tape, aligned, with the unused bytes of the instructions zeroed
+    size_t pos = file.tellp();
+    if (pos%BINARY_FUNCTION_ALIGN) {
+      string pad(BINARY_FUNCTION_ALIGN - pos%BINARY_FUNCTION_ALIGN, '\0');
+      file.write(pad.data(), pad.size());
+    }
+    for (vector<ScalarAtomic>::const_iterator it=n->algorithm_.begin();
+         it!=n->algorithm_.end(); ++it) {
+      ScalarAtomic e;
+      memset(&e, 0, sizeof(e));
+      e.op = it->op;
+      e.i0 = it->i0;
+      if (it->op==OP_CONST) {
+        e.d = it->d;
+      } else {
+        e.i1 = it->i1;
+        e.i2 = it->i2;
+      }
+      file.write(reinterpret_cast<const char*>(&e), sizeof(e));
+    }
+    casadi_assert_message(file.good(), "Function::save: Failed to write \"" << filename << "\"");
+  }
+
+} // namespace casadi
@@ -0,0 +1,123 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#ifndef CASADI_BINARY_FUNCTION_INTERNAL_HPP
+#define CASADI_BINARY_FUNCTION_INTERNAL_HPP
+
+#include "binary_function.hpp"
+#include "function_internal.hpp"
+
+/// \cond INTERNAL
+namespace casadi {
+
+  /** \brief  Internal class for BinaryFunction
+
+      File layout, all integers are 32 bit in native byte order:
+      - the magic string "casadibf", the format version, a byte order mark and the
+        size of an instruction
+      - the number of inputs and outputs, the size of the work vector and the number
+        of instructions
+      - the name of the function, then for each input and output its name and
+        sparsity pattern (rows, columns, column offsets, row indices), strings
+        are stored as their length followed by the characters
+      - padding to a multiple of 16 bytes, followed directly by the tape
+  */
+  class CASADI_EXPORT BinaryFunctionInternal : public FunctionInternal {
+  public:
+    /** \brief  Constructor, maps the file */
+    explicit BinaryFunctionInternal(const std::string& filename);
+
+    /** \brief  Clone, maps the file again */
+    virtual BinaryFunctionInternal* clone() const;
+
+    /** \brief  Destructor, unmaps the file */
+    virtual ~BinaryFunctionInternal();
+
+    /** \brief  Initialize */
+    virtual void init();
+
+    /** \brief  Evaluate numerically, work vectors given */
+    virtual void evalD(const double** arg, double** res, int* iw, double* w);
+
+    /** \brief  Propagate sparsity forward */
+    virtual void spFwd(const bvec_t** arg, bvec_t** res, int* iw, bvec_t* w);
+
+    /** \brief  Propagate sparsity backwards */
+    virtual void spAdj(bvec_t** arg, bvec_t** res, int* iw, bvec_t* w);
+
+    /// Is the class able to propagate seeds through the algorithm?
+    virtual bool spCanEvaluate(bool fwd) { return true;}
+
+    ///@{
+    /** \brief Forward mode derivatives, from the symbolic expressions */
+    virtual Function getDerForward(const std::string& name, int nfwd, Dict& opts);
+    virtual int numDerForward() const { return 64;}
+    ///@}
+
+    ///@{
+    /** \brief Reverse mode derivatives, from the symbolic expressions */
+    virtual Function getDerReverse(const std::string& name, int nadj, Dict& opts);
+    virtual int numDerReverse() const { return 64;}
+    ///@}
+
+    /** \brief Jacobian, from the symbolic expressions */
+    virtual Function getJacobian(const std::string& name, int iind, int oind,
+                                 bool compact, bool symmetric, const Dict& opts);
+
+    /** \brief Reconstruct the symbolic expressions */
+    SXFunction symbolic();
+
+    /** \brief Write an SXFunction, or a function that can be expanded, to a file */
+    static void save(const Function& f, const std::string& filename);
+
+  protected:
+    /// Name of the file
+    std::string filename_;
+
+    /// Contents of the file, mapped or (if mapping is not available) read
+    const char* data_;
+    size_t size_;
+    bool mapped_;
+    std::vector<char> buffer_;
+
+    /// Name of the function in the file
+    std::string fname_;
+
+    /// Instruction tape, in the file contents
+    const ScalarAtomic* alg_;
+    int n_alg_;
+
+    /// Size of the work vector
+    int n_w_;
+
+    /// Symbolic expressions, reconstructed when needed
+    SXFunction symbolic_;
+  };
+
+} // namespace casadi
+/// \endcond
+
+#endif // CASADI_BINARY_FUNCTION_INTERNAL_HPP
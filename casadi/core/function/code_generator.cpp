@@ -27,6 +27,7 @@
 #include "code_generator.hpp"
 #include "function_internal.hpp"
 #include <iomanip>
+#include <cctype>
 #include "casadi/core/runtime/runtime_embedded.hpp"
 
 using namespace std;
@@ -44,6 +45,9 @@ namespace casadi {
     this->opencl = false;
     this->meta = true;
     this->null_test = true;
+    this->static_memory = false;
+    this->specialize = false;
+    this->unroll_max = 8;
 
     // Read options
     for (Dict::const_iterator it=opts.begin(); it!=opts.end(); ++it) {
@@ -67,6 +71,12 @@ namespace casadi {
         this->meta = it->second;
       } else if (it->first=="null_test") {
         this->null_test = it->second;
+      } else if (it->first=="static_memory") {
+        this->static_memory = it->second;
+      } else if (it->first=="specialize") {
+        this->specialize = it->second;
+      } else if (it->first=="unroll_max") {
+        this->unroll_max = it->second;
       } else {
         casadi_error("Unrecongnized option: " << it->first);
       }
@@ -107,9 +117,71 @@ namespace casadi {
     if (this->meta) {
       f->generateMeta(*this, fname);
     }
+
+    // Work memory, stack usage and number of operations
+    size_t sz_real = this->real_t=="float" ? sizeof(float) : sizeof(double);
+    size_t work_bytes = (f->sz_arg() + f->sz_res())*sizeof(void*) + f->sz_iw()*sizeof(int)
+      + f->sz_w()*sz_real;
+    size_t stack_bytes, n_op;
+    f->generateCost(*this, stack_bytes, n_op);
+    Dict stats;
+    stats["sz_arg"] = static_cast<int>(f->sz_arg());
+    stats["sz_res"] = static_cast<int>(f->sz_res());
+    stats["sz_iw"] = static_cast<int>(f->sz_iw());
+    stats["sz_w"] = static_cast<int>(f->sz_w());
+    stats["work_bytes"] = static_cast<int>(work_bytes);
+    stats["stack_bytes"] = static_cast<int>(stack_bytes);
+    stats["n_op"] = static_cast<int>(n_op);
+    stats_[fname] = stats;
+
+    // Entry point with static work memory
+    if (this->static_memory) {
+      this->body
+        << "/* " << fname << ": " << work_bytes << " bytes of static work memory, "
+        << "estimated worst-case stack " << stack_bytes << " bytes, "
+        << n_op << " operations */" << endl;
+      generateStatic(f, fname);
+    }
     this->exposed_fname.push_back(fname);
   }
 
+  Dict CodeGenerator::getStats() const {
+    return stats_;
+  }
+
+  void CodeGenerator::generateStatic(const Function& f, const std::string& fname) {
+    int n_in = f.nIn(), n_out = f.nOut();
+
+    // Work vectors, at least one element since C does not allow empty arrays
+    this->body
+      << "static const real_t* " << fname << "_arg[" << max(f->sz_arg(), size_t(1)) << "];"
+      << endl
+      << "static real_t* " << fname << "_res[" << max(f->sz_res(), size_t(1)) << "];" << endl;
+    if (f->sz_iw()>0) {
+      this->body << "static int " << fname << "_iw[" << f->sz_iw() << "];" << endl;
+    }
+    if (f->sz_w()>0) {
+      this->body << "static real_t " << fname << "_w[" << f->sz_w() << "];" << endl;
+    }
+
+    // Entry point, not reentrant
+    string tmp = "int " + fname + "_static(const real_t** arg, real_t** res)";
+    if (this->cpp) tmp = "extern \"C\" " + tmp;  // C linkage
+    if (this->with_header) this->header << tmp << ";" << endl;
+    this->body << tmp << " {" << endl;
+    for (int i=0; i<n_in; ++i) {
+      this->body << "  " << fname << "_arg[" << i << "] = arg[" << i << "];" << endl;
+    }
+    for (int i=0; i<n_out; ++i) {
+      this->body << "  " << fname << "_res[" << i << "] = res[" << i << "];" << endl;
+    }
+    this->body
+      << "  return " << fname << "(" << fname << "_arg, " << fname << "_res, "
+      << (f->sz_iw()>0 ? fname + "_iw" : "0") << ", "
+      << (f->sz_w()>0 ? fname + "_w" : "0") << ");" << endl
+      << "}" << endl << endl;
+  }
+
   std::string CodeGenerator::generate() const {
     stringstream s;
     generate(s);
@@ -559,6 +631,41 @@ namespace casadi {
         << codegen_str_mm_sparse_define
         << endl;
       break;
+    case AUX_MM_DENSE:
+      this->auxiliaries << codegen_str_mm_dense
+        << codegen_str_mm_dense_define
+        << endl;
+      break;
+    case AUX_MM_LDIAG:
+      this->auxiliaries << codegen_str_mm_ldiag
+        << codegen_str_mm_ldiag_define
+        << endl;
+      break;
+    case AUX_MM_RDIAG:
+      this->auxiliaries << codegen_str_mm_rdiag
+        << codegen_str_mm_rdiag_define
+        << endl;
+      break;
+    case AUX_MM_DENSE_SPARSE:
+      this->auxiliaries << codegen_str_mm_dense_sparse
+        << codegen_str_mm_dense_sparse_define
+        << endl;
+      break;
+    case AUX_MM_BAND:
+      this->auxiliaries << codegen_str_mm_band
+        << codegen_str_mm_band_define
+        << endl;
+      break;
+    case AUX_GETRF:
+      this->auxiliaries << codegen_str_getrf
+        << codegen_str_getrf_define
+        << endl;
+      break;
+    case AUX_GETRS:
+      this->auxiliaries << codegen_str_getrs
+        << codegen_str_getrs_define
+        << endl;
+      break;
     case AUX_SQ:
       auxSq();
       break;
@@ -571,6 +678,16 @@ namespace casadi {
         << codegen_str_project_define
         << endl << endl;
       break;
+    case AUX_DENSIFY:
+      this->auxiliaries << codegen_str_densify
+        << codegen_str_densify_define
+        << endl;
+      break;
+    case AUX_SPARSIFY:
+      this->auxiliaries << codegen_str_sparsify
+        << codegen_str_sparsify_define
+        << endl;
+      break;
     case AUX_TRANS:
       this->auxiliaries << codegen_str_trans
         << "#define trans(x, sp_x, y, sp_y, tmp) CASADI_PREFIX(trans)(x, sp_x, y, sp_y, tmp)"
@@ -720,8 +837,44 @@ namespace casadi {
     return s.str();
   }
 
+  // Element of an array expression, parenthesized unless a plain identifier
+  static std::string element(const std::string& x, const std::string& i) {
+    for (string::const_iterator c=x.begin(); c!=x.end(); ++c) {
+      if (!isalnum(*c) && *c!='_') return "(" + x + ")[" + i + "]";
+    }
+    return x + "[" + i + "]";
+  }
+
+  std::string CodeGenerator::inlineAssign(const std::string& arg, int arg_off, int n,
+                                          const std::string& res, int res_off,
+                                          bool& loop) const {
+    stringstream s;
+    if (n<=this->unroll_max) {
+      // Unrolled
+      for (int i=0; i<n; ++i) {
+        s << element(res, to_string(res_off+i)) << "="
+          << (arg_off<0 ? arg : element(arg, to_string(arg_off+i))) << "; ";
+      }
+    } else {
+      // Loop with constant bounds
+      loop = true;
+      string ri = res_off==0 ? "i_" : to_string(res_off) + "+i_";
+      string ai = arg_off==0 ? "i_" : to_string(arg_off) + "+i_";
+      s << "for (i_=0; i_<" << n << "; ++i_) " << element(res, ri) << "="
+        << (arg_off<0 ? arg : element(arg, ai)) << "; ";
+    }
+    return s.str();
+  }
+
   std::string CodeGenerator::copy_n(const std::string& arg,
                                     std::size_t n, const std::string& res) {
+    // Specialized to the length
+    if (this->specialize) {
+      bool loop = false;
+      string s = inlineAssign(arg, 0, n, res, 0, loop);
+      return "{" + string(loop ? "int i_; " : "") + s + "}";
+    }
+
     stringstream s;
     // Perform operation
     addAuxiliary(AUX_COPY_N);
@@ -731,6 +884,13 @@ namespace casadi {
 
   std::string CodeGenerator::fill_n(const std::string& res,
                                     std::size_t n, const std::string& v) {
+    // Specialized to the length
+    if (this->specialize) {
+      bool loop = false;
+      string s = inlineAssign(v, -1, n, res, 0, loop);
+      return "{" + string(loop ? "int i_; " : "") + s + "}";
+    }
+
     stringstream s;
     // Perform operation
     addAuxiliary(AUX_FILL_N);
@@ -753,9 +913,53 @@ namespace casadi {
     // If sparsity match, simple copy
     if (sp_arg==sp_res) return copy_n(arg, sp_arg.nnz(), res);
 
+    // Specialized to the sparsity patterns: no sparsity tables or work vector
+    if (this->specialize) {
+      casadi_assert(sp_arg.shape()==sp_res.shape());
+
+      // Nonzero of arg for each nonzero of res, -1 if not present
+      const int *colind_arg = sp_arg.colind(), *row_arg = sp_arg.row();
+      const int *colind_res = sp_res.colind(), *row_res = sp_res.row();
+      vector<int> nz(sp_res.nnz(), -1);
+      for (int c=0; c<sp_res.size2(); ++c) {
+        int ka = colind_arg[c];
+        for (int k=colind_res[c]; k<colind_res[c+1]; ++k) {
+          while (ka<colind_arg[c+1] && row_arg[ka]<row_res[k]) ka++;
+          if (ka<colind_arg[c+1] && row_arg[ka]==row_res[k]) nz[k] = ka;
+        }
+      }
+
+      // Assign contiguous blocks of nonzeros and blocks of structural zeros
+      bool loop = false;
+      stringstream s;
+      for (int k=0; k<nz.size();) {
+        int n = 1;
+        if (nz[k]<0) {
+          while (k+n<nz.size() && nz[k+n]<0) n++;
+          s << inlineAssign("0", -1, n, res, k, loop);
+        } else {
+          while (k+n<nz.size() && nz[k+n]==nz[k]+n) n++;
+          s << inlineAssign(arg, nz[k], n, res, k, loop);
+        }
+        k += n;
+      }
+      return "{" + string(loop ? "int i_; " : "") + s.str() + "}";
+    }
+
+    // Scatter into or gather from a dense matrix, no work vector needed
+    stringstream s;
+    if (sp_res.isdense()) {
+      addAuxiliary(CodeGenerator::AUX_DENSIFY);
+      s << "densify(" << arg << ", " << sparsity(sp_arg) << ", " << res << ");";
+      return s.str();
+    } else if (sp_arg.isdense()) {
+      addAuxiliary(CodeGenerator::AUX_SPARSIFY);
+      s << "sparsify(" << arg << ", " << res << ", " << sparsity(sp_res) << ");";
+      return s.str();
+    }
+
     // Create call
     addAuxiliary(CodeGenerator::AUX_PROJECT);
-    stringstream s;
     s << "  project(" << arg << ", " << sparsity(sp_arg) << ", " << res << ", "
       << sparsity(sp_res) << ", " << w << ");";
     return s.str();
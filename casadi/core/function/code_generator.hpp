@@ -58,6 +58,16 @@ namespace casadi {
     /// Compile and load function
     std::string compile(const std::string& name, const std::string& compiler="gcc -fPIC -O2");
 
+    /** \brief Memory and cost of the generated functions
+
+        For each function added, a dictionary with the work vector lengths (sz_arg, sz_res,
+        sz_iw, sz_w), the work memory in bytes, statically allocated with the option
+        static_memory (work_bytes), the estimated worst-case stack usage in bytes
+        (stack_bytes) and the estimated number of elementary operations (n_op).
+        Byte counts use the sizes of int and pointers on the generating platform.
+    */
+    Dict getStats() const;
+
     /// Add an include file optionally using a relative path "..." instead of an absolute path <...>
     void addInclude(const std::string& new_include, bool relative_path=false,
                     const std::string& use_ifdef=std::string());
@@ -113,7 +123,16 @@ namespace casadi {
       AUX_SQ,
       AUX_SIGN,
       AUX_MM_SPARSE,
+      AUX_MM_DENSE,
+      AUX_MM_LDIAG,
+      AUX_MM_RDIAG,
+      AUX_MM_DENSE_SPARSE,
+      AUX_MM_BAND,
+      AUX_GETRF,
+      AUX_GETRS,
       AUX_PROJECT,
+      AUX_DENSIFY,
+      AUX_SPARSIFY,
       AUX_TRANS,
       AUX_TO_MEX,
       AUX_FROM_MEX,
@@ -173,6 +192,17 @@ namespace casadi {
     /// SQUARE
     void auxSq();
 
+    /** \brief Inline code assigning n elements of res, starting at res_off
+
+        The elements are read from arg starting at arg_off or, if arg_off<0, set to the
+        scalar expression arg. Sets loop to true if the loop counter i_ is used.
+    */
+    std::string inlineAssign(const std::string& arg, int arg_off, int n,
+                             const std::string& res, int res_off, bool& loop) const;
+
+    /// Statically allocated work vectors and entry point for a function
+    void generateStatic(const Function& f, const std::string& fname);
+
     /// SIGN
     void auxSign();
 
@@ -208,6 +238,21 @@ namespace casadi {
 
     bool null_test;
 
+    /** \brief Static memory
+     * Allocate the work vectors of each function statically and generate an entry
+     * point <fname>_static(arg, res) that does not need any work memory from the caller
+     */
+    bool static_memory;
+
+    /** \brief Specialize
+     * Generate copy, fill and sparse assignment operations inline, for their compile-time
+     * lengths and sparsity patterns, instead of calling the generic auxiliary functions
+     */
+    bool specialize;
+
+    /// Maximum number of iterations of a specialized loop that is unrolled
+    int unroll_max;
+
     /** \brief Codegen scalar
      * Use the work vector for storing work vector elements of length 1
      * (typically scalar) instead of using local variables
@@ -226,6 +271,9 @@ namespace casadi {
     // Names of exposed functions
     std::vector<std::string> exposed_fname;
 
+    // Memory and cost of the exposed functions
+    Dict stats_;
+
     // Set of already included header files
     typedef std::map<const void*, int> PointerMap;
     std::set<std::string> added_includes_;
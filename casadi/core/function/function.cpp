@@ -30,6 +30,7 @@
 #include "../function/map.hpp"
 #include "../function/mapaccum.hpp"
 #include "../function/external_function.hpp"
+#include "../function/binary_function_internal.hpp"
 
 using namespace std;
 
@@ -223,6 +224,19 @@ namespace casadi {
     (*this)->setJacobian(jac, iind, oind, compact);
   }
 
+  std::string Function::getJacobianPlan(int iind, int oind, bool symmetric) {
+    assertInit();
+    stringstream ss;
+    (*this)->getJacobianPlan(iind, oind, symmetric).serialize(ss);
+    return ss.str();
+  }
+
+  void Function::setJacobianPlan(const std::string& plan, int iind, int oind, bool symmetric) {
+    assertInit();
+    stringstream ss(plan);
+    (*this)->setJacobianPlan(JacobianPlan::deserialize(ss), iind, oind, symmetric);
+  }
+
   Function Function::gradient(int iind, int oind) {
     assertInit();
     return (*this)->gradient(iind, oind);
@@ -577,6 +591,11 @@ namespace casadi {
     (*this)->printDimensions(stream);
   }
 
+  void Function::save(const string& filename) {
+    assertInit();
+    BinaryFunctionInternal::save(*this, filename);
+  }
+
   void Function::generate(const Dict& opts) {
     generate(getSanitizedName(), opts);
   }
@@ -942,6 +961,11 @@ namespace casadi {
     (*this)->eval(arg, res, iw, w);
   }
 
+  void Function::operator()(const std::vector<const double*>& arg,
+                            const std::vector<double*>& res) {
+    (*this)->call(arg, res);
+  }
+
   void Function::operator()(const SXElement** arg, SXElement** res, int* iw, SXElement* w) {
     (*this)->evalSX(arg, res, iw, w);
   }
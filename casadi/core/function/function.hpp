@@ -234,6 +234,20 @@ namespace casadi {
      NOTE: Does _not_ take ownership, only weak references to the Jacobians are kept internally */
     void setJacobian(const Function& jac, int iind=0, int oind=0, bool compact=false);
 
+    /** \brief Get the evaluation plan of a Jacobian (or Hessian if \a symmetric) block
+     *
+     * The plan contains the graph coloring and the decompression index map, which only
+     * depend on the sparsity pattern of the block. It is returned in serialized form
+     * so that it can be stored and passed to setJacobianPlan, e.g. in a later session.
+     */
+    std::string getJacobianPlan(int iind=0, int oind=0, bool symmetric=false);
+
+    /** \brief Set the evaluation plan of a Jacobian block, as returned by getJacobianPlan
+     *
+     * The Jacobian sparsity pattern must match the one the plan was computed for.
+     */
+    void setJacobianPlan(const std::string& plan, int iind=0, int oind=0, bool symmetric=false);
+
     ///@{
     /** \brief Generate a gradient function of output \a oind with respect to input \a iind
      * \param iind The index of the input
@@ -337,6 +351,13 @@ namespace casadi {
     /** \brief Evaluate memory-less, numerically */
     void operator()(const double** arg, double** res, int* iw, double* w);
 
+    /** \brief Evaluate numerically, binding caller-owned buffers
+        One pointer to the nonzeros per input and per output. A null input is treated
+        as zero, a null output is not calculated. No data is copied and, after the
+        first call, no memory is allocated.
+     */
+    void operator()(const std::vector<const double*>& arg, const std::vector<double*>& res);
+
     /** \brief Evaluate memory-less SXElement
         Same syntax as the double version, allowing use in templated code
      */
@@ -586,6 +607,12 @@ namespace casadi {
     /** \brief Export / Generate C code for the function */
     void generate(const Dict& opts=Dict());
 
+    /** \brief Save the function to a binary file, which can be loaded with BinaryFunction
+     *
+     * Functions other than SXFunction are expanded first.
+     */
+    void save(const std::string& filename);
+
     /** \brief Wrap a function in an MXFunction package */
     Function wrap(const std::string& fname, const Dict& opts=Dict());
 
@@ -98,6 +98,13 @@ namespace casadi {
     addOption("starcoloring_threshold", OT_INTEGER, -1, "Sets the maximum amount of nonzeros "
                                                         "in a row for which coloring will be "
                                                         "attempted.");
+    addOption("coloring_ordering", OT_STRING, GenericType(),
+              "Vertex ordering for the graph coloring of Jacobian and Hessian sparsity "
+              "patterns. Default is natural for Jacobians and largest first for Hessians.",
+              "natural|largest_first|smallest_last|incidence_degree");
+    addOption("bidirectional_coloring", OT_BOOLEAN, false,
+              "Also consider bidirectional partitions of Jacobians, with the densest rows "
+              "(columns) calculated in adjoint (forward) mode and the rest in the other mode.");
 
     verbose_ = false;
     jit_ = false;
@@ -112,6 +119,8 @@ namespace casadi {
   }
 
   FunctionInternal::~FunctionInternal() {
+    // Derivatives kept alive by the global cache can no longer be retrieved
+    uncacheDerivatives();
   }
 
   void FunctionInternal::deepCopyMembers(
@@ -140,6 +149,21 @@ namespace casadi {
 
     starcoloring_threshold_ = getOption("starcoloring_threshold");
     starcoloring_mode_ = getOption("starcoloring_mode");
+    if (hasSetOption("coloring_ordering")) {
+      std::string ordering = getOption("coloring_ordering");
+      if (ordering=="natural") {
+        coloring_ordering_ = 0;
+      } else if (ordering=="largest_first") {
+        coloring_ordering_ = 1;
+      } else if (ordering=="smallest_last") {
+        coloring_ordering_ = 2;
+      } else {
+        coloring_ordering_ = 3;
+      }
+    } else {
+      coloring_ordering_ = -1;
+    }
+    bidirectional_coloring_ = getOption("bidirectional_coloring");
 
     // Warn for functions with too many inputs or outputs
     casadi_assert_warning(nIn()<10000, "Function " << getOption("name")
@@ -153,6 +177,7 @@ namespace casadi {
     jac_sparsity_ = jac_sparsity_compact_ =
         SparseStorage<Sparsity>(Sparsity(nOut(), nIn()));
     jac_ = jac_compact_ = SparseStorage<WeakRef>(Sparsity(nOut(), nIn()));
+    jac_plan_.clear();
 
     if (hasSetOption("user_data")) {
       user_data_ = getOption("user_data").toVoidPointer();
@@ -356,6 +381,10 @@ namespace casadi {
 
     opts["starcoloring_mode"]      = starcoloring_mode_;
     opts["starcoloring_threshold"] = starcoloring_threshold_;
+    opts["bidirectional_coloring"] = bidirectional_coloring_;
+    if (hasSetOption("coloring_ordering")) {
+      opts["coloring_ordering"] = getOption("coloring_ordering");
+    }
 
     // Propagate AD rules (options to be deprecated)
     const char* oname[] = {"custom_forward", "custom_reverse",  "full_jacobian"};
@@ -1254,14 +1283,20 @@ namespace casadi {
     Sparsity &AT = jacSparsity(iind, oind, compact, symmetric);
     Sparsity A = symmetric ? AT : AT.T();
 
+    // Number of colors (-1 if interrupted) and time for each coloring method
+    Dict coloring_stats;
+
     // Get seed matrices by graph coloring
     if (symmetric) {
       casadi_assert(numDerForward()>0);
 
       // Star coloring if symmetric
       log("FunctionInternal::getPartition starColoring");
-      D1 = A.starColoring(1, std::numeric_limits<int>::max(),
-                             starcoloring_mode_, starcoloring_threshold_);
+      double t0 = getRealTime();
+      D1 = A.starColoring(coloring_ordering_>=0 ? coloring_ordering_ : 1,
+                          std::numeric_limits<int>::max(),
+                          starcoloring_mode_, starcoloring_threshold_);
+      coloring_stats["star"] = make_dict("colors", D1.size2(), "time", getRealTime()-t0);
       casadi_msg("Star coloring completed: " << D1.size2() << " directional derivatives needed ("
                  << A.size1() << " without coloring).");
 
@@ -1273,6 +1308,9 @@ namespace casadi {
       // Which AD mode?
       bool test_ad_fwd=w<1, test_ad_adj=w>0;
 
+      // Vertex ordering
+      int ordering = coloring_ordering_>=0 ? coloring_ordering_ : 0;
+
       // Best coloring encountered so far (relatively tight upper bound)
       double best_coloring = numeric_limits<double>::infinity();
 
@@ -1290,11 +1328,14 @@ namespace casadi {
         if (!test_ad_adj && !fwd) continue;
 
         // Perform the coloring
+        double t0 = getRealTime();
         if (fwd) {
           log("FunctionInternal::getPartition unidirectional coloring (forward mode)");
           int max_colorings_to_test = best_coloring>=w*A.size1() ? A.size1() :
             floor(best_coloring/w);
-          D1 = AT.unidirectionalColoring(A, max_colorings_to_test);
+          D1 = AT.unidirectionalColoring(A, max_colorings_to_test, ordering);
+          coloring_stats["fwd"] = make_dict("colors", D1.isNull() ? -1 : D1.size2(),
+                                            "time", getRealTime()-t0);
           if (D1.isNull()) {
             if (verbose()) userOut() << "Forward mode coloring interrupted (more than "
                                << max_colorings_to_test << " needed)." << endl;
@@ -1310,7 +1351,9 @@ namespace casadi {
           int max_colorings_to_test = best_coloring>=(1-w)*A.size2() ? A.size2() :
             floor(best_coloring/(1-w));
 
-          D2 = A.unidirectionalColoring(AT, max_colorings_to_test);
+          D2 = A.unidirectionalColoring(AT, max_colorings_to_test, ordering);
+          coloring_stats["adj"] = make_dict("colors", D2.isNull() ? -1 : D2.size2(),
+                                            "time", getRealTime()-t0);
           if (D2.isNull()) {
             if (verbose()) userOut() << "Adjoint mode coloring interrupted (more than "
                                << max_colorings_to_test << " needed)." << endl;
@@ -1324,26 +1367,162 @@ namespace casadi {
         }
       }
 
+      // Bidirectional partition, i.e. forward and adjoint directions combined
+      if (bidirectional_coloring_ && test_ad_fwd && test_ad_adj) {
+        log("FunctionInternal::getPartition bidirectional coloring");
+        double t0 = getRealTime();
+        Sparsity B1, B2;
+        AT.bidirectionalColoring(B1, B2, w, ordering);
+        int nfwd = B1.isNull() ? 0 : B1.size2();
+        int nadj = B2.isNull() ? 0 : B2.size2();
+        coloring_stats["bidirectional"] = make_dict("fwd", nfwd, "adj", nadj,
+                                                    "time", getRealTime()-t0);
+        if (verbose()) userOut() << "Bidirectional coloring completed: " << nfwd
+                                 << " forward and " << nadj << " adjoint directional "
+                                 << "derivatives needed." << endl;
+        if (w*nfwd + (1-w)*nadj < best_coloring) {
+          D1 = B1;
+          D2 = B2;
+          best_coloring = w*nfwd + (1-w)*nadj;
+        }
+      }
     }
+    stats_["coloring"] = coloring_stats;
     log("FunctionInternal::getPartition end");
   }
 
+  const JacobianPlan& FunctionInternal::getJacobianPlan(int iind, int oind, bool symmetric) {
+    // Quick return if already available
+    JacobianPlan& plan = jac_plan_[2*(oind*nIn()+iind) + (symmetric ? 1 : 0)];
+    if (!plan.isNull()) return plan;
+
+    // Options affecting the coloring
+    stringstream ss;
+    ss << adWeight() << " " << coloring_ordering_ << " " << bidirectional_coloring_ << " "
+       << starcoloring_mode_ << " " << starcoloring_threshold_;
+    string settings = ss.str();
+
+    // Look for a plan computed by another function with the same Jacobian sparsity
+    const Sparsity& sp = jacSparsity(iind, oind, true, symmetric);
+    if (JacobianPlan::getCached(sp, symmetric, settings, plan)) {
+      log("FunctionInternal::getJacobianPlan", "reusing cached plan");
+      stats_["coloring"] = plan.stats;
+      return plan;
+    }
+
+    // Compute a new plan
+    double t0 = getRealTime();
+    Sparsity D1, D2;
+    getPartition(iind, oind, D1, D2, true, symmetric);
+    plan = JacobianPlan(sp, symmetric, D1, D2);
+    plan.stats = stats_["coloring"];
+    stats_["t_jacobian_plan"] = getRealTime()-t0;
+    JacobianPlan::addCached(settings, plan);
+    return plan;
+  }
+
+  void FunctionInternal::setJacobianPlan(const JacobianPlan& plan, int iind, int oind,
+                                         bool symmetric) {
+    casadi_assert_message(plan.symmetric==symmetric,
+                          "FunctionInternal::setJacobianPlan: Mismatching symmetry");
+    casadi_assert_message(plan.sp.isEqual(jacSparsity(iind, oind, true, symmetric)),
+                          "FunctionInternal::setJacobianPlan: Mismatching Jacobian sparsity");
+    jac_plan_[2*(oind*nIn()+iind) + (symmetric ? 1 : 0)] = plan;
+  }
+
+  /// Derivative functions kept alive by the global derivative cache, most recently used first
+  static list<Function>& getDerivativeCache() {
+    // Never destroyed, the functions may refer to other static objects
+    static list<Function>* cache = new list<Function>();
+    return *cache;
+  }
+
+  void FunctionInternal::cacheDerivative(const Function& fcn) {
+    if (CasadiOptions::derivative_cache_size<=0) return;
+    list<Function>& cache = getDerivativeCache();
+    for (list<Function>::iterator it=cache.begin(); it!=cache.end(); ++it) {
+      if (it->get()==fcn.get()) {
+        // Move to the front
+        cache.splice(cache.begin(), cache, it);
+        return;
+      }
+    }
+    cache.push_front(fcn);
+    trimDerivativeCache();
+  }
+
+  void FunctionInternal::trimDerivativeCache() {
+    list<Function>& cache = getDerivativeCache();
+    while (cache.size()>max(CasadiOptions::derivative_cache_size, 0)) cache.pop_back();
+  }
+
+  // Defined here rather than in casadi_options.cpp, next to the cache it trims
+  void CasadiOptions::setDerivativeCacheSize(int n) {
+    derivative_cache_size = n;
+    FunctionInternal::trimDerivativeCache();
+  }
+
+  void FunctionInternal::uncacheDerivatives() {
+    list<Function>& cache = getDerivativeCache();
+    if (cache.empty()) return;
+
+    // Derivative functions that are still alive
+    vector<WeakRef> der(derivative_fwd_);
+    der.insert(der.end(), derivative_adj_.begin(), derivative_adj_.end());
+    der.insert(der.end(), jac_.data().begin(), jac_.data().end());
+    der.insert(der.end(), jac_compact_.data().begin(), jac_compact_.data().end());
+    der.push_back(full_jacobian_);
+    vector<const SharedObjectNode*> der_nodes;
+    for (vector<WeakRef>::iterator it=der.begin(); it!=der.end(); ++it) {
+      if (it->alive()) der_nodes.push_back(it->shared().get());
+    }
+    if (der_nodes.empty()) return;
+
+    // Move them out of the cache, they are released when the list goes out of scope,
+    // since their destructors may modify the cache as well
+    list<Function> dropped;
+    for (list<Function>::iterator it=cache.begin(); it!=cache.end(); ) {
+      list<Function>::iterator next = it;
+      ++next;
+      if (find(der_nodes.begin(), der_nodes.end(), it->get())!=der_nodes.end()) {
+        dropped.splice(dropped.end(), cache, it);
+      }
+      it = next;
+    }
+  }
+
   void FunctionInternal::evaluate() {
     // Allocate temporary memory if needed
     alloc();
 
     // Get pointers to input arguments
     int n_in = nIn();
-    vector<const double*> arg(sz_arg());
-    for (int i=0; i<n_in; ++i) arg[i]=input(i).ptr();
+    for (int i=0; i<n_in; ++i) arg_tmp_[i]=input(i).ptr();
 
     // Get pointers to output arguments
     int n_out = nOut();
-    vector<double*> res(sz_res());
-    for (int i=0; i<n_out; ++i) res[i]=output(i).ptr();
+    for (int i=0; i<n_out; ++i) res_tmp_[i]=output(i).ptr();
+
+    // Call memory-less
+    eval(getPtr(arg_tmp_), getPtr(res_tmp_), getPtr(iw_tmp_), getPtr(w_tmp_));
+  }
+
+  void FunctionInternal::call(const std::vector<const double*>& arg,
+                              const std::vector<double*>& res) {
+    casadi_assert_message(arg.size()==nIn(), "FunctionInternal::call: Expected "
+                          << nIn() << " input pointers, got " << arg.size() << ".");
+    casadi_assert_message(res.size()==nOut(), "FunctionInternal::call: Expected "
+                          << nOut() << " output pointers, got " << res.size() << ".");
+
+    // Allocate temporary memory if needed
+    alloc();
+
+    // Bind the buffers, the remainder of arg_tmp_ and res_tmp_ is work space
+    copy(arg.begin(), arg.end(), arg_tmp_.begin());
+    copy(res.begin(), res.end(), res_tmp_.begin());
 
     // Call memory-less
-    eval(getPtr(arg), getPtr(res), getPtr(iw_tmp_), getPtr(w_tmp_));
+    eval(getPtr(arg_tmp_), getPtr(res_tmp_), getPtr(iw_tmp_), getPtr(w_tmp_));
   }
 
   void FunctionInternal::evalD(const double** arg,
@@ -1582,7 +1761,9 @@ namespace casadi {
     // Check if cached
     if (cached.alive()) {
       // Return an owning reference
-      return shared_cast<Function>(cached.shared());
+      Function ret = shared_cast<Function>(cached.shared());
+      cacheDerivative(ret);
+      return ret;
 
     } else {
       // Give it a suitable name
@@ -1608,6 +1789,7 @@ namespace casadi {
 
       // Save in cache
       compact ? jac_compact_.elem(oind, iind) : jac_.elem(oind, iind) = ret;
+      cacheDerivative(ret);
       return ret;
     }
   }
@@ -1636,7 +1818,9 @@ namespace casadi {
 
     // Quick return if already cached
     if (derivative_fwd_[nfwd].alive()) {
-      return shared_cast<Function>(derivative_fwd_[nfwd].shared());
+      Function ret = shared_cast<Function>(derivative_fwd_[nfwd].shared());
+      cacheDerivative(ret);
+      return ret;
     }
 
     // Give it a suitable name
@@ -1728,6 +1912,7 @@ namespace casadi {
 
     // Save to cache
     derivative_fwd_[nfwd] = ret;
+    cacheDerivative(ret);
 
     // Return generated function
     return ret;
@@ -1743,7 +1928,9 @@ namespace casadi {
 
     // Quick return if already cached
     if (derivative_adj_[nadj].alive()) {
-      return shared_cast<Function>(derivative_adj_[nadj].shared());
+      Function ret = shared_cast<Function>(derivative_adj_[nadj].shared());
+      cacheDerivative(ret);
+      return ret;
     }
 
     // Give it a suitable name
@@ -1834,6 +2021,7 @@ namespace casadi {
 
     // Save to cache
     derivative_adj_[nadj] = ret;
+    cacheDerivative(ret);
 
     // Return generated function
     return ret;
@@ -2412,6 +2600,11 @@ namespace casadi {
     // Nothing to declare
   }
 
+  void FunctionInternal::generateCost(const CodeGenerator& g, size_t& stack,
+                                      size_t& n_op) const {
+    stack = n_op = 0;
+  }
+
   void FunctionInternal::generateBody(CodeGenerator& g) const {
     casadi_error("FunctionInternal::generateBody: generateBody not defined for class "
                  << typeid(*this).name());
@@ -2592,6 +2785,8 @@ namespace casadi {
   }
 
   void FunctionInternal::alloc() {
+    arg_tmp_.resize(sz_arg_);
+    res_tmp_.resize(sz_res_);
     iw_tmp_.resize(sz_iw_);
     w_tmp_.resize(sz_w_);
   }
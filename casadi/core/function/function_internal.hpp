@@ -33,6 +33,7 @@
 #include "code_generator.hpp"
 #include "compiler.hpp"
 #include "../matrix/sparse_storage.hpp"
+#include "jacobian_plan.hpp"
 
 // This macro is for documentation purposes
 #define INPUTSCHEME(name)
@@ -116,6 +117,10 @@ namespace casadi {
     /** \brief  Evaluate numerically, work vectors given */
     virtual void evalD(const double** arg, double** res, int* iw, double* w);
 
+    /** \brief  Evaluate numerically, binding caller-owned buffers
+        Uses the preallocated work vectors, i.e. without copying nonzeros or allocating memory */
+    void call(const std::vector<const double*>& arg, const std::vector<double*>& res);
+
     /** \brief Quickfix to avoid segfault, #1552 */
     virtual bool canEvalSX() const {return false;}
 
@@ -288,6 +293,10 @@ namespace casadi {
     /** \brief Generate code for the function body */
     virtual void generateBody(CodeGenerator& g) const;
 
+    /** \brief Estimated worst-case stack usage (bytes) and number of elementary operations
+     * of the generated code, including the functions called. Zero if not available. */
+    virtual void generateCost(const CodeGenerator& g, size_t& stack, size_t& n_op) const;
+
     /** \brief  Print */
     virtual void print(std::ostream &stream) const;
 
@@ -303,6 +312,21 @@ namespace casadi {
     /** \brief Get the unidirectional or bidirectional partition */
     void getPartition(int iind, int oind, Sparsity& D1, Sparsity& D2, bool compact, bool symmetric);
 
+    /** \brief Get the plan for evaluating a compact Jacobian block, computed if needed */
+    const JacobianPlan& getJacobianPlan(int iind, int oind, bool symmetric);
+
+    /** \brief Set the plan for evaluating a compact Jacobian block, e.g. a deserialized one */
+    void setJacobianPlan(const JacobianPlan& plan, int iind, int oind, bool symmetric);
+
+    /** \brief Keep a derivative function alive in the global derivative cache */
+    static void cacheDerivative(const Function& fcn);
+
+    /** \brief Drop derivative functions exceeding CasadiOptions::derivative_cache_size */
+    static void trimDerivativeCache();
+
+    /** \brief Drop the derivatives of this function from the global derivative cache */
+    void uncacheDerivatives();
+
     /// Verbose mode?
     bool verbose() const;
 
@@ -623,6 +647,9 @@ namespace casadi {
     /// Cache for Jacobians
     SparseStorage<WeakRef> jac_, jac_compact_;
 
+    /// Cache for Jacobian plans, key 2*(oind*nIn()+iind)+symmetric
+    std::map<int, JacobianPlan> jac_plan_;
+
     /// User-set field
     void* user_data_;
 
@@ -645,6 +672,12 @@ namespace casadi {
     int starcoloring_threshold_;
     int starcoloring_mode_;
 
+    /// Vertex ordering for the graph coloring, -1 for default
+    int coloring_ordering_;
+
+    /// Consider bidirectional partitions of Jacobians
+    bool bidirectional_coloring_;
+
     /** \brief get function name with all non alphanumeric characters converted to '_' */
     std::string getSanitizedName() const;
 
@@ -664,6 +697,12 @@ namespace casadi {
     std::vector<std::vector<MatType> > symbolicAdjSeed(int nadj, const std::vector<MatType>& v);
 
   protected:
+    /** \brief  Temporary vector needed for the evaluation (pointers to arguments) */
+    std::vector<const double*> arg_tmp_;
+
+    /** \brief  Temporary vector needed for the evaluation (pointers to results) */
+    std::vector<double*> res_tmp_;
+
     /** \brief  Temporary vector needed for the evaluation (integer) */
     std::vector<int> iw_tmp_;
 
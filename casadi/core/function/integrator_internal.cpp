@@ -54,6 +54,9 @@ namespace casadi {
     // Negative number of parameters for consistancy checking
     np_ = -1;
 
+    // A single trajectory unless set by a plugin supporting ensembles
+    ensemble_ = 1;
+
     ischeme_ = IOScheme(SCHEME_IntegratorInput);
     oscheme_ = IOScheme(SCHEME_IntegratorOutput);
   }
@@ -114,25 +117,26 @@ namespace casadi {
       nrq_ = g_.output(RDAE_QUAD).nnz();
     }
 
-    // Allocate space for inputs
+    // Allocate space for inputs, trajectories of an ensemble are stacked horizontally
+    casadi_assert(ensemble_>=1);
     ibuf_.resize(INTEGRATOR_NUM_IN);
-    x0()  = DMatrix::zeros(f_.input(DAE_X).sparsity());
-    p()   = DMatrix::zeros(f_.input(DAE_P).sparsity());
-    z0()   = DMatrix::zeros(f_.input(DAE_Z).sparsity());
+    x0()  = DMatrix::zeros(repmat(f_.input(DAE_X).sparsity(), 1, ensemble_));
+    p()   = DMatrix::zeros(repmat(f_.input(DAE_P).sparsity(), 1, ensemble_));
+    z0()   = DMatrix::zeros(repmat(f_.input(DAE_Z).sparsity(), 1, ensemble_));
     if (!g_.isNull()) {
-      rx0()  = DMatrix::zeros(g_.input(RDAE_RX).sparsity());
-      rp()  = DMatrix::zeros(g_.input(RDAE_RP).sparsity());
-      rz0()  = DMatrix::zeros(g_.input(RDAE_RZ).sparsity());
+      rx0()  = DMatrix::zeros(repmat(g_.input(RDAE_RX).sparsity(), 1, ensemble_));
+      rp()  = DMatrix::zeros(repmat(g_.input(RDAE_RP).sparsity(), 1, ensemble_));
+      rz0()  = DMatrix::zeros(repmat(g_.input(RDAE_RZ).sparsity(), 1, ensemble_));
     }
 
     // Allocate space for outputs
     obuf_.resize(INTEGRATOR_NUM_OUT);
     xf() = x0();
-    qf() = DMatrix::zeros(f_.output(DAE_QUAD).sparsity());
+    qf() = DMatrix::zeros(repmat(f_.output(DAE_QUAD).sparsity(), 1, ensemble_));
     zf() = z0();
     if (!g_.isNull()) {
       rxf()  = rx0();
-      rqf()  = DMatrix::zeros(g_.output(RDAE_QUAD).sparsity());
+      rqf()  = DMatrix::zeros(repmat(g_.output(RDAE_QUAD).sparsity(), 1, ensemble_));
       rzf()  = rz0();
     }
 
@@ -141,22 +145,22 @@ namespace casadi {
                           "Sparse states in integrators are experimental");
 
     // Consistency checks
-    casadi_assert_message(f_.output(DAE_ODE).shape()==x0().shape(),
+    casadi_assert_message(f_.output(DAE_ODE).shape()==f_.input(DAE_X).shape(),
                           "Inconsistent dimensions. Expecting DAE_ODE output of shape "
-                          << x0().shape() << ", but got "
+                          << f_.input(DAE_X).shape() << ", but got "
                           << f_.output(DAE_ODE).shape() << " instead.");
-    casadi_assert(f_.output(DAE_ODE).sparsity()==x0().sparsity());
-    casadi_assert_message(f_.output(DAE_ALG).shape()==z0().shape(),
+    casadi_assert(f_.output(DAE_ODE).sparsity()==f_.input(DAE_X).sparsity());
+    casadi_assert_message(f_.output(DAE_ALG).shape()==f_.input(DAE_Z).shape(),
                           "Inconsistent dimensions. Expecting DAE_ALG output of shape "
-                          << z0().shape() << ", but got "
+                          << f_.input(DAE_Z).shape() << ", but got "
                           << f_.output(DAE_ALG).shape() << " instead.");
-    casadi_assert(f_.output(DAE_ALG).sparsity()==z0().sparsity());
+    casadi_assert(f_.output(DAE_ALG).sparsity()==f_.input(DAE_Z).sparsity());
     if (!g_.isNull()) {
-      casadi_assert(g_.input(RDAE_P).sparsity()==p().sparsity());
-      casadi_assert(g_.input(RDAE_X).sparsity()==x0().sparsity());
-      casadi_assert(g_.input(RDAE_Z).sparsity()==z0().sparsity());
-      casadi_assert(g_.output(RDAE_ODE).sparsity()==rx0().sparsity());
-      casadi_assert(g_.output(RDAE_ALG).sparsity()==rz0().sparsity());
+      casadi_assert(g_.input(RDAE_P).sparsity()==f_.input(DAE_P).sparsity());
+      casadi_assert(g_.input(RDAE_X).sparsity()==f_.input(DAE_X).sparsity());
+      casadi_assert(g_.input(RDAE_Z).sparsity()==f_.input(DAE_Z).sparsity());
+      casadi_assert(g_.output(RDAE_ODE).sparsity()==g_.input(RDAE_RX).sparsity());
+      casadi_assert(g_.output(RDAE_ALG).sparsity()==g_.input(RDAE_RZ).sparsity());
     }
 
     // Call the base class method
@@ -190,6 +194,7 @@ namespace casadi {
     sz_w = max(sz_w, static_cast<size_t>(nx_+nz_));
     sz_w = max(sz_w, static_cast<size_t>(nrx_+nrz_));
     alloc_w(sz_w + nx_ + nz_ + nrx_ + nrz_);
+    alloc();
   }
 
   void IntegratorInternal::deepCopyMembers(
@@ -488,6 +493,7 @@ namespace casadi {
 
   void IntegratorInternal::spFwd(const bvec_t** arg, bvec_t** res, int* iw, bvec_t* w) {
     log("IntegratorInternal::spFwd", "begin");
+    casadi_assert_message(ensemble_==1, "Sparsity propagation not supported in ensemble mode");
 
     // Work vectors
     bvec_t *tmp_x = w; w += nx_;
@@ -575,6 +581,7 @@ namespace casadi {
 
   void IntegratorInternal::spAdj(bvec_t** arg, bvec_t** res, int* iw, bvec_t* w) {
     log("IntegratorInternal::spAdj", "begin");
+    casadi_assert_message(ensemble_==1, "Sparsity propagation not supported in ensemble mode");
 
     // Work vectors
     bvec_t** arg1 = arg+nIn();
@@ -740,21 +747,11 @@ namespace casadi {
 
   Function IntegratorInternal::getDerForward(const std::string& name, int nfwd, Dict& opts) {
     log("IntegratorInternal::getDerForward", "begin");
+    casadi_assert_message(ensemble_==1, "Sensitivities not supported in ensemble mode");
 
-    // Form the augmented DAE
+    // Create integrator for the forward sensitivity problem
     AugOffset offset;
-    std::pair<Function, Function> aug_dae = getAugmented(nfwd, 0, offset);
-
-    // Create integrator for augmented DAE
-    Integrator integrator;
-    integrator.assignNode(create(aug_dae.first, aug_dae.second));
-
-    // Set solver specific options
-    setDerivativeOptions(integrator, offset);
-
-    // Pass down specific options if provided
-    if (hasSetOption("augmented_options"))
-      integrator.setOption(getOption("augmented_options"));
+    Integrator integrator = getFwdSensIntegrator(nfwd, offset);
 
     // Initialize the integrator since we will call it below
     integrator.init();
@@ -881,8 +878,26 @@ namespace casadi {
     return MXFunction(name, ret_in, ret_out, opts);
   }
 
+  Integrator IntegratorInternal::getFwdSensIntegrator(int nfwd, AugOffset& offset) {
+    // Form the augmented DAE
+    std::pair<Function, Function> aug_dae = getAugmented(nfwd, 0, offset);
+
+    // Create integrator for augmented DAE
+    Integrator integrator;
+    integrator.assignNode(create(aug_dae.first, aug_dae.second));
+
+    // Set solver specific options
+    setDerivativeOptions(integrator, offset);
+
+    // Pass down specific options if provided
+    if (hasSetOption("augmented_options"))
+      integrator.setOption(getOption("augmented_options"));
+    return integrator;
+  }
+
   Function IntegratorInternal::getDerReverse(const std::string& name, int nadj, Dict& opts) {
     log("IntegratorInternal::getDerReverse", "begin");
+    casadi_assert_message(ensemble_==1, "Sensitivities not supported in ensemble mode");
 
     // Form the augmented DAE
     AugOffset offset;
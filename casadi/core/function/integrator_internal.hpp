@@ -112,6 +112,10 @@ namespace casadi {
     /** \brief Set solver specific options to generated augmented integrators */
     virtual void setDerivativeOptions(Integrator& integrator, const AugOffset& offset);
 
+    /** \brief Create an integrator for the problem and \a nfwd forward sensitivities,
+     * stacked horizontally as in the augmented DAE returned by getAugmented */
+    virtual Integrator getFwdSensIntegrator(int nfwd, AugOffset& offset);
+
     /** \brief Generate a augmented DAE system with \a nfwd forward sensitivities
     * and \a nadj adjoint sensitivities */
     virtual std::pair<Function, Function> getAugmented(int nfwd, int nadj, AugOffset& offset);
@@ -150,6 +154,9 @@ namespace casadi {
     /// Number of forward and backward parameters
     int np_, nrp_;
 
+    /// Number of trajectories integrated simultaneously (ensemble mode)
+    int ensemble_;
+
     /// Integration horizon
     double t0_, tf_;
 
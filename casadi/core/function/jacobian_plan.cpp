@@ -0,0 +1,283 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#include "jacobian_plan.hpp"
+#include "../casadi_options.hpp"
+#include "../casadi_mutex.hpp"
+#include <list>
+
+using namespace std;
+namespace casadi {
+
+  JacobianPlan::JacobianPlan() : symmetric(false) {
+  }
+
+  JacobianPlan::JacobianPlan(const Sparsity& sp, bool symmetric, const Sparsity& D1,
+                             const Sparsity& D2) : sp(sp), symmetric(symmetric), D1(D1), D2(D2) {
+    // Transpose, with the position in sp of each nonzero of the transpose
+    vector<int> mapping;
+    Sparsity spT = sp.transpose(mapping);
+    const int* colind = sp.colind();
+    const int* row = sp.row();
+    const int* colindT = spT.colind();
+    const int* rowT = spT.row();
+
+    // Bidirectional partition: only use the nonzeros that are determined directly
+    bool bidirectional = nfwd()>0 && nadj()>0;
+
+    // Number of times each nonzero appears in a direction
+    vector<int> count;
+
+    // Forward directions
+    fwd_ptr.resize(1, 0);
+    for (int d=0; d<nfwd(); ++d) {
+      // If symmetric or bidirectional, see how many times each output appears
+      if (symmetric || bidirectional) {
+        count.assign(sp.size1(), 0);
+        for (int el=D1.colind(d); el<D1.colind(d+1); ++el) {
+          int c = D1.row(el);
+          for (int k=colind[c]; k<colind[c+1]; ++k) count[row[k]]++;
+        }
+      }
+
+      // For all the input nonzeros seeded in the direction
+      for (int el=D1.colind(d); el<D1.colind(d+1); ++el) {
+        int c = D1.row(el);
+
+        // Loop over the output nonzeros depending on the input nonzero
+        for (int k=colind[c]; k<colind[c+1]; ++k) {
+          int r = row[k];
+          if (symmetric) {
+            // The sensitivity also gives the mirrored entry
+            if (count[r]==1) {
+              fwd_src.push_back(r);
+              fwd_dst.push_back(k);
+              if (mapping[k]!=k) {
+                fwd_src.push_back(r);
+                fwd_dst.push_back(mapping[k]);
+              }
+            }
+          } else if (!bidirectional || count[r]==1) {
+            fwd_src.push_back(r);
+            fwd_dst.push_back(k);
+          }
+        }
+      }
+      fwd_ptr.push_back(fwd_src.size());
+    }
+
+    // Adjoint directions
+    adj_ptr.resize(1, 0);
+    for (int d=0; d<nadj(); ++d) {
+      // If bidirectional, see how many times each input appears
+      if (bidirectional) {
+        count.assign(sp.size2(), 0);
+        for (int el=D2.colind(d); el<D2.colind(d+1); ++el) {
+          int r = D2.row(el);
+          for (int k=colindT[r]; k<colindT[r+1]; ++k) count[rowT[k]]++;
+        }
+      }
+
+      // For all the output nonzeros seeded in the direction
+      for (int el=D2.colind(d); el<D2.colind(d+1); ++el) {
+        int r = D2.row(el);
+
+        // Loop over the input nonzeros that influence this output nonzero
+        for (int k=colindT[r]; k<colindT[r+1]; ++k) {
+          int c = rowT[k];
+          if (!bidirectional || count[c]==1) {
+            adj_src.push_back(c);
+            adj_dst.push_back(mapping[k]);
+          }
+        }
+      }
+      adj_ptr.push_back(adj_src.size());
+    }
+  }
+
+  size_t JacobianPlan::memory() const {
+    size_t n = fwd_ptr.size() + fwd_src.size() + fwd_dst.size()
+      + adj_ptr.size() + adj_src.size() + adj_dst.size();
+    const Sparsity* s[] = {&sp, &D1, &D2};
+    for (int i=0; i<3; ++i) {
+      if (!s[i]->isNull()) n += s[i]->size2() + 1 + s[i]->nnz();
+    }
+    return sizeof(int)*n + sizeof(JacobianPlan);
+  }
+
+  /// Write an integer vector, preceded by its length
+  static void writeVector(ostream& stream, const vector<int>& v) {
+    stream << v.size();
+    for (int k=0; k<v.size(); ++k) stream << " " << v[k];
+    stream << endl;
+  }
+
+  /// Read an integer vector written by writeVector
+  static vector<int> readVector(istream& stream) {
+    int n = -1;
+    stream >> n;
+    casadi_assert_message(stream.good() && n>=0, "JacobianPlan: Corrupt plan");
+    vector<int> v(n);
+    for (int k=0; k<n; ++k) stream >> v[k];
+    casadi_assert_message(!stream.fail(), "JacobianPlan: Corrupt plan");
+    return v;
+  }
+
+  /// Write a sparsity pattern in compressed form, empty if null
+  static void writeSparsity(ostream& stream, const Sparsity& sp) {
+    writeVector(stream, sp.isNull() ? vector<int>() : sp.compress());
+  }
+
+  /// Read a sparsity pattern written by writeSparsity
+  static Sparsity readSparsity(istream& stream) {
+    vector<int> v = readVector(stream);
+    return v.empty() ? Sparsity() : Sparsity::compressed(v);
+  }
+
+  void JacobianPlan::serialize(std::ostream& stream) const {
+    stream << "jacobian_plan 1 " << (symmetric ? 1 : 0) << endl;
+    writeSparsity(stream, sp);
+    writeSparsity(stream, D1);
+    writeSparsity(stream, D2);
+    writeVector(stream, fwd_ptr);
+    writeVector(stream, fwd_src);
+    writeVector(stream, fwd_dst);
+    writeVector(stream, adj_ptr);
+    writeVector(stream, adj_src);
+    writeVector(stream, adj_dst);
+  }
+
+  /// Check that the indices of a decompression map are within bounds
+  static bool checkMap(const vector<int>& ptr, const vector<int>& src, const vector<int>& dst,
+                       int ndir, int nsrc, int ndst) {
+    if (ptr.size()!=ndir+1 || ptr.front()!=0 || ptr.back()!=src.size()) return false;
+    if (src.size()!=dst.size()) return false;
+    for (int k=0; k<ndir; ++k) if (ptr[k]>ptr[k+1]) return false;
+    for (int k=0; k<src.size(); ++k) {
+      if (src[k]<0 || src[k]>=nsrc || dst[k]<0 || dst[k]>=ndst) return false;
+    }
+    return true;
+  }
+
+  JacobianPlan JacobianPlan::deserialize(std::istream& stream) {
+    string header;
+    int version = -1, symmetric = -1;
+    stream >> header >> version >> symmetric;
+    casadi_assert_message(header=="jacobian_plan" && version==1,
+                          "JacobianPlan: Not a serialized plan or unsupported version");
+    JacobianPlan ret;
+    ret.symmetric = symmetric==1;
+    ret.sp = readSparsity(stream);
+    ret.D1 = readSparsity(stream);
+    ret.D2 = readSparsity(stream);
+    ret.fwd_ptr = readVector(stream);
+    ret.fwd_src = readVector(stream);
+    ret.fwd_dst = readVector(stream);
+    ret.adj_ptr = readVector(stream);
+    ret.adj_src = readVector(stream);
+    ret.adj_dst = readVector(stream);
+
+    // Consistency checks, a plan is used without further checks
+    casadi_assert_message(!ret.sp.isNull(), "JacobianPlan: Corrupt plan");
+    casadi_assert_message(ret.D1.isNull() || ret.D1.size1()==ret.sp.size2(),
+                          "JacobianPlan: Corrupt plan");
+    casadi_assert_message(ret.D2.isNull() || ret.D2.size1()==ret.sp.size1(),
+                          "JacobianPlan: Corrupt plan");
+    casadi_assert_message(checkMap(ret.fwd_ptr, ret.fwd_src, ret.fwd_dst, ret.nfwd(),
+                                   ret.sp.size1(), ret.sp.nnz())
+                          && checkMap(ret.adj_ptr, ret.adj_src, ret.adj_dst, ret.nadj(),
+                                      ret.sp.size2(), ret.sp.nnz()),
+                          "JacobianPlan: Corrupt plan");
+    return ret;
+  }
+
+  /// Entry of the global cache of Jacobian plans
+  struct CachedJacobianPlan {
+    std::size_t hash;
+    std::string settings;
+    JacobianPlan plan;
+  };
+
+  /// Global cache of Jacobian plans, most recently used first
+  static list<CachedJacobianPlan>& getPlanCache() {
+    static list<CachedJacobianPlan> cache;
+    return cache;
+  }
+
+  /// Memory used by the plans in the global cache
+  static size_t& getPlanCacheMemory() {
+    static size_t memory = 0;
+    return memory;
+  }
+
+  /// Lock protecting the global cache of Jacobian plans
+  static CasadiMutex& getPlanCacheMutex() {
+    static CasadiMutex mutex;
+    return mutex;
+  }
+
+  bool JacobianPlan::getCached(const Sparsity& sp, bool symmetric, const std::string& settings,
+                               JacobianPlan& plan) {
+    CasadiScopedLock lock(getPlanCacheMutex());
+    list<CachedJacobianPlan>& cache = getPlanCache();
+    std::size_t h = sp.hash();
+    for (list<CachedJacobianPlan>::iterator it=cache.begin(); it!=cache.end(); ++it) {
+      if (it->hash==h && it->plan.symmetric==symmetric && it->settings==settings
+          && it->plan.sp.isEqual(sp)) {
+        // Move to the front
+        cache.splice(cache.begin(), cache, it);
+        plan = cache.front().plan;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void JacobianPlan::addCached(const std::string& settings, const JacobianPlan& plan) {
+    CasadiScopedLock lock(getPlanCacheMutex());
+    list<CachedJacobianPlan>& cache = getPlanCache();
+    size_t& memory = getPlanCacheMemory();
+    CachedJacobianPlan e;
+    e.hash = plan.sp.hash();
+    e.settings = settings;
+    e.plan = plan;
+    cache.push_front(e);
+    memory += plan.memory();
+
+    // Drop the least recently used plans until within the memory limit
+    size_t max_memory = std::max(CasadiOptions::jacobian_plan_cache_memory, 0L);
+    while (!cache.empty() && memory>max_memory) {
+      memory -= cache.back().plan.memory();
+      cache.pop_back();
+    }
+  }
+
+  void JacobianPlan::clearCache() {
+    CasadiScopedLock lock(getPlanCacheMutex());
+    getPlanCache().clear();
+    getPlanCacheMemory() = 0;
+  }
+
+} // namespace casadi
@@ -0,0 +1,109 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#ifndef CASADI_JACOBIAN_PLAN_HPP
+#define CASADI_JACOBIAN_PLAN_HPP
+
+#include "../matrix/sparsity.hpp"
+#include "../generic_type.hpp"
+#include <iostream>
+
+/// \cond INTERNAL
+namespace casadi {
+
+  /** \brief Evaluation plan for a Jacobian or Hessian block
+
+      Everything needed to calculate a (compact) Jacobian block with directional
+      derivatives, which only depends on its sparsity pattern: the graph coloring,
+      i.e. the nonzeros seeded in each forward and adjoint direction, and the
+      decompression index map, i.e. for each direction the pairs of sensitivity
+      nonzeros and Jacobian nonzeros.
+
+      Plans can be serialized and are cached globally, so that functions with the
+      same Jacobian sparsity and coloring options share the same plan.
+  */
+  class CASADI_EXPORT JacobianPlan {
+  public:
+    /// Default constructor, null plan
+    JacobianPlan();
+
+    /** \brief Create a plan from a graph coloring
+        \param sp Compact Jacobian sparsity, output nonzeros by input nonzeros
+        \param D1 Input nonzeros (rows) seeded in each forward direction (columns), or null
+        \param D2 Output nonzeros (rows) seeded in each adjoint direction (columns), or null
+    */
+    JacobianPlan(const Sparsity& sp, bool symmetric, const Sparsity& D1, const Sparsity& D2);
+
+    /// Is the plan null
+    bool isNull() const { return sp.isNull();}
+
+    /// Number of forward directions
+    int nfwd() const { return D1.isNull() ? 0 : D1.size2();}
+
+    /// Number of adjoint directions
+    int nadj() const { return D2.isNull() ? 0 : D2.size2();}
+
+    /// Approximate memory usage in bytes
+    size_t memory() const;
+
+    /// Write the plan to a stream
+    void serialize(std::ostream& stream) const;
+
+    /// Read a plan from a stream
+    static JacobianPlan deserialize(std::istream& stream);
+
+    /// Look up a plan in the global cache
+    static bool getCached(const Sparsity& sp, bool symmetric, const std::string& settings,
+                          JacobianPlan& plan);
+
+    /// Add a plan to the global cache, least recently used plans are dropped
+    static void addCached(const std::string& settings, const JacobianPlan& plan);
+
+    /// Clear the global cache
+    static void clearCache();
+
+    /// Compact Jacobian sparsity
+    Sparsity sp;
+
+    /// Hessian, i.e. symmetric Jacobian with a star coloring
+    bool symmetric;
+
+    /// Seeded nonzeros in each forward and adjoint direction
+    Sparsity D1, D2;
+
+    /// Forward directions: output nonzero fwd_src[k] gives Jacobian nonzero fwd_dst[k]
+    std::vector<int> fwd_ptr, fwd_src, fwd_dst;
+
+    /// Adjoint directions: input nonzero adj_src[k] gives Jacobian nonzero adj_dst[k]
+    std::vector<int> adj_ptr, adj_src, adj_dst;
+
+    /// Statistics of the graph coloring, not serialized
+    Dict stats;
+  };
+
+} // namespace casadi
+/// \endcond
+
+#endif // CASADI_JACOBIAN_PLAN_HPP
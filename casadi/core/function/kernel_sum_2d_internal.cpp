@@ -28,6 +28,10 @@
 #include "../profiling.hpp"
 #include <sstream>
 
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif // WITH_OPENMP
+
 using namespace std;
 
 namespace casadi {
@@ -43,7 +47,7 @@ namespace casadi {
     } else {
       if (par_op->second == "openmp") {
   #ifdef WITH_OPENMP
-        return new KernelSum2DSerial(f, size, r, n);
+        return new KernelSum2DOmp(f, size, r, n);
   #else // WITH_OPENMP
         casadi_warning("CasADi was not compiled with OpenMP. "
                        "Falling back to serial mode.");
@@ -309,6 +313,134 @@ namespace casadi {
     }
   }
 
+#ifdef WITH_OPENMP
+
+  KernelSum2DOmp::~KernelSum2DOmp() {
+  }
+
+  void KernelSum2DOmp::init() {
+    // Call the initialization method of the base class
+    KernelSum2DSerial::init();
+
+    nthreads_ = omp_get_max_threads();
+
+    // Zero pixels can be skipped if all outputs of f vanish structurally for v=0
+    skip_zero_ = false;
+    try {
+      std::vector<SX> f_in = f_.symbolicInputSX();
+      f_in[1] = 0;
+      std::vector<SX> f_out = f_(f_in);
+      skip_zero_ = true;
+      for (int k=0; k<f_out.size(); ++k) {
+        skip_zero_ = skip_zero_ && f_out[k].isZero();
+      }
+    } catch (exception& e) {
+      log("KernelSum2DOmp::init", "f cannot be evaluated symbolically, zero pixels are evaluated");
+    }
+
+    // Each thread: arguments and results of f, work vectors, temporary results,
+    // coordinates, pixel value and a partial sum
+    alloc_w((f_.sz_w() + 2*nnz_out_ + 3)*nthreads_);
+
+    // Integer work vectors of f for each thread and the linear indices of the pixels
+    // in a window, clipped to the image
+    int r = round(r_);
+    alloc_iw(f_.sz_iw()*nthreads_ + min(2*r+1, size_.first)*min(2*r+1, size_.second));
+    alloc_arg(f_.sz_arg()*(nthreads_+1));
+    alloc_res(f_.sz_res()*(nthreads_+1));
+  }
+
+  void KernelSum2DOmp::evalD(const double** arg, double** res, int* iw, double* w) {
+    int num_in = f_.nIn(), num_out = f_.nOut();
+
+    const double* V;
+    if (pointer_input_) {
+      V = reinterpret_cast<const double *>(*(reinterpret_cast<const uint64_t *>(arg[0])));
+    } else {
+      V = arg[0];
+    }
+
+    const double* X = arg[1];
+
+    //     ---> j,v
+    //   |
+    //   v  i,u
+    int u = round(X[0]);
+    int v = round(X[1]);
+    int r = round(r_);
+
+    // Collect the pixels that contribute, column by column
+    int* pixels = iw + f_.sz_iw()*nthreads_;
+    int npixels = 0;
+    for (int j = max(v-r, 0); j<= min(v+r, size_.second-1); ++j) {
+      for (int i = max(u-r, 0); i<= min(u+r, size_.first-1); ++i) {
+        int ind = i+j*size_.first;
+        if (!skip_zero_ || V[ind]!=0) pixels[npixels++] = ind;
+      }
+    }
+    int nthreads = min(nthreads_, max(npixels, 1));
+
+    int sz_w = f_.sz_w() + 2*nnz_out_ + 3;
+#pragma omp parallel for num_threads(nthreads)
+    for (int t=0; t<nthreads; ++t) {
+      const double** arg1 = arg + f_.sz_arg()*(t+1);
+      double** res1 = res + f_.sz_res()*(t+1);
+      int* iw1 = iw + f_.sz_iw()*t;
+      double* w1 = w + sz_w*t;
+
+      // Everything except the first argument can be passed as-is to f
+      std::copy(arg+1, arg+num_in, arg1+2);
+
+      // Pixel coordinates and value
+      double* coord = w1+f_.sz_w()+2*nnz_out_;
+      double* value = coord+2;
+      arg1[0] = coord;
+      arg1[1] = value;
+
+      // Outputs of f and partial sums
+      double* temp_res = w1+f_.sz_w();
+      double* psum = temp_res+nnz_out_;
+      std::fill(psum, psum+nnz_out_, 0);
+      for (int k=0; k<num_out; ++k) {
+        res1[k] = (res[k]==0)? 0: temp_res;
+        temp_res+= step_out_[k];
+      }
+
+      // Contiguous chunk of the pixel list
+      int lower = (npixels*t)/nthreads, upper = (npixels*(t+1))/nthreads;
+      for (int p=lower; p<upper; ++p) {
+        int ind = pixels[p];
+        coord[0] = ind % size_.first;
+        coord[1] = ind / size_.first;
+        value[0] = V[ind];
+        f_->eval(arg1, res1, iw1, w1);
+        double* s = psum;
+        for (int k=0; k<num_out; ++k) {
+          if (res1[k]) {
+            for (int i=0; i<step_out_[k]; ++i) s[i] += res1[k][i];
+          }
+          s+= step_out_[k];
+        }
+      }
+    }
+
+    // Add the partial sums in a fixed order
+    for (int k=0; k<num_out; ++k) {
+      if (res[k]!=0) std::fill(res[k], res[k]+step_out_[k], 0);
+    }
+    for (int t=0; t<nthreads; ++t) {
+      const double* s = w + sz_w*t + f_.sz_w() + nnz_out_;
+      for (int k=0; k<num_out; ++k) {
+        if (res[k]) {
+          for (int i=0; i<step_out_[k]; ++i) res[k][i] += s[i];
+        }
+        s+= step_out_[k];
+      }
+    }
+  }
+
+#endif // WITH_OPENMP
+
   Function KernelSum2DBase
   ::getDerForward(const std::string& name, int nfwd, Dict& opts) {
 
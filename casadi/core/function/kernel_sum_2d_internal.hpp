@@ -151,6 +151,48 @@ namespace casadi {
 
   };
 
+#ifdef WITH_OPENMP
+  /** KernelSum2D evaluated in parallel using OpenMP
+
+      The pixels in the window are collected in a list in the integer work
+      vector, leaving out zero pixels if these do not contribute to the sum,
+      and the list is split into contiguous chunks, one per thread. Each
+      thread accumulates a partial sum, the partial sums are added in a fixed
+      order.
+  */
+  class CASADI_EXPORT KernelSum2DOmp : public KernelSum2DSerial {
+  public:
+
+    /** \brief Constructor (generic kernel_sum_2d) */
+    KernelSum2DOmp(const Function& f,
+           const std::pair<int, int> & size,
+           double r,
+           int n) : KernelSum2DSerial(f, size, r, n) {}
+
+    /** \brief  clone function */
+    virtual KernelSum2DOmp* clone() const { return new KernelSum2DOmp(*this);}
+
+    /** \brief  Destructor */
+    virtual ~KernelSum2DOmp();
+
+    /** \brief  Initialize */
+    virtual void init();
+
+    /** \brief  Evaluate numerically, work vectors given */
+    virtual void evalD(const double** arg, double** res, int* iw, double* w);
+
+    /// Type of parallellization
+    virtual std::string parallelization() const { return "openmp"; }
+
+  protected:
+    /// Number of threads
+    int nthreads_;
+
+    /// Is f structurally zero for a zero pixel value?
+    bool skip_zero_;
+  };
+#endif // WITH_OPENMP
+
   /** KernelSum2D statement
       \author Joris Gillis
       \date 2015
@@ -110,6 +110,37 @@ namespace casadi {
     solve(false);
   }
 
+  void LinearSolverInternal::evalD(const double** arg, double** res, int* iw, double* w) {
+    // Pass the linear system matrix, unless already bound
+    const double* A = arg[LINSOL_A];
+    if (A==0) {
+      setInput(0., LINSOL_A);
+    } else if (A!=input(LINSOL_A).ptr()) {
+      setInputNZ(A, LINSOL_A);
+    }
+
+    // Quick return if the solution is not requested
+    double* x = res[LINSOL_X];
+    if (x==0) return;
+
+    // Right-hand side, copied to the solution buffer unless aliased
+    const double* b = arg[LINSOL_B];
+    int nnz_b = input(LINSOL_B).nnz();
+    if (b==0) {
+      fill(x, x+nnz_b, 0.);
+    } else if (b!=x) {
+      copy(b, b+nnz_b, x);
+    }
+
+    // Factorize
+    prepare();
+    if (!prepared_)
+      throw CasadiException("LinearSolverInternal::evalD: Preparation failed");
+
+    // Solve the factorized system in-place
+    solve(x, input(LINSOL_B).size2(), false);
+  }
+
   void LinearSolverInternal::solve(bool transpose) {
     // Get input and output vector
     const vector<double>& b = input(LINSOL_B).data();
@@ -56,6 +56,9 @@ namespace casadi {
     /// Solve the system of equations
     virtual void evaluate();
 
+    /// Solve the system of equations, in-place in the result buffer
+    virtual void evalD(const double** arg, double** res, int* iw, double* w);
+
     /// Prepare the factorization
     virtual void prepare() {}
 
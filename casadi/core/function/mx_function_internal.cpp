@@ -28,18 +28,98 @@
 #include "../profiling.hpp"
 #include "../casadi_options.hpp"
 #include "../casadi_interrupt.hpp"
+#include "../casadi_math.hpp"
+#include "sx_function.hpp"
 
 #include <stack>
 #include <typeinfo>
 
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif // WITH_OPENMP
+
 using namespace std;
 
 namespace casadi {
 
+  /// Block size for the evaluation of fused elementwise kernels
+  static const int FUSE_BLOCKSIZE = 256;
+
+  /// Can an algorithm element be part of a fused elementwise kernel?
+  static bool isFusable(const MXAlgEl& e) {
+    if (e.op==OP_OUTPUT || e.op==OP_PRINTME || e.op==OP_LIFT) return false;
+    if (!e.data->isUnaryOp() && !e.data->isBinaryOp()) return false;
+    const Sparsity& sp = e.data.sparsity();
+    if (sp.nnz()<=1) return false;
+
+    // Arguments with the same sparsity, or dense scalars for binary operations
+    for (int i=0; i<e.data->ndep(); ++i) {
+      const Sparsity& sp_dep = e.data->dep(i).sparsity();
+      if (sp_dep!=sp && !(sp_dep.isscalar(true) && e.data->isBinaryOp())) return false;
+    }
+    return true;
+  }
+
+  /// Estimated cost of evaluating an algorithm element
+  static double elementCost(const MXAlgEl& e) {
+    if (e.op==OP_OUTPUT) return 1;
+    switch (e.op) {
+    case OP_MATMUL:
+      return static_cast<double>(e.data->dep(1).nnz())*e.data->dep(2).size2();
+    case OP_SOLVE:
+      {
+        double n = e.data->dep(1).size1();
+        return e.data->dep(1).nnz()*n/3 + n*e.data->dep(0).size2();
+      }
+    case OP_INVERSE:
+    case OP_DETERMINANT:
+      {
+        double n = e.data->dep(0).size1();
+        return n*n*n;
+      }
+    default:
+      break;
+    }
+
+    // Functions with a known algorithm
+    if (e.op==OP_CALL) {
+      const Function& f = e.data->getFunction(0);
+      const MXFunctionInternal* mx = dynamic_cast<const MXFunctionInternal*>(f.get());
+      if (mx) return mx->cost_;
+      if (is_a<SXFunction>(f)) return shared_cast<SXFunction>(f).getAlgorithmSize();
+    }
+
+    // Proportional to the number of nonzeros
+    double ret = 0;
+    for (int i=0; i<e.data->ndep(); ++i) ret += e.data->dep(i).nnz();
+    for (int i=0; i<e.data->nout(); ++i) ret += e.data->sparsity(i).nnz();
+    return e.op==OP_CALL ? 100*ret : ret;
+  }
+
+  /// Can an algorithm element be evaluated while other threads evaluate the same function?
+  static bool isReentrant(const MXAlgEl& e) {
+    if (e.op==OP_OUTPUT) return true;
+    for (int i=0; i<e.data->numFunctions(); ++i) {
+      const Function& f = e.data->getFunction(i);
+      const MXFunctionInternal* mx = dynamic_cast<const MXFunctionInternal*>(f.get());
+      if (mx ? !mx->reentrant_ : !is_a<SXFunction>(f)) return false;
+    }
+    return true;
+  }
+
   MXFunctionInternal::MXFunctionInternal(const std::vector<MX>& inputv,
                                          const std::vector<MX>& outputv) :
     XFunctionInternal<MXFunction, MXFunctionInternal, MX, MXNode>(inputv, outputv) {
 
+    addOption("fuse_elementwise", OT_BOOLEAN, true,
+              "Evaluate chains of elementwise operations with the same sparsity "
+              "in a single loop, without intermediate work vector elements");
+    addOption("parallelization", OT_STRING, "serial",
+              "Evaluate independent operations in parallel", "serial|openmp");
+    addOption("parallel_min_cost", OT_REAL, 1e4,
+              "Minimum estimated cost of a level of independent operations for it to be "
+              "evaluated in parallel, the cost of an operation is roughly its number of flops");
+
     setOption("name", "unnamed_mx_function");
   }
 
@@ -54,6 +134,19 @@ namespace casadi {
     // Call the init function of the base class
     XFunctionInternal<MXFunction, MXFunctionInternal, MX, MXNode>::init();
 
+    // Parallel evaluation
+    parallel_ = getOption("parallelization") == "openmp";
+#ifndef WITH_OPENMP
+    if (parallel_) {
+      casadi_warning("CasADi was not compiled with OpenMP. Falling back to serial mode.");
+      parallel_ = false;
+    }
+#endif // WITH_OPENMP
+    nthreads_ = 1;
+#ifdef WITH_OPENMP
+    if (parallel_) nthreads_ = omp_get_max_threads();
+#endif // WITH_OPENMP
+
     // Stack used to sort the computational graph
     stack<MXNode*> s;
 
@@ -165,6 +258,119 @@ namespace casadi {
       }
     }
 
+    // Sort the algorithm by level in the dependency graph: the elements of a level only
+    // depend on elements of earlier levels and can be evaluated in any order
+    vector<int> alg_level;
+    if (parallel_) {
+      vector<int> node_level(nodes.size(), 0);
+      alg_level.resize(algorithm_.size());
+      int nlevel = 0;
+      for (int a=0; a<algorithm_.size(); ++a) {
+        const AlgEl& e = algorithm_[a];
+        int l = 0;
+        for (int c=0; c<e.arg.size(); ++c) {
+          if (e.arg[c]>=0) l = max(l, node_level[e.arg[c]]+1);
+        }
+        if (e.op!=OP_OUTPUT) {
+          for (int c=0; c<e.res.size(); ++c) {
+            if (e.res[c]>=0) node_level[e.res[c]] = l;
+          }
+        }
+        alg_level[a] = l;
+        nlevel = max(nlevel, l+1);
+      }
+
+      // Stable counting sort
+      vector<int> level_start(nlevel+1, 0);
+      for (int a=0; a<algorithm_.size(); ++a) level_start[alg_level[a]+1]++;
+      for (int l=0; l<nlevel; ++l) level_start[l+1] += level_start[l];
+      vector<int> new_place(algorithm_.size());
+      for (int a=0; a<algorithm_.size(); ++a) new_place[a] = level_start[alg_level[a]]++;
+      vector<AlgEl> sorted(algorithm_.size());
+      for (int a=0; a<algorithm_.size(); ++a) sorted[new_place[a]] = algorithm_[a];
+      algorithm_.swap(sorted);
+      sort(alg_level.begin(), alg_level.end());
+      for (int i=0; i<place_in_alg.size(); ++i) {
+        if (place_in_alg[i]>=0) place_in_alg[i] = new_place[place_in_alg[i]];
+      }
+      for (int i=0; i<symb_loc.size(); ++i) symb_loc[i].first = new_place[symb_loc[i].first];
+    }
+
+    // Group chains of elementwise operations into fused kernels: an operation is absorbed
+    // into the kernel of its (only) user if both are elementwise with the same nonzeros
+    vector<int> fuse_root(algorithm_.size(), -1);
+    vector<int> node_root(nodes.size(), -1);
+    kernels_.clear();
+    fused_.clear();
+    if (getOption("fuse_elementwise")) {
+      fused_.resize(algorithm_.size(), -1);
+      vector<int> group;
+      for (int a=algorithm_.size()-1; a>=0; --a) {
+        if (fuse_root[a]>=0 || !isFusable(algorithm_[a])) continue;
+        int n = algorithm_[a].data.nnz();
+
+        // Collect the operations of the kernel with root a
+        fuse_root[a] = a;
+        group.resize(1);
+        group[0] = a;
+        for (int i=0; i<group.size(); ++i) {
+          const AlgEl& e = algorithm_[group[i]];
+          for (int c=0; c<e.arg.size(); ++c) {
+            int nd = e.arg[c];
+            if (nd<0 || refcount[nd]!=1) continue;
+            int b = place_in_alg[nd];
+            if (b>=0 && fuse_root[b]<0 && isFusable(algorithm_[b])
+                && algorithm_[b].data.sparsity()==algorithm_[a].data.sparsity()) {
+              fuse_root[b] = a;
+              group.push_back(b);
+            }
+          }
+        }
+
+        // Nothing to fuse
+        if (group.size()==1) {
+          fuse_root[a] = -1;
+          continue;
+        }
+
+        // Operations in the order of evaluation
+        sort(group.begin(), group.end());
+        fused_[a] = kernels_.size();
+        kernels_.push_back(MXFusedKernel());
+        MXFusedKernel& k = kernels_.back();
+        k.n = n;
+        k.op.resize(group.size());
+        k.x.resize(group.size());
+        k.y.resize(group.size());
+        for (int i=0; i<group.size(); ++i) {
+          const AlgEl& e = algorithm_[group[i]];
+          if (group[i]!=a) fused_[group[i]] = -2;
+          node_root[e.res.front()] = a;
+          k.op[i] = e.op;
+          for (int c=0; c<e.arg.size(); ++c) {
+            int nd = e.arg[c], ind;
+            int b = place_in_alg[nd];
+            if (b>=0 && fuse_root[b]==a) {
+              // Result of an earlier operation in the kernel
+              ind = ~(lower_bound(group.begin(), group.end(), b) - group.begin());
+            } else {
+              // External argument, node index until work vector indices have been assigned
+              ind = find(k.arg.begin(), k.arg.end(), nd) - k.arg.begin();
+              if (ind==k.arg.size()) {
+                k.arg.push_back(nd);
+                k.scalar.push_back(e.data->dep(c).nnz()==1);
+              }
+            }
+            (c==0 ? k.x[i] : k.y[i]) = ind;
+          }
+          if (e.arg.size()==1) k.y[i] = k.x[i];
+        }
+      }
+    }
+
+    // External arguments of fused operations are kept until the kernel is evaluated
+    map<int, vector<int> > postponed;
+
     // Place in the work vector for each of the nodes in the tree (overwrites the reference counter)
     vector<int>& place = place_in_alg; // Reuse memory as it is no longer needed
     place.resize(nodes.size());
@@ -172,11 +378,25 @@ namespace casadi {
     // Stack with unused elements in the work vector, sorted by sparsity pattern
     SPARSITY_MAP<int, stack<int> > unused_all;
 
+    // In parallel mode, elements freed within a level can only be reused in later levels
+    vector<pair<int, int> > pending;
+
     // Work vector size
     int worksize = 0;
 
     // Find a place in the work vector for the operation
     for (vector<AlgEl>::iterator it=algorithm_.begin(); it!=algorithm_.end(); ++it) {
+      // Root of the fused kernel the operation is part of, if any
+      int root = fuse_root[it-algorithm_.begin()];
+
+      // Make the elements freed in the previous level available
+      if (parallel_ && it!=algorithm_.begin()
+          && alg_level[it-algorithm_.begin()]!=alg_level[it-algorithm_.begin()-1]) {
+        for (vector<pair<int, int> >::const_iterator i=pending.begin(); i!=pending.end(); ++i) {
+          unused_all[i->first].push(i->second);
+        }
+        pending.clear();
+      }
 
       // There are two tasks, allocate memory of the result and free the
       // memory off the arguments, order depends on whether inplace is possible
@@ -193,18 +413,27 @@ namespace casadi {
           int& ch_ind = it->arg[c];
           if (ch_ind>=0) {
 
-            // Decrease reference count and add to the stack of
-            // unused variables if the count hits zero
-            int remaining = --refcount[ch_ind];
-
-            // Free variable for reuse
-            if (live_variables && remaining==0) {
-
-              // Get a pointer to the sparsity pattern of the argument that can be freed
-              int nnz = nodes[ch_ind]->sparsity().nnz();
-
-              // Add to the stack of unused work vector elements for the current sparsity
-              unused_all[nnz].push(place[ch_ind]);
+            if (root>=0 && root!=it-algorithm_.begin() && node_root[ch_ind]!=root) {
+              // External argument of a fused operation, free when the kernel is evaluated
+              postponed[root].push_back(ch_ind);
+            } else {
+              // Decrease reference count and add to the stack of
+              // unused variables if the count hits zero
+              int remaining = --refcount[ch_ind];
+
+              // Free variable for reuse
+              if (live_variables && remaining==0) {
+
+                // Get a pointer to the sparsity pattern of the argument that can be freed
+                int nnz = nodes[ch_ind]->sparsity().nnz();
+
+                // Add to the stack of unused work vector elements for the current sparsity
+                if (parallel_) {
+                  pending.push_back(make_pair(nnz, place[ch_ind]));
+                } else {
+                  unused_all[nnz].push(place[ch_ind]);
+                }
+              }
             }
 
             // Point to the place in the work vector instead of to the place in the list of nodes
@@ -212,6 +441,21 @@ namespace casadi {
           }
         }
 
+        // Free the external arguments of a fused kernel, after its result has been allocated
+        if (task==1 && root==it-algorithm_.begin()) {
+          const vector<int>& ext = postponed[root];
+          for (vector<int>::const_iterator i=ext.begin(); i!=ext.end(); ++i) {
+            if (--refcount[*i]==0 && live_variables) {
+              int nnz = nodes[*i]->sparsity().nnz();
+              if (parallel_) {
+                pending.push_back(make_pair(nnz, place[*i]));
+              } else {
+                unused_all[nnz].push(place[*i]);
+              }
+            }
+          }
+        }
+
         // Nothing more to allocate
         if (it->op==OP_OUTPUT || task==1) break;
 
@@ -246,7 +490,19 @@ namespace casadi {
       }
     }
 
+    // Work vector indices of the fused kernels
+    for (vector<MXFusedKernel>::iterator k=kernels_.begin(); k!=kernels_.end(); ++k) {
+      for (vector<int>::iterator i=k->arg.begin(); i!=k->arg.end(); ++i) *i = place[*i];
+    }
+    for (int a=0; a<fused_.size(); ++a) {
+      if (fused_[a]>=0) kernels_[fused_[a]].res = algorithm_[a].res.front();
+    }
+
     if (verbose()) {
+      if (!kernels_.empty()) {
+        userOut() << "Fused elementwise operations into " << kernels_.size()
+                  << " kernels" << endl;
+      }
       if (live_variables) {
         userOut() << "Using live variables: work array is "
              <<  worksize << " instead of "
@@ -259,14 +515,14 @@ namespace casadi {
     // Allocate work vectors (numeric)
     workloc_.resize(worksize+1);
     fill(workloc_.begin(), workloc_.end(), -1);
-    size_t wind=0, sz_w=0;
+    size_t wind=0, sz_arg=0, sz_res=0, sz_iw=0, sz_w=0;
     for (vector<AlgEl>::iterator it=algorithm_.begin(); it!=algorithm_.end(); ++it) {
       if (it->op!=OP_OUTPUT) {
         for (int c=0; c<it->res.size(); ++c) {
           if (it->res[c]>=0) {
-            alloc_arg(it->data->sz_arg());
-            alloc_res(it->data->sz_res());
-            alloc_iw(it->data->sz_iw());
+            sz_arg = max(sz_arg, it->data->sz_arg());
+            sz_res = max(sz_res, it->data->sz_res());
+            sz_iw = max(sz_iw, it->data->sz_iw());
             sz_w = max(sz_w, it->data->sz_w());
             if (workloc_[it->res[c]] < 0) {
               workloc_[it->res[c]] = wind;
@@ -277,6 +533,21 @@ namespace casadi {
       }
     }
     workloc_.back()=wind;
+
+    // Intermediate results of the fused kernels, evaluated block by block
+    for (vector<MXFusedKernel>::const_iterator k=kernels_.begin(); k!=kernels_.end(); ++k) {
+      sz_w = max(sz_w, static_cast<size_t>((k->op.size()-1)*min(k->n, FUSE_BLOCKSIZE)));
+    }
+
+    // Work vectors of the nodes, one set for each thread
+    sz_arg_t_ = sz_arg;
+    sz_res_t_ = sz_res;
+    sz_iw_t_ = sz_iw;
+    sz_w_t_ = sz_w;
+    alloc_arg(nthreads_*sz_arg);
+    alloc_res(nthreads_*sz_res);
+    alloc_iw(nthreads_*sz_iw);
+    sz_w *= nthreads_;
     for (int i=0; i<workloc_.size(); ++i) {
       if (workloc_[i]<0) workloc_[i] = i==0 ? 0 : workloc_[i-1];
       workloc_[i] += sz_w;
@@ -335,6 +606,84 @@ namespace casadi {
       }
     }
 
+    // Estimated cost of the elements, fused kernels are evaluated at their root
+    vector<double> alg_cost(algorithm_.size(), 0);
+    cost_ = 0;
+    reentrant_ = true;
+    for (int k=0; k<algorithm_.size(); ++k) {
+      if (!fused_.empty() && fused_[k]!=-1) {
+        if (fused_[k]>=0) {
+          const MXFusedKernel& K = kernels_[fused_[k]];
+          alg_cost[k] = static_cast<double>(K.n)*K.op.size();
+        }
+      } else {
+        alg_cost[k] = elementCost(algorithm_[k]);
+      }
+      cost_ += alg_cost[k];
+      reentrant_ = reentrant_ && isReentrant(algorithm_[k]);
+    }
+
+    // Divide each level into chunks of about the same cost
+    level_ptr_.clear();
+    chunk_ptr_.clear();
+    chunk_el_.clear();
+    if (parallel_) {
+      double min_cost = getOption("parallel_min_cost");
+      level_ptr_.push_back(0);
+      chunk_ptr_.push_back(0);
+      vector<pair<double, int> > order;
+      vector<vector<int> > chunks;
+      vector<double> load;
+      int n_parallel = 0;
+      for (int k0=0, k1; k0<algorithm_.size(); k0=k1) {
+        // Elements of the level, most expensive first
+        double level_cost = 0;
+        order.clear();
+        for (k1=k0; k1<algorithm_.size() && alg_level[k1]==alg_level[k0]; ++k1) {
+          if (!fused_.empty() && fused_[k1]==-2) continue;
+          order.push_back(make_pair(-alg_cost[k1], k1));
+          level_cost += alg_cost[k1];
+        }
+        sort(order.begin(), order.end());
+
+        // Number of chunks
+        int nchunk = level_cost<min_cost ? 1 : min(nthreads_, static_cast<int>(order.size()));
+        if (nchunk>1) n_parallel++;
+        chunks.assign(max(nchunk, 1), vector<int>());
+        load.assign(chunks.size(), 0);
+
+        // Elements calling functions that are not reentrant are evaluated by the same thread
+        for (vector<pair<double, int> >::const_iterator i=order.begin(); i!=order.end(); ++i) {
+          if (!isReentrant(algorithm_[i->second])) {
+            chunks[0].push_back(i->second);
+            load[0] -= i->first;
+          }
+        }
+
+        // Assign the other elements to the chunk with the least cost
+        for (vector<pair<double, int> >::const_iterator i=order.begin(); i!=order.end(); ++i) {
+          if (isReentrant(algorithm_[i->second])) {
+            int c = min_element(load.begin(), load.end()) - load.begin();
+            chunks[c].push_back(i->second);
+            load[c] -= i->first;
+          }
+        }
+
+        // Save to the plan
+        for (vector<vector<int> >::iterator c=chunks.begin(); c!=chunks.end(); ++c) {
+          if (c->empty()) continue;
+          sort(c->begin(), c->end());
+          chunk_el_.insert(chunk_el_.end(), c->begin(), c->end());
+          chunk_ptr_.push_back(chunk_el_.size());
+        }
+        level_ptr_.push_back(chunk_ptr_.size()-1);
+      }
+      if (verbose()) {
+        userOut() << "Parallel evaluation: " << (level_ptr_.size()-1) << " levels, "
+                  << n_parallel << " evaluated in parallel, estimated cost " << cost_ << endl;
+      }
+    }
+
     if (CasadiOptions::profiling && CasadiOptions::profilingBinary) {
       profileWriteName(CasadiOptions::profilingLog, this, getOption("name"),
                        ProfilingData_FunctionType_MXFunction, algorithm_.size());
@@ -387,6 +736,13 @@ namespace casadi {
                    << free_vars_ << " are free.");
     }
 
+    // Evaluate level by level
+    if (parallel_ && !CasadiOptions::profiling) {
+      evalParallel(arg, res, iw, w);
+      casadi_msg("MXFunctionInternal::evalD():end "  << getOption("name"));
+      return;
+    }
+
     // Evaluate all of the nodes of the algorithm:
     // should only evaluate nodes that have not yet been calculated!
     int alg_counter = 0;
@@ -395,32 +751,8 @@ namespace casadi {
         time_start = getRealTime(); // Start timer
       }
 
-      if (it->op==OP_INPUT) {
-        // Pass an input
-        double *w1 = w+workloc_[it->res.front()];
-        int nnz=it->data.nnz();
-        int i=it->arg.at(0);
-        int nz_offset=it->arg.at(2);
-        if (arg[i]==0) {
-          fill(w1, w1+nnz, 0);
-        } else {
-          copy(arg[i]+nz_offset, arg[i]+nz_offset+nnz, w1);
-        }
-      } else if (it->op==OP_OUTPUT) {
-        // Get an output
-        double *w1 = w+workloc_[it->arg.front()];
-        int i=it->res.front();
-        if (res[i]!=0) copy(w1, w1+output(i).nnz(), res[i]);
-      } else {
-        // Point pointers to the data corresponding to the element
-        for (int i=0; i<it->arg.size(); ++i)
-          arg1[i] = it->arg[i]>=0 ? w+workloc_[it->arg[i]] : 0;
-        for (int i=0; i<it->res.size(); ++i)
-          res1[i] = it->res[i]>=0 ? w+workloc_[it->res[i]] : 0;
-
-        // Evaluate
-        it->data->evalD(arg1, res1, iw, w);
-      }
+      // Evaluate the element
+      evalElement(alg_counter, arg, res, arg1, res1, iw, w, w);
 
       // Write out profiling information
       if (CasadiOptions::profiling) {
@@ -463,6 +795,94 @@ namespace casadi {
     casadi_msg("MXFunctionInternal::evalD():end "  << getOption("name"));
   }
 
+  void MXFunctionInternal::evalParallel(const double** arg, double** res, int* iw, double* w) {
+    int nlevel = level_ptr_.size()-1;
+    for (int l=0; l<nlevel; ++l) {
+      int c0 = level_ptr_[l], nchunk = level_ptr_[l+1]-c0;
+
+      // Exceptions cannot leave the parallel region
+      string err;
+#ifdef WITH_OPENMP
+#pragma omp parallel for if (nchunk>1)
+#endif // WITH_OPENMP
+      for (int c=0; c<nchunk; ++c) {
+        // Work vectors of the chunk
+        const double** arg1 = arg+nIn()+c*sz_arg_t_;
+        double** res1 = res+nOut()+c*sz_res_t_;
+        try {
+          for (int i=chunk_ptr_[c0+c]; i<chunk_ptr_[c0+c+1]; ++i) {
+            evalElement(chunk_el_[i], arg, res, arg1, res1, iw+c*sz_iw_t_, w, w+c*sz_w_t_);
+          }
+        } catch(exception& e) {
+#ifdef WITH_OPENMP
+#pragma omp critical
+#endif // WITH_OPENMP
+          err = e.what();
+        }
+      }
+      casadi_assert_message(err.empty(), err);
+    }
+  }
+
+  void MXFunctionInternal::evalElement(int k, const double** arg, double** res,
+                                       const double** arg1, double** res1,
+                                       int* iw, double* w, double* wt) {
+    AlgEl& e = algorithm_[k];
+    if (e.op==OP_INPUT) {
+      // Pass an input
+      double *w1 = w+workloc_[e.res.front()];
+      int nnz=e.data.nnz();
+      int i=e.arg.at(0);
+      int nz_offset=e.arg.at(2);
+      if (arg[i]==0) {
+        fill(w1, w1+nnz, 0);
+      } else {
+        copy(arg[i]+nz_offset, arg[i]+nz_offset+nnz, w1);
+      }
+    } else if (e.op==OP_OUTPUT) {
+      // Get an output
+      double *w1 = w+workloc_[e.arg.front()];
+      int i=e.res.front();
+      if (res[i]!=0) copy(w1, w1+output(i).nnz(), res[i]);
+    } else if (!fused_.empty() && fused_[k]!=-1) {
+      // Fused elementwise operations, evaluated at the last one
+      if (fused_[k]>=0) evalFused(kernels_[fused_[k]], w, wt);
+    } else {
+      // Point pointers to the data corresponding to the element
+      for (int i=0; i<e.arg.size(); ++i)
+        arg1[i] = e.arg[i]>=0 ? w+workloc_[e.arg[i]] : 0;
+      for (int i=0; i<e.res.size(); ++i)
+        res1[i] = e.res[i]>=0 ? w+workloc_[e.res[i]] : 0;
+
+      // Evaluate
+      e.data->evalD(arg1, res1, iw, wt);
+    }
+  }
+
+  void MXFunctionInternal::evalFused(const MXFusedKernel& k, double* w, double* reg) const {
+    int nop = k.op.size();
+    int bs = min(k.n, FUSE_BLOCKSIZE);
+    for (int j=0; j<k.n; j+=bs) {
+      int m = min(bs, k.n-j);
+      for (int i=0; i<nop; ++i) {
+        // Intermediate results are kept in reg
+        double* f = i==nop-1 ? w+workloc_[k.res]+j : reg+i*bs;
+        int x = k.x[i], y = k.y[i];
+        bool x_scalar = x>=0 && k.scalar[x];
+        bool y_scalar = y>=0 && k.scalar[y];
+        const double* xp = x<0 ? reg+(~x)*bs : w+workloc_[k.arg[x]]+(x_scalar ? 0 : j);
+        const double* yp = y<0 ? reg+(~y)*bs : w+workloc_[k.arg[y]]+(y_scalar ? 0 : j);
+        if (x_scalar) {
+          casadi_math<double>::fun(k.op[i], *xp, yp, f, m);
+        } else if (y_scalar) {
+          casadi_math<double>::fun(k.op[i], xp, *yp, f, m);
+        } else {
+          casadi_math<double>::fun(k.op[i], xp, yp, f, m);
+        }
+      }
+    }
+  }
+
   void MXFunctionInternal::print(ostream &stream, const AlgEl& el) const {
     if (el.op==OP_OUTPUT) {
       stream << "output[" << el.res.front() << "] = @" << el.arg.at(0);
@@ -1220,6 +1640,16 @@ namespace casadi {
               << "    " << g.fill_n(g.work(i, n), n, "0") << endl;
           }
         }
+      } else if (!fused_.empty() && fused_[it-algorithm_.begin()]!=-1) {
+        // Fused elementwise operations, generated at the last one
+        int f = fused_[it-algorithm_.begin()];
+        if (f>=0) {
+          if (g.verbose) {
+            s << "  /* #" << k++ << ": Fused elementwise kernel, "
+              << kernels_[f].op.size() << " operations */" << endl;
+          }
+          generateFused(kernels_[f], g);
+        }
       } else {
         // Generate comment
         if (g.verbose) {
@@ -1256,6 +1686,63 @@ namespace casadi {
     }
   }
 
+  void MXFunctionInternal::generateCost(const CodeGenerator& g, size_t& stack,
+                                        size_t& n_op) const {
+    size_t sz_real = g.real_t=="float" ? sizeof(float) : sizeof(double);
+
+    // Temporaries declared in generateBody (i, j, k, i_; ii, jj, kk, cii, rr, ss, tt, cr, cs, ct,
+    // arg1, res1; r, s, t)
+    stack = 4*sizeof(int) + 12*sizeof(void*) + 3*sz_real;
+
+    // Work vector elements declared as local variables or pointers
+    for (int i=0; i<workloc_.size()-1; ++i) {
+      int n=workloc_[i+1]-workloc_[i];
+      if (n==0) continue;
+      stack += !g.codegen_scalars && n==1 ? sz_real : sizeof(void*);
+    }
+
+    // One operation per nonzero calculated, the cost of called functions
+    size_t stack_call = 0;
+    n_op = 0;
+    for (vector<AlgEl>::const_iterator it=algorithm_.begin(); it!=algorithm_.end(); ++it) {
+      if (it->op==OP_INPUT || it->op==OP_OUTPUT || it->op==OP_CONST) continue;
+      if (it->data->numFunctions()>0) {
+        for (int i=0; i<it->data->numFunctions(); ++i) {
+          size_t stack_i, n_op_i;
+          it->data->getFunction(i)->generateCost(g, stack_i, n_op_i);
+          stack_call = max(stack_call, stack_i);
+          n_op += n_op_i;
+        }
+      } else {
+        n_op += it->data.nnz();
+      }
+    }
+    stack += stack_call;
+  }
+
+  void MXFunctionInternal::generateFused(const MXFusedKernel& k, CodeGenerator& g) const {
+    // Expressions for the operations, intermediate results are used exactly once
+    vector<string> ex(k.op.size());
+    for (int i=0; i<k.op.size(); ++i) {
+      string xy[2];
+      for (int c=0; c<2; ++c) {
+        int x = c==0 ? k.x[i] : k.y[i];
+        if (x<0) {
+          xy[c] = ex[~x];
+        } else if (k.scalar[x]) {
+          xy[c] = g.workel(k.arg[x]);
+        } else {
+          xy[c] = g.work(k.arg[x], k.n) + "[i]";
+        }
+      }
+      stringstream ss;
+      casadi_math<double>::print(k.op[i], ss, xy[0], xy[1]);
+      ex[i] = ss.str();
+    }
+    g.body << "  for (i=0; i<" << k.n << "; ++i) " << g.work(k.res, k.n) << "[i] = "
+           << ex.back() << ";" << endl;
+  }
+
   void MXFunctionInternal::generateLiftingFunctions(MXFunction& vdef_fcn, MXFunction& vinit_fcn) {
     assertInit();
 
@@ -54,6 +54,28 @@ namespace casadi {
     /// Work vector indices of the results
     std::vector<int> res;
   };
+
+  /** \brief  A chain of elementwise operations evaluated in a single loop
+
+      The operations are stored in the order of evaluation, the last one
+      being the root whose result is written to the work vector. An operand
+      index i>=0 refers to the external argument arg[i], an index i<0 to the
+      result of operation ~i.
+  */
+  struct MXFusedKernel {
+    /// Number of nonzeros of the result and of all non-scalar operands
+    int n;
+
+    /// Work vector indices of the external arguments, scalar (broadcasted) or not
+    std::vector<int> arg;
+    std::vector<bool> scalar;
+
+    /// Operations and their operands
+    std::vector<int> op, x, y;
+
+    /// Work vector index of the result
+    int res;
+  };
 #endif // SWIG
 
   /** \brief  Internal node class for MXFunction
@@ -77,6 +99,30 @@ namespace casadi {
     /// Free variables
     std::vector<MX> free_vars_;
 
+    /** \brief  Fused elementwise kernels, evaluated in place of their root element */
+    std::vector<MXFusedKernel> kernels_;
+
+    /** \brief  For each algorithm element: index in kernels_, -1 if not fused,
+        -2 if part of a kernel evaluated at a later element */
+    std::vector<int> fused_;
+
+    /** \brief  Parallel evaluation: the algorithm is sorted by level in the dependency graph
+        and the elements of each level are divided into chunks, evaluated by one thread each */
+    bool parallel_;
+    int nthreads_;
+
+    /** \brief  Chunks of each level, elements of each chunk */
+    std::vector<int> level_ptr_, chunk_ptr_, chunk_el_;
+
+    /** \brief  Size of the arg, res, iw and w fields for each thread */
+    size_t sz_arg_t_, sz_res_t_, sz_iw_t_, sz_w_t_;
+
+    /** \brief  Estimated cost of an evaluation */
+    double cost_;
+
+    /** \brief  Can the function be evaluated by several threads at the same time */
+    bool reentrant_;
+
     /** \brief  Multiple input, multiple output constructor, only to be accessed from MXFunction,
         therefore protected */
     MXFunctionInternal(const std::vector<MX>& input, const std::vector<MX>& output);
@@ -93,6 +139,16 @@ namespace casadi {
     /** \brief  Evaluate numerically, work vectors given */
     virtual void evalD(const double** arg, double** res, int* iw, double* w);
 
+    /** \brief  Evaluate numerically in parallel, level by level */
+    void evalParallel(const double** arg, double** res, int* iw, double* w);
+
+    /** \brief  Evaluate an element of the algorithm, wt is the thread's part of w */
+    void evalElement(int k, const double** arg, double** res, const double** arg1,
+                     double** res1, int* iw, double* w, double* wt);
+
+    /** \brief  Evaluate a fused elementwise kernel, intermediate results in reg */
+    void evalFused(const MXFusedKernel& k, double* w, double* reg) const;
+
     /** \brief  Print description */
     virtual void print(std::ostream &stream) const;
 
@@ -105,6 +161,12 @@ namespace casadi {
     /** \brief Generate code for the body of the C function */
     virtual void generateBody(CodeGenerator& g) const;
 
+    /** \brief Stack usage and number of operations of the generated code */
+    virtual void generateCost(const CodeGenerator& g, size_t& stack, size_t& n_op) const;
+
+    /** \brief Generate code for a fused elementwise kernel */
+    void generateFused(const MXFusedKernel& k, CodeGenerator& g) const;
+
     /** \brief Extract the residual function G and the modified function Z out of an expression
      * (see Albersmeyer2010 paper) */
     void generateLiftingFunctions(MXFunction& vdef_fcn, MXFunction& vinit_fcn);
@@ -26,6 +26,7 @@
 #include "nlp_solver_internal.hpp"
 #include "mx_function.hpp"
 #include "sx_function.hpp"
+#include "../profiling.hpp"
 
 INPUTSCHEME(NlpSolverInput)
 OUTPUTSCHEME(NlpSolverOutput)
@@ -78,6 +79,10 @@ namespace casadi {
     addOption("eval_errors_fatal", OT_BOOLEAN, false,
               "When errors occur during evaluation of f,g,...,"
               "stop the iterations");
+    addOption("parallel_derivatives", OT_BOOLEAN, false,
+              "Detect the sparsity patterns and colorings of the derivative functions "
+              "concurrently (requires OpenMP and an SXFunction NLP). "
+              "Construction times are reported in the statistics.");
 
     addOption("defaults_recipes",    OT_STRINGVECTOR, GenericType(), "",
                                                        "qp", true);
@@ -160,7 +165,7 @@ namespace casadi {
 
     callback_step_ = getOption("iteration_callback_step");
     eval_errors_fatal_ = getOption("eval_errors_fatal");
-
+    parallel_derivatives_ = getOption("parallel_derivatives");
   }
 
   void NlpSolverInternal::checkInitialBounds() {
@@ -204,14 +209,18 @@ namespace casadi {
 
   Function& NlpSolverInternal::gradF() {
     if (gradF_.isNull()) {
+      double t0 = getRealTime();
       gradF_ = getGradF();
+      stats_["t_init_grad_f"] = getRealTime()-t0;
     }
     return gradF_;
   }
 
   Function& NlpSolverInternal::jacF() {
     if (jacF_.isNull()) {
+      double t0 = getRealTime();
       jacF_ = getJacF();
+      stats_["t_init_jac_f"] = getRealTime()-t0;
     }
     return jacF_;
   }
@@ -270,7 +279,9 @@ namespace casadi {
 
   Function& NlpSolverInternal::jacG() {
     if (jacG_.isNull()) {
+      double t0 = getRealTime();
       jacG_ = getJacG();
+      stats_["t_init_jac_g"] = getRealTime()-t0;
     }
     return jacG_;
   }
@@ -307,7 +318,9 @@ namespace casadi {
 
   Function& NlpSolverInternal::gradLag() {
     if (gradLag_.isNull()) {
+      double t0 = getRealTime();
       gradLag_ = getGradLag();
+      stats_["t_init_grad_lag"] = getRealTime()-t0;
     }
     return gradLag_;
   }
@@ -332,7 +345,9 @@ namespace casadi {
 
   Function& NlpSolverInternal::hessLag() {
     if (hessLag_.isNull()) {
+      double t0 = getRealTime();
       hessLag_ = getHessLag();
+      stats_["t_init_hess_lag"] = getRealTime()-t0;
     }
     return hessLag_;
   }
@@ -367,7 +382,9 @@ namespace casadi {
 
   Sparsity& NlpSolverInternal::spHessLag() {
     if (spHessLag_.isNull()) {
+      double t0 = getRealTime();
       spHessLag_ = getSpHessLag();
+      stats_["t_init_sp_hess_lag"] = getRealTime()-t0;
     }
     return spHessLag_;
   }
@@ -386,6 +403,83 @@ namespace casadi {
     return spHessLag;
   }
 
+  void NlpSolverInternal::initDerivatives(bool hess) {
+    // Symbolic differentiation is serial, the Hessian is generated from the Lagrangian gradient
+    bool gen_hess = hess && !hasSetOption("hess_lag");
+    if (gen_hess) gradLag();
+
+    // Sparsity detection and graph coloring can run concurrently for SXFunction NLPs, for
+    // which sparsity propagation only touches the work vectors passed by the caller
+    if (parallel_derivatives_) {
+#ifdef WITH_OPENMP
+      if (is_a<SXFunction>(nlp_) && !(gen_hess && hasSetOption("grad_lag"))) {
+        initDerivativeSparsity(!hasSetOption("grad_f"), ng_>0 && !hasSetOption("jac_g"),
+                               gen_hess);
+      } else {
+        log("NlpSolverInternal::initDerivatives",
+            "derivatives constructed serially, the NLP is not an SXFunction");
+      }
+#else // WITH_OPENMP
+      log("NlpSolverInternal::initDerivatives",
+          "derivatives constructed serially, compiled without OpenMP");
+#endif // WITH_OPENMP
+    }
+
+    // Generate the functions, reusing the patterns and colorings
+    gradF();
+    jacG();
+    if (hess) hessLag();
+  }
+
+  void NlpSolverInternal::initDerivativeSparsity(bool grad_f, bool jac_g, bool hess_lag) {
+    double t0 = getRealTime();
+
+    // Exceptions cannot leave the parallel region
+    string err;
+#ifdef WITH_OPENMP
+#pragma omp parallel sections num_threads(2)
+#endif // WITH_OPENMP
+    {
+#ifdef WITH_OPENMP
+#pragma omp section
+#endif // WITH_OPENMP
+      {
+        try {
+          // Objective gradient and constraint Jacobian
+          if (grad_f) nlp_.jacSparsity(NL_X, NL_F, true, false);
+          if (jac_g) {
+            nlp_.jacSparsity(NL_X, NL_G, false, false);
+            nlp_->getJacobianPlan(NL_X, NL_G, false);
+          }
+        } catch(exception& e) {
+#ifdef WITH_OPENMP
+#pragma omp critical
+#endif // WITH_OPENMP
+          err = e.what();
+        }
+      }
+#ifdef WITH_OPENMP
+#pragma omp section
+#endif // WITH_OPENMP
+      {
+        try {
+          // Hessian of the Lagrangian, star coloring
+          if (hess_lag) {
+            gradLag_.jacSparsity(NL_X, NL_NUM_OUT+NL_X, false, true);
+            gradLag_->getJacobianPlan(NL_X, NL_NUM_OUT+NL_X, true);
+          }
+        } catch(exception& e) {
+#ifdef WITH_OPENMP
+#pragma omp critical
+#endif // WITH_OPENMP
+          err = e.what();
+        }
+      }
+    }
+    casadi_assert_message(err.empty(), err);
+    stats_["t_init_sparsity"] = getRealTime()-t0;
+  }
+
   void NlpSolverInternal::checkInputs() const {
     for (int i=0;i<input(NLP_SOLVER_LBX).nnz();++i) {
       casadi_assert_message(input(NLP_SOLVER_LBX).at(i)<=input(NLP_SOLVER_UBX).at(i),
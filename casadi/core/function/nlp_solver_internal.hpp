@@ -105,6 +105,13 @@ namespace casadi {
     /// Get the sparsity pattern of the Hessian of the Lagrangian
     Sparsity& spHessLag();
 
+    /** \brief Generate the objective gradient, the constraint Jacobian and,
+        if \a hess is true, the Hessian of the Lagrangian */
+    void initDerivatives(bool hess);
+
+    /// Detect the derivative sparsity patterns and colorings concurrently
+    void initDerivativeSparsity(bool grad_f, bool jac_g, bool hess_lag);
+
     /// Number of variables
     int nx_;
 
@@ -123,6 +130,9 @@ namespace casadi {
     // Evaluation errors are fatal
     bool eval_errors_fatal_;
 
+    /// Construct the derivative functions concurrently
+    bool parallel_derivatives_;
+
     /// The NLP
     Function nlp_;
 
@@ -54,6 +54,14 @@ namespace casadi {
     (*this)->generateNativeCode(file);
   }
 
+  std::vector<int> QpSolver::getWorkingSet() const {
+    return (*this)->getWorkingSet();
+  }
+
+  void QpSolver::setWorkingSet(const std::vector<int>& ws) {
+    (*this)->setWorkingSet(ws);
+  }
+
 #ifdef WITH_DEPRECATED_FEATURES
   QpSolver::QpSolver(const std::string& solver, const std::map<std::string, Sparsity>& st) {
     assignNode(QpSolverInternal::instantiatePlugin(solver, st));
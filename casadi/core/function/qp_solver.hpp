@@ -151,6 +151,21 @@ namespace casadi {
 
     /** Generate native code in the interfaced language for debugging */
     void generateNativeCode(std::ostream &file) const;
+
+    /** \brief Get the working set after the last solve
+     *
+     * One entry per variable followed by one entry per linear constraint:
+     * -1 if active at the lower bound, 1 if active at the upper bound and 0 if inactive.
+     * The result can be stored and passed to setWorkingSet of a solver with the same
+     * dimensions in order to hot-start it.
+     */
+    std::vector<int> getWorkingSet() const;
+
+    /** \brief Set the working set used to hot-start the next solve
+     *
+     * See getWorkingSet for the format. Only used for the next call.
+     */
+    void setWorkingSet(const std::vector<int>& ws);
   };
 
 } // namespace casadi
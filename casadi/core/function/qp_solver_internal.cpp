@@ -131,6 +131,17 @@ namespace casadi {
                  << typeid(*this).name());
   }
 
+  std::vector<int> QpSolverInternal::getWorkingSet() const {
+    casadi_error("QpSolverInternal::getWorkingSet not defined for class "
+                 << typeid(*this).name());
+    return std::vector<int>();
+  }
+
+  void QpSolverInternal::setWorkingSet(const std::vector<int>& ws) {
+    casadi_error("QpSolverInternal::setWorkingSet not defined for class "
+                 << typeid(*this).name());
+  }
+
   std::map<std::string, QpSolverInternal::Plugin> QpSolverInternal::solvers_;
 
   const std::string QpSolverInternal::infix_ = "qpsolver";
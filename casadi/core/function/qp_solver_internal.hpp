@@ -68,6 +68,12 @@ namespace casadi {
     /** Generate native code in the interfaced language for debugging */
     virtual void generateNativeCode(std::ostream& file) const;
 
+    /// Get the working set after the last solve
+    virtual std::vector<int> getWorkingSet() const;
+
+    /// Set the working set used to hot-start the next solve
+    virtual void setWorkingSet(const std::vector<int>& ws);
+
     // Creator function for internal class
     typedef QpSolverInternal* (*Creator)(const std::map<std::string, Sparsity>& st);
 
@@ -275,6 +275,18 @@ namespace casadi {
     }
   }
 
+  void SXFunctionInternal::generateCost(const CodeGenerator& g, size_t& stack,
+                                        size_t& n_op) const {
+    // All work vector elements are local variables
+    stack = sz_w()*(g.real_t=="float" ? sizeof(float) : sizeof(double));
+
+    // Operations other than reading inputs, writing outputs and constants
+    n_op = 0;
+    for (vector<AlgEl>::const_iterator it = algorithm_.begin(); it!=algorithm_.end(); ++it) {
+      if (it->op!=OP_INPUT && it->op!=OP_OUTPUT && it->op!=OP_CONST) n_op++;
+    }
+  }
+
   void SXFunctionInternal::init() {
 
     // Call the init function of the base class
@@ -582,6 +594,34 @@ namespace casadi {
     }
   }
 
+  void SXFunctionInternal::evalBatch(const double** arg, double** res, int n, double* w) {
+    casadi_assert_message(free_vars_.empty(),
+                          "Cannot evaluate \"" << getOption("name") << "\" since variables "
+                          << free_vars_ << " are free.");
+
+    // Evaluate the algorithm, one operation at a time for all evaluations
+    for (vector<AlgEl>::iterator it=algorithm_.begin(); it!=algorithm_.end(); ++it) {
+      switch (it->op) {
+        CASADI_MATH_FUN_BUILTIN_GEN(BinaryOperationVV,
+                                    w + it->i1*n, w + it->i2*n, w + it->i0*n, n)
+
+      case OP_CONST: fill_n(w + it->i0*n, n, it->d); break;
+      case OP_INPUT:
+        if (arg[it->i1]==0) {
+          fill_n(w + it->i0*n, n, 0);
+        } else {
+          copy(arg[it->i1] + it->i2*n, arg[it->i1] + (it->i2+1)*n, w + it->i0*n);
+        }
+        break;
+      case OP_OUTPUT:
+        if (res[it->i0]!=0) copy(w + it->i1*n, w + (it->i1+1)*n, res[it->i0] + it->i2*n);
+        break;
+      default:
+        casadi_error("SXFunctionInternal::evalBatch: Unknown operation" << it->op);
+      }
+    }
+  }
+
   void SXFunctionInternal::evalSX(const SXElement** arg, SXElement** res,
                                   int* iw, SXElement* w) {
     if (verbose()) userOut() << "SXFunctionInternal::evalSXsparse begin" << endl;
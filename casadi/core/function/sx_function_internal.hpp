@@ -94,6 +94,13 @@ class CASADI_EXPORT SXFunctionInternal :
   /** \brief  Evaluate numerically, work vectors given */
   virtual void evalD(const double** arg, double** res, int* iw, double* w);
 
+  /** \brief  Evaluate numerically for \a n arguments simultaneously
+   *
+   * Structure-of-arrays layout: nonzero \a k of input/output \a i for evaluation \a j
+   * is stored at arg[i][k*n+j]. The work vector must have length sz_w()*n.
+   */
+  void evalBatch(const double** arg, double** res, int n, double* w);
+
   /** \brief Quickfix to avoid segfault, #1552 */
   virtual bool canEvalSX() const {return true;}
 
@@ -164,6 +171,9 @@ class CASADI_EXPORT SXFunctionInternal :
   /** \brief Generate code for the body of the C function */
   virtual void generateBody(CodeGenerator& g) const;
 
+  /** \brief Stack usage and number of operations of the generated code */
+  virtual void generateCost(const CodeGenerator& g, size_t& stack, size_t& n_op) const;
+
   /** \brief Clear the function from its symbolic representation, to free up memory,
    * no symbolic evaluations are possible after this */
   void clearSymbolic();
@@ -618,22 +618,23 @@ namespace casadi {
     }
 
     // Create return object
-    MatType ret = MatType::zeros(jacSparsity(iind, oind, compact, symmetric).T());
+    MatType ret = MatType::zeros(jacSparsity(iind, oind, compact, symmetric));
     if (verbose()) userOut() << "XFunctionInternal::jac allocated return value" << std::endl;
 
     // Quick return if empty
     if (ret.nnz()==0) {
-      return ret.T();
+      return ret;
     }
 
-    // Get a bidirectional partition
-    Sparsity D1, D2;
-    getPartition(iind, oind, D1, D2, true, symmetric);
+    // Get the evaluation plan: partition and decompression map
+    const JacobianPlan& plan = getJacobianPlan(iind, oind, symmetric);
+    const Sparsity& D1 = plan.D1;
+    const Sparsity& D2 = plan.D2;
     if (verbose()) userOut() << "XFunctionInternal::jac graph coloring completed" << std::endl;
 
     // Get the number of forward and adjoint sweeps
-    int nfdir = D1.isNull() ? 0 : D1.size2();
-    int nadir = D2.isNull() ? 0 : D2.size2();
+    int nfdir = plan.nfwd();
+    int nadir = plan.nadj();
 
     // Number of derivative directions supported by the function
     int max_nfdir = CasadiOptions::optimized_num_dir;
@@ -648,11 +649,6 @@ namespace casadi {
     // Forward and adjoint seeds and sensitivities
     std::vector<std::vector<MatType> > fseed, aseed, fsens, asens;
 
-    // Get the sparsity of the Jacobian block
-    Sparsity jsp = jacSparsity(iind, oind, true, symmetric).T();
-    const int* jsp_colind = jsp.colind();
-    const int* jsp_row = jsp.row();
-
     // Input sparsity
     std::vector<int> input_col = input(iind).sparsity().getCol();
     const int* input_row = input(iind).row();
@@ -661,19 +657,11 @@ namespace casadi {
     std::vector<int> output_col = output(oind).sparsity().getCol();
     const int* output_row = output(oind).row();
 
-    // Get transposes and mappings for jacobian sparsity pattern if we are using forward mode
-    if (verbose())   userOut() << "XFunctionInternal::jac transposes and mapping" << std::endl;
-    std::vector<int> mapping;
-    Sparsity jsp_trans;
-    if (nfdir>0) {
-      jsp_trans = jsp.transpose(mapping);
-    }
-
     // The nonzeros of the sensitivity matrix
-    std::vector<int> nzmap, nzmap2;
+    std::vector<int> nzmap;
 
     // Additions to the jacobian matrix
-    std::vector<int> adds, adds2;
+    std::vector<int> adds;
 
     // Temporary vector
     std::vector<int> tmp;
@@ -793,149 +781,54 @@ namespace casadi {
       // Evaluate symbolically
       if (verbose()) userOut() << "XFunctionInternal::jac making function call" << std::endl;
       if (fseed.size()>0) {
-        casadi_assert(aseed.size()==0);
         static_cast<DerivedType*>(this)->callForward(inputv_, outputv_,
                                                  fseed, fsens, always_inline, never_inline);
-      } else if (aseed.size()>0) {
-        casadi_assert(fseed.size()==0);
+      }
+      if (aseed.size()>0) {
         static_cast<DerivedType*>(this)->callReverse(inputv_, outputv_,
                                                  aseed, asens, always_inline, never_inline);
       }
 
       // Carry out the forward sweeps
       for (int d=0; d<nfdir_batch; ++d) {
-
-        // If symmetric, see how many times each output appears
-        if (symmetric) {
-          // Initialize to zero
-          tmp.resize(output(oind).sparsity().nnz());
-          fill(tmp.begin(), tmp.end(), 0);
-
-          // "Multiply" Jacobian sparsity by seed vector
-          for (int el = D1.colind(offset_nfdir+d); el<D1.colind(offset_nfdir+d+1); ++el) {
-
-            // Get the input nonzero
-            int c = D1.row(el);
-
-            // Propagate dependencies
-            for (int el_jsp=jsp_colind[c]; el_jsp<jsp_colind[c+1]; ++el_jsp) {
-              tmp[jsp_row[el_jsp]]++;
-            }
-          }
-        }
-
         // Locate the nonzeros of the forward sensitivity matrix
         output(oind).sparsity().find(nzmap);
         fsens[d][oind].sparsity().getNZ(nzmap);
 
-        if (symmetric) {
-          input(iind).sparsity().find(nzmap2);
-          fsens[d][oind].sparsity().getNZ(nzmap2);
+        // Nonzeros of the Jacobian determined in the direction
+        adds.clear();
+        tmp.clear();
+        int dd = offset_nfdir+d;
+        for (int k=plan.fwd_ptr[dd]; k<plan.fwd_ptr[dd+1]; ++k) {
+          int f_out = nzmap[plan.fwd_src[k]];
+          if (f_out<0) continue; // Skip if structurally zero
+          adds.push_back(plan.fwd_dst[k]);
+          tmp.push_back(f_out);
         }
 
-        // Assignments to the Jacobian
-        adds.resize(fsens[d][oind].nnz());
-        fill(adds.begin(), adds.end(), -1);
-        if (symmetric) {
-          adds2.resize(adds.size());
-          fill(adds2.begin(), adds2.end(), -1);
-        }
-
-        // For all the input nonzeros treated in the sweep
-        for (int el = D1.colind(offset_nfdir+d); el<D1.colind(offset_nfdir+d+1); ++el) {
-
-          // Get the input nonzero
-          int c = D1.row(el);
-          //int f2_out;
-          //if (symmetric) {
-          //  f2_out = nzmap2[c];
-          //}
-
-          // Loop over the output nonzeros corresponding to this input nonzero
-          for (int el_out = jsp_trans.colind(c); el_out<jsp_trans.colind(c+1); ++el_out) {
-
-            // Get the output nonzero
-            int r_out = jsp_trans.row(el_out);
-
-            // Get the forward sensitivity nonzero
-            int f_out = nzmap[r_out];
-            if (f_out<0) continue; // Skip if structurally zero
-
-            // The nonzero of the Jacobian now treated
-            int elJ = mapping[el_out];
-
-            if (symmetric) {
-              if (tmp[r_out]==1) {
-                adds[f_out] = el_out;
-                adds2[f_out] = elJ;
-              }
-            } else {
-              // Get the output seed
-              adds[f_out] = elJ;
-            }
-          }
-        }
-
-        // Get entries in fsens[d][oind] with nonnegative indices
-        tmp.resize(adds.size());
-        int sz = 0;
-        for (int i=0; i<adds.size(); ++i) {
-          if (adds[i]>=0) {
-            adds[sz] = adds[i];
-            tmp[sz++] = i;
-          }
-        }
-        adds.resize(sz);
-        tmp.resize(sz);
-
         // Add contribution to the Jacobian
         if (!adds.empty()) ret[adds] = fsens[d][oind][tmp];
-
-        if (symmetric) {
-          // Get entries in fsens[d][oind] with nonnegative indices
-          tmp.resize(adds2.size());
-          sz = 0;
-          for (int i=0; i<adds2.size(); ++i) {
-            if (adds2[i]>=0) {
-              adds2[sz] = adds2[i];
-              tmp[sz++] = i;
-            }
-          }
-          adds2.resize(sz);
-          tmp.resize(sz);
-
-          // Add contribution to the Jacobian
-          ret[adds2] = fsens[d][oind][tmp];
-        }
       }
 
       // Add elements to the Jacobian matrix
       for (int d=0; d<nadir_batch; ++d) {
-
         // Locate the nonzeros of the adjoint sensitivity matrix
         input(iind).sparsity().find(nzmap);
         asens[d][iind].sparsity().getNZ(nzmap);
 
-        // For all the output nonzeros treated in the sweep
-        for (int el = D2.colind(offset_nadir+d); el<D2.colind(offset_nadir+d+1); ++el) {
-
-          // Get the output nonzero
-          int r = D2.row(el);
-
-          // Loop over the input nonzeros that influences this output nonzero
-          for (int elJ = jsp.colind(r); elJ<jsp.colind(r+1); ++elJ) {
-
-            // Get the input nonzero
-            int inz = jsp.row(elJ);
-
-            // Get the corresponding adjoint sensitivity nonzero
-            int anz = nzmap[inz];
-            if (anz<0) continue;
-
-            // Get the input seed
-            ret.at(elJ) = asens[d][iind].at(anz);
-          }
+        // Nonzeros of the Jacobian determined in the direction
+        adds.clear();
+        tmp.clear();
+        int dd = offset_nadir+d;
+        for (int k=plan.adj_ptr[dd]; k<plan.adj_ptr[dd+1]; ++k) {
+          int anz = nzmap[plan.adj_src[k]];
+          if (anz<0) continue; // Skip if structurally zero
+          adds.push_back(plan.adj_dst[k]);
+          tmp.push_back(anz);
         }
+
+        // Add contribution to the Jacobian
+        if (!adds.empty()) ret[adds] = asens[d][iind][tmp];
       }
 
       // Update direction offsets
@@ -945,7 +838,7 @@ namespace casadi {
 
     // Return
     if (verbose()) userOut() << "XFunctionInternal::jac end" << std::endl;
-    return ret.T();
+    return ret;
   }
 
   template<typename PublicType, typename DerivedType, typename MatType, typename NodeType>
@@ -26,12 +26,73 @@
 #include "sparsity_internal.hpp"
 #include "../matrix/matrix.hpp"
 #include "../std_vector_tools.hpp"
+#include "../casadi_mutex.hpp"
 #include <climits>
 
 using namespace std;
 
 namespace casadi {
 
+  /// Number of independently locked parts of the cache, selected by the hash
+  static const int CACHE_SHARDS = 64;
+
+  /// Number of cache entries checked for deleted patterns for each new pattern
+  static const int CACHE_PURGE_STEP = 2;
+
+  /// \cond INTERNAL
+  /// Part of the cache of sparsity patterns, with its own lock and statistics
+  class SparsityCacheShard {
+  public:
+    SparsityCacheShard() : hits(0), misses(0), collisions(0), purged(0), has_cursor(false) {}
+
+    /// Remove the entries of deleted patterns, checking at most n entries
+    void purge(int n) {
+      Sparsity::CachingMap::iterator i = has_cursor ? cache.find(cursor) : cache.end();
+      if (i==cache.end()) i = cache.begin();
+      for (int k=0; k<n && i!=cache.end(); ++k) {
+        if (i->second.alive()) {
+          ++i;
+        } else {
+          cache.erase(i++);
+          purged++;
+        }
+      }
+
+      // Continue from here the next time
+      has_cursor = i!=cache.end();
+      if (has_cursor) cursor = i->first;
+    }
+
+    /// Cached sparsity patterns
+    Sparsity::CachingMap cache;
+
+    /// Statistics
+    int hits, misses, collisions, purged;
+
+    /// Hash of the next entry to be checked for deleted patterns
+    std::size_t cursor;
+    bool has_cursor;
+
+    /// Lock, recursive since a pattern released with the lock held may be deleted
+    CasadiMutex mutex;
+  };
+  /// \endcond
+
+  /// All parts of the cache
+  static SparsityCacheShard* getCacheShards() {
+    static SparsityCacheShard shards[CACHE_SHARDS];
+    return shards;
+  }
+
+  SparsityInternal::~SparsityInternal() {
+    // Invalidate the weak reference with the lock held: another thread recovering the pattern
+    // from the cache then finds either an invalid reference or a zero reference count
+    if (cache_shard_>=0) {
+      CasadiScopedLock lock(getCacheShards()[cache_shard_].mutex);
+      killWeak();
+    }
+  }
+
   /// \cond INTERNAL
   // Singletons
   class EmptySparsity : public Sparsity {
@@ -464,11 +525,6 @@ namespace casadi {
     }
   }
 
-  Sparsity::CachingMap& Sparsity::getCache() {
-    static CachingMap ret;
-    return ret;
-  }
-
   const Sparsity& Sparsity::getScalar() {
     static ScalarSparsity ret;
     return ret;
@@ -579,14 +635,19 @@ namespace casadi {
     (*this)->getNZ(indices);
   }
 
-  Sparsity Sparsity::unidirectionalColoring(const Sparsity& AT, int cutoff) const {
+  Sparsity Sparsity::unidirectionalColoring(const Sparsity& AT, int cutoff, int ordering) const {
     if (AT.isNull()) {
-      return (*this)->unidirectionalColoring(T(), cutoff);
+      return (*this)->unidirectionalColoring(T(), cutoff, ordering);
     } else {
-      return (*this)->unidirectionalColoring(AT, cutoff);
+      return (*this)->unidirectionalColoring(AT, cutoff, ordering);
     }
   }
 
+  void Sparsity::bidirectionalColoring(Sparsity& D1, Sparsity& D2, double w,
+                                       int ordering) const {
+    (*this)->bidirectionalColoring(T(), w, ordering, D1, D2);
+  }
+
   Sparsity Sparsity::starColoring(int ordering, int cutoff, int mode, int threshold) const {
     return (*this)->starColoring(ordering, cutoff, mode, threshold);
   }
@@ -603,6 +664,14 @@ namespace casadi {
     return (*this)->largestFirstOrdering();
   }
 
+  std::vector<int> Sparsity::smallestLastOrdering() const {
+    return (*this)->smallestLastOrdering(T());
+  }
+
+  std::vector<int> Sparsity::incidenceDegreeOrdering() const {
+    return (*this)->incidenceDegreeOrdering(T());
+  }
+
   Sparsity Sparsity::pmult(const std::vector<int>& p, bool permute_rows, bool permute_cols,
                            bool invert_permutation) const {
     return (*this)->pmult(p, permute_rows, permute_cols, invert_permutation);
@@ -656,17 +725,20 @@ namespace casadi {
     // Hash the pattern
     std::size_t h = hash_sparsity(nrow, ncol, colind, row);
 
-    // Get a reference to the cache
-    CachingMap& cache = getCache();
+    // Part of the cache for the hash
+    int shard_ind = (h ^ (h >> 16)) % CACHE_SHARDS;
+    SparsityCacheShard& shard = getCacheShards()[shard_ind];
 
-    // Record the current number of buckets (for garbage collection below)
-#ifdef USE_CXX11
-    int bucket_count_before = cache.bucket_count();
-#endif // USE_CXX11
+    // Release the current pattern after the lock, deleting it requires the lock of its part
+    Sparsity old = *this;
+
+    // Locked until return
+    CasadiScopedLock lock(shard.mutex);
+    CachingMap& cache = shard.cache;
 
     // WORKAROUND, functions do not appear to work when bucket_count==0
 #ifdef USE_CXX11
-    if (bucket_count_before>0) {
+    if (cache.bucket_count()>0) {
 #endif // USE_CXX11
 
       // Find the range of patterns equal to the key (normally only zero or one)
@@ -678,17 +750,16 @@ namespace casadi {
         // Get a weak reference to the cached sparsity pattern
         WeakRef& wref = i->second;
 
-        // Check if the pattern still exists
-        if (wref.alive()) {
-
-          // Get an owning reference to the cached pattern
-          Sparsity ref = shared_cast<Sparsity>(wref.shared());
+        // Get an owning reference to the cached pattern, if it still exists
+        Sparsity ref = shared_cast<Sparsity>(wref.shared());
+        if (!ref.isNull()) {
 
           // Check if the pattern matches
           if (ref.isEqual(nrow, ncol, colind, row)) {
 
             // Found match!
             assignNode(ref.get());
+            shard.hits++;
             return;
 
           } else {
@@ -700,9 +771,11 @@ namespace casadi {
 
               // Create a new pattern
               assignNode(new SparsityInternal(nrow, ncol, colind, row));
+              shard.misses++;
 
               // Cache this pattern instead of the old one
               wref = *this;
+              (*this)->cache_shard_ = shard_ind;
 
               // Recache the old sparsity pattern
               // TODO(Joel): recache "ref"
@@ -710,6 +783,7 @@ namespace casadi {
 
             } else { // There is a hash rowision (unlikely, but possible)
               // Leave the pattern alone, continue to the next matching pattern
+              shard.collisions++;
               continue;
             }
           }
@@ -718,14 +792,14 @@ namespace casadi {
           CachingMap::iterator j=i;
           j++; // Start at the next matching key
           for (; j!=eq.second; ++j) {
-            if (j->second.alive()) {
-
-              // Recover cached sparsity
-              Sparsity ref = shared_cast<Sparsity>(j->second.shared());
+            // Recover cached sparsity
+            ref = shared_cast<Sparsity>(j->second.shared());
+            if (!ref.isNull()) {
 
               // Match found if sparsity matches
               if (ref.isEqual(nrow, ncol, colind, row)) {
                 assignNode(ref.get());
+                shard.hits++;
                 return;
               }
             }
@@ -733,9 +807,11 @@ namespace casadi {
 
           // The cached entry has been deleted, create a new one
           assignNode(new SparsityInternal(nrow, ncol, colind, row));
+          shard.misses++;
 
           // Cache this pattern
           wref = *this;
+          (*this)->cache_shard_ = shard_ind;
 
           // Return
           return;
@@ -749,31 +825,43 @@ namespace casadi {
 
     // No matching sparsity pattern could be found, create a new one
     assignNode(new SparsityInternal(nrow, ncol, colind, row));
+    shard.misses++;
+
+    // Garbage collection, a few entries at a time so that the cost is spread out
+    shard.purge(CACHE_PURGE_STEP);
 
     // Cache this pattern
-    //cache.insert(eq.second, std::pair<std::size_t, WeakRef>(h, ret));
     cache.insert(std::pair<std::size_t, WeakRef>(h, *this));
+    (*this)->cache_shard_ = shard_ind;
+  }
 
-    // Garbage collection (currently only supported for unordered_multimap)
-#ifdef USE_CXX11
-    int bucket_count_after = cache.bucket_count();
-
-    // We we increased the number of buckets, take time to garbage-collect deleted references
-    if (bucket_count_before!=bucket_count_after) {
-      CachingMap::const_iterator i=cache.begin();
-      while (i!=cache.end()) {
-        if (!i->second.alive()) {
-          i = cache.erase(i);
-        } else {
-          i++;
-        }
-      }
+  void Sparsity::clearCache() {
+    for (int i=0; i<CACHE_SHARDS; ++i) {
+      SparsityCacheShard& shard = getCacheShards()[i];
+      CasadiScopedLock lock(shard.mutex);
+      shard.cache.clear();
+      shard.has_cursor = false;
     }
-#endif // USE_CXX11
   }
 
-  void Sparsity::clearCache() {
-    getCache().clear();
+  Dict Sparsity::cacheStats() {
+    int hits=0, misses=0, collisions=0, purged=0, entries=0;
+    for (int i=0; i<CACHE_SHARDS; ++i) {
+      SparsityCacheShard& shard = getCacheShards()[i];
+      CasadiScopedLock lock(shard.mutex);
+      hits += shard.hits;
+      misses += shard.misses;
+      collisions += shard.collisions;
+      purged += shard.purged;
+      entries += shard.cache.size();
+    }
+    Dict ret;
+    ret["hits"] = hits;
+    ret["misses"] = misses;
+    ret["collisions"] = collisions;
+    ret["purged"] = purged;
+    ret["entries"] = entries;
+    return ret;
   }
 
   Sparsity Sparsity::zz_tril(bool includeDiagonal) const {
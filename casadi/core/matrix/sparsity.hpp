@@ -44,6 +44,7 @@
 #define CACHING_MULTIMAP std::multimap
 #endif // USE_CXX11
 #include "../weak_ref.hpp"
+#include "../generic_type.hpp"
 
 namespace casadi {
 
@@ -210,6 +211,10 @@ namespace casadi {
 
     /** \brief Clear the cache */
     static void clearCache();
+
+    /** \brief Statistics of the cache: number of hits, misses, hash collisions,
+     * purged entries of deleted patterns and current number of entries */
+    static Dict cacheStats();
     /// \endcond
 
     /** \brief Check if the dimensions and colind, row vectors are compatible.
@@ -622,9 +627,6 @@ namespace casadi {
 #ifndef SWIG
     typedef CACHING_MULTIMAP<std::size_t, WeakRef> CachingMap;
 
-    /// Cached sparsity patterns
-    static CachingMap& getCache();
-
     /// (Dense) scalar
     static const Sparsity& getScalar();
 
@@ -709,9 +711,28 @@ namespace casadi {
 #endif // SWIG
 
     /** \brief Perform a unidirectional coloring: A greedy distance-2 coloring algorithm
-        (Algorithm 3.1 in A. H. GEBREMEDHIN, F. MANNE, A. POTHEN) */
+        (Algorithm 3.1 in A. H. GEBREMEDHIN, F. MANNE, A. POTHEN)
+
+        Ordering options: None (0), largest first (1), smallest last (2),
+        incidence degree (3)
+
+        For large patterns, and if compiled with OpenMP, the speculative parallel
+        coloring of Gebremedhin and Manne is used, so the number of colors may
+        depend on the number of threads.
+    */
     Sparsity unidirectionalColoring(const Sparsity& AT=Sparsity(),
-                                    int cutoff = std::numeric_limits<int>::max()) const;
+                                    int cutoff = std::numeric_limits<int>::max(),
+                                    int ordering = 0) const;
+
+    /** \brief Perform a bidirectional coloring
+        Partition the columns (forward mode, D1) and the rows (adjoint mode, D2) such
+        that each nonzero is determined directly by either a forward or an adjoint
+        directional derivative. The densest rows are colored in adjoint mode and the
+        remaining rows in forward mode, or vice versa, and the partition minimizing
+        w*nfwd + (1-w)*nadj is returned. D1 or D2 is null if unidirectional is best.
+    */
+    void bidirectionalColoring(Sparsity& SWIG_OUTPUT(D1), Sparsity& SWIG_OUTPUT(D2),
+                               double w=0.5, int ordering=0) const;
 
     /** \brief Perform a star coloring of a symmetric matrix
 
@@ -726,7 +747,8 @@ namespace casadi {
           A. H. GEBREMEDHIN, F. MANNE, A. POTHEN
           SIAM Rev., 47(4), 629–705 (2006)
 
-        Ordering options: None (0), largest first (1)
+        Ordering options: None (0), largest first (1), smallest last (2),
+        incidence degree (3)
 
 
         S = H.starColoring()
@@ -742,13 +764,22 @@ namespace casadi {
           A. H. GEBREMEDHIN, A. TARAFDAR, F. MANNE, A. POTHEN
           SIAM J. SCI. COMPUT. Vol. 29, No. 3, pp. 1042–1072 (2007)
 
-        Ordering options: None (0), largest first (1)
+        Ordering options: None (0), largest first (1), smallest last (2),
+        incidence degree (3)
     */
     Sparsity starColoring2(int ordering = 1, int cutoff = std::numeric_limits<int>::max()) const;
 
     /** \brief Order the cols by decreasing degree */
     std::vector<int> largestFirstOrdering() const;
 
+    /** \brief Order the cols by smallest last in the column intersection graph
+        Columns of minimal degree are repeatedly removed and placed last */
+    std::vector<int> smallestLastOrdering() const;
+
+    /** \brief Order the cols by incidence degree in the column intersection graph
+        The next column is the one with the most neighbors already ordered */
+    std::vector<int> incidenceDegreeOrdering() const;
+
     /** \brief Permute rows and/or columns
         Multiply the sparsity with a permutation matrix from the left and/or from the right
         P * A * trans(P), A * trans(P) or A * trans(P) with P defined by an index vector
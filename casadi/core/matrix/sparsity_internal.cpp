@@ -30,10 +30,20 @@
 #include <cmath>
 #include "matrix.hpp"
 
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif // WITH_OPENMP
+
 using namespace std;
 
 namespace casadi {
 
+  /// Minimum number of nonzeros of the factors for a parallel pattern product
+  static const int MULTIPLY_PARALLEL_MIN_NNZ = 100000;
+
+  /// Minimum number of columns for a parallel (speculative) graph coloring
+  static const int COLORING_PARALLEL_MIN = 10000;
+
   int SparsityInternal::numel() const {
     return size1()*size2();
   }
@@ -123,12 +133,33 @@ namespace casadi {
   }
 
   Sparsity SparsityInternal::transpose(vector<int>& mapping, bool invert_mapping) const {
-    // Get the sparsity of the transpose in sparse triplet form
-    vector<int> trans_col = getRow();
-    vector<int> trans_row = getCol();
+    const int* colind = this->colind();
+    const int* row = this->row();
+    int nrow = size1();
+    int ncol = size2();
+
+    // Number of nonzeros in each row, cumsum to get the offsets in the transpose
+    vector<int> ret_colind(nrow+1, 0);
+    for (int k=0; k<nnz(); ++k) ret_colind[row[k]+1]++;
+    for (int i=0; i<nrow; ++i) ret_colind[i+1] += ret_colind[i];
+
+    // Place the nonzeros, column by column so that the rows of the transpose are sorted
+    vector<int> next(ret_colind.begin(), ret_colind.end()-1);
+    vector<int> ret_row(nnz());
+    mapping.resize(nnz());
+    for (int cc=0; cc<ncol; ++cc) {
+      for (int k=colind[cc]; k<colind[cc+1]; ++k) {
+        int el = next[row[k]]++;
+        ret_row[el] = cc;
+        if (invert_mapping) {
+          mapping[k] = el;
+        } else {
+          mapping[el] = k;
+        }
+      }
+    }
 
-    // Create the sparsity pattern
-    return Sparsity::triplet(size2(), size1(), trans_row, trans_col, mapping, invert_mapping);
+    return Sparsity(ncol, nrow, ret_colind, ret_row);
   }
 
   std::vector<int> SparsityInternal::eliminationTree(bool ata) const {
@@ -1724,62 +1755,75 @@ namespace casadi {
     return P;
   }
 
-  int SparsityInternal::scatter(int j, std::vector<int>& w, int mark, int* Ci, int nz) const {
-    int i, p;
-    const int *Ap = colind();
-    const int *Ai = row();
-
-    for (p = Ap[j]; p<Ap[j+1]; ++p) {
-      // A(i, j) is nonzero
-      i = Ai[p];
-
-      if (w[i] < mark) {
-        // i is new entry in row j
-        w[i] = mark;
-
-        // add i to pattern of C(:, j)
-        Ci[nz++] = i;
-      }
-    }
-    return nz;
-  }
-
   Sparsity SparsityInternal::multiply(const Sparsity& B) const {
-    int nz = 0;
     casadi_assert_message(size2() == B.size1(), "Dimension mismatch.");
     int m = size1();
-    int anz = nnz();
     int n = B.size2();
-    const int* Bp = B.colind();
-    const int* Bi = B.row();
-    int bnz = Bp[n];
-
-    // get workspace
-    vector<int> w(m);
-
-    // allocate result
-    vector<int> C_colind(n+1, 0), C_row;
-
-    C_colind.resize(anz + bnz);
-
-    int* Cp = &C_colind.front();
-    for (int j=0; j<n; ++j) {
-      if (nz+m > C_row.size()) {
-        C_row.resize(2*(C_row.size())+m);
+    const int* colind = this->colind();
+    const int* row = this->row();
+    const int* B_colind = B.colind();
+    const int* B_row = B.row();
+
+    // Large products are formed in parallel, in blocks of columns
+    int nblock = 1;
+#ifdef WITH_OPENMP
+    if (nnz()+B.nnz()>=MULTIPLY_PARALLEL_MIN_NNZ) nblock = min(omp_get_max_threads(), n);
+#endif // WITH_OPENMP
+
+    // Row markers, one for each block of columns
+    vector<int> w(static_cast<size_t>(m)*nblock, -1);
+
+    // Count the nonzeros of each column of the result (marker: j)
+    vector<int> C_colind(n+1, 0);
+#ifdef WITH_OPENMP
+#pragma omp parallel for if (nblock>1)
+#endif // WITH_OPENMP
+    for (int b=0; b<nblock; ++b) {
+      int* mark = getPtr(w) + static_cast<size_t>(m)*b;
+      int j_end = static_cast<int>(static_cast<long>(n)*(b+1)/nblock);
+      for (int j=static_cast<int>(static_cast<long>(n)*b/nblock); j<j_end; ++j) {
+        int nz = 0;
+        for (int kk=B_colind[j]; kk<B_colind[j+1]; ++kk) {
+          int r = B_row[kk];
+          for (int k=colind[r]; k<colind[r+1]; ++k) {
+            if (mark[row[k]]!=j) {
+              mark[row[k]] = j;
+              nz++;
+            }
+          }
+        }
+        C_colind[j+1] = nz;
       }
-
-      // row j of C starts here
-      Cp[j] = nz;
-      for (int p = Bp[j] ; p<Bp[j+1] ; ++p) {
-        nz = scatter(Bi[p], w, j+1, &C_row.front(), nz);
+    }
+    for (int j=0; j<n; ++j) C_colind[j+1] += C_colind[j];
+
+    // Collect the rows of each column of the result (marker: -2-j), sort if needed
+    vector<int> C_row(C_colind.back());
+#ifdef WITH_OPENMP
+#pragma omp parallel for if (nblock>1)
+#endif // WITH_OPENMP
+    for (int b=0; b<nblock; ++b) {
+      int* mark = getPtr(w) + static_cast<size_t>(m)*b;
+      int j_end = static_cast<int>(static_cast<long>(n)*(b+1)/nblock);
+      for (int j=static_cast<int>(static_cast<long>(n)*b/nblock); j<j_end; ++j) {
+        int* C = getPtr(C_row) + C_colind[j];
+        int nz = 0;
+        bool sorted = true;
+        for (int kk=B_colind[j]; kk<B_colind[j+1]; ++kk) {
+          int r = B_row[kk];
+          for (int k=colind[r]; k<colind[r+1]; ++k) {
+            int i = row[k];
+            if (mark[i]!=-2-j) {
+              mark[i] = -2-j;
+              if (nz>0 && C[nz-1]>i) sorted = false;
+              C[nz++] = i;
+            }
+          }
+        }
+        if (!sorted) std::sort(C, C+nz);
       }
     }
 
-    // finalize the last row of C
-    Cp[n] = nz;
-    C_row.resize(nz);
-
-    // Success
     return Sparsity(m, n, C_colind, C_row);
   }
 
@@ -1912,39 +1956,8 @@ namespace casadi {
     // Quick return if second factor is diagonal
     if (y.isdiag()) return shared_from_this<Sparsity>();
 
-    // Direct access to the vectors
-    const int* x_row = row();
-    const int* x_colind = colind();
-    const int* y_row = y.row();
-    const int* y_colind = y.colind();
-
-    // Sparsity pattern of the result
-    vector<int> row, col;
-
-    // Temporary vector for avoiding duplicate nonzeros
-    vector<int> tmp(d1, -1);
-
-    // Loop over the nonzeros of y
-    for (int cc=0; cc<d2; ++cc) {
-      for (int kk=y_colind[cc]; kk<y_colind[cc+1]; ++kk) {
-        int rr = y_row[kk];
-
-        // Loop over corresponding columns of x
-        for (int kk1=x_colind[rr]; kk1<x_colind[rr+1]; ++kk1) {
-          int rr1 = x_row[kk1];
-
-          // Add to pattern if not already encountered
-          if (tmp[rr1]!=cc) {
-            tmp[rr1] = cc;
-            row.push_back(rr1);
-            col.push_back(cc);
-          }
-        }
-      }
-    }
-
-    // Assemble sparsity pattern and return
-    return Sparsity::triplet(d1, d2, row, col);
+    // General case
+    return multiply(y);
   }
 
   bool SparsityInternal::isscalar(bool scalar_and_dense) const {
@@ -2216,7 +2229,7 @@ namespace casadi {
           int j=ret_row[el];
 
           // Continue to the next row to skip
-          for (; je!=rr.end() && *je<j; ++je) {}
+          je = lower_bound(je, rr.end(), j);
 
           // Remove row if necessary
           if (je!=rr.end() && *je==j) {
@@ -2331,6 +2344,7 @@ namespace casadi {
 
     // Construct new pattern of the corresponding elements
     vector<int> ret_colind(sp.size2()+1), ret_row;
+    ret_row.reserve(sp.nnz());
     ret_colind[0] = 0;
     const int* sp_colind = sp.colind();
     const int* sp_row = sp.row();
@@ -2484,7 +2498,7 @@ namespace casadi {
 
   Sparsity SparsityInternal::patternCombine(const Sparsity& y, bool f0x_is_zero,
                                             bool function0_is_zero) const {
-    static vector<unsigned char> mapping;
+    vector<unsigned char> mapping;
     return patternCombineGen1<false>(y, f0x_is_zero, function0_is_zero, mapping);
   }
 
@@ -2534,12 +2548,14 @@ namespace casadi {
     const int* colind = this->colind();
     const int* row = this->row();
 
-    // Sparsity pattern of the result
+    // Sparsity pattern of the result, allocated for the nonzeros of both patterns
     vector<int> ret_colind(size2()+1, 0);
-    vector<int> ret_row;
+    vector<int> ret_row(nnz()+y.nnz());
+    int* r = getPtr(ret_row);
 
-    // Clear the mapping
-    if (with_mapping) mapping.clear();
+    // One entry in the mapping for each nonzero of either pattern
+    if (with_mapping) mapping.resize(nnz()+y.nnz());
+    unsigned char* m = getPtr(mapping);
 
     // Loop over columns of both patterns
     for (int i=0; i<size2(); ++i) {
@@ -2551,40 +2567,67 @@ namespace casadi {
       int el1_last = colind[i+1];
       int el2_last = y_colind[i+1];
 
-      // Loop over the non-zeros of both matrices
-      while (el1<el1_last || el2<el2_last) {
-        // Get the rows
-        int row1 = el1<el1_last ? row[el1] : size1();
-        int row2 = el2<el2_last ? y_row[el2] : size1();
-
-        // Add to the return matrix
-        if (row1==row2) { //  both nonzero
-          ret_row.push_back(row1);
-          if (with_mapping) mapping.push_back( 1 | 2);
-          el1++; el2++;
-        } else if (row1<row2) { //  only first argument is nonzero
-          if (!function0_is_zero) {
-            ret_row.push_back(row1);
-            if (with_mapping) mapping.push_back(1);
-          } else {
-            if (with_mapping) mapping.push_back(1 | 4);
-          }
-          el1++;
-        } else { //  only second argument is nonzero
-          if (!f0x_is_zero) {
-            ret_row.push_back(row2);
-            if (with_mapping) mapping.push_back(2);
-          } else {
-            if (with_mapping) mapping.push_back(2 | 4);
+      if (el1_last-el1==el2_last-el2 && equal(row+el1, row+el1_last, y_row+el2)) {
+        // Same rows
+        r = copy(row+el1, row+el1_last, r);
+        if (with_mapping) {
+          fill_n(m, el1_last-el1, 1 | 2);
+          m += el1_last-el1;
+        }
+      } else if (el2==el2_last) {
+        // Only first argument has nonzeros
+        if (!function0_is_zero) r = copy(row+el1, row+el1_last, r);
+        if (with_mapping) {
+          fill_n(m, el1_last-el1, function0_is_zero ? 1 | 4 : 1);
+          m += el1_last-el1;
+        }
+      } else if (el1==el1_last) {
+        // Only second argument has nonzeros
+        if (!f0x_is_zero) r = copy(y_row+el2, y_row+el2_last, r);
+        if (with_mapping) {
+          fill_n(m, el2_last-el2, f0x_is_zero ? 2 | 4 : 2);
+          m += el2_last-el2;
+        }
+      } else {
+        // Merge the sorted rows
+        while (el1<el1_last || el2<el2_last) {
+          // Get the rows
+          int row1 = el1<el1_last ? row[el1] : size1();
+          int row2 = el2<el2_last ? y_row[el2] : size1();
+
+          // Add to the return matrix
+          if (row1==row2) { //  both nonzero
+            *r++ = row1;
+            if (with_mapping) *m++ = 1 | 2;
+            el1++; el2++;
+          } else if (row1<row2) { //  only first argument is nonzero
+            if (!function0_is_zero) {
+              *r++ = row1;
+              if (with_mapping) *m++ = 1;
+            } else {
+              if (with_mapping) *m++ = 1 | 4;
+            }
+            el1++;
+          } else { //  only second argument is nonzero
+            if (!f0x_is_zero) {
+              *r++ = row2;
+              if (with_mapping) *m++ = 2;
+            } else {
+              if (with_mapping) *m++ = 2 | 4;
+            }
+            el2++;
           }
-          el2++;
         }
       }
 
       // Save the index of the last nonzero on the col
-      ret_colind[i+1] = ret_row.size();
+      ret_colind[i+1] = r - getPtr(ret_row);
     }
 
+    // Remove the unused entries
+    ret_row.resize(ret_colind.back());
+    if (with_mapping) mapping.resize(m - getPtr(mapping));
+
     // Return cached object
     return Sparsity(size1(), size2(), ret_colind, ret_row);
   }
@@ -3057,67 +3100,141 @@ namespace casadi {
     fill(it, indices.end(), -1);
   }
 
-  Sparsity SparsityInternal::unidirectionalColoring(const Sparsity& AT, int cutoff) const {
+  /// Smallest color not used by any previously colored distance-2 neighbor of column i
+  static int firstAvailableColor(int i, const int* colind, const int* row,
+                                 const int* AT_colind, const int* AT_row, const int* color,
+                                 std::vector<int>& forbidden, int stamp, bool previous_only) {
+    // Loop over nonzero elements
+    for (int el=colind[i]; el<colind[i+1]; ++el) {
 
-    // Allocate temporary vectors
-    vector<int> forbiddenColors;
-    forbiddenColors.reserve(size2());
-    vector<int> color(size2(), 0);
+      // Get row
+      int r = row[el];
 
-    // Access the sparsity of the transpose
-    const int* AT_colind = AT.colind();
-    const int* AT_row = AT.row();
-    const int* colind = this->colind();
-    const int* row = this->row();
+      // Loop over other columns that have an element in row r
+      for (int el_prev=AT_colind[r]; el_prev<AT_colind[r+1]; ++el_prev) {
 
-    // Loop over columns
-    for (int i=0; i<size2(); ++i) {
+        // Get the column
+        int j = AT_row[el_prev];
 
-      // Loop over nonzero elements
-      for (int el=colind[i]; el<colind[i+1]; ++el) {
+        // Escape loop if we have arrived at the current column (natural ordering)
+        if (previous_only && j>=i) break;
 
-        // Get row
-        int c = row[el];
+        // Mark the color of the column, if any, as forbidden for column i
+        int color_j = color[j];
+        if (color_j<0 || j==i) continue;
+        if (color_j>=forbidden.size()) forbidden.resize(color_j+1, -1);
+        forbidden[color_j] = stamp;
+      }
+    }
 
-        // Loop over previous columns that have an element in row c
-        for (int el_prev=AT_colind[c]; el_prev<AT_colind[c+1]; ++el_prev) {
+    // Get the first nonforbidden color
+    int color_i = 0;
+    while (color_i<forbidden.size() && forbidden[color_i]==stamp) color_i++;
+    return color_i;
+  }
 
-          // Get the col
-          int i_prev = AT_row[el_prev];
+  /// Does column i share a color with a distance-2 neighbor that is earlier in the ordering
+  static bool hasColorConflict(int i, const int* colind, const int* row,
+                               const int* AT_colind, const int* AT_row, const int* color,
+                               const int* pos) {
+    for (int el=colind[i]; el<colind[i+1]; ++el) {
+      int r = row[el];
+      for (int el_prev=AT_colind[r]; el_prev<AT_colind[r+1]; ++el_prev) {
+        int j = AT_row[el_prev];
+        if (j!=i && color[j]==color[i] && pos[j]<pos[i]) return true;
+      }
+    }
+    return false;
+  }
 
-          // Escape loop if we have arrived at the current col
-          if (i_prev>=i)
-            break;
+  Sparsity SparsityInternal::unidirectionalColoring(const Sparsity& AT, int cutoff,
+                                                    int ordering) const {
 
-          // Get the color of the col
-          int color_prev = color[i_prev];
+    // Access the sparsity of the transpose
+    const int* AT_colind = AT.colind();
+    const int* AT_row = AT.row();
+    const int* colind = this->colind();
+    const int* row = this->row();
 
-          // Mark the color as forbidden for the current col
-          forbiddenColors[color_prev] = i;
-        }
-      }
+    // Order in which the columns are colored
+    vector<int> ord = coloringOrdering(ordering, AT);
+    bool natural = ord.empty();
+    if (natural) ord = range(size2());
 
-      // Get the first nonforbidden color
-      int color_i;
-      for (color_i=0; color_i<forbiddenColors.size(); ++color_i) {
-        // Break if color is ok
-        if (forbiddenColors[color_i]!=i) break;
+    // Number of threads for the speculative coloring
+    int nthreads = 1;
+#ifdef WITH_OPENMP
+    if (size2()>=COLORING_PARALLEL_MIN) nthreads = omp_get_max_threads();
+#endif // WITH_OPENMP
+
+    // Color of each column, -1 if not yet colored
+    vector<int> color(size2(), -1);
+    int num_colors = 0;
+
+    if (nthreads==1) {
+      // Greedy coloring, distance-2 neighbors colored before forbid their colors
+      vector<int> forbiddenColors;
+      forbiddenColors.reserve(size2());
+      for (int k=0; k<ord.size(); ++k) {
+        int i = ord[k];
+        color[i] = firstAvailableColor(i, colind, row, AT_colind, AT_row, getPtr(color),
+                                       forbiddenColors, k, natural);
+
+        // Add color if reached end, cutoff if too many colors
+        if (color[i]==num_colors) {
+          if (++num_colors>cutoff) return Sparsity();
+        }
       }
-      color[i] = color_i;
+    } else {
+#ifdef WITH_OPENMP
+      // Speculative coloring (Gebremedhin and Manne): the columns are colored in parallel,
+      // conflicts are detected in parallel and the later column of each conflict is
+      // colored again in the next round
+      vector<int> pos(size2());
+      for (int k=0; k<ord.size(); ++k) pos[ord[k]] = k;
+      vector<vector<int> > forbidden(nthreads);
+      vector<int> stamp(nthreads, 0);
+      vector<char> conflict(size2(), 0);
+
+      // Columns to be colored in the current round
+      vector<int>& U = ord;
+      while (!U.empty()) {
+        int nU = U.size();
+
+        // Tentative coloring
+#pragma omp parallel for num_threads(nthreads) schedule(static)
+        for (int k=0; k<nU; ++k) {
+          int t = omp_get_thread_num();
+          color[U[k]] = firstAvailableColor(U[k], colind, row, AT_colind, AT_row,
+                                            getPtr(color), forbidden[t], stamp[t]++, false);
+        }
 
-      // Add color if reached end
-      if (color_i==forbiddenColors.size()) {
-        forbiddenColors.push_back(0);
+        // Detect conflicts
+#pragma omp parallel for num_threads(nthreads) schedule(static)
+        for (int k=0; k<nU; ++k) {
+          conflict[U[k]] = hasColorConflict(U[k], colind, row, AT_colind, AT_row,
+                                            getPtr(color), getPtr(pos));
+        }
 
-        // Cutoff if too many colors
-        if (forbiddenColors.size()>cutoff) {
-          return Sparsity();
+        // Columns in conflict, still in coloring order
+        int nconflict = 0;
+        for (int k=0; k<nU; ++k) {
+          if (conflict[U[k]]) {
+            conflict[U[k]] = 0;
+            U[nconflict++] = U[k];
+          }
         }
+        U.resize(nconflict);
       }
+
+      // Number of colors used, cutoff if too many
+      for (int i=0; i<size2(); ++i) num_colors = max(num_colors, color[i]+1);
+      if (num_colors>cutoff) return Sparsity();
+#endif // WITH_OPENMP
     }
 
     // Create return sparsity containing the coloring
-    vector<int> ret_colind(forbiddenColors.size()+1, 0), ret_row;
+    vector<int> ret_colind(num_colors+1, 0), ret_row;
 
     // Get the number of rows for each col
     for (int i=0; i<color.size(); ++i) {
@@ -3125,7 +3242,7 @@ namespace casadi {
     }
 
     // Cumsum
-    for (int j=0; j<forbiddenColors.size(); ++j) {
+    for (int j=0; j<num_colors; ++j) {
       ret_colind[j+1] += ret_colind[j];
     }
 
@@ -3142,8 +3259,120 @@ namespace casadi {
     ret_colind[0] = 0;
 
     // Return the coloring
-    return Sparsity(size2(), forbiddenColors.size(), ret_colind, ret_row);
-;
+    return Sparsity(size2(), num_colors, ret_colind, ret_row);
+  }
+
+  /// Keep the rows r of a pattern for which keep[r] equals val
+  static Sparsity keepRows(const Sparsity& A, const std::vector<char>& keep, char val) {
+    const int* colind = A.colind();
+    const int* row = A.row();
+    vector<int> ret_colind(A.size2()+1, 0), ret_row;
+    ret_row.reserve(A.nnz());
+    for (int c=0; c<A.size2(); ++c) {
+      for (int el=colind[c]; el<colind[c+1]; ++el) {
+        if (keep[row[el]]==val) ret_row.push_back(row[el]);
+      }
+      ret_colind[c+1] = ret_row.size();
+    }
+    return Sparsity(A.size1(), A.size2(), ret_colind, ret_row);
+  }
+
+  /// Remove the colors without any columns from a coloring
+  static Sparsity removeEmptyColors(const Sparsity& D) {
+    vector<int> nonempty;
+    for (int c=0; c<D.size2(); ++c) {
+      if (D.colind(c+1)>D.colind(c)) nonempty.push_back(c);
+    }
+    if (nonempty.size()==D.size2()) return D;
+    vector<int> mapping;
+    return D.sub(range(D.size1()), nonempty, mapping);
+  }
+
+  /// Largest number of colors with a weighted cost below a bound
+  static int coloringCutoff(double bound, double weight) {
+    if (weight<=0 || bound>=weight*std::numeric_limits<int>::max()) {
+      return std::numeric_limits<int>::max();
+    }
+    return static_cast<int>(floor(bound/weight));
+  }
+
+  /** \brief Bidirectional partitions with the densest rows in adjoint mode
+   * The k densest rows, for k = 1, 2, 4, ..., are colored in adjoint mode and the
+   * remaining rows in forward mode. D1 and D2 are updated if the weighted number of
+   * directions is lower than best.
+   */
+  static void splitColoring(const Sparsity& A, const Sparsity& AT, double w, int ordering,
+                            double& best, Sparsity& D1, Sparsity& D2) {
+    // Rows ordered by decreasing number of nonzeros
+    vector<int> rows = AT.largestFirstOrdering();
+    const int* AT_colind = AT.colind();
+
+    // Rows treated in adjoint mode
+    vector<char> adj(A.size1(), 0);
+    int nadj = 0;
+    for (int k=1; k<=A.size1()/2; k*=2) {
+      // Only rows with more than one nonzero can reduce the number of forward directions
+      int r = rows[k-1];
+      if (AT_colind[r+1]-AT_colind[r]<2) break;
+
+      // Skip if the densest remaining row already rules out an improvement
+      if (k<rows.size()) {
+        int r_next = rows[k];
+        if (w*(AT_colind[r_next+1]-AT_colind[r_next]) + (1-w) >= best) continue;
+      }
+      for (; nadj<k; ++nadj) adj[rows[nadj]] = 1;
+
+      // Adjoint mode coloring of the dense rows
+      Sparsity Aa = keepRows(A, adj, 1);
+      Sparsity Da = Aa.T().unidirectionalColoring(Aa, coloringCutoff(best, 1-w), ordering);
+      if (Da.isNull()) break;
+      Da = removeEmptyColors(keepRows(Da, adj, 1));
+      double cost_adj = (1-w)*Da.size2();
+
+      // Forward mode coloring of the remaining rows
+      Sparsity Af = keepRows(A, adj, 0);
+      Sparsity Df = Af.unidirectionalColoring(Af.T(), coloringCutoff(best-cost_adj, w),
+                                              ordering);
+      if (Df.isNull()) continue;
+
+      // Columns without nonzeros in the remaining rows are not seeded
+      vector<char> nonempty(A.size2(), 0);
+      for (int c=0; c<A.size2(); ++c) nonempty[c] = Af.colind(c+1)>Af.colind(c);
+      Df = removeEmptyColors(keepRows(Df, nonempty, 1));
+
+      // Keep if better
+      double cost = w*Df.size2() + cost_adj;
+      if (cost<best) {
+        best = cost;
+        D1 = Df;
+        D2 = Da;
+      }
+    }
+  }
+
+  void SparsityInternal::bidirectionalColoring(const Sparsity& AT, double w, int ordering,
+                                               Sparsity& D1, Sparsity& D2) const {
+    casadi_assert_message(w>=0 && w<=1, "Weighting factor must be in [0, 1], got " << w);
+    Sparsity A = shared_from_this<Sparsity>();
+
+    // Forward mode
+    D1 = unidirectionalColoring(AT, std::numeric_limits<int>::max(), ordering);
+    D2 = Sparsity();
+    double best = w*D1.size2();
+
+    // Adjoint mode
+    Sparsity Dadj = AT.unidirectionalColoring(A, coloringCutoff(best, 1-w), ordering);
+    if (!Dadj.isNull() && (1-w)*Dadj.size2()<best) {
+      D1 = Sparsity();
+      D2 = Dadj;
+      best = (1-w)*Dadj.size2();
+    }
+
+    // Dense rows in adjoint mode, the remaining rows in forward mode
+    splitColoring(A, AT, w, ordering, best, D1, D2);
+
+    // Dense columns in forward mode, the remaining columns in adjoint mode
+    splitColoring(AT, A, 1-w, ordering, best, D2, D1);
   }
 
   Sparsity SparsityInternal::starColoring2(int ordering, int cutoff) const {
@@ -3151,15 +3380,12 @@ namespace casadi {
                           "StarColoring requires a square matrix, but got "
                           << dimString() << ".");
 
-    // TODO(Joel): What we need here, is a distance-2 smallest last ordering
     // Reorder, if necessary
     const int* colind = this->colind();
     const int* row = this->row();
     if (ordering!=0) {
-      casadi_assert(ordering==1);
-
-      // Ordering
-      vector<int> ord = largestFirstOrdering();
+      // Ordering, the matrix is its own transpose
+      vector<int> ord = coloringOrdering(ordering, shared_from_this<Sparsity>());
 
       // Create a new sparsity pattern
       Sparsity sp_permuted = pmult(ord, true, true, true);
@@ -3443,10 +3669,8 @@ namespace casadi {
                           << dimString() << ".");
     // Reorder, if necessary
     if (ordering!=0) {
-      casadi_assert(ordering==1);
-
-      // Ordering
-      vector<int> ord = largestFirstOrdering();
+      // Ordering, the matrix is its own transpose
+      vector<int> ord = coloringOrdering(ordering, shared_from_this<Sparsity>());
 
       // Create a new sparsity pattern
       Sparsity sp_permuted = pmult(ord, true, true, true);
@@ -3583,6 +3807,117 @@ namespace casadi {
     return reverse_ordering;
   }
 
+  std::vector<int> SparsityInternal::coloringOrdering(int ordering, const Sparsity& AT) const {
+    switch (ordering) {
+    case 0: return std::vector<int>();
+    case 1: return largestFirstOrdering();
+    case 2: return smallestLastOrdering(AT);
+    case 3: return incidenceDegreeOrdering(AT);
+    default: casadi_error("Unknown ordering " << ordering << ", expected 0 (none), "
+                          "1 (largest first), 2 (smallest last) or 3 (incidence degree)");
+    }
+    return std::vector<int>();
+  }
+
+  /// Insert vertex v at the front of the bucket list for degree d
+  static inline void bucketInsert(int v, int d, int* head, int* next, int* prev) {
+    prev[v] = -1;
+    next[v] = head[d];
+    if (head[d]>=0) prev[head[d]] = v;
+    head[d] = v;
+  }
+
+  /// Remove vertex v from the bucket list for degree d
+  static inline void bucketRemove(int v, int d, int* head, int* next, int* prev) {
+    if (prev[v]>=0) {
+      next[prev[v]] = next[v];
+    } else {
+      head[d] = next[v];
+    }
+    if (next[v]>=0) prev[next[v]] = prev[v];
+  }
+
+  std::vector<int> SparsityInternal::dynamicDegreeOrdering(const Sparsity& AT,
+                                                           bool smallest_last) const {
+    const int* colind = this->colind();
+    const int* row = this->row();
+    const int* AT_colind = AT.colind();
+    const int* AT_row = AT.row();
+    int n = size2();
+
+    // Marker for the distance-2 neighbors of a column
+    vector<int> mark(n, -1);
+
+    // Smallest last: degree in the column intersection graph,
+    // incidence degree: number of neighbors already ordered
+    vector<int> degree(n, 0);
+    if (smallest_last) {
+      for (int i=0; i<n; ++i) {
+        mark[i] = i;
+        for (int el=colind[i]; el<colind[i+1]; ++el) {
+          int r = row[el];
+          for (int el2=AT_colind[r]; el2<AT_colind[r+1]; ++el2) {
+            int j = AT_row[el2];
+            if (mark[j]!=i) {
+              mark[j] = i;
+              degree[i]++;
+            }
+          }
+        }
+      }
+      fill(mark.begin(), mark.end(), -1);
+    }
+
+    // Columns bucketed by degree, ties resolved by column index
+    vector<int> head(n+1, -1), next(n), prev(n);
+    for (int i=n-1; i>=0; --i) {
+      bucketInsert(i, degree[i], getPtr(head), getPtr(next), getPtr(prev));
+    }
+
+    // Columns already ordered
+    vector<char> ordered(n, 0);
+
+    // Smallest last: repeatedly remove a column of minimal degree and place it last,
+    // incidence degree: repeatedly take a column with the most ordered neighbors
+    vector<int> ord(n);
+    int d = 0;
+    for (int k=0; k<n; ++k) {
+      if (smallest_last) {
+        while (head[d]<0) d++;
+      } else {
+        while (head[d]<0) d--;
+      }
+      int v = head[d];
+      bucketRemove(v, d, getPtr(head), getPtr(next), getPtr(prev));
+      ordered[v] = 1;
+      ord[smallest_last ? n-1-k : k] = v;
+
+      // Update the degrees of the distance-2 neighbors
+      mark[v] = v;
+      for (int el=colind[v]; el<colind[v+1]; ++el) {
+        int r = row[el];
+        for (int el2=AT_colind[r]; el2<AT_colind[r+1]; ++el2) {
+          int j = AT_row[el2];
+          if (ordered[j] || mark[j]==v) continue;
+          mark[j] = v;
+          bucketRemove(j, degree[j], getPtr(head), getPtr(next), getPtr(prev));
+          degree[j] += smallest_last ? -1 : 1;
+          bucketInsert(j, degree[j], getPtr(head), getPtr(next), getPtr(prev));
+          d = smallest_last ? min(d, degree[j]) : max(d, degree[j]);
+        }
+      }
+    }
+    return ord;
+  }
+
+  std::vector<int> SparsityInternal::smallestLastOrdering(const Sparsity& AT) const {
+    return dynamicDegreeOrdering(AT, true);
+  }
+
+  std::vector<int> SparsityInternal::incidenceDegreeOrdering(const Sparsity& AT) const {
+    return dynamicDegreeOrdering(AT, false);
+  }
+
   Sparsity SparsityInternal::pmult(const std::vector<int>& p, bool permute_rows,
                                    bool permute_columns, bool invert_permutation) const {
     // Invert p, possibly
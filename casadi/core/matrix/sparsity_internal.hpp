@@ -44,7 +44,7 @@ namespace casadi {
   public:
     /// Construct a sparsity pattern from arrays
     SparsityInternal(int nrow, int ncol, const int* colind, const int* row) :
-      sp_(2 + ncol+1 + colind[ncol]) {
+      sp_(2 + ncol+1 + colind[ncol]), cache_shard_(-1) {
       sp_[0] = nrow;
       sp_[1] = ncol;
       std::copy(colind, colind+ncol+1, sp_.begin()+2);
@@ -52,6 +52,16 @@ namespace casadi {
       sanityCheck(false);
     }
 
+    /// Copy constructor, the copy is not cached
+    SparsityInternal(const SparsityInternal& x) :
+      SharedObjectNode(x), sp_(x.sp_), cache_shard_(-1) {}
+
+    /// Destructor, invalidates the weak reference held by the cache
+    virtual ~SparsityInternal();
+
+    /// Part of the cache of sparsity patterns referring to the pattern, -1 if not cached
+    int cache_shard_;
+
     /** \brief Get number of rows (see public class) */
     inline const std::vector<int>& sp() const { return sp_;}
 
@@ -212,14 +222,9 @@ namespace casadi {
     /// keep off-diagonal entries; drop diagonal entries: See cs_diag in CSparse
     static int diag(int i, int j, double aij, void *other);
 
-    /// C = A*B: See cs_multiply in CSparse
+    /// C = A*B: See cs_multiply in CSparse, two passes and sorted rows
     Sparsity multiply(const Sparsity& B) const;
 
-    /** x = x + beta * A(:, j), where x is a dense vector and A(:, j) is sparse:
-     * See cs_scatter in CSparse
-     */
-    int scatter(int j, std::vector<int>& w, int mark, int* Ci, int nz) const;
-
     /// Get row() as a vector
     std::vector<int> getRow() const;
 
@@ -414,7 +419,14 @@ namespace casadi {
      * A greedy distance-2 coloring algorithm
      * (Algorithm 3.1 in A. H. GEBREMEDHIN, F. MANNE, A. POTHEN)
      */
-    Sparsity unidirectionalColoring(const Sparsity& AT, int cutoff) const;
+    Sparsity unidirectionalColoring(const Sparsity& AT, int cutoff, int ordering=0) const;
+
+    /** \brief Perform a bidirectional coloring
+     *
+     * Dense rows (columns) are colored in adjoint (forward) mode, the rest in the other mode
+     */
+    void bidirectionalColoring(const Sparsity& AT, double w, int ordering,
+                               Sparsity& D1, Sparsity& D2) const;
 
     /** \brief Perform a star coloring
      *
@@ -437,6 +449,18 @@ namespace casadi {
     /// Order the columns by decreasing degree
     std::vector<int> largestFirstOrdering() const;
 
+    /// Smallest last ordering of the columns, distance-2 neighbors given by the transpose
+    std::vector<int> smallestLastOrdering(const Sparsity& AT) const;
+
+    /// Incidence degree ordering of the columns, distance-2 neighbors given by the transpose
+    std::vector<int> incidenceDegreeOrdering(const Sparsity& AT) const;
+
+    /// Coloring order: none (0), largest first (1), smallest last (2), incidence degree (3)
+    std::vector<int> coloringOrdering(int ordering, const Sparsity& AT) const;
+
+    /// Smallest last or incidence degree ordering
+    std::vector<int> dynamicDegreeOrdering(const Sparsity& AT, bool smallest_last) const;
+
     /// Permute rows and/or columns
     Sparsity pmult(const std::vector<int>& p, bool permute_rows=true, bool permute_cols=true,
                    bool invert_permutation=false) const;
@@ -28,6 +28,7 @@
 #include <map>
 #include <string>
 #include <sstream>
+#include <fstream>
 #include <ctime>
 #include <cctype>
 
@@ -37,7 +38,7 @@
 #include "../function/integrator.hpp"
 #include "../function/code_generator.hpp"
 #include "../casadi_calculus.hpp"
-#include "xml_file.hpp"
+#include "xml_reader.hpp"
 
 using namespace std;
 namespace casadi {
@@ -54,292 +55,278 @@ namespace casadi {
     return s.str();
   }
 
+  /// FNV-1a hash of a variable name
+  static size_t hashName(const std::string& name) {
+    size_t h = 2166136261u;
+    for (string::const_iterator c=name.begin(); c!=name.end(); ++c) {
+      h = (h ^ static_cast<unsigned char>(*c)) * 16777619u;
+    }
+    return h;
+  }
+
   DaeBuilder::DaeBuilder() {
     this->t = MX::sym("t");
   }
 
   void DaeBuilder::parseFMI(const std::string& filename) {
 
-    // Load
-    XmlFile xml_file("tinyxml");
-    XmlNode document = xml_file.parse(filename);
-
-    // **** Add model variables ****
-    {
-      //if (verbose) userOut() << "Adding model variables." << endl;
-
-      // Get a reference to the ModelVariables node
-      const XmlNode& modvars = document[0]["ModelVariables"];
-
-      // Add variables
-      for (int i=0; i<modvars.size(); ++i) {
-
-        // Get a reference to the variable
-        const XmlNode& vnode = modvars[i];
-
-        // Get the attributes
-        string name        = vnode.getAttribute("name");
-        int valueReference;
-        vnode.readAttribute("valueReference", valueReference);
-        string variability = vnode.getAttribute("variability");
-        string causality   = vnode.getAttribute("causality");
-        string alias       = vnode.getAttribute("alias");
-
-        // Skip to the next variable if its an alias
-        if (alias.compare("alias") == 0 || alias.compare("negatedAlias") == 0)
-          continue;
-
-        // Get the name
-        const XmlNode& nn = vnode["QualifiedName"];
-        string qn = qualifiedName(nn);
-
-        // Add variable, if not already added
-        if (varmap_.find(qn)==varmap_.end()) {
-
-          // Create variable
-          Variable var(name);
-
-          // Value reference
-          var.valueReference = valueReference;
-
-          // Variability
-          if (variability.compare("constant")==0)
-            var.variability = CONSTANT;
-          else if (variability.compare("parameter")==0)
-            var.variability = PARAMETER;
-          else if (variability.compare("discrete")==0)
-            var.variability = DISCRETE;
-          else if (variability.compare("continuous")==0)
-            var.variability = CONTINUOUS;
-          else
-            throw CasadiException("Unknown variability");
-
-          // Causality
-          if (causality.compare("input")==0)
-            var.causality = INPUT;
-          else if (causality.compare("output")==0)
-            var.causality = OUTPUT;
-          else if (causality.compare("internal")==0)
-            var.causality = INTERNAL;
-          else
-            throw CasadiException("Unknown causality");
-
-          // Alias
-          if (alias.compare("noAlias")==0)
-            var.alias = NO_ALIAS;
-          else if (alias.compare("alias")==0)
-            var.alias = ALIAS;
-          else if (alias.compare("negatedAlias")==0)
-            var.alias = NEGATED_ALIAS;
-          else
-            throw CasadiException("Unknown alias");
-
-          // Other properties
-          if (vnode.hasChild("Real")) {
-            const XmlNode& props = vnode["Real"];
-            props.readAttribute("unit", var.unit, false);
-            props.readAttribute("displayUnit", var.displayUnit, false);
-            props.readAttribute("min", var.min, false);
-            props.readAttribute("max", var.max, false);
-            props.readAttribute("initialGuess", var.initialGuess, false);
-            props.readAttribute("start", var.start, false);
-            props.readAttribute("nominal", var.nominal, false);
-            props.readAttribute("free", var.free, false);
-          }
-
-          // Variable category
-          if (vnode.hasChild("VariableCategory")) {
-            string cat = vnode["VariableCategory"].getText();
-            if (cat.compare("derivative")==0)
-              var.category = CAT_DERIVATIVE;
-            else if (cat.compare("state")==0)
-              var.category = CAT_STATE;
-            else if (cat.compare("dependentConstant")==0)
-              var.category = CAT_DEPENDENT_CONSTANT;
-            else if (cat.compare("independentConstant")==0)
-              var.category = CAT_INDEPENDENT_CONSTANT;
-            else if (cat.compare("dependentParameter")==0)
-              var.category = CAT_DEPENDENT_PARAMETER;
-            else if (cat.compare("independentParameter")==0)
-              var.category = CAT_INDEPENDENT_PARAMETER;
-            else if (cat.compare("algebraic")==0)
-              var.category = CAT_ALGEBRAIC;
-            else
-              throw CasadiException("Unknown variable category: " + cat);
-          }
-
-          // Add to list of variables
-          addVariable(qn, var);
-
-          // Sort expression
-          switch (var.category) {
-          case CAT_DERIVATIVE:
-            // Skip - meta information about time derivatives is
-            //        kept together with its parent variable
-            break;
-          case CAT_STATE:
-            this->s.push_back(var.v);
-            this->sdot.push_back(var.d);
-            break;
-          case CAT_DEPENDENT_CONSTANT:
-            // Skip
-            break;
-          case CAT_INDEPENDENT_CONSTANT:
-            // Skip
-            break;
-          case CAT_DEPENDENT_PARAMETER:
-            // Skip
-            break;
-          case CAT_INDEPENDENT_PARAMETER:
-            if (var.free) {
-              this->p.push_back(var.v);
-            } else {
-              // Skip
-            }
-            break;
-          case CAT_ALGEBRAIC:
-            if (var.causality == INTERNAL) {
-              this->s.push_back(var.v);
-              this->sdot.push_back(var.d);
-            } else if (var.causality == INPUT) {
-              this->u.push_back(var.v);
-            }
-            break;
-          default:
-            casadi_error("Unknown category");
-          }
+    // Open the file, it is read element by element without building the document tree
+    ifstream file(filename.c_str());
+    casadi_assert_message(file.good(), "DaeBuilder::parseFMI: Could not open " << filename);
+    XmlReader reader(file);
+
+    // Enter the root element
+    casadi_assert_message(reader.nextChild(), "DaeBuilder::parseFMI: No root element in "
+                          << filename);
+
+    // Sections that refer to variables, but appear before ModelVariables
+    vector<XmlNode> deferred;
+    bool has_modvars = false;
+
+    // Loop over the sections
+    while (reader.nextChild()) {
+      const string& section = reader.name();
+      if (section=="ModelVariables") {
+        // **** Add model variables ****
+        while (reader.nextChild()) readModelVariable(reader.readNode());
+        has_modvars = true;
+      } else if (section=="equ:BindingEquations" || section=="equ:DynamicEquations"
+                 || section=="equ:InitialEquations" || section=="opt:Optimization") {
+        // **** Add equations and optimization ****
+        if (has_modvars) {
+          while (reader.nextChild()) readSectionNode(section, reader.readNode());
+        } else {
+          deferred.push_back(reader.readNode());
         }
+      } else {
+        reader.skip();
       }
     }
 
-    // **** Add binding equations ****
-    {
-      //if (verbose) userOut() << "Adding binding equations." << endl;
-
-      // Get a reference to the BindingEquations node
-      const XmlNode& bindeqs = document[0]["equ:BindingEquations"];
-
-      for (int i=0; i<bindeqs.size(); ++i) {
-        const XmlNode& beq = bindeqs[i];
-
-        // Get the variable and binding expression
-        Variable& var = readVariable(beq[0]);
-        MX bexpr = readExpr(beq[1][0]);
-        this->d.push_back(var.v);
-        this->ddef.push_back(bexpr);
-      }
+    // Add the sections that were read before the variables
+    for (vector<XmlNode>::const_iterator it=deferred.begin(); it!=deferred.end(); ++it) {
+      for (int i=0; i<it->size(); ++i) readSectionNode(it->getName(), (*it)[i]);
     }
 
-    // **** Add dynamic equations ****
-    {
-      // Get a reference to the DynamicEquations node
-      const XmlNode& dyneqs = document[0]["equ:DynamicEquations"];
-
-      // Add equations
-      for (int i=0; i<dyneqs.size(); ++i) {
-
-        // Get a reference to the variable
-        const XmlNode& dnode = dyneqs[i];
+    // Make sure that the dimensions are consistent at this point
+    casadi_assert_warning(this->s.size()==this->dae.size(),
+                          "The number of differential-algebraic equations does not match "
+                          "the number of implicitly defined states.");
+    casadi_assert_warning(this->z.size()==this->alg.size(),
+                          "The number of algebraic equations (equations not involving "
+                          "differentiated variables) does not match the number of "
+                          "algebraic variables.");
+  }
 
-        // Add the differential equation
-        MX de_new = readExpr(dnode[0]);
-        this->dae.push_back(de_new);
+  void DaeBuilder::readModelVariable(const XmlNode& vnode) {
+    // Get the attributes
+    string name        = vnode.getAttribute("name");
+    int valueReference;
+    vnode.readAttribute("valueReference", valueReference);
+    string variability = vnode.getAttribute("variability");
+    string causality   = vnode.getAttribute("causality");
+    string alias       = vnode.getAttribute("alias");
+
+    // Skip the variable if its an alias
+    if (alias.compare("alias") == 0 || alias.compare("negatedAlias") == 0)
+      return;
+
+    // Get the name
+    const XmlNode& nn = vnode["QualifiedName"];
+    string qn = qualifiedName(nn);
+
+    // Add variable, if not already added
+    if (findVariable(qn)==varmap_.end()) {
+
+      // Create variable
+      Variable var(name);
+
+      // Value reference
+      var.valueReference = valueReference;
+
+      // Variability
+      if (variability.compare("constant")==0)
+        var.variability = CONSTANT;
+      else if (variability.compare("parameter")==0)
+        var.variability = PARAMETER;
+      else if (variability.compare("discrete")==0)
+        var.variability = DISCRETE;
+      else if (variability.compare("continuous")==0)
+        var.variability = CONTINUOUS;
+      else
+        throw CasadiException("Unknown variability");
+
+      // Causality
+      if (causality.compare("input")==0)
+        var.causality = INPUT;
+      else if (causality.compare("output")==0)
+        var.causality = OUTPUT;
+      else if (causality.compare("internal")==0)
+        var.causality = INTERNAL;
+      else
+        throw CasadiException("Unknown causality");
+
+      // Alias
+      if (alias.compare("noAlias")==0)
+        var.alias = NO_ALIAS;
+      else if (alias.compare("alias")==0)
+        var.alias = ALIAS;
+      else if (alias.compare("negatedAlias")==0)
+        var.alias = NEGATED_ALIAS;
+      else
+        throw CasadiException("Unknown alias");
+
+      // Other properties
+      if (vnode.hasChild("Real")) {
+        const XmlNode& props = vnode["Real"];
+        props.readAttribute("unit", var.unit, false);
+        props.readAttribute("displayUnit", var.displayUnit, false);
+        props.readAttribute("min", var.min, false);
+        props.readAttribute("max", var.max, false);
+        props.readAttribute("initialGuess", var.initialGuess, false);
+        props.readAttribute("start", var.start, false);
+        props.readAttribute("nominal", var.nominal, false);
+        props.readAttribute("free", var.free, false);
       }
-    }
 
-    // **** Add initial equations ****
-    {
-      // Get a reference to the DynamicEquations node
-      const XmlNode& initeqs = document[0]["equ:InitialEquations"];
-
-      // Add equations
-      for (int i=0; i<initeqs.size(); ++i) {
-
-        // Get a reference to the node
-        const XmlNode& inode = initeqs[i];
+      // Variable category
+      if (vnode.hasChild("VariableCategory")) {
+        string cat = vnode["VariableCategory"].getText();
+        if (cat.compare("derivative")==0)
+          var.category = CAT_DERIVATIVE;
+        else if (cat.compare("state")==0)
+          var.category = CAT_STATE;
+        else if (cat.compare("dependentConstant")==0)
+          var.category = CAT_DEPENDENT_CONSTANT;
+        else if (cat.compare("independentConstant")==0)
+          var.category = CAT_INDEPENDENT_CONSTANT;
+        else if (cat.compare("dependentParameter")==0)
+          var.category = CAT_DEPENDENT_PARAMETER;
+        else if (cat.compare("independentParameter")==0)
+          var.category = CAT_INDEPENDENT_PARAMETER;
+        else if (cat.compare("algebraic")==0)
+          var.category = CAT_ALGEBRAIC;
+        else
+          throw CasadiException("Unknown variable category: " + cat);
+      }
 
-        // Add the differential equations
-        for (int i=0; i<inode.size(); ++i) {
-          this->init.push_back(readExpr(inode[i]));
+      // Add to list of variables
+      addVariable(qn, var);
+
+      // Sort expression
+      switch (var.category) {
+      case CAT_DERIVATIVE:
+        // Skip - meta information about time derivatives is
+        //        kept together with its parent variable
+        break;
+      case CAT_STATE:
+        this->s.push_back(var.v);
+        this->sdot.push_back(var.d);
+        break;
+      case CAT_DEPENDENT_CONSTANT:
+        // Skip
+        break;
+      case CAT_INDEPENDENT_CONSTANT:
+        // Skip
+        break;
+      case CAT_DEPENDENT_PARAMETER:
+        // Skip
+        break;
+      case CAT_INDEPENDENT_PARAMETER:
+        if (var.free) {
+          this->p.push_back(var.v);
+        } else {
+          // Skip
+        }
+        break;
+      case CAT_ALGEBRAIC:
+        if (var.causality == INTERNAL) {
+          this->s.push_back(var.v);
+          this->sdot.push_back(var.d);
+        } else if (var.causality == INPUT) {
+          this->u.push_back(var.v);
         }
+        break;
+      default:
+        casadi_error("Unknown category");
       }
     }
+  }
 
-    // **** Add optimization ****
-    if (document[0].hasChild("opt:Optimization")) {
-
-      // Get a reference to the DynamicEquations node
-      const XmlNode& opts = document[0]["opt:Optimization"];
-      for (int i=0; i<opts.size(); ++i) {
-
-        // Get a reference to the node
-        const XmlNode& onode = opts[i];
+  void DaeBuilder::readSectionNode(const std::string& section, const XmlNode& node) {
+    if (section=="equ:BindingEquations") {
+      // Get the variable and binding expression
+      Variable& var = readVariable(node[0]);
+      MX bexpr = readExpr(node[1][0]);
+      this->d.push_back(var.v);
+      this->ddef.push_back(bexpr);
+    } else if (section=="equ:DynamicEquations") {
+      // Add the differential equation
+      MX de_new = readExpr(node[0]);
+      this->dae.push_back(de_new);
+    } else if (section=="equ:InitialEquations") {
+      // Add the initial equations
+      for (int i=0; i<node.size(); ++i) {
+        this->init.push_back(readExpr(node[i]));
+      }
+    } else if (section=="opt:Optimization") {
+      const XmlNode& onode = node;
 
-        // Get the type
-        if (onode.checkName("opt:ObjectiveFunction")) { // mayer term
-          try {
-            // Add components
-            for (int i=0; i<onode.size(); ++i) {
-              const XmlNode& var = onode[i];
+      // Get the type
+      if (onode.checkName("opt:ObjectiveFunction")) { // mayer term
+        try {
+          // Add components
+          for (int i=0; i<onode.size(); ++i) {
+            const XmlNode& var = onode[i];
 
-              // If string literal, ignore
-              if (var.checkName("exp:StringLiteral"))
-                continue;
+            // If string literal, ignore
+            if (var.checkName("exp:StringLiteral"))
+              continue;
 
-              // Read expression
-              MX v = readExpr(var);
+            // Read expression
+            MX v = readExpr(var);
 
-              // Treat as an output
-              add_y(v, "mterm");
-            }
-          } catch(exception& ex) {
-            throw CasadiException(std::string("addObjectiveFunction failed: ") + ex.what());
+            // Treat as an output
+            add_y(v, "mterm");
           }
-        } else if (onode.checkName("opt:IntegrandObjectiveFunction")) {
-          try {
-            for (int i=0; i<onode.size(); ++i) {
-              const XmlNode& var = onode[i];
+        } catch(exception& ex) {
+          throw CasadiException(std::string("addObjectiveFunction failed: ") + ex.what());
+        }
+      } else if (onode.checkName("opt:IntegrandObjectiveFunction")) {
+        try {
+          for (int i=0; i<onode.size(); ++i) {
+            const XmlNode& var = onode[i];
 
-              // If string literal, ignore
-              if (var.checkName("exp:StringLiteral")) continue;
+            // If string literal, ignore
+            if (var.checkName("exp:StringLiteral")) continue;
 
-              // Read expression
-              MX v = readExpr(var);
+            // Read expression
+            MX v = readExpr(var);
 
-              // Treat as a quadrature state
-              add_q("lterm");
-              add_quad(v, "lterm_rhs");
-            }
-          } catch(exception& ex) {
-            throw CasadiException(std::string("addIntegrandObjectiveFunction failed: ")
-                                  + ex.what());
+            // Treat as a quadrature state
+            add_q("lterm");
+            add_quad(v, "lterm_rhs");
           }
-        } else if (onode.checkName("opt:IntervalStartTime")) {
-          // Ignore, treated above
-        } else if (onode.checkName("opt:IntervalFinalTime")) {
-          // Ignore, treated above
-        } else if (onode.checkName("opt:TimePoints")) {
-          // Ignore, treated above
-        } else if (onode.checkName("opt:PointConstraints")) {
-          casadi_warning("opt:PointConstraints not supported, ignored");
-        } else if (onode.checkName("opt:Constraints")) {
-          casadi_warning("opt:Constraints not supported, ignored");
-        } else if (onode.checkName("opt:PathConstraints")) {
-          casadi_warning("opt:PointConstraints not supported, ignored");
-        } else {
-          casadi_warning("DaeBuilder::addOptimization: Unknown node " << onode.getName());
+        } catch(exception& ex) {
+          throw CasadiException(std::string("addIntegrandObjectiveFunction failed: ")
+                                + ex.what());
         }
+      } else if (onode.checkName("opt:IntervalStartTime")) {
+        // Ignore, treated above
+      } else if (onode.checkName("opt:IntervalFinalTime")) {
+        // Ignore, treated above
+      } else if (onode.checkName("opt:TimePoints")) {
+        // Ignore, treated above
+      } else if (onode.checkName("opt:PointConstraints")) {
+        casadi_warning("opt:PointConstraints not supported, ignored");
+      } else if (onode.checkName("opt:Constraints")) {
+        casadi_warning("opt:Constraints not supported, ignored");
+      } else if (onode.checkName("opt:PathConstraints")) {
+        casadi_warning("opt:PointConstraints not supported, ignored");
+      } else {
+        casadi_warning("DaeBuilder::addOptimization: Unknown node " << onode.getName());
       }
     }
-
-    // Make sure that the dimensions are consistent at this point
-    casadi_assert_warning(this->s.size()==this->dae.size(),
-                          "The number of differential-algebraic equations does not match "
-                          "the number of implicitly defined states.");
-    casadi_assert_warning(this->z.size()==this->alg.size(),
-                          "The number of algebraic equations (equations not involving "
-                          "differentiated variables) does not match the number of "
-                          "algebraic variables.");
   }
 
   Variable& DaeBuilder::readVariable(const XmlNode& node) {
@@ -985,7 +972,7 @@ namespace casadi {
 
   Variable& DaeBuilder::variable(const std::string& name) {
     // Find the variable
-    VarMap::iterator it = varmap_.find(name);
+    VarMap::iterator it = findVariable(name);
     if (it==varmap_.end()) {
       casadi_error("No such variable: \"" << name << "\".");
     }
@@ -996,13 +983,51 @@ namespace casadi {
 
   void DaeBuilder::addVariable(const std::string& name, const Variable& var) {
     // Try to find the component
-    if (varmap_.find(name)!=varmap_.end()) {
-      stringstream ss;
+    if (findVariable(name)!=varmap_.end()) {
       casadi_error("Variable \"" << name << "\" has already been added.");
     }
 
     // Add to the map of all variables
-    varmap_[name] = var;
+    VarMap::iterator it = varmap_.insert(make_pair(name, var)).first;
+
+    // Add to the hash index, keeping the load factor below one half
+    if (2*varmap_.size() > varindex_.slot.size()) {
+      rebuildVarIndex();
+    } else {
+      size_t mask = varindex_.slot.size()-1;
+      size_t i = hashName(name) & mask;
+      while (varindex_.slot[i]!=varmap_.end()) i = (i+1) & mask;
+      varindex_.slot[i] = it;
+      varindex_.n++;
+    }
+  }
+
+  DaeBuilder::VarMap::iterator DaeBuilder::findVariable(const std::string& name) {
+    // Index out of date, e.g. after a copy
+    if (varindex_.n!=varmap_.size()) rebuildVarIndex();
+    if (varindex_.slot.empty()) return varmap_.end();
+
+    // Probe until the variable or an unused slot is found
+    size_t mask = varindex_.slot.size()-1;
+    for (size_t i = hashName(name) & mask; ; i = (i+1) & mask) {
+      VarMap::iterator it = varindex_.slot[i];
+      if (it==varmap_.end() || it->first==name) return it;
+    }
+  }
+
+  void DaeBuilder::rebuildVarIndex() {
+    // Power of two number of slots, at least twice the number of variables
+    size_t nslot = 16;
+    while (nslot < 2*varmap_.size()) nslot *= 2;
+    varindex_.slot.assign(nslot, varmap_.end());
+    varindex_.n = varmap_.size();
+
+    // Add all variables
+    for (VarMap::iterator it=varmap_.begin(); it!=varmap_.end(); ++it) {
+      size_t i = hashName(it->first) & (nslot-1);
+      while (varindex_.slot[i]!=varmap_.end()) i = (i+1) & (nslot-1);
+      varindex_.slot[i] = it;
+    }
   }
 
   MX DaeBuilder::addVariable(const std::string& name, int n) {
@@ -232,7 +232,11 @@ namespace casadi {
     /** @name Import and export
      */
     ///@{
-    /// Import existing problem from FMI/XML
+    /** \brief Import existing problem from FMI/XML
+
+        The file is read in a single streaming pass: variables and equations are
+        created as their elements are encountered, without loading the document tree.
+    */
     void parseFMI(const std::string& filename);
 
 #ifndef SWIG
@@ -437,6 +441,26 @@ namespace casadi {
     typedef std::map<std::string, Variable> VarMap;
     VarMap varmap_;
 
+    /** \brief Hash index into varmap_, open addressing with linear probing
+
+        Unused slots hold varmap_.end(). The index is emptied when copied and
+        rebuilt on demand, so that it never refers to another instance.
+    */
+    struct VarIndex {
+      VarIndex() : n(0) {}
+      VarIndex(const VarIndex&) : n(0) {}
+      VarIndex& operator=(const VarIndex&) { slot.clear(); n=0; return *this;}
+      std::vector<VarMap::iterator> slot;
+      std::size_t n;
+    };
+    VarIndex varindex_;
+
+    /// Find a variable using the hash index, varmap_.end() if not found
+    VarMap::iterator findVariable(const std::string& name);
+
+    /// Rebuild the hash index
+    void rebuildVarIndex();
+
     /// Linear combinations of output expressions
     std::map<std::string, MX> lin_comb_;
 
@@ -446,6 +470,13 @@ namespace casadi {
     /// Read a variable
     Variable& readVariable(const XmlNode& node);
 
+    /// Add a ScalarVariable element of ModelVariables
+    void readModelVariable(const XmlNode& vnode);
+
+    /// Add an element of the BindingEquations, DynamicEquations, InitialEquations or
+    /// Optimization sections
+    void readSectionNode(const std::string& section, const XmlNode& node);
+
     /// Get an attribute by expression
     typedef double (DaeBuilder::*getAtt)(const std::string& name, bool normalized) const;
     std::vector<double> attribute(getAtt f, const MX& var, bool normalized) const;
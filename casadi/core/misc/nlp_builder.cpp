@@ -25,11 +25,406 @@
 
 #include "nlp_builder.hpp"
 #include "../core.hpp"
-#include <fstream>
+#include "../profiling.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 
 using namespace std;
 namespace casadi {
 
+/** \brief Buffered reader for NL-files, text or binary format
+
+  In the binary format, the header, the segment keys and the expression keys are
+  characters as in the text format, while integers and floating point numbers are
+  stored in their native binary representation (int and double).
+*/
+class NlReader {
+  public:
+    /// Open the file
+    NlReader(const std::string& filename, size_t buffer_size)
+      : buf_(buffer_size), pos_(0), end_(0), nread_(0), binary_(false) {
+      file_ = fopen(filename.c_str(), "rb");
+      casadi_assert_message(file_!=0, "NlpBuilder::parseNL: Cannot open \"" << filename << "\"");
+    }
+
+    /// Close the file
+    ~NlReader() { fclose(file_);}
+
+    /// Select the binary format
+    void setBinary(bool binary) { binary_ = binary;}
+
+    /// Number of bytes read so far
+    size_t bytesRead() const { return nread_ - (end_ - pos_);}
+
+    /// Read a line of the header
+    std::string readLine() {
+      std::string line;
+      int c;
+      while ((c=get())!=EOF && c!='\n') line += static_cast<char>(c);
+      return line;
+    }
+
+    /// Read a segment or expression key, EOF at the end of the file
+    int readKey() {
+      if (!binary_) skipSpace();
+      return get();
+    }
+
+    /// Read an integer
+    int readInt() {
+      if (binary_) {
+        int v;
+        readRaw(&v, sizeof(v));
+        return v;
+      }
+      readToken();
+      char* end;
+      long v = strtol(tok_, &end, 10);
+      casadi_assert_message(*end==0, "NlpBuilder::parseNL: Expected an integer, got \""
+                            << tok_ << "\"");
+      return static_cast<int>(v);
+    }
+
+    /// Read a floating point number
+    double readDouble() {
+      if (binary_) {
+        double v;
+        readRaw(&v, sizeof(v));
+        return v;
+      }
+      readToken();
+      char* end;
+      double v = strtod(tok_, &end);
+      casadi_assert_message(*end==0, "NlpBuilder::parseNL: Expected a number, got \""
+                            << tok_ << "\"");
+      return v;
+    }
+
+    /// Read an integer constant of an expression, key 's' (short) or 'l' (long)
+    double readIntConstant(int key) {
+      if (binary_ && key=='s') {
+        short v;
+        readRaw(&v, sizeof(v));
+        return v;
+      }
+      return readInt();
+    }
+
+    /// Read a bound type: a character in the binary format
+    int readBoundType() {
+      return binary_ ? get() - '0' : readInt();
+    }
+
+    /// Read a name: a token in the text format, length and characters in the binary format
+    std::string readName() {
+      if (binary_) {
+        int n = readInt();
+        casadi_assert_message(n>=0, "NlpBuilder::parseNL: Corrupt file");
+        std::string s(n, ' ');
+        if (n>0) readRaw(&s[0], n);
+        return s;
+      }
+      readToken();
+      return tok_;
+    }
+
+  private:
+    /// Refill the buffer, false at the end of the file
+    bool fill() {
+      pos_ = 0;
+      end_ = fread(&buf_.front(), 1, buf_.size(), file_);
+      nread_ += end_;
+      return end_>0;
+    }
+
+    /// Get the next character
+    int get() {
+      if (pos_==end_ && !fill()) return EOF;
+      return static_cast<unsigned char>(buf_[pos_++]);
+    }
+
+    /// Peek at the next character
+    int peek() {
+      if (pos_==end_ && !fill()) return EOF;
+      return static_cast<unsigned char>(buf_[pos_]);
+    }
+
+    /// Read raw bytes
+    void readRaw(void* dest, size_t n) {
+      char* d = static_cast<char*>(dest);
+      while (n>0) {
+        casadi_assert_message(pos_<end_ || fill(), "NlpBuilder::parseNL: Unexpected end of file");
+        size_t m = std::min(n, end_-pos_);
+        memcpy(d, &buf_[pos_], m);
+        pos_ += m;
+        d += m;
+        n -= m;
+      }
+    }
+
+    /// Skip white space and comments
+    void skipSpace() {
+      int c;
+      while ((c=peek())!=EOF) {
+        if (c=='#') {
+          // Comment until the end of the line
+          while ((c=get())!=EOF && c!='\n') {}
+        } else if (isspace(c)) {
+          pos_++;
+        } else {
+          break;
+        }
+      }
+    }
+
+    /// Read a token, delimited by white space or a comment
+    void readToken() {
+      skipSpace();
+      int n = 0, c;
+      while ((c=peek())!=EOF && !isspace(c) && c!='#') {
+        casadi_assert_message(n+1<sizeof(tok_), "NlpBuilder::parseNL: Token too long");
+        tok_[n++] = static_cast<char>(c);
+        pos_++;
+      }
+      tok_[n] = 0;
+      casadi_assert_message(n>0, "NlpBuilder::parseNL: Unexpected end of file");
+    }
+
+    FILE* file_;
+    std::vector<char> buf_;
+    size_t pos_, end_, nread_;
+    bool binary_;
+    char tok_[256];
+};
+
+/// Number of arguments of an NL operator, -1 if n-ary, -2 if not supported
+static int nlArity(int op) {
+  switch (op) {
+    // Unary operations, class 1 in Gay2005
+    case 13:  case 14:  case 15:  case 16:  case 34:  case 37:  case 38:  case 39:  case 40:
+    case 41:  case 43:  case 42:  case 44:  case 45:  case 46:  case 47:  case 49:  case 50:
+    case 51:  case 52:  case 53:
+      return 1;
+
+    // Binary operations, class 2 in Gay2005
+    case 0:   case 1:   case 2:   case 3:   case 4:   case 5:   case 6:   case 20:  case 21:
+    case 22:  case 23:  case 24:  case 28:  case 29:  case 30:  case 48:  case 55:  case 56:
+    case 57:  case 58:  case 73:
+      return 2;
+
+    // N-ary operator, classes 2, 6 and 11 in Gay2005
+    case 11: case 12: case 54: case 59: case 60: case 61: case 70: case 71: case 74:
+      return -1;
+
+    default:
+      return -2;
+  }
+}
+
+/// Apply an NL operator to its arguments
+static SXElement nlApply(int op, const SXElement* args, int n) {
+  // Error message
+  stringstream msg;
+
+  switch (nlArity(op)) {
+    case 1:
+    {
+      const SXElement& x = args[0];
+      switch (op) {
+        case 13:  return floor(x);
+        case 14:  return ceil(x);
+        case 15:  return abs(x);
+        case 16:  return -x;
+        case 34:  return logic_not(x);
+        case 37:  return tanh(x);
+        case 38:  return tan(x);
+        case 39:  return sqrt(x);
+        case 40:  return sinh(x);
+        case 41:  return sin(x);
+        case 42:  return log10(x);
+        case 43:  return log(x);
+        case 44:  return exp(x);
+        case 45:  return cosh(x);
+        case 46:  return cos(x);
+        // case 47:  return atanh(x); FIXME
+        case 49:  return atan(x);
+        // case 50:  return asinh(x); FIXME
+        case 51:  return asin(x);
+        // case 52:  return acosh(x); FIXME
+        case 53:  return acos(x);
+
+        default:
+          msg << "Unknown unary operation: \"" << op << "\"";
+      }
+      break;
+    }
+
+    case 2:
+    {
+      const SXElement& x = args[0];
+      const SXElement& y = args[1];
+      switch (op) {
+        case 0:   return x + y;
+        case 1:   return x - y;
+        case 2:   return x * y;
+        case 3:   return x / y;
+        // case 4:   return rem(x, y); FIXME
+        case 5:   return pow(x, y);
+        // case 6:   return x < y; // TODO(Joel): Verify this,
+                                   // what is the difference to 'le' == 23 below?
+        case 20:  return logic_or(x, y);
+        case 21:  return logic_and(x, y);
+        case 22:  return x < y;
+        case 23:  return x <= y;
+        case 24:  return x == y;
+        case 28:  return x >= y;
+        case 29:  return x > y;
+        case 30:  return x != y;
+        case 48:  return atan2(x, y);
+        // case 55:  return intdiv(x, y); // FIXME
+        // case 56:  return precision(x, y); // FIXME
+        // case 57:  return round(x, y); // FIXME
+        // case 58:  return trunc(x, y); // FIXME
+        // case 73:  return iff(x, y); // FIXME
+
+        default:
+          msg << "Unknown binary operation: \"" << op << "\"";
+      }
+      break;
+    }
+
+    case -1:
+      switch (op) {
+        // case 11: return min(args).toScalar(); FIXME // rename?
+        // case 12: return max(args).toScalar(); FIXME // rename?
+        // case 54: return sum(args).toScalar(); FIXME // rename?
+        // case 59: return count(args).toScalar(); FIXME // rename?
+        // case 60: return numberof(args).toScalar(); FIXME // rename?
+        // case 61: return numberofs(args).toScalar(); FIXME // rename?
+        // case 70: return all(args).toScalar(); FIXME // and in AMPL // rename?
+        // case 71: return any(args).toScalar(); FIXME // or in AMPL // rename?
+        // case 74: return alldiff(args).toScalar(); FIXME // rename?
+        case 54:
+        {
+          SXElement r = 0;
+          for (int k=0; k<n; ++k) r += args[k];
+          return r;
+        }
+
+        default:
+          msg << "Unknown n-ary operation: \"" << op << "\"";
+      }
+      break;
+
+    default:
+      switch (op) {
+        // Piecewise linear terms, class 4 in Gay2005
+        case 64:
+          msg << "Piecewise linear terms not supported";
+          break;
+
+        // If-then-else expressions, class 5 in Gay2005
+        case 35: case 65: case 72:
+          msg << "If-then-else expressions not supported";
+          break;
+
+        default:
+          msg << "Unknown operation: \"" << op << "\"";
+      }
+  }
+
+  // Throw error message
+  throw CasadiException("Error in NlpBuilder::readExpressionNL: " + msg.str());
+}
+
+/** \brief Read an expression from an NL-file (Polish prefix format)
+
+  The expression is parsed without recursion: operators wait on a stack until
+  all their arguments have been read, so that deeply nested expressions are
+  supported.
+*/
+static SXElement readExpressionNL(NlReader& reader, const std::vector<SXElement>& v) {
+  // Operators waiting for arguments: operator, number of arguments, first argument
+  vector<int> op_stack;
+  vector<int> narg_stack;
+  vector<int> first_stack;
+
+  // Arguments and results
+  vector<SXElement> stack;
+
+  while (true) {
+    // Read the instruction
+    int inst = reader.readKey();
+
+    switch (inst) {
+      // Symbolic variable
+      case 'v':
+      {
+        int i = reader.readInt();
+        casadi_assert_message(i>=0 && i<v.size(),
+                              "Error in NlpBuilder::readExpressionNL: Variable " << i
+                              << " out of bounds");
+        stack.push_back(v[i]);
+        break;
+      }
+
+      // Numeric expression
+      case 'n':
+        stack.push_back(reader.readDouble());
+        break;
+
+      // Integer constants
+      case 's':
+      case 'l':
+        stack.push_back(reader.readIntConstant(inst));
+        break;
+
+      // Operation
+      case 'o':
+      {
+        int op = reader.readInt();
+        int n = nlArity(op);
+        if (n==-2) nlApply(op, 0, 0); // throws
+        if (n==-1) {
+          // Number of arguments follows
+          n = reader.readInt();
+          casadi_assert_message(n>=0, "Error in NlpBuilder::readExpressionNL: "
+                                "Negative number of arguments");
+        }
+        op_stack.push_back(op);
+        narg_stack.push_back(n);
+        first_stack.push_back(stack.size());
+        break;
+      }
+
+      default:
+        stringstream msg;
+        if (inst==EOF) {
+          msg << "Unexpected end of file";
+        } else {
+          msg << "Unknown instruction: \"" << static_cast<char>(inst) << "\"";
+        }
+        throw CasadiException("Error in NlpBuilder::readExpressionNL: " + msg.str());
+    }
+
+    // Apply the operators which have all their arguments
+    while (!op_stack.empty() && stack.size()-first_stack.back()==narg_stack.back()) {
+      int first = first_stack.back();
+      SXElement r = nlApply(op_stack.back(), stack.empty() ? 0 : &stack[0] + first,
+                            narg_stack.back());
+      stack.resize(first);
+      stack.push_back(r);
+      op_stack.pop_back();
+      narg_stack.pop_back();
+      first_stack.pop_back();
+    }
+
+    // Done if nothing remains to be read
+    if (op_stack.empty()) return stack.back();
+  }
+}
+
 void NlpBuilder::parseNL(const std::string& filename, const Dict& options) {
   // Note: The implementation of this function follows the
   // "Writing .nl Files" paper by David M. Gay (2005)
@@ -49,21 +444,25 @@ void NlpBuilder::parseNL(const std::string& filename, const Dict& options) {
   }
 
   // Open the NL file for reading
-  ifstream nlfile;
-  nlfile.open(filename.c_str());
+  double time_start = getRealTime();
+  NlReader nlfile(filename, 1<<20);
   if (verbose) userOut() << "Reading file \"" << filename << "\"" << endl;
 
   // Read the header of the NL-file (first 10 lines)
   const int header_sz = 10;
   vector<string> header(header_sz);
   for (int k=0; k<header_sz; ++k) {
-    getline(nlfile, header[k]);
+    header[k] = nlfile.readLine();
   }
 
-  // Assert that the file is not in binary form
-  casadi_assert_message(header.at(0).at(0)=='g',
-                        "File could not be read, or file is binary format "
-                        "(currently not supported)");
+  // Text ('g') or binary ('b') format
+  casadi_assert_message(!header.at(0).empty() &&
+                        (header.at(0).at(0)=='g' || header.at(0).at(0)=='b'),
+                        "File could not be read, or is not an NL-file");
+  nlfile.setBinary(header.at(0).at(0)=='b');
+  if (verbose) {
+    userOut() << (header.at(0).at(0)=='b' ? "Binary" : "Text") << " format" << endl;
+  }
 
   // Get the number of objectives and constraints
   stringstream ss(header[1]);
@@ -99,34 +498,55 @@ void NlpBuilder::parseNL(const std::string& filename, const Dict& options) {
   while (true) {
 
     // Read segment key
-    char key;
-    nlfile >> key;
+    int key = nlfile.readKey();
 
     // Break if end of file
-    if (nlfile.eof()) break;
+    if (key==EOF) break;
 
     // Process segments
     switch (key) {
       // Imported function description
       case 'F':
+      {
         if (verbose) {
           userOut<true, PL_WARN>() << "Imported function description unsupported: ignored" << endl;
         }
+        // Index, type and number of arguments, followed by the name
+        nlfile.readInt();
+        nlfile.readInt();
+        nlfile.readInt();
+        nlfile.readName();
         break;
+      }
 
       // Suffix values
       case 'S':
+      {
         if (verbose) {
           userOut<true, PL_WARN>() << "Suffix values unsupported: ignored" << endl;
         }
+        // Kind, number of values and name, then the values (real if bit 2 of the kind is set)
+        int kind = nlfile.readInt();
+        int n = nlfile.readInt();
+        nlfile.readName();
+        for (int i=0; i<n; ++i) {
+          nlfile.readInt();
+          if (kind & 4) {
+            nlfile.readDouble();
+          } else {
+            nlfile.readInt();
+          }
+        }
         break;
+      }
 
       // Defined variable definition
       case 'V':
       {
         // Read header
-        int i, j, k;
-        nlfile >> i >> j >> k;
+        int i = nlfile.readInt();
+        int j = nlfile.readInt();
+        nlfile.readInt();
 
         // Make sure that v is long enough
         if (i >= v.size()) {
@@ -139,9 +559,8 @@ void NlpBuilder::parseNL(const std::string& filename, const Dict& options) {
         // Add the linear terms
         for (int jj=0; jj<j; ++jj) {
           // Linear term
-          int pl;
-          double cl;
-          nlfile >> pl >> cl;
+          int pl = nlfile.readInt();
+          double cl = nlfile.readDouble();
 
           // Add to variable definition (assuming it has already been defined)
           casadi_assert_message(!v.at(pl).isNan(), "Circular dependencies not supported");
@@ -158,8 +577,7 @@ void NlpBuilder::parseNL(const std::string& filename, const Dict& options) {
       case 'C':
       {
         // Get the number
-        int i;
-        nlfile >> i;
+        int i = nlfile.readInt();
 
         // Parse and save expression
         g.at(i) = readExpressionNL(nlfile, v);
@@ -169,21 +587,24 @@ void NlpBuilder::parseNL(const std::string& filename, const Dict& options) {
 
       // Logical constraint expression
       case 'L':
+      {
         if (verbose) {
           userOut<true, PL_WARN>() << "Logical constraint expression unsupported: ignored" << endl;
         }
+        // Number and expression
+        nlfile.readInt();
+        readExpressionNL(nlfile, v);
         break;
+      }
 
       // Objective function
       case 'O':
       {
         // Get the number
-        int i;
-        nlfile >> i;
+        int i = nlfile.readInt();
 
         // Should the objective be maximized
-        int sigma;
-        nlfile >> sigma;
+        int sigma = nlfile.readInt();
 
         // Parse and save expression
         f.at(i) = readExpressionNL(nlfile, v);
@@ -200,15 +621,13 @@ void NlpBuilder::parseNL(const std::string& filename, const Dict& options) {
       case 'd':
       {
         // Read the number of guesses supplied
-        int m;
-        nlfile >> m;
+        int m = nlfile.readInt();
 
         // Process initial guess for the fual variables
         for (int i=0; i<m; ++i) {
           // Offset and value
-          int offset;
-          double d;
-          nlfile >> offset >> d;
+          int offset = nlfile.readInt();
+          double d = nlfile.readDouble();
 
           // Save initial guess
           lambda_init.at(offset) = d;
@@ -221,15 +640,13 @@ void NlpBuilder::parseNL(const std::string& filename, const Dict& options) {
       case 'x':
       {
         // Read the number of guesses supplied
-        int m;
-        nlfile >> m;
+        int m = nlfile.readInt();
 
         // Process initial guess
         for (int i=0; i<m; ++i) {
           // Offset and value
-          int offset;
-          double d;
-          nlfile >> offset >> d;
+          int offset = nlfile.readInt();
+          double d = nlfile.readDouble();
 
           // Save initial guess
           x_init.at(offset) = d;
@@ -245,31 +662,23 @@ void NlpBuilder::parseNL(const std::string& filename, const Dict& options) {
         for (int i=0; i<n_con; ++i) {
 
           // Read constraint type
-          int c_type;
-          nlfile >> c_type;
-
-          // Temporary
-          double c;
+          int c_type = nlfile.readBoundType();
 
           switch (c_type) {
             // Upper and lower bounds
             case 0:
-              nlfile >> c;
-              g_lb.at(i) = c;
-              nlfile >> c;
-              g_ub.at(i) = c;
+              g_lb.at(i) = nlfile.readDouble();
+              g_ub.at(i) = nlfile.readDouble();
               continue;
 
             // Only upper bounds
             case 1:
-              nlfile >> c;
-              g_ub.at(i) = c;
+              g_ub.at(i) = nlfile.readDouble();
               continue;
 
             // Only lower bounds
             case 2:
-              nlfile >> c;
-              g_lb.at(i) = c;
+              g_lb.at(i) = nlfile.readDouble();
               continue;
 
             // No bounds
@@ -278,16 +687,15 @@ void NlpBuilder::parseNL(const std::string& filename, const Dict& options) {
 
             // Equality constraints
             case 4:
-              nlfile >> c;
-              g_lb.at(i) = g_ub.at(i) = c;
+              g_lb.at(i) = g_ub.at(i) = nlfile.readDouble();
               continue;
 
               // Complementary constraints
               case 5:
               {
                 // Read the indices
-                int ck, ci;
-                nlfile >> ck >> ci;
+                nlfile.readInt();
+                nlfile.readInt();
                 if (verbose) {
                   userOut<true, PL_WARN>()
                     << "Complementary constraints unsupported: ignored" << endl;
@@ -309,31 +717,23 @@ void NlpBuilder::parseNL(const std::string& filename, const Dict& options) {
         for (int i=0; i<n_var; ++i) {
 
           // Read constraint type
-          int c_type;
-          nlfile >> c_type;
-
-          // Temporary
-          double c;
+          int c_type = nlfile.readBoundType();
 
           switch (c_type) {
             // Upper and lower bounds
             case 0:
-              nlfile >> c;
-              x_lb.at(i) = c;
-              nlfile >> c;
-              x_ub.at(i) = c;
+              x_lb.at(i) = nlfile.readDouble();
+              x_ub.at(i) = nlfile.readDouble();
               continue;
 
             // Only upper bounds
             case 1:
-              nlfile >> c;
-              x_ub.at(i) = c;
+              x_ub.at(i) = nlfile.readDouble();
               continue;
 
            // Only lower bounds
            case 2:
-              nlfile >> c;
-              x_lb.at(i) = c;
+              x_lb.at(i) = nlfile.readDouble();
               continue;
 
            // No bounds
@@ -342,8 +742,7 @@ void NlpBuilder::parseNL(const std::string& filename, const Dict& options) {
 
            // Equality constraints
            case 4:
-              nlfile >> c;
-              x_lb.at(i) = x_ub.at(i) = c;
+              x_lb.at(i) = x_ub.at(i) = nlfile.readDouble();
               continue;
 
            default:
@@ -357,18 +756,13 @@ void NlpBuilder::parseNL(const std::string& filename, const Dict& options) {
       // Jacobian row counts
       case 'k':
       {
-        // Get row offsets
-        vector<int> rowind(n_var+1);
-
         // Get the number of offsets
-        int k;
-        nlfile >> k;
+        int k = nlfile.readInt();
         casadi_assert(k==n_var-1);
 
-        // Get the row offsets
-        rowind[0]=0;
+        // Skip the row offsets, not needed
         for (int i=0; i<k; ++i) {
-          nlfile >> rowind[i+1];
+          nlfile.readInt();
         }
         break;
       }
@@ -377,15 +771,14 @@ void NlpBuilder::parseNL(const std::string& filename, const Dict& options) {
       case 'J':
       {
         // Get constraint number and number of terms
-        int i, k;
-        nlfile >> i >> k;
+        int i = nlfile.readInt();
+        int k = nlfile.readInt();
 
         // Get terms
         for (int kk=0; kk<k; ++kk) {
           // Get the term
-          int j;
-          double c;
-          nlfile >> j >> c;
+          int j = nlfile.readInt();
+          double c = nlfile.readDouble();
 
           // Add to constraints
           g.at(i) += c*v.at(j);
@@ -397,205 +790,31 @@ void NlpBuilder::parseNL(const std::string& filename, const Dict& options) {
       case 'G':
       {
         // Get objective number and number of terms
-        int i, k;
-        nlfile >> i >> k;
+        int i = nlfile.readInt();
+        int k = nlfile.readInt();
 
         // Get terms
         for (int kk=0; kk<k; ++kk) {
           // Get the term
-          int j;
-          double c;
-          nlfile >> j >> c;
+          int j = nlfile.readInt();
+          double c = nlfile.readDouble();
 
           // Add to objective
           f.at(i) += c*v.at(j);
         }
         break;
       }
+
+      default:
+        casadi_error("NlpBuilder::parseNL: Unknown segment \"" << static_cast<char>(key) << "\"");
     }
   }
 
-  // Close the NL file
-  nlfile.close();
-}
-
-SXElement NlpBuilder::readExpressionNL(std::istream &stream, const std::vector<SXElement>& v) {
-  // Read the instruction
-  char inst;
-  stream >> inst;
-
-  // Temporaries
-  int i;
-  double d;
-
-  // Error message
-  stringstream msg;
-
-  // Process instruction
-  switch (inst) {
-    // Symbolic variable
-    case 'v':
-      // Read the variable number
-      stream >> i;
-
-      // Return the corresponding expression
-      return v.at(i);
-
-    // Numeric expression
-    case 'n':
-
-      // Read the floating point number
-      stream >> d;
-
-      // Return an expression containing the number
-      return d;
-
-    // Operation
-    case 'o':
-
-      // Read the operation
-      stream >> i;
-
-      // Process
-      switch (i) {
-
-        // Unary operations, class 1 in Gay2005
-        case 13:  case 14:  case 15:  case 16:  case 34:  case 37:  case 38:  case 39:  case 40:
-        case 41:  case 43:  case 42:  case 44:  case 45:  case 46:  case 47:  case 49:  case 50:
-        case 51:  case 52:  case 53:
-        {
-          // Read dependency
-          SXElement x = readExpressionNL(stream, v);
-
-          // Perform operation
-          switch (i) {
-            case 13:  return floor(x);
-            case 14:  return ceil(x);
-            case 15:  return abs(x);
-            case 16:  return -x;
-            case 34:  return logic_not(x);
-            case 37:  return tanh(x);
-            case 38:  return tan(x);
-            case 39:  return sqrt(x);
-            case 40:  return sinh(x);
-            case 41:  return sin(x);
-            case 42:  return log10(x);
-            case 43:  return log(x);
-            case 44:  return exp(x);
-            case 45:  return cosh(x);
-            case 46:  return cos(x);
-            // case 47:  return atanh(x); FIXME
-            case 49:  return atan(x);
-            // case 50:  return asinh(x); FIXME
-            case 51:  return asin(x);
-            // case 52:  return acosh(x); FIXME
-            case 53:  return acos(x);
-
-            default:
-              msg << "Unknown unary operation: \"" << i << "\"";
-          }
-          break;
-        }
-
-        // Binary operations, class 2 in Gay2005
-        case 0:   case 1:   case 2:   case 3:   case 4:   case 5:   case 6:   case 20:  case 21:
-        case 22:  case 23:  case 24:  case 28:  case 29:  case 30:  case 48:  case 55:  case 56:
-        case 57:  case 58:  case 73:
-        {
-          // Read dependencies
-          SXElement x = readExpressionNL(stream, v);
-          SXElement y = readExpressionNL(stream, v);
-
-          // Perform operation
-          switch (i) {
-            case 0:   return x + y;
-            case 1:   return x - y;
-            case 2:   return x * y;
-            case 3:   return x / y;
-            // case 4:   return rem(x, y); FIXME
-            case 5:   return pow(x, y);
-            // case 6:   return x < y; // TODO(Joel): Verify this,
-                                       // what is the difference to 'le' == 23 below?
-            case 20:  return logic_or(x, y);
-            case 21:  return logic_and(x, y);
-            case 22:  return x < y;
-            case 23:  return x <= y;
-            case 24:  return x == y;
-            case 28:  return x >= y;
-            case 29:  return x > y;
-            case 30:  return x != y;
-            case 48:  return atan2(x, y);
-            // case 55:  return intdiv(x, y); // FIXME
-            // case 56:  return precision(x, y); // FIXME
-            // case 57:  return round(x, y); // FIXME
-            // case 58:  return trunc(x, y); // FIXME
-            // case 73:  return iff(x, y); // FIXME
-
-            default:
-              msg << "Unknown binary operation: \"" << i << "\"";
-          }
-          break;
-        }
-
-        // N-ary operator, classes 2, 6 and 11 in Gay2005
-        case 11: case 12: case 54: case 59: case 60: case 61: case 70: case 71: case 74:
-        {
-          // Number of elements in the sum
-          int n;
-          stream >> n;
-
-          // Collect the arguments
-          vector<SXElement> args(n);
-          for (int k=0; k<n; ++k) {
-            args[k] = readExpressionNL(stream, v);
-          }
-
-          // Perform the operation
-          switch (i) {
-            // case 11: return min(args).toScalar(); FIXME // rename?
-            // case 12: return max(args).toScalar(); FIXME // rename?
-            // case 54: return sum(args).toScalar(); FIXME // rename?
-            // case 59: return count(args).toScalar(); FIXME // rename?
-            // case 60: return numberof(args).toScalar(); FIXME // rename?
-            // case 61: return numberofs(args).toScalar(); FIXME // rename?
-            // case 70: return all(args).toScalar(); FIXME // and in AMPL // rename?
-            // case 71: return any(args).toScalar(); FIXME // or in AMPL // rename?
-            // case 74: return alldiff(args).toScalar(); FIXME // rename?
-            case 54:
-            {
-              SXElement r = 0;
-              for (vector<SXElement>::const_iterator it=args.begin();
-                   it!=args.end(); ++it) r += *it;
-              return r;
-            }
-
-            default:
-              msg << "Unknown n-ary operation: \"" << i << "\"";
-          }
-          break;
-        }
-
-        // Piecewise linear terms, class 4 in Gay2005
-        case 64:
-          msg << "Piecewise linear terms not supported";
-          break;
-
-        // If-then-else expressions, class 5 in Gay2005
-        case 35: case 65: case 72:
-          msg << "If-then-else expressions not supported";
-          break;
-
-        default:
-          msg << "Unknown operatio: \"" << i << "\"";
-     }
-     break;
-
-    default:
-      msg << "Unknown instruction: \"" << inst << "\"";
+  if (verbose) {
+    double t = getRealTime() - time_start;
+    double mb = nlfile.bytesRead()/1e6;
+    userOut() << "Read " << mb << " MB in " << t << " s (" << mb/t << " MB/s)" << endl;
   }
-
-  // Throw error message
-  throw CasadiException("Error in NlpBuilder::readExpressionNL: " + msg.str());
 }
 
 void NlpBuilder::print(std::ostream &stream, bool trailing_newline) const {
@@ -65,7 +65,7 @@ class CASADI_EXPORT NlpBuilder : public PrintableObject<NlpBuilder> {
 
     ///@}
 
-    /// Parse an AMPL och PyOmo NL-file
+    /// Parse an AMPL och PyOmo NL-file, text or binary format
     void parseNL(const std::string& filename, const Dict& options = Dict());
 
     /// Print a description of the object
@@ -73,14 +73,6 @@ class CASADI_EXPORT NlpBuilder : public PrintableObject<NlpBuilder> {
 
     /// Print a representation of the object
     void repr(std::ostream &stream=casadi::userOut(), bool trailing_newline=true) const;
-
-#ifndef SWIG
-  protected:
-
-    /// Read an expression from an NL-file (Polish infix format)
-    static SXElement readExpressionNL(std::istream &stream, const std::vector<SXElement>& v);
-
-#endif // SWIG
 };
 
 } // namespace casadi
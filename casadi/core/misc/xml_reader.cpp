@@ -0,0 +1,307 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#include "xml_reader.hpp"
+#include <cstring>
+#include <cstdlib>
+#include <sstream>
+
+using namespace std;
+namespace casadi {
+
+  XmlReader::XmlReader(std::istream& stream) : stream_(stream), buf_(1<<16), pos_(0), end_(0),
+                                               line_(1), empty_(false), name_(0), n_att_(0) {
+  }
+
+  XmlReader::~XmlReader() {
+  }
+
+  bool XmlReader::fill() {
+    if (!stream_.good()) return false;
+    stream_.read(&buf_.front(), buf_.size());
+    end_ = stream_.gcount();
+    pos_ = 0;
+    return end_>0;
+  }
+
+  void XmlReader::error(const std::string& msg) const {
+    casadi_error("XmlReader: " << msg << " on line " << line_ << ".");
+  }
+
+  const std::string* XmlReader::intern(const std::string& str) {
+    // Only allocates if the string is not already in the pool
+    return &*pool_.insert(str).first;
+  }
+
+  void XmlReader::skipSpace() {
+    while (isspace(peek())) get();
+  }
+
+  void XmlReader::readName() {
+    tok_.clear();
+    while (true) {
+      int c = peek();
+      if (c<0 || isspace(c) || c=='=' || c=='>' || c=='/' || c=='?') break;
+      tok_.push_back(static_cast<char>(get()));
+    }
+    if (tok_.empty()) error("Expected a name");
+  }
+
+  void XmlReader::readEntity(std::string& str) {
+    // Read until ';'
+    tok_.clear();
+    while (true) {
+      int c = get();
+      if (c<0) error("Unterminated entity reference");
+      if (c==';') break;
+      tok_.push_back(static_cast<char>(c));
+    }
+
+    // Predefined entities
+    if (tok_=="lt") {
+      str.push_back('<');
+    } else if (tok_=="gt") {
+      str.push_back('>');
+    } else if (tok_=="amp") {
+      str.push_back('&');
+    } else if (tok_=="quot") {
+      str.push_back('"');
+    } else if (tok_=="apos") {
+      str.push_back('\'');
+    } else if (tok_.size()>1 && tok_[0]=='#') {
+      // Character reference, encoded as UTF-8
+      char* end;
+      unsigned long cp = tok_[1]=='x' ? strtoul(tok_.c_str()+2, &end, 16) :
+        strtoul(tok_.c_str()+1, &end, 10);
+      if (*end!='\0') error("Invalid character reference &" + tok_ + ";");
+      if (cp<0x80) {
+        str.push_back(static_cast<char>(cp));
+      } else if (cp<0x800) {
+        str.push_back(static_cast<char>(0xC0 | (cp>>6)));
+        str.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+      } else if (cp<0x10000) {
+        str.push_back(static_cast<char>(0xE0 | (cp>>12)));
+        str.push_back(static_cast<char>(0x80 | ((cp>>6) & 0x3F)));
+        str.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+      } else {
+        str.push_back(static_cast<char>(0xF0 | (cp>>18)));
+        str.push_back(static_cast<char>(0x80 | ((cp>>12) & 0x3F)));
+        str.push_back(static_cast<char>(0x80 | ((cp>>6) & 0x3F)));
+        str.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+      }
+    } else {
+      // Unknown entity, keep as is (TinyXML behavior)
+      str.push_back('&');
+      str.append(tok_);
+      str.push_back(';');
+    }
+  }
+
+  void XmlReader::readValue(std::string& str, int delim) {
+    while (true) {
+      int c = get();
+      if (c<0) error("Unterminated attribute value");
+      if (c==delim) break;
+      if (c=='&') {
+        readEntity(str);
+      } else {
+        str.push_back(static_cast<char>(c));
+      }
+    }
+  }
+
+  void XmlReader::readUntil(const char* term, std::string* str) {
+    // Without output, only keep a short tail of the characters read
+    string& s = str ? *str : tok_;
+    if (!str) tok_.clear();
+    size_t n = strlen(term), start = s.size();
+    while (true) {
+      int c = get();
+      if (c<0) error(string("Expected \"") + term + "\"");
+      s.push_back(static_cast<char>(c));
+      if (s.size()-start>=n && s.compare(s.size()-n, n, term)==0) {
+        s.erase(s.size()-n);
+        return;
+      }
+      if (!str && tok_.size()>64) tok_.erase(0, tok_.size()-n);
+    }
+  }
+
+  void XmlReader::condenseText() {
+    text_.clear();
+    bool space = false;
+    for (string::const_iterator it=raw_.begin(); it!=raw_.end(); ++it) {
+      if (isspace(static_cast<unsigned char>(*it))) {
+        space = true;
+      } else {
+        if (space && !text_.empty()) text_.push_back(' ');
+        space = false;
+        text_.push_back(*it);
+      }
+    }
+  }
+
+  bool XmlReader::nextChild() {
+    // Element closed with "/>": return its (implicit) end tag
+    if (empty_) {
+      empty_ = false;
+      text_.clear();
+      open_.pop_back();
+      name_ = open_.empty() ? 0 : open_.back();
+      return false;
+    }
+
+    raw_.clear();
+    while (true) {
+      int c = get();
+      if (c<0) {
+        if (!open_.empty()) error("Unexpected end of file, expected </" + *open_.back() + ">");
+        text_.clear();
+        return false;
+      } else if (c=='&') {
+        readEntity(raw_);
+      } else if (c!='<') {
+        raw_.push_back(static_cast<char>(c));
+      } else {
+        c = peek();
+        if (c=='?') {
+          // Processing instruction or XML declaration
+          readUntil("?>");
+        } else if (c=='!') {
+          get();
+          if (peek()=='-') {
+            // Comment
+            readUntil("--");
+            readUntil("-->");
+          } else if (peek()=='[') {
+            // CDATA section, added to the text
+            readUntil("[CDATA[");
+            readUntil("]]>", &raw_);
+          } else {
+            // Document type declaration, possibly with an internal subset
+            int nest = 0;
+            while (true) {
+              c = get();
+              if (c<0) error("Unterminated document type declaration");
+              if (c=='[') nest++;
+              if (c==']') nest--;
+              if (c=='>' && nest==0) break;
+            }
+          }
+        } else if (c=='/') {
+          // End tag
+          get();
+          readName();
+          if (open_.empty() || tok_!=*open_.back()) {
+            error("Unexpected end tag </" + tok_ + ">");
+          }
+          skipSpace();
+          if (get()!='>') error("Expected '>'");
+          condenseText();
+          open_.pop_back();
+          name_ = open_.empty() ? 0 : open_.back();
+          return false;
+        } else {
+          // Start tag
+          condenseText();
+          readName();
+          name_ = intern(tok_);
+
+          // Read attributes
+          n_att_ = 0;
+          while (true) {
+            skipSpace();
+            c = get();
+            if (c=='>') break;
+            if (c=='/') {
+              if (get()!='>') error("Expected '>'");
+              empty_ = true;
+              break;
+            }
+            if (c<0) error("Unexpected end of file in <" + *name_ + ">");
+            pos_--;  // put back, the character cannot be a newline
+            readName();
+            if (n_att_==static_cast<int>(att_value_.size())) {
+              att_name_.push_back(0);
+              att_value_.push_back(string());
+            }
+            att_name_[n_att_] = intern(tok_);
+            string& val = att_value_[n_att_++];
+            val.clear();
+            skipSpace();
+            if (get()!='=') error("Expected '=' after attribute " + *att_name_[n_att_-1]);
+            skipSpace();
+            c = get();
+            if (c!='"' && c!='\'') error("Expected quoted attribute value");
+            readValue(val, c);
+          }
+          open_.push_back(name_);
+          return true;
+        }
+      }
+    }
+  }
+
+  void XmlReader::skip() {
+    while (nextChild()) skip();
+  }
+
+  const std::string& XmlReader::getAttribute(const std::string& attribute_name) const {
+    int i;
+    for (i=0; i<n_att_; ++i) {
+      if (*att_name_[i]==attribute_name) break;
+    }
+    casadi_assert_message(i<n_att_, "XmlReader::getAttribute: could not find " << attribute_name
+                          << " in <" << name() << "> on line " << line_ << ".");
+    return att_value_[i];
+  }
+
+  bool XmlReader::hasAttribute(const std::string& attribute_name) const {
+    for (int i=0; i<n_att_; ++i) {
+      if (*att_name_[i]==attribute_name) return true;
+    }
+    return false;
+  }
+
+  XmlNode XmlReader::readNode() {
+    XmlNode ret;
+    ret.setName(name());
+    for (int i=0; i<n_att_; ++i) {
+      ret.setAttribute(*att_name_[i], att_value_[i]);
+    }
+
+    // Read children, the text is the last non-empty text segment (TinyXML behavior)
+    int ch = 0;
+    while (true) {
+      bool more = nextChild();
+      if (!text_.empty()) ret.text_ = text_;
+      if (!more) break;
+      ret.children_.push_back(readNode());
+      ret.child_indices_[ret.children_.back().getName()] = ch++;
+    }
+    return ret;
+  }
+
+} // namespace casadi
@@ -0,0 +1,182 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#ifndef CASADI_XML_READER_HPP
+#define CASADI_XML_READER_HPP
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <set>
+#include "xml_node.hpp"
+
+/// \cond INTERNAL
+
+namespace casadi {
+
+  /** \brief Streaming XML reader
+
+      Pull parser that reads an XML document element by element from a stream,
+      without building the document tree. Only the subtrees explicitly requested
+      with readNode are materialized as XmlNode instances, so very large files can
+      be processed in bounded memory. Element and attribute names are interned:
+      the references returned remain valid for the lifetime of the reader.
+
+      Typical use:
+      \verbatim
+      XmlReader reader(stream);
+      reader.nextChild(); // root element
+      while (reader.nextChild()) {
+        if (reader.name()=="Section") {
+          while (reader.nextChild()) process(reader.readNode());
+        } else {
+          reader.skip();
+        }
+      }
+      \endverbatim
+
+      Processing instructions, comments and document type declarations are
+      skipped. Text is trimmed and white space is condensed, as in TinyXML.
+  */
+  class CASADI_EXPORT XmlReader {
+  public:
+    /// Constructor
+    explicit XmlReader(std::istream& stream);
+
+    /// Destructor
+    ~XmlReader();
+
+    /** \brief Advance to the next child element of the current element
+
+        Returns true if a start tag was read, in which case the child becomes the
+        current element. Returns false when the end tag of the current element
+        has been read instead, the parent then becomes the current element.
+    */
+    bool nextChild();
+
+    /// Skip the remainder of the current element, including its children
+    void skip();
+
+    /// Read the remainder of the current element into a node
+    XmlNode readNode();
+
+    /// Name of the current element
+    const std::string& name() const { return *name_;}
+
+    /// Number of open elements
+    int depth() const { return open_.size();}
+
+    /// Current line in the stream, for error messages
+    int line() const { return line_;}
+
+    /** \brief Get an attribute of the current element
+
+        Only valid directly after nextChild returned true.
+    */
+    const std::string& getAttribute(const std::string& attribute_name) const;
+
+    /// Check if the current element has an attribute
+    bool hasAttribute(const std::string& attribute_name) const;
+
+    /// Text preceding the last tag read
+    const std::string& text() const { return text_;}
+
+  private:
+    /// Get a character, -1 at end of file
+    inline int get() {
+      if (pos_==end_ && !fill()) return -1;
+      int c = static_cast<unsigned char>(buf_[pos_++]);
+      if (c=='\n') line_++;
+      return c;
+    }
+
+    /// Peek at the next character, -1 at end of file
+    inline int peek() {
+      if (pos_==end_ && !fill()) return -1;
+      return static_cast<unsigned char>(buf_[pos_]);
+    }
+
+    /// Refill the buffer
+    bool fill();
+
+    /// Read a tag or attribute name into tok_
+    void readName();
+
+    /// Read an entity reference, the '&' has already been read
+    void readEntity(std::string& str);
+
+    /// Read an attribute value until the delimiter into str
+    void readValue(std::string& str, int delim);
+
+    /// Read until a terminating string, which is not included
+    void readUntil(const char* term, std::string* str=0);
+
+    /// Skip white space
+    void skipSpace();
+
+    /// Condense raw_ into text_
+    void condenseText();
+
+    /// Intern a string
+    const std::string* intern(const std::string& str);
+
+    /// Read error
+    void error(const std::string& msg) const;
+
+    /// Stream
+    std::istream& stream_;
+
+    /// Read buffer
+    std::vector<char> buf_;
+    std::size_t pos_, end_;
+
+    /// Current line
+    int line_;
+
+    /// Names of the open elements
+    std::vector<const std::string*> open_;
+
+    /// Was the current element closed with "/>"
+    bool empty_;
+
+    /// Pool of interned names
+    std::set<std::string> pool_;
+
+    /// Name of the current element
+    const std::string* name_;
+
+    /// Attributes of the current element, values are reused to avoid allocations
+    std::vector<const std::string*> att_name_;
+    std::vector<std::string> att_value_;
+    int n_att_;
+
+    /// Text preceding the last tag, token buffers
+    std::string text_, tok_, raw_;
+  };
+
+} // namespace casadi
+/// \endcond
+
+#endif // CASADI_XML_READER_HPP
@@ -30,6 +30,8 @@ using namespace std;
 namespace casadi {
 
   Determinant::Determinant(const MX& x) {
+    casadi_assert_message(x.size1()==x.size2(),
+                          "Determinant: matrix must be square, but you supplied " << x.dimString());
     setDependencies(x);
     setSparsity(Sparsity::dense(1, 1));
   }
@@ -38,6 +40,43 @@ namespace casadi {
     return "det(" + arg.at(0) + ")";
   }
 
+  void Determinant::evalD(const double** arg, double** res, int* iw, double* w) {
+    // Dense copy of the argument, factorized in-place
+    int n = dep().size1();
+    const Sparsity& sp = dep().sparsity();
+    if (sp.isdense()) {
+      copy(arg[0], arg[0]+n*n, w);
+    } else {
+      fill(w, w+n*n, 0.);
+      const int* colind = sp.colind();
+      const int* row = sp.row();
+      for (int c=0; c<n; ++c) {
+        for (int k=colind[c]; k<colind[c+1]; ++k) w[row[k]+c*n] = arg[0][k];
+      }
+    }
+    casadi_getrf(w, n, iw);
+
+    // Product of the pivots, sign changes for row interchanges
+    double r = 1;
+    for (int i=0; i<n; ++i) r *= iw[i]==i ? w[i*(n+1)] : -w[i*(n+1)];
+    res[0][0] = r;
+  }
+
+  void Determinant::generate(const std::vector<int>& arg, const std::vector<int>& res,
+                             CodeGenerator& g) const {
+    // Dense copy of the argument, factorized in-place
+    int n = dep().size1();
+    g.addAuxiliary(CodeGenerator::AUX_GETRF);
+    g.body << "  " << g.project(g.work(arg[0], dep().nnz()), dep().sparsity(),
+                                "w", Sparsity::dense(n, n), "w+" + g.to_string(n*n)) << endl;
+    g.body << "  getrf(w, " << n << ", iw);" << endl;
+
+    // Product of the pivots, sign changes for row interchanges
+    g.body << "  for (i=0, r=1; i<" << n << "; ++i) r *= iw[i]==i ? w[i*" << (n+1)
+           << "] : -w[i*" << (n+1) << "];" << endl;
+    g.body << "  " << g.workel(res[0]) << " = r;" << endl;
+  }
+
   void Determinant::evalMX(const std::vector<MX>& arg, std::vector<MX>& res) {
     res[0] = det(arg[0]);
   }
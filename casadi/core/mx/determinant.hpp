@@ -49,6 +49,9 @@ namespace casadi {
     /// Destructor
     virtual ~Determinant() {}
 
+    /// Evaluate the function numerically
+    virtual void evalD(const double** arg, double** res, int* iw, double* w);
+
     /** \brief  Evaluate symbolically (MX) */
     virtual void evalMX(const std::vector<MX>& arg, std::vector<MX>& res);
 
@@ -63,6 +66,16 @@ namespace casadi {
     /** \brief  Print expression */
     virtual std::string print(const std::vector<std::string>& arg) const;
 
+    /** \brief Generate code for the operation */
+    virtual void generate(const std::vector<int>& arg, const std::vector<int>& res,
+                          CodeGenerator& g) const;
+
+    /** \brief Get required length of iw field */
+    virtual size_t sz_iw() const { return dep().size1();}
+
+    /** \brief Get required length of w field */
+    virtual size_t sz_w() const { return dep().size1()*(dep().size1()+1);}
+
     /** \brief Get the operation */
     virtual int getOp() const { return OP_DETERMINANT;}
   };
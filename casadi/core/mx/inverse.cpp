@@ -40,6 +40,45 @@ namespace casadi {
     return "inv(" + arg.at(0) + ")";
   }
 
+  void Inverse::evalD(const double** arg, double** res, int* iw, double* w) {
+    // Dense copy of the argument, factorized in-place
+    int n = dep().size1();
+    const Sparsity& sp = dep().sparsity();
+    if (sp.isdense()) {
+      copy(arg[0], arg[0]+n*n, w);
+    } else {
+      fill(w, w+n*n, 0.);
+      const int* colind = sp.colind();
+      const int* row = sp.row();
+      for (int c=0; c<n; ++c) {
+        for (int k=colind[c]; k<colind[c+1]; ++k) w[row[k]+c*n] = arg[0][k];
+      }
+    }
+    casadi_getrf(w, n, iw);
+
+    // Solve for the columns of the identity matrix
+    fill(res[0], res[0]+n*n, 0.);
+    for (int i=0; i<n; ++i) res[0][i*(n+1)] = 1;
+    casadi_getrs(w, n, iw, res[0], n);
+  }
+
+  void Inverse::generate(const std::vector<int>& arg, const std::vector<int>& res,
+                         CodeGenerator& g) const {
+    // Dense copy of the argument, factorized in-place
+    int n = dep().size1();
+    g.addAuxiliary(CodeGenerator::AUX_GETRF);
+    g.body << "  " << g.project(g.work(arg[0], dep().nnz()), dep().sparsity(),
+                                "w", Sparsity::dense(n, n), "w+" + g.to_string(n*n)) << endl;
+    g.body << "  getrf(w, " << n << ", iw);" << endl;
+
+    // Solve for the columns of the identity matrix
+    string r = g.work(res[0], n*n);
+    g.addAuxiliary(CodeGenerator::AUX_GETRS);
+    g.body << "  " << g.fill_n(r, n*n, "0") << endl;
+    g.body << "  for (i=0; i<" << n << "; ++i) " << r << "[i*" << (n+1) << "] = 1;" << endl;
+    g.body << "  getrs(w, " << n << ", iw, " << r << ", " << n << ");" << endl;
+  }
+
   void Inverse::evalMX(const std::vector<MX>& arg, std::vector<MX>& res) {
     res[0] = inv(arg[0]);
   }
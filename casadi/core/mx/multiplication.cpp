@@ -43,6 +43,28 @@ namespace casadi {
 
     setDependencies(z, x, y);
     setSparsity(z.sparsity());
+    kernel_ = getKernel(z.sparsity(), x.sparsity(), y.sparsity());
+  }
+
+  Multiplication::Kernel Multiplication::getKernel(const Sparsity& z, const Sparsity& x,
+                                                   const Sparsity& y) {
+    // Scaling of the rows or the columns
+    if (x.isdiag() && z==y) return MM_LDIAG;
+    if (y.isdiag() && z==x) return MM_RDIAG;
+
+    // The remaining kernels write to a dense result
+    if (!z.isdense()) return MM_SPARSE;
+    if (x.isdense()) return MM_DENSE_SPARSE;
+    if (!y.isdense()) return MM_SPARSE;
+
+    // Banded, triangular, block diagonal: nonzeros in each column on consecutive rows
+    const int* colind = x.colind();
+    const int* row = x.row();
+    for (int cc=0; cc<x.size2(); ++cc) {
+      int n = colind[cc+1]-colind[cc];
+      if (n>0 && row[colind[cc]+n-1]-row[colind[cc]]!=n-1) return MM_SPARSE;
+    }
+    return MM_BAND;
   }
 
   std::string Multiplication::print(const std::vector<std::string>& arg) const {
@@ -61,9 +83,24 @@ namespace casadi {
   template<typename T>
   void Multiplication::evalGen(const T** arg, T** res, int* iw, T* w) {
     if (arg[0]!=res[0]) copy(arg[0], arg[0]+dep(0).nnz(), res[0]);
-    casadi_mm_sparse(arg[1], dep(1).sparsity(),
-                     arg[2], dep(2).sparsity(),
-                     res[0], sparsity(), w);
+    switch (kernel_) {
+    case MM_LDIAG:
+      casadi_mm_ldiag(arg[1], arg[2], dep(2).sparsity(), res[0]);
+      break;
+    case MM_RDIAG:
+      casadi_mm_rdiag(arg[1], dep(1).sparsity(), arg[2], res[0]);
+      break;
+    case MM_DENSE_SPARSE:
+      casadi_mm_dense_sparse(arg[1], dep(1).size1(), arg[2], dep(2).sparsity(), res[0]);
+      break;
+    case MM_BAND:
+      casadi_mm_band(arg[1], dep(1).sparsity(), arg[2], dep(2).size2(), res[0]);
+      break;
+    default:
+      casadi_mm_sparse(arg[1], dep(1).sparsity(),
+                       arg[2], dep(2).sparsity(),
+                       res[0], sparsity(), w);
+    }
   }
 
   void Multiplication::evalFwd(const std::vector<std::vector<MX> >& fseed,
@@ -111,12 +148,42 @@ namespace casadi {
       g.body << "  " << g.copy_n(g.work(arg[0], nnz()), nnz(), g.work(res[0], nnz())) << endl;
     }
 
-    // Perform sparse matrix multiplication
-    g.addAuxiliary(CodeGenerator::AUX_MM_SPARSE);
-    g.body << "  mm_sparse(   ";
-    g.body << g.work(arg[1], dep(1).nnz()) << ", " << g.sparsity(dep(1).sparsity()) << ", ";
-    g.body << g.work(arg[2], dep(2).nnz()) << ", " << g.sparsity(dep(2).sparsity()) << ", ";
-    g.body << g.work(res[0], nnz()) << ", " << g.sparsity(sparsity()) << ", w);" << endl;
+    // Perform the multiplication with the kernel for the sparsity patterns
+    string x = g.work(arg[1], dep(1).nnz()), y = g.work(arg[2], dep(2).nnz());
+    string z = g.work(res[0], nnz());
+    switch (kernel_) {
+    case MM_LDIAG:
+      g.addAuxiliary(CodeGenerator::AUX_MM_LDIAG);
+      g.body << "  mm_ldiag(" << x << ", " << y << ", " << g.sparsity(dep(2).sparsity())
+             << ", " << z << ");" << endl;
+      break;
+    case MM_RDIAG:
+      g.addAuxiliary(CodeGenerator::AUX_MM_RDIAG);
+      g.body << "  mm_rdiag(" << x << ", " << g.sparsity(dep(1).sparsity()) << ", " << y
+             << ", " << z << ");" << endl;
+      break;
+    case MM_DENSE_SPARSE:
+      g.addAuxiliary(CodeGenerator::AUX_MM_DENSE_SPARSE);
+      g.body << "  mm_dense_sparse(" << x << ", " << dep(1).size1() << ", " << y << ", "
+             << g.sparsity(dep(2).sparsity()) << ", " << z << ");" << endl;
+      break;
+    case MM_BAND:
+      g.addAuxiliary(CodeGenerator::AUX_MM_BAND);
+      g.body << "  mm_band(" << x << ", " << g.sparsity(dep(1).sparsity()) << ", " << y
+             << ", " << dep(2).size2() << ", " << z << ");" << endl;
+      break;
+    default:
+      g.addAuxiliary(CodeGenerator::AUX_MM_SPARSE);
+      g.body << "  mm_sparse(   ";
+      g.body << x << ", " << g.sparsity(dep(1).sparsity()) << ", ";
+      g.body << y << ", " << g.sparsity(dep(2).sparsity()) << ", ";
+      g.body << z << ", " << g.sparsity(sparsity()) << ", w);" << endl;
+    }
+  }
+
+  void DenseMultiplication::evalD(const double** arg, double** res, int* iw, double* w) {
+    if (arg[0]!=res[0]) copy(arg[0], arg[0]+dep(0).nnz(), res[0]);
+    casadi_mm_dense(arg[1], dep(1).size1(), dep(1).size2(), arg[2], dep(2).size2(), res[0]);
   }
 
   void DenseMultiplication::generate(const std::vector<int>& arg, const std::vector<int>& res,
@@ -127,12 +194,12 @@ namespace casadi {
                                  g.work(res[0], nnz())) << endl;
     }
 
-    int nrow_x = dep(1).size1(), nrow_y = dep(2).size1(), ncol_y = dep(2).size2();
-    g.body << "  for (i=0, rr=" << g.work(res[0], nnz()) <<"; i<" << ncol_y << "; ++i)";
-    g.body << " for (j=0; j<" << nrow_x << "; ++j, ++rr)";
-    g.body << " for (k=0, ss=" << g.work(arg[1], dep(1).nnz()) << "+j, tt="
-           << g.work(arg[2], dep(2).nnz()) << "+i*" << nrow_y << "; k<" << nrow_y << "; ++k)";
-    g.body << " *rr += ss[k*" << nrow_x << "]**tt++;" << endl;
+    // Perform dense matrix multiplication
+    g.addAuxiliary(CodeGenerator::AUX_MM_DENSE);
+    g.body << "  mm_dense(" << g.work(arg[1], dep(1).nnz()) << ", "
+           << dep(1).size1() << ", " << dep(1).size2() << ", "
+           << g.work(arg[2], dep(2).nnz()) << ", " << dep(2).size2() << ", "
+           << g.work(res[0], nnz()) << ");" << endl;
   }
 
 } // namespace casadi
@@ -97,6 +97,16 @@ namespace casadi {
 
     /** \brief Get required length of w field */
     virtual size_t sz_w() const { return sparsity().size1();}
+
+    /// Kernels specialized to the sparsity patterns of the factors and the result
+    enum Kernel {MM_SPARSE, MM_LDIAG, MM_RDIAG, MM_DENSE_SPARSE, MM_BAND};
+
+    /// Select a kernel for z + x*y
+    static Kernel getKernel(const Sparsity& z, const Sparsity& x, const Sparsity& y);
+
+  protected:
+    /// Kernel used for numerical evaluation and code generation
+    Kernel kernel_;
   };
 
 
@@ -118,6 +128,9 @@ namespace casadi {
     /** \brief  Clone function */
     virtual DenseMultiplication* clone() const { return new DenseMultiplication(*this);}
 
+    /// Evaluate the function numerically
+    virtual void evalD(const double** arg, double** res, int* iw, double* w);
+
     /** \brief Generate code for the operation */
     virtual void generate(const std::vector<int>& arg, const std::vector<int>& res,
                           CodeGenerator& g) const;
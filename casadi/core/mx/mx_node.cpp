@@ -429,6 +429,10 @@ namespace casadi {
                           << " and x" << x.dimString() << ".");
     if (x.isdense() && y.isdense() && z.isdense()) {
       return MX::create(new DenseMultiplication(z, x, y));
+    } else if (z.isdense() && 2.*x.nnz()>=static_cast<double>(x.size1())*x.size2()
+               && 2.*y.nnz()>=static_cast<double>(y.size1())*y.size2()) {
+      // Nearly dense factors: cheaper to densify and use the dense kernel
+      return MX::create(new DenseMultiplication(z, densify(x), densify(y)));
     } else {
       return MX::create(new Multiplication(z, x, y));
     }
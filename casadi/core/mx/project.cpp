@@ -51,7 +51,13 @@ namespace casadi {
 
   template<typename T>
   void Project::evalGen(const T** arg, T** res, int* iw, T* w) {
-    casadi_project(arg[0], dep().sparsity(), res[0], sparsity(), w);
+    if (sparsity().isdense()) {
+      casadi_densify(arg[0], dep().sparsity(), res[0]);
+    } else if (dep().isdense()) {
+      casadi_sparsify(arg[0], res[0], sparsity());
+    } else {
+      casadi_project(arg[0], dep().sparsity(), res[0], sparsity(), w);
+    }
   }
 
   void Project::evalD(const double** arg, double** res, int* iw, double* w) {
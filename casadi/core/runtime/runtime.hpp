@@ -44,6 +44,14 @@ namespace casadi {
   template<typename real_t>
   void CASADI_PREFIX(project)(const real_t* x, const int* sp_x, real_t* y, const int* sp_y, real_t* w);
 
+  /// Sparse to dense: y <- x, y dense column-major
+  template<typename real_t>
+  void CASADI_PREFIX(densify)(const real_t* x, const int* sp_x, real_t* y);
+
+  /// Dense to sparse: y <- x, x dense column-major
+  template<typename real_t>
+  void CASADI_PREFIX(sparsify)(const real_t* x, real_t* y, const int* sp_y);
+
   /// SCAL: x <- alpha*x
   template<typename real_t>
   void CASADI_PREFIX(scal)(int n, real_t alpha, real_t* x, int inc_x);
@@ -76,6 +84,37 @@ namespace casadi {
   template<typename real_t>
   void CASADI_PREFIX(mm_sparse_t)(const real_t* x, const int* sp_x, const real_t* y, const int* sp_y, real_t* z, const int* sp_z, real_t* w);
 
+  /// Dense matrix-matrix multiplication, column-major, cache-blocked: z <- z + x*y
+  template<typename real_t>
+  void CASADI_PREFIX(mm_dense)(const real_t* x, int nrow_x, int ncol_x, const real_t* y, int ncol_y, real_t* z);
+
+  /// Diagonal times sparse: z <- z + diag(x)*y, z with the sparsity of y
+  template<typename real_t>
+  void CASADI_PREFIX(mm_ldiag)(const real_t* x, const real_t* y, const int* sp_y, real_t* z);
+
+  /// Sparse times diagonal: z <- z + x*diag(y), z with the sparsity of x
+  template<typename real_t>
+  void CASADI_PREFIX(mm_rdiag)(const real_t* x, const int* sp_x, const real_t* y, real_t* z);
+
+  /// Dense times sparse, dense result, column-major: z <- z + x*y
+  template<typename real_t>
+  void CASADI_PREFIX(mm_dense_sparse)(const real_t* x, int nrow_x, const real_t* y, const int* sp_y, real_t* z);
+
+  /** Banded times dense, dense result, column-major: z <- z + x*y
+   * The nonzeros in each column of x must have consecutive rows, as in banded,
+   * triangular or block diagonal matrices with dense blocks
+   */
+  template<typename real_t>
+  void CASADI_PREFIX(mm_band)(const real_t* x, const int* sp_x, const real_t* y, int ncol_y, real_t* z);
+
+  /// Dense LU factorization with partial pivoting, column-major, in-place
+  template<typename real_t>
+  void CASADI_PREFIX(getrf)(real_t* a, int n, int* ipiv);
+
+  /// Solve with a dense LU factorization from getrf: x <- inv(A)*x for nrhs right-hand sides
+  template<typename real_t>
+  void CASADI_PREFIX(getrs)(const real_t* lu, int n, const int* ipiv, real_t* x, int nrhs);
+
   /// Sparse matrix-vector multiplication: z <- z + x*y
   template<typename real_t>
   void CASADI_PREFIX(mv)(const real_t* x, const int* sp_x, const real_t* y, real_t* z);
@@ -164,6 +203,27 @@ namespace casadi {
     }
   }
 
+  template<typename real_t>
+  void CASADI_PREFIX(densify)(const real_t* x, const int* sp_x, real_t* y) {
+    int nrow_x = sp_x[0], ncol_x = sp_x[1];
+    const int *colind_x = sp_x+2, *row_x = sp_x + 2 + ncol_x+1;
+    int i, el;
+    for (i=0; i<ncol_x; ++i, y+=nrow_x) {
+      for (el=0; el<nrow_x; ++el) y[el] = 0;
+      for (el=colind_x[i]; el<colind_x[i+1]; ++el) y[row_x[el]] = x[el];
+    }
+  }
+
+  template<typename real_t>
+  void CASADI_PREFIX(sparsify)(const real_t* x, real_t* y, const int* sp_y) {
+    int nrow_y = sp_y[0], ncol_y = sp_y[1];
+    const int *colind_y = sp_y+2, *row_y = sp_y + 2 + ncol_y+1;
+    int i, el;
+    for (i=0; i<ncol_y; ++i, x+=nrow_y) {
+      for (el=colind_y[i]; el<colind_y[i+1]; ++el) y[el] = x[row_y[el]];
+    }
+  }
+
   template<typename real_t>
   void CASADI_PREFIX(scal)(int n, real_t alpha, real_t* x, int inc_x) {
     int i;
@@ -285,6 +345,169 @@ namespace casadi {
     }
   }
 
+  template<typename real_t>
+  void CASADI_PREFIX(mm_dense)(const real_t* x, int nrow_x, int ncol_x, const real_t* y, int ncol_y, real_t* z) {
+    /* Blocks of rows of z, each column of z updated with four columns of x at a time */
+    int i, j, k, i0, i1;
+    const real_t *x0, *x1, *x2, *x3, *yj;
+    real_t *zj, y0, y1, y2, y3;
+    for (i0=0; i0<nrow_x; i0+=256) {
+      i1 = i0+256<nrow_x ? i0+256 : nrow_x;
+      for (j=0, zj=z, yj=y; j<ncol_y; ++j, zj+=nrow_x, yj+=ncol_x) {
+        for (k=0; k+4<=ncol_x; k+=4) {
+          x0 = x + k*nrow_x;
+          x1 = x0 + nrow_x;
+          x2 = x1 + nrow_x;
+          x3 = x2 + nrow_x;
+          y0 = yj[k];
+          y1 = yj[k+1];
+          y2 = yj[k+2];
+          y3 = yj[k+3];
+          for (i=i0; i<i1; ++i) zj[i] += x0[i]*y0 + x1[i]*y1 + x2[i]*y2 + x3[i]*y3;
+        }
+        for (; k<ncol_x; ++k) {
+          x0 = x + k*nrow_x;
+          y0 = yj[k];
+          for (i=i0; i<i1; ++i) zj[i] += x0[i]*y0;
+        }
+      }
+    }
+  }
+
+  template<typename real_t>
+  void CASADI_PREFIX(mm_ldiag)(const real_t* x, const real_t* y, const int* sp_y, real_t* z) {
+    int nrow_y = sp_y[0], ncol_y = sp_y[1];
+    const int *colind_y = sp_y+2, *row_y = sp_y + 2 + ncol_y+1;
+    int i, j, el;
+    if (colind_y[ncol_y]==nrow_y*ncol_y) {
+      /* Dense y: unit stride, no row indices */
+      for (j=0; j<ncol_y; ++j, y+=nrow_y, z+=nrow_y) {
+        for (i=0; i<nrow_y; ++i) z[i] += x[i]*y[i];
+      }
+    } else {
+      for (el=0; el<colind_y[ncol_y]; ++el) z[el] += x[row_y[el]]*y[el];
+    }
+  }
+
+  template<typename real_t>
+  void CASADI_PREFIX(mm_rdiag)(const real_t* x, const int* sp_x, const real_t* y, real_t* z) {
+    int ncol_x = sp_x[1];
+    const int *colind_x = sp_x+2;
+    int j, el;
+    real_t t;
+    for (j=0; j<ncol_x; ++j) {
+      t = y[j];
+      for (el=colind_x[j]; el<colind_x[j+1]; ++el) z[el] += x[el]*t;
+    }
+  }
+
+  template<typename real_t>
+  void CASADI_PREFIX(mm_dense_sparse)(const real_t* x, int nrow_x, const real_t* y, const int* sp_y, real_t* z) {
+    int ncol_y = sp_y[1];
+    const int *colind_y = sp_y+2, *row_y = sp_y + 2 + ncol_y+1;
+    /* Each column of z updated with four columns of x at a time */
+    int i, j, el;
+    const real_t *x0, *x1, *x2, *x3;
+    real_t y0, y1, y2, y3;
+    for (j=0; j<ncol_y; ++j, z+=nrow_x) {
+      for (el=colind_y[j]; el+4<=colind_y[j+1]; el+=4) {
+        x0 = x + row_y[el]*nrow_x;
+        x1 = x + row_y[el+1]*nrow_x;
+        x2 = x + row_y[el+2]*nrow_x;
+        x3 = x + row_y[el+3]*nrow_x;
+        y0 = y[el];
+        y1 = y[el+1];
+        y2 = y[el+2];
+        y3 = y[el+3];
+        for (i=0; i<nrow_x; ++i) z[i] += x0[i]*y0 + x1[i]*y1 + x2[i]*y2 + x3[i]*y3;
+      }
+      for (; el<colind_y[j+1]; ++el) {
+        x0 = x + row_y[el]*nrow_x;
+        y0 = y[el];
+        for (i=0; i<nrow_x; ++i) z[i] += x0[i]*y0;
+      }
+    }
+  }
+
+  template<typename real_t>
+  void CASADI_PREFIX(mm_band)(const real_t* x, const int* sp_x, const real_t* y, int ncol_y, real_t* z) {
+    int nrow_x = sp_x[0], ncol_x = sp_x[1];
+    const int *colind_x = sp_x+2, *row_x = sp_x + 2 + ncol_x+1;
+    /* Columns of x are contiguous segments: unit stride, no row indices */
+    int i, j, k, n;
+    const real_t *xk;
+    real_t *zk, t;
+    for (j=0; j<ncol_y; ++j, y+=ncol_x, z+=nrow_x) {
+      for (k=0; k<ncol_x; ++k) {
+        n = colind_x[k+1]-colind_x[k];
+        if (n==0) continue;
+        t = y[k];
+        xk = x + colind_x[k];
+        zk = z + row_x[colind_x[k]];
+        for (i=0; i<n; ++i) zk[i] += xk[i]*t;
+      }
+    }
+  }
+
+  template<typename real_t>
+  void CASADI_PREFIX(getrf)(real_t* a, int n, int* ipiv) {
+    /* Right-looking elimination, one column at a time */
+    int i, j, k, p;
+    real_t t, *ak, *aj;
+    for (k=0, ak=a; k<n; ++k, ak+=n) {
+      /* Pivot: largest entry on or below the diagonal */
+      p = k;
+      for (i=k+1; i<n; ++i) if (fabs(ak[i])>fabs(ak[p])) p = i;
+      ipiv[k] = p;
+      if (ak[p]==0) continue;
+      /* Interchange rows k and p */
+      if (p!=k) {
+        for (j=0, aj=a; j<n; ++j, aj+=n) {
+          t = aj[k];
+          aj[k] = aj[p];
+          aj[p] = t;
+        }
+      }
+      /* Multipliers */
+      t = 1/ak[k];
+      for (i=k+1; i<n; ++i) ak[i] *= t;
+      /* Update the trailing submatrix */
+      for (j=k+1, aj=ak+n; j<n; ++j, aj+=n) {
+        t = aj[k];
+        for (i=k+1; i<n; ++i) aj[i] -= ak[i]*t;
+      }
+    }
+  }
+
+  template<typename real_t>
+  void CASADI_PREFIX(getrs)(const real_t* lu, int n, const int* ipiv, real_t* x, int nrhs) {
+    int i, j, k;
+    real_t t;
+    const real_t* lk;
+    for (j=0; j<nrhs; ++j, x+=n) {
+      /* Row interchanges */
+      for (k=0; k<n; ++k) {
+        if (ipiv[k]!=k) {
+          t = x[k];
+          x[k] = x[ipiv[k]];
+          x[ipiv[k]] = t;
+        }
+      }
+      /* Forward substitution, unit lower triangular factor */
+      for (k=0, lk=lu; k<n; ++k, lk+=n) {
+        t = x[k];
+        for (i=k+1; i<n; ++i) x[i] -= lk[i]*t;
+      }
+      /* Backward substitution, upper triangular factor */
+      for (k=n-1; k>=0; --k) {
+        lk = lu + k*n;
+        x[k] /= lk[k];
+        t = x[k];
+        for (i=0; i<k; ++i) x[i] -= lk[i]*t;
+      }
+    }
+  }
+
   template<typename real_t>
   void CASADI_PREFIX(mv)(const real_t* x, const int* sp_x, const real_t* y, real_t* z) {
     /* Get sparsities */
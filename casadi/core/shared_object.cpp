@@ -93,11 +93,22 @@ namespace casadi {
   }
 
   void SharedObject::count_up() {
-    if (node) node->count++;
+    if (!node) return;
+#ifdef USE_CXX11
+    node->count++;
+#else // USE_CXX11
+    __sync_add_and_fetch(&node->count, 1);
+#endif // USE_CXX11
   }
 
   void SharedObject::count_down() {
-    if (node && --node->count == 0) {
+    if (!node) return;
+#ifdef USE_CXX11
+    unsigned int count = --node->count;
+#else // USE_CXX11
+    unsigned int count = __sync_sub_and_fetch(&node->count, 1);
+#endif // USE_CXX11
+    if (count == 0) {
       delete node;
       node = 0;
     }
@@ -125,10 +136,30 @@ namespace casadi {
       std::cerr << "Reference counting failure." <<
                    "Possible cause: Circular dependency in user code." << std::endl;
     }
+    killWeak();
+  }
+
+  void SharedObjectNode::killWeak() {
     if (weak_ref_!=0) {
       weak_ref_->kill();
       delete weak_ref_;
+      weak_ref_ = 0;
+    }
+  }
+
+  bool SharedObjectNode::countUpIfAlive() {
+#ifdef USE_CXX11
+    unsigned int c = count.load();
+    while (c!=0 && !count.compare_exchange_weak(c, c+1)) {}
+#else // USE_CXX11
+    unsigned int c = count;
+    while (c!=0) {
+      unsigned int c_old = __sync_val_compare_and_swap(&count, c, c+1);
+      if (c_old==c) break;
+      c = c_old;
     }
+#endif // USE_CXX11
+    return c!=0;
   }
 
   void SharedObject::init(bool allow_reinit) {
@@ -30,6 +30,9 @@
 #include "casadi_exception.hpp"
 #include <map>
 #include <vector>
+#ifdef USE_CXX11
+#include <atomic>
+#endif // USE_CXX11
 
 namespace casadi {
 
@@ -200,6 +203,7 @@ namespace casadi {
   /// Internal class for the reference counting framework, see comments on the public class.
   class CASADI_EXPORT SharedObjectNode {
     friend class SharedObject;
+    friend class WeakRef;
   public:
 
     /// Default constructor
@@ -264,12 +268,25 @@ namespace casadi {
     template<class B>
     const B shared_from_this() const;
 
+    /// Invalidate the weak reference to the object, if any, before the destructor does it
+    void killWeak();
+
     /// Has the function been initialized?
     bool is_init_;
 
   private:
-    /// Number of references pointing to the object
+    /** \brief Increase the reference count, unless it has reached zero
+     *
+     * A count of zero means that the object is being deleted, possibly by another thread
+     */
+    bool countUpIfAlive();
+
+    /// Number of references pointing to the object, updated atomically
+#ifdef USE_CXX11
+    std::atomic<unsigned int> count;
+#else // USE_CXX11
     unsigned int count;
+#endif // USE_CXX11
 
     /// Weak pointer (non-owning) object for the object
     WeakRef* weak_ref_;
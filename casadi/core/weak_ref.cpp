@@ -39,8 +39,9 @@ namespace casadi {
 
   SharedObject WeakRef::shared() {
     SharedObject ret;
-    if (alive()) {
-      ret.assignNode((*this)->raw_);
+    // The count is zero if the object is being deleted by another thread
+    if (alive() && (*this)->raw_->countUpIfAlive()) {
+      ret.assignNodeNoCount((*this)->raw_);
     }
     return ret;
   }
@@ -51,7 +51,7 @@ namespace casadi {
     /** \brief Construct from a shared object (also implicit type conversion) */
     WeakRef(SharedObject shared);
 
-    /** \brief Get a shared (owning) reference */
+    /** \brief Get a shared (owning) reference, null if the object has been deleted */
     SharedObject shared();
 
     /** \brief Check if alive */
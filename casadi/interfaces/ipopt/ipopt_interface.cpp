@@ -318,11 +318,7 @@ namespace casadi {
 #endif // WITH_SIPOPT
 
     // Get/generate required functions
-    gradF();
-    jacG();
-    if (exact_hessian_) {
-      hessLag();
-    }
+    initDerivatives(exact_hessian_);
 
     // Start an IPOPT application
     Ipopt::SmartPtr<Ipopt::IpoptApplication> *app = new Ipopt::SmartPtr<Ipopt::IpoptApplication>();
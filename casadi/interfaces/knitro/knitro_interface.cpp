@@ -163,11 +163,7 @@ namespace casadi {
     if (hasSetOption("Debug")) int_param_["debug"] = getOption("Debug");
 
     // Get/generate required functions
-    gradF();
-    jacG();
-    if (true) { // NOTE: should be only if HessOpt
-      hessLag();
-    }
+    initDerivatives(true); // NOTE: should be only if HessOpt
 
     // Commented out since I have not found out how to change the bounds
     // Allocate KNITRO memory block
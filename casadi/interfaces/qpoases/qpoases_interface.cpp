@@ -26,6 +26,7 @@
 #include "qpoases_interface.hpp"
 
 #include "../../core/std_vector_tools.hpp"
+#include "../../core/profiling.hpp"
 
 // Bug in qpOASES?
 #define ALLOW_QPROBLEMB true
@@ -169,6 +170,11 @@ namespace casadi {
     // Create data for A
     a_data_.resize(n_*nc_);
 
+    // Matrices of the last call
+    h_last_.resize(n_*n_);
+    a_last_.resize(n_*nc_);
+    ws_guess_.clear();
+
     // Dual solution vector
     dual_.resize(n_+nc_);
 
@@ -261,25 +267,85 @@ namespace casadi {
     const double* lbA = getPtr(input(QP_SOLVER_LBA));
     const double* ubA = getPtr(input(QP_SOLVER_UBA));
 
+    // Can the factorization of the last call be reused?
+    bool same_matrices = called_once_ && nc_>0
+      && std::equal(h_last_.begin(), h_last_.end(), h)
+      && std::equal(a_last_.begin(), a_last_.end(), a);
+
+    // Working set guess, if any
+    bool guess = !ws_guess_.empty();
+    qpOASES::Bounds guessed_bounds;
+    qpOASES::Constraints guessed_constraints;
+    if (guess) {
+      guessed_bounds.init(n_);
+      for (int i=0; i<n_; ++i) {
+        guessed_bounds.setupBound(i, int_to_SubjectToStatus(ws_guess_[i]));
+      }
+      if (nc_>0) {
+        guessed_constraints.init(nc_);
+        for (int i=0; i<nc_; ++i) {
+          guessed_constraints.setupConstraint(i, int_to_SubjectToStatus(ws_guess_[n_+i]));
+        }
+      }
+      // Only used once
+      ws_guess_.clear();
+    }
+
+    double time_start = getRealTime();
     int flag;
-    if (!called_once_) {
+    if (guess) {
+      if (nc_==0) {
+        qpOASES::QProblemB* qp = static_cast<qpOASES::QProblemB*>(qp_);
+        if (called_once_) qp->reset();
+        flag = qp->init(h, g, lb, ub, nWSR, cputime_ptr, 0, 0, &guessed_bounds);
+      } else if (same_matrices) {
+        flag = static_cast<qpOASES::SQProblem*>(qp_)->hotstart(g, lb, ub, lbA, ubA,
+                                                               nWSR, cputime_ptr,
+                                                               &guessed_bounds,
+                                                               &guessed_constraints);
+      } else {
+        qpOASES::SQProblem* qp = static_cast<qpOASES::SQProblem*>(qp_);
+        if (called_once_) qp->reset();
+        flag = qp->init(h, g, a, lb, ub, lbA, ubA, nWSR, cputime_ptr, 0, 0,
+                        &guessed_bounds, &guessed_constraints);
+      }
+    } else if (!called_once_) {
       if (nc_==0) {
         flag = static_cast<qpOASES::QProblemB*>(qp_)->init(h, g, lb, ub, nWSR, cputime_ptr);
       } else {
         flag = static_cast<qpOASES::SQProblem*>(qp_)->init(h, g, a, lb, ub, lbA, ubA,
                                                            nWSR, cputime_ptr);
       }
-      called_once_ = true;
     } else {
       if (nc_==0) {
         static_cast<qpOASES::QProblemB*>(qp_)->reset();
         flag = static_cast<qpOASES::QProblemB*>(qp_)->init(h, g, lb, ub, nWSR, cputime_ptr);
         //flag = static_cast<qpOASES::QProblemB*>(qp_)->hotstart(g, lb, ub, nWSR, cputime_ptr);
+      } else if (same_matrices) {
+        // Reuse the factorization of the last call
+        flag = static_cast<qpOASES::SQProblem*>(qp_)->hotstart(g, lb, ub, lbA, ubA,
+                                                               nWSR, cputime_ptr);
       } else {
         flag = static_cast<qpOASES::SQProblem*>(qp_)->hotstart(h, g, a, lb, ub, lbA, ubA,
                                                                nWSR, cputime_ptr);
       }
     }
+
+    // Statistics
+    stats_["t_solve"] = getRealTime() - time_start;
+    stats_["nWSR"] = nWSR;
+    stats_["hotstart"] = called_once_ && (nc_>0 || guess);
+    stats_["working_set_guess"] = guess;
+    stats_["factorization_reused"] = same_matrices;
+    stats_["return_status"] = getErrorMessage(flag);
+    called_once_ = true;
+
+    // Save matrices for the next call
+    if (nc_>0) {
+      copy(h, h+n_*n_, h_last_.begin());
+      copy(a, a+n_*nc_, a_last_.begin());
+    }
+
     if (flag!=qpOASES::SUCCESSFUL_RETURN && flag!=qpOASES::RET_MAX_NWSR_REACHED) {
       throw CasadiException("qpOASES failed: " + getErrorMessage(flag));
     }
@@ -298,6 +364,50 @@ namespace casadi {
     transform(dual_.begin()+n_, dual_.end(),     output(QP_SOLVER_LAM_A).begin(), negate<double>());
   }
 
+  std::vector<int> QpoasesInterface::getWorkingSet() const {
+    casadi_assert_message(called_once_, "QpoasesInterface::getWorkingSet: No QP solved yet");
+    std::vector<int> ws(n_+nc_);
+    qpOASES::Bounds bounds;
+    qp_->getBounds(bounds);
+    for (int i=0; i<n_; ++i) ws[i] = SubjectToStatus_to_int(bounds.getStatus(i));
+    if (nc_>0) {
+      qpOASES::Constraints constraints;
+      static_cast<qpOASES::SQProblem*>(qp_)->getConstraints(constraints);
+      for (int i=0; i<nc_; ++i) ws[n_+i] = SubjectToStatus_to_int(constraints.getStatus(i));
+    }
+    return ws;
+  }
+
+  void QpoasesInterface::setWorkingSet(const std::vector<int>& ws) {
+    casadi_assert_message(ws.size()==n_+nc_,
+                          "QpoasesInterface::setWorkingSet: Expecting " << (n_+nc_)
+                          << " entries, but got " << ws.size());
+    ws_guess_ = ws;
+  }
+
+  int QpoasesInterface::SubjectToStatus_to_int(qpOASES::SubjectToStatus b) {
+    switch (b) {
+    case qpOASES::ST_LOWER:
+    case qpOASES::ST_INFEASIBLE_LOWER:
+      return -1;
+    case qpOASES::ST_UPPER:
+    case qpOASES::ST_INFEASIBLE_UPPER:
+      return 1;
+    default:
+      return 0;
+    }
+  }
+
+  qpOASES::SubjectToStatus QpoasesInterface::int_to_SubjectToStatus(int b) {
+    if (b<0) {
+      return qpOASES::ST_LOWER;
+    } else if (b>0) {
+      return qpOASES::ST_UPPER;
+    } else {
+      return qpOASES::ST_INACTIVE;
+    }
+  }
+
   std::string QpoasesInterface::getErrorMessage(int flag) {
     switch (flag) {
     case qpOASES::SUCCESSFUL_RETURN:
@@ -33,6 +33,11 @@
 /** \defgroup plugin_QpSolver_qpoases
 Interface to QPOases Solver for quadratic programming
 
+Consecutive calls are hot-started from the working set of the previous
+call. If H and A are unchanged, the matrix factorization is reused as
+well. The working set can be retrieved with getWorkingSet and passed to
+setWorkingSet of the same or another solver instance to hot-start it.
+
 */
 
 /** \pluginsection{QpSolver,qpoases} */
@@ -73,6 +78,12 @@ public:
 
   virtual void evaluate();
 
+  /// Get the working set after the last solve
+  virtual std::vector<int> getWorkingSet() const;
+
+  /// Set the working set used to hot-start the next solve
+  virtual void setWorkingSet(const std::vector<int>& ws);
+
   /// A documentation string
   static const std::string meta_doc;
 
@@ -91,6 +102,8 @@ public:
     static qpOASES::SubjectToStatus string_to_SubjectToStatus(std::string b);
     static std::string PrintLevel_to_string(qpOASES::PrintLevel b);
     static qpOASES::PrintLevel string_to_PrintLevel(std::string b);
+    static int SubjectToStatus_to_int(qpOASES::SubjectToStatus b);
+    static qpOASES::SubjectToStatus int_to_SubjectToStatus(int b);
     ///@}
 
     /// Number of working set recalculations
@@ -109,6 +122,13 @@ public:
     std::vector<double> h_data_;
     std::vector<double> a_data_;
 
+    /// H and A of the last call, to detect when the factorization can be reused
+    std::vector<double> h_last_;
+    std::vector<double> a_last_;
+
+    /// Working set guess for the next call (empty if none)
+    std::vector<int> ws_guess_;
+
     /// Temporary vector holding the dual solution
     std::vector<double> dual_;
 
@@ -30,6 +30,11 @@
       "\n"
 "Interface to QPOases Solver for quadratic programming\n"
 "\n"
+"Consecutive calls are hot-started from the working set of the previous\n"
+"call. If H and A are unchanged, the matrix factorization is reused as\n"
+"well. The working set can be retrieved with getWorkingSet and passed to\n"
+"setWorkingSet of the same or another solver instance to hot-start it.\n"
+"\n"
 "\n"
 ">List of available options\n"
 "\n"
@@ -220,6 +225,25 @@
 "+-----------------+-----------------+-----------------+-----------------+\n"
 "\n"
 "\n"
+">List of available stats\n"
+"\n"
+"+----------------------+\n"
+"|          Id          |\n"
+"+======================+\n"
+"| factorization_reused |\n"
+"+----------------------+\n"
+"| hotstart             |\n"
+"+----------------------+\n"
+"| nWSR                 |\n"
+"+----------------------+\n"
+"| return_status        |\n"
+"+----------------------+\n"
+"| t_solve              |\n"
+"+----------------------+\n"
+"| working_set_guess    |\n"
+"+----------------------+\n"
+"\n"
+"\n"
 "\n"
 "\n"
 ;
@@ -54,6 +54,8 @@ namespace casadi {
     node->setOption(dictionary());
     node->jac_ = jac_;
     node->linsol_ = linsol_;
+    node->nfsens_ = nfsens_;
+    node->fsens_parent_ = fsens_parent_;
     return node;
   }
 
@@ -64,6 +66,9 @@ namespace casadi {
               "", "newton|functional");
     addOption("fsens_all_at_once",                OT_BOOLEAN,             true,
               "Calculate all right hand sides of the sensitivity equations at once");
+    addOption("fsens_native",                     OT_BOOLEAN,             true,
+              "Calculate forward derivatives with the sensitivity module of CVodes "
+              "rather than by integrating the augmented ODE");
     addOption("disable_internal_warnings",        OT_BOOLEAN,             false,
               "Disable CVodes internal warning messages");
     addOption("monitor",                          OT_STRINGVECTOR,        GenericType(),
@@ -76,6 +81,8 @@ namespace casadi {
 
     isInitAdj_ = false;
     disable_internal_warnings_ = false;
+    nfsens_ = 0;
+    fsens_batch_ = 0;
   }
 
   void CvodesInterface::freeCVodes() {
@@ -110,6 +117,9 @@ namespace casadi {
     // Free memory if already initialized
     if (isInit()) freeCVodes();
 
+    // Forward sensitivities are stacked horizontally after the nondifferentiated problem
+    ensemble_ = 1 + nfsens_;
+
     // Initialize the base classes
     SundialsInterface::init();
 
@@ -118,10 +128,25 @@ namespace casadi {
                           "CVODES does not support algebraic variables");
 
     // Read options
+    fsens_native_ = getOption("fsens_native");
     monitor_rhsB_  = monitored("resB");
     monitor_rhs_   = monitored("res");
     monitor_rhsQB_ = monitored("resQB");
 
+    // Saved Jacobians and positions of the diagonal in the Newton matrices
+    if (!jac_.isNull()) {
+      jac_nz_.resize(jac_.output().nnz());
+      jac_.output().sparsity().getDiag(jac_diag_);
+      casadi_assert(jac_diag_.size()==nx_);
+    }
+    if (!jacB_.isNull()) {
+      jacB_nz_.resize(jacB_.output().nnz());
+      jacB_.output().sparsity().getDiag(jacB_diag_);
+      casadi_assert(jacB_diag_.size()==nrx_);
+    }
+    nstlj_ = nstljB_ = 0;
+    njac_ = njacB_ = 0;
+
     // Sundials return flag
     int flag;
 
@@ -206,82 +231,79 @@ namespace casadi {
     }
 
     // Forward sensitivity problem
-    // if (nfdir_>0) {
-    //   // Allocate n-vectors
-    //   xF0_.resize(nfdir_, 0);
-    //   xF_.resize(nfdir_, 0);
-    //   for (int i=0; i<nfdir_; ++i) {
-    //     xF0_[i] = N_VMake_Serial(nx_, fwdSeed(INTEGRATOR_X0, i).ptr());
-    //     xF_[i] = N_VMake_Serial(nx_, fwdSens(INTEGRATOR_XF, i).ptr());
-    //   }
-
-    //   // Allocate n-vectors for quadratures
-    //   if (nq_>0) {
-    //     qF_.resize(nfdir_, 0);
-    //     for (int i=0; i<nfdir_; ++i) {
-    //       qF_[i] = N_VMake_Serial(nq_, fwdSens(INTEGRATOR_QF, i).ptr());
-    //     }
-    //   }
-
-    //   // Calculate all forward sensitivity right hand sides at once?
-    //   bool all_at_once = getOption("fsens_all_at_once");
-
-    //   // Get the sensitivity method
-    //   if (getOption("sensitivity_method")=="simultaneous") ism_ = CV_SIMULTANEOUS;
-    //   else if (getOption("sensitivity_method")=="staggered")
-    //             ism_ = all_at_once ? CV_STAGGERED : CV_STAGGERED1;
-    //   else throw CasadiException("CVodes: Unknown sensitivity method");
-
-    //   // Initialize forward sensitivities
-    //   if (finite_difference_fsens_) {
-    //     // Use finite differences to calculate the residual in the forward sensitivity equations
-    //     if (all_at_once) {
-    //       flag = CVodeSensInit(mem_, nfdir_, ism_, 0, getPtr(xF0_));
-    //       if (flag != CV_SUCCESS) cvodes_error("CVodeSensInit", flag);
-    //     } else {
-    //       flag = CVodeSensInit1(mem_, nfdir_, ism_, 0, getPtr(xF0_));
-    //       if (flag != CV_SUCCESS) cvodes_error("CVodeSensInit1", flag);
-    //     }
-
-    //     // Pass pointer to parameters
-    //     flag = CVodeSetSensParams(mem_, input(INTEGRATOR_P).ptr(), 0, 0);
-    //     if (flag != CV_SUCCESS) cvodes_error("CVodeSetSensParams", flag);
-
-    //     //  CVodeSetSensDQMethod
-
-    //   } else {
-    //     if (all_at_once) {
-    //       // Use AD to calculate the residual in the forward sensitivity equations
-    //       flag = CVodeSensInit(mem_, nfdir_, ism_, rhsS_wrapper, getPtr(xF0_));
-    //       if (flag != CV_SUCCESS) cvodes_error("CVodeSensInit", flag);
-    //     } else {
-    //       flag = CVodeSensInit1(mem_, nfdir_, ism_, rhsS1_wrapper, getPtr(xF0_));
-    //       if (flag != CV_SUCCESS) cvodes_error("CVodeSensInit", flag);
-    //     }
-    //   }
-
-    //   // Set tolerances
-    //   vector<double> fsens_abstol(nfdir_, fsens_abstol_);
-
-    //   flag = CVodeSensSStolerances(mem_, fsens_reltol_, getPtr(fsens_abstol));
-    //   if (flag != CV_SUCCESS) cvodes_error("CVodeSensSStolerances", flag);
-
-    //   // Set optional inputs
-    //   bool errconS = getOption("fsens_err_con");
-    //   flag = CVodeSetSensErrCon(mem_, errconS);
-    //   if (flag != CV_SUCCESS) cvodes_error("CVodeSetSensErrCon", flag);
-
-    //   // Quadrature equations
-    //   if (nq_>0) {
-    //     for (vector<N_Vector>::iterator it=qF_.begin(); it!=qF_.end(); ++it) N_VConst(0.0, *it);
-    //     flag = CVodeQuadSensInit(mem_, rhsQS_wrapper, getPtr(qF_));
-    //     if (flag != CV_SUCCESS) cvodes_error("CVodeQuadSensInit", flag);
-
-    //     // Set tolerances
-    //     flag = CVodeQuadSensSStolerances(mem_, fsens_reltol_, getPtr(fsens_abstol));
-    //     if (flag != CV_SUCCESS) cvodes_error("CVodeQuadSensSStolerances", flag);
-    //   }
-    // } // enable fsens
+    if (nfsens_>0) {
+      casadi_assert_message(g_.isNull(),
+                            "Forward sensitivities of a backward problem not supported");
+
+      // Allocate n-vectors, direction i is column i+1 of the inputs and outputs
+      xF0_.resize(nfsens_, 0);
+      xF_.resize(nfsens_, 0);
+      for (int i=0; i<nfsens_; ++i) {
+        xF0_[i] = N_VMake_Serial(nx_, input(INTEGRATOR_X0).ptr() + (i+1)*nx_);
+        xF_[i] = N_VMake_Serial(nx_, output(INTEGRATOR_XF).ptr() + (i+1)*nx_);
+      }
+
+      // Allocate n-vectors for quadratures
+      if (nq_>0) {
+        qF_.resize(nfsens_, 0);
+        for (int i=0; i<nfsens_; ++i) {
+          qF_[i] = N_VMake_Serial(nq_, output(INTEGRATOR_QF).ptr() + (i+1)*nq_);
+        }
+      }
+
+      // Calculate all forward sensitivity right hand sides at once?
+      bool all_at_once = getOption("fsens_all_at_once");
+
+      // Get the sensitivity method
+      if (getOption("sensitivity_method")=="simultaneous") ism_ = CV_SIMULTANEOUS;
+      else if (getOption("sensitivity_method")=="staggered")
+        ism_ = all_at_once ? CV_STAGGERED : CV_STAGGERED1;
+      else
+        throw CasadiException("CVodes: Unknown sensitivity method");
+
+      // Directional derivatives of the right hand side, all directions in one call if possible
+      fsens_batch_ = all_at_once ? nfsens_ : 1;
+      f_fsens_ = f_.derForward(fsens_batch_);
+      alloc(f_fsens_);
+      alloc();
+
+      // Initialize forward sensitivities
+      if (all_at_once) {
+        flag = CVodeSensInit(mem_, nfsens_, ism_, rhsS_wrapper, getPtr(xF0_));
+        if (flag != CV_SUCCESS) cvodes_error("CVodeSensInit", flag);
+      } else {
+        flag = CVodeSensInit1(mem_, nfsens_, ism_, rhsS1_wrapper, getPtr(xF0_));
+        if (flag != CV_SUCCESS) cvodes_error("CVodeSensInit1", flag);
+      }
+
+      // Set tolerances
+      vector<double> fsens_abstol(nfsens_, fsens_abstol_);
+      flag = CVodeSensSStolerances(mem_, fsens_reltol_, getPtr(fsens_abstol));
+      if (flag != CV_SUCCESS) cvodes_error("CVodeSensSStolerances", flag);
+
+      // Set optional inputs
+      bool errconS = getOption("fsens_err_con");
+      flag = CVodeSetSensErrCon(mem_, errconS);
+      if (flag != CV_SUCCESS) cvodes_error("CVodeSetSensErrCon", flag);
+
+      // Quadrature equations
+      if (nq_>0) {
+        for (vector<N_Vector>::iterator it=qF_.begin(); it!=qF_.end(); ++it) N_VConst(0.0, *it);
+        flag = CVodeQuadSensInit(mem_, rhsQS_wrapper, getPtr(qF_));
+        if (flag != CV_SUCCESS) cvodes_error("CVodeQuadSensInit", flag);
+
+        // CVodeQuadSensInit sets the user data of fS instead of fQS
+        static_cast<CVodeMem>(mem_)->cv_fQS_data = this;
+
+        if (getOption("quad_err_con").toInt()) {
+          flag = CVodeSetQuadSensErrCon(mem_, true);
+          if (flag != CV_SUCCESS) cvodes_error("CVodeSetQuadSensErrCon", flag);
+
+          flag = CVodeQuadSensSStolerances(mem_, fsens_reltol_, getPtr(fsens_abstol));
+          if (flag != CV_SUCCESS) cvodes_error("CVodeQuadSensSStolerances", flag);
+        }
+      }
+    }
 
     // Adjoint sensitivity problem
     if (!g_.isNull()) {
@@ -378,26 +400,19 @@ namespace casadi {
     // Get time
     time1 = clock();
 
-    // Pass input
-    f_.setInputNZ(&t, DAE_T);
-    f_.setInputNZ(x, DAE_X);
-    f_.setInput(input(INTEGRATOR_P), DAE_P);
-
     if (monitor_rhs_) {
       userOut() << "t       = " << t << endl;
-      userOut() << "x       = " << f_.input(DAE_X) << endl;
-      userOut() << "p       = " << f_.input(DAE_P) << endl;
+      userOut() << "x       = " << vector<double>(x, x+nx_) << endl;
+      userOut() << "p       = " << input(INTEGRATOR_P) << endl;
     }
-    // Evaluate
-    f_.evaluate();
+
+    // Evaluate, writing directly to the result
+    evalF(t, x, 0, xdot, 0, 0);
 
     if (monitor_rhs_) {
-      userOut() << "xdot       = " << f_.output(DAE_ODE)<< endl;
+      userOut() << "xdot       = " << vector<double>(xdot, xdot+nx_) << endl;
     }
 
-    // Get results
-    f_.getOutputNZ(xdot);
-
     // Log time
     time2 = clock();
     t_res += static_cast<double>(time2-time1)/CLOCKS_PER_SEC;
@@ -432,6 +447,7 @@ namespace casadi {
 
     // Reset timers
     t_res = t_fres = t_jac = t_lsolve = t_lsetup_jac = t_lsetup_fac = 0;
+    njac_ = 0;
 
     // Re-initialize
     int flag = CVodeReInit(mem_, t0_, x0_);
@@ -445,20 +461,20 @@ namespace casadi {
     }
 
     // Re-initialize sensitivities
-    // if (nsens>0) {
-    //   flag = CVodeSensReInit(mem_, ism_, getPtr(xF0_));
-    //   if (flag != CV_SUCCESS) cvodes_error("CVodeSensReInit", flag);
-
-    //   if (nq_>0) {
-    //     for (vector<N_Vector>::iterator it=qF_.begin(); it!=qF_.end(); ++it) N_VConst(0.0, *it);
-    //     flag = CVodeQuadSensReInit(mem_, getPtr(qF_));
-    //     if (flag != CV_SUCCESS) cvodes_error("CVodeQuadSensReInit", flag);
-    //   }
-    // } else {
-    // Turn of sensitivities
-    flag = CVodeSensToggleOff(mem_);
-    if (flag != CV_SUCCESS) cvodes_error("CVodeSensToggleOff", flag);
-    // }
+    if (nfsens_>0) {
+      flag = CVodeSensReInit(mem_, ism_, getPtr(xF0_));
+      if (flag != CV_SUCCESS) cvodes_error("CVodeSensReInit", flag);
+
+      if (nq_>0) {
+        for (vector<N_Vector>::iterator it=qF_.begin(); it!=qF_.end(); ++it) N_VConst(0.0, *it);
+        flag = CVodeQuadSensReInit(mem_, getPtr(qF_));
+        if (flag != CV_SUCCESS) cvodes_error("CVodeQuadSensReInit", flag);
+      }
+    } else {
+      // Turn of sensitivities
+      flag = CVodeSensToggleOff(mem_);
+      if (flag != CV_SUCCESS) cvodes_error("CVodeSensToggleOff", flag);
+    }
 
     // Re-initialize backward integration
     if (nrx_>0) {
@@ -505,18 +521,17 @@ namespace casadi {
       if (flag!=CV_SUCCESS) cvodes_error("CVodeGetQuad", flag);
     }
 
-    // if (nsens_>0) {
-    //   // Get the sensitivities
-    //   flag = CVodeGetSens(mem_, &t_, getPtr(xF_));
-    //   if (flag != CV_SUCCESS) cvodes_error("CVodeGetSens", flag);
-
-    //   if (nq_>0) {
-    //     double tret;
-    //     flag = CVodeGetQuadSens(mem_, &tret, getPtr(qF_));
-    //     if (flag != CV_SUCCESS) cvodes_error("CVodeGetQuadSens", flag);
-    //   }
-    // }
+    if (nfsens_>0) {
+      // Get the sensitivities
+      double tret;
+      flag = CVodeGetSens(mem_, &tret, getPtr(xF_));
+      if (flag != CV_SUCCESS) cvodes_error("CVodeGetSens", flag);
 
+      if (nq_>0) {
+        flag = CVodeGetQuadSens(mem_, &tret, getPtr(qF_));
+        if (flag != CV_SUCCESS) cvodes_error("CVodeGetQuadSens", flag);
+      }
+    }
 
     // Print statistics
     if (getOption("print_stats")) printStats(userOut());
@@ -531,7 +546,15 @@ namespace casadi {
 
       stats_["nsteps"] = 1.0*nsteps;
       stats_["nlinsetups"] = 1.0*nlinsetups;
-
+      if (linsol_f_==SD_USER_DEFINED) stats_["njevals"] = 1.0*njac_;
+
+      if (nfsens_>0) {
+        long nfSevals, nfevalsS, netfailsS, nlinsetupsS;
+        flag = CVodeGetSensStats(mem_, &nfSevals, &nfevalsS, &netfailsS, &nlinsetupsS);
+        if (flag!=CV_SUCCESS) cvodes_error("CVodeGetSensStats", flag);
+        stats_["nfSevals"] = 1.0*nfSevals;
+        stats_["t_fres"] = t_fres;
+      }
     }
 
     casadi_msg("CvodesInterface::integrate(" << t_out << ") end");
@@ -542,6 +565,7 @@ namespace casadi {
 
     // Reset the base classes
     SundialsInterface::resetB();
+    njacB_ = 0;
 
     int flag;
     if (isInitAdj_) {
@@ -592,6 +616,7 @@ namespace casadi {
 
       stats_["nstepsB"] = 1.0*nsteps;
       stats_["nlinsetupsB"] = 1.0*nlinsetups;
+      if (linsol_g_==SD_USER_DEFINED) stats_["njevalsB"] = 1.0*njacB_;
 
     }
     casadi_msg("CvodesInterface::integrateB(" << t_out << ") end");
@@ -735,38 +760,48 @@ namespace casadi {
     }
   }
 
+  void CvodesInterface::evalFsens(double t, const double* x, const double* xdot,
+                                  const double* qdot, int offset,
+                                  N_Vector* xF, N_Vector* xdotF, N_Vector* qdotF) {
+    // Arguments, the first nIn() pointers are reserved for the integrator itself
+    const double** arg = getPtr(arg_tmp_) + nIn();
+    fill_n(arg, DAE_NUM_IN + DAE_NUM_OUT, static_cast<const double*>(0));
+    arg[DAE_T] = &t;
+    arg[DAE_X] = x;
+    arg[DAE_P] = input(INTEGRATOR_P).ptr();
+    arg[DAE_NUM_IN + DAE_ODE] = xdot;
+    arg[DAE_NUM_IN + DAE_QUAD] = qdot;
+
+    // Results
+    double** res = getPtr(res_tmp_) + nOut();
+
+    // Forward seeds and sensitivities, the parameter seeds follow the parameters
+    const double** fseed = arg + DAE_NUM_IN + DAE_NUM_OUT;
+    for (int d=0; d<fsens_batch_; ++d) {
+      fseed[DAE_T] = 0;
+      fseed[DAE_X] = NV_DATA_S(xF[d]);
+      fseed[DAE_Z] = 0;
+      fseed[DAE_P] = np_==0 ? 0 : input(INTEGRATOR_P).ptr() + (1+offset+d)*np_;
+      fseed += DAE_NUM_IN;
+      res[DAE_ODE] = xdotF ? NV_DATA_S(xdotF[d]) : 0;
+      res[DAE_ALG] = 0;
+      res[DAE_QUAD] = qdotF ? NV_DATA_S(qdotF[d]) : 0;
+      res += DAE_NUM_OUT;
+    }
+
+    // Evaluate all directions in one call, without copying
+    f_fsens_(arg, getPtr(res_tmp_) + nOut(), getPtr(iw_tmp_), getPtr(w_tmp_));
+  }
+
   void CvodesInterface::rhsS(int Ns, double t, N_Vector x, N_Vector xdot, N_Vector *xF,
                             N_Vector *xdotF, N_Vector tmp1, N_Vector tmp2) {
-    //    casadi_assert(Ns==nfdir_);
+    casadi_assert(Ns==nfsens_ && fsens_batch_==nfsens_);
 
     // Record the current cpu time
     time1 = clock();
 
-    // Commented out since a new implementation currently cannot be tested
-    casadi_error("Commented out, #884, #794.");
-
-    //   // Pass input
-    // f_.setInputNZ(&t, DAE_T);
-    // f_.setInputNZ(NV_DATA_S(x), DAE_X);
-    // f_.setInput(input(INTEGRATOR_P), DAE_P);
-
-    //  // Calculate the forward sensitivities, nfdir_f_ directions at a time
-    //  for (int j=0; j<nfdir_; j += nfdir_f_) {
-    //    for (int dir=0; dir<nfdir_f_ && j+dir<nfdir_; ++dir) {
-    //      // Pass forward seeds
-    //      f_.fwdSeed(DAE_T, dir).setZero();
-    //      f_.setFwdSeed(NV_DATA_S(xF[j+dir]), DAE_X, dir);
-    //      f_.setFwdSeed(fwdSeed(INTEGRATOR_P, j+dir), DAE_P, dir);
-    //    }
-
-    //    // Evaluate the AD forward algorithm
-    //    f_.evaluateOld(nfdir_f_, 0);
-
-    //    // Get the output seeds
-    //    for (int dir=0; dir<nfdir_f_ && j+dir<nfdir_; ++dir) {
-    //      f_.getFwdSens(NV_DATA_S(xdotF[j+dir]), DAE_ODE, dir);
-    //    }
-    //  }
+    // Evaluate, writing directly to the result
+    evalFsens(t, NV_DATA_S(x), NV_DATA_S(xdot), 0, 0, xF, xdotF, 0);
 
     // Record timings
     time2 = clock();
@@ -788,26 +823,17 @@ namespace casadi {
 
   void CvodesInterface::rhsS1(int Ns, double t, N_Vector x, N_Vector xdot, int iS, N_Vector xF,
                              N_Vector xdotF, N_Vector tmp1, N_Vector tmp2) {
-    //    casadi_assert(Ns==nfdir_);
+    casadi_assert(Ns==nfsens_ && fsens_batch_==1);
 
-    // Commented out since a new implementation currently cannot be tested
-    casadi_error("Commented out, #884, #794.");
-
-    // // Pass input
-    // f_.setInputNZ(&t, DAE_T);
-    // f_.setInputNZ(NV_DATA_S(x), DAE_X);
-    // f_.setInput(input(INTEGRATOR_P), DAE_P);
-
-    // // Pass forward seeds
-    // f_.fwdSeed(DAE_T).setZero();
-    // f_.setFwdSeed(NV_DATA_S(xF), DAE_X);
-    // f_.setFwdSeed(fwdSeed(INTEGRATOR_P, iS), DAE_P);
+    // Record the current cpu time
+    time1 = clock();
 
-    // // Evaluate the AD forward algorithm
-    // f_.evaluateOld(1, 0);
+    // Evaluate the direction iS, writing directly to the result
+    evalFsens(t, NV_DATA_S(x), NV_DATA_S(xdot), 0, iS, &xF, &xdotF, 0);
 
-    // // Get the fwd sensitivities
-    // f_.getFwdSens(NV_DATA_S(xdotF));
+    // Record timings
+    time2 = clock();
+    t_fres += static_cast<double>(time2-time1)/CLOCKS_PER_SEC;
   }
 
   int CvodesInterface::rhsS1_wrapper(int Ns, double t, N_Vector x, N_Vector xdot, int iS,
@@ -837,42 +863,25 @@ namespace casadi {
   }
 
   void CvodesInterface::rhsQ(double t, const double* x, double* qdot) {
-    // Pass input
-    f_.setInputNZ(&t, DAE_T);
-    f_.setInputNZ(x, DAE_X);
-    f_.setInput(input(INTEGRATOR_P), DAE_P);
-
-    // Evaluate
-    f_.evaluate();
-
-    // Get results
-    f_.getOutputNZ(qdot, DAE_QUAD);
+    // Evaluate, writing directly to the result
+    evalF(t, x, 0, 0, 0, qdot);
   }
 
   void CvodesInterface::rhsQS(int Ns, double t, N_Vector x, N_Vector *xF, N_Vector qdot,
                              N_Vector *qdotF, N_Vector tmp1, N_Vector tmp2) {
-    //    casadi_assert(Ns==nfdir_);
-
-    // Commented out since a new implementation currently cannot be tested
-    casadi_error("Commented out, #884, #794.");
-
-    // // Pass input
-    // f_.setInputNZ(&t, DAE_T);
-    // f_.setInputNZ(NV_DATA_S(x), DAE_X);
-    // f_.setInput(input(INTEGRATOR_P), DAE_P);
+    casadi_assert(Ns==nfsens_);
 
-    // for (int i=0; i<nfdir_; ++i) {
-    //   // Pass forward seeds
-    //   f_.fwdSeed(DAE_T).setZero();
-    //   f_.setFwdSeed(NV_DATA_S(xF[i]), DAE_X);
-    //   f_.setFwdSeed(fwdSeed(INTEGRATOR_P, i), DAE_P);
+    // Record the current cpu time
+    time1 = clock();
 
-    //   // Evaluate the AD forward algorithm
-    //   f_.evaluateOld(1, 0);
+    // Evaluate, fsens_batch_ directions at a time
+    for (int offset=0; offset<Ns; offset+=fsens_batch_) {
+      evalFsens(t, NV_DATA_S(x), 0, NV_DATA_S(qdot), offset, xF+offset, 0, qdotF+offset);
+    }
 
-    //   // Get the forward sensitivities
-    //   f_.getFwdSens(NV_DATA_S(qdotF[i]), DAE_QUAD);
-    // }
+    // Record timings
+    time2 = clock();
+    t_fres += static_cast<double>(time2-time1)/CLOCKS_PER_SEC;
   }
 
   int CvodesInterface::rhsQS_wrapper(int Ns, double t, N_Vector x, N_Vector *xF, N_Vector qdot,
@@ -897,29 +906,19 @@ namespace casadi {
   void CvodesInterface::rhsB(double t, const double* x, const double *rx, double* rxdot) {
     log("CvodesInterface::rhsB", "begin");
 
-    // Pass inputs
-    g_.setInputNZ(&t, RDAE_T);
-    g_.setInputNZ(x, RDAE_X);
-    g_.setInput(input(INTEGRATOR_P), RDAE_P);
-    g_.setInput(input(INTEGRATOR_RP), RDAE_RP);
-    g_.setInputNZ(rx, RDAE_RX);
-
     if (monitor_rhsB_) {
       userOut() << "t       = " << t << endl;
-      userOut() << "x       = " << g_.input(RDAE_X) << endl;
-      userOut() << "p       = " << g_.input(RDAE_P) << endl;
-      userOut() << "rx      = " << g_.input(RDAE_RX) << endl;
-      userOut() << "rp      = " << g_.input(RDAE_RP) << endl;
+      userOut() << "x       = " << vector<double>(x, x+nx_) << endl;
+      userOut() << "p       = " << input(INTEGRATOR_P) << endl;
+      userOut() << "rx      = " << vector<double>(rx, rx+nrx_) << endl;
+      userOut() << "rp      = " << input(INTEGRATOR_RP) << endl;
     }
 
-    // Evaluate
-    g_.evaluate();
-
-    // Save to output
-    g_.getOutputNZ(rxdot, RDAE_ODE);
+    // Evaluate, writing directly to the result
+    evalG(t, x, 0, rx, 0, rxdot, 0, 0);
 
     if (monitor_rhsB_) {
-      userOut() << "xdotB = " << g_.output(RDAE_ODE) << endl;
+      userOut() << "xdotB = " << vector<double>(rxdot, rxdot+nrx_) << endl;
     }
 
     // Negate (note definition of g)
@@ -1014,29 +1013,19 @@ namespace casadi {
       userOut() << "CvodesInterface::rhsQB: begin" << endl;
     }
 
-    // Pass inputs
-    g_.setInputNZ(&t, RDAE_T);
-    g_.setInputNZ(x, RDAE_X);
-    g_.setInput(input(INTEGRATOR_P), RDAE_P);
-    g_.setInput(input(INTEGRATOR_RP), RDAE_RP);
-    g_.setInputNZ(rx, RDAE_RX);
-
     if (monitor_rhsB_) {
       userOut() << "t       = " << t << endl;
-      userOut() << "x       = " << g_.input(RDAE_X) << endl;
-      userOut() << "p       = " << g_.input(RDAE_P) << endl;
-      userOut() << "rx      = " << g_.input(RDAE_RX) << endl;
-      userOut() << "rp      = " << g_.input(RDAE_RP) << endl;
+      userOut() << "x       = " << vector<double>(x, x+nx_) << endl;
+      userOut() << "p       = " << input(INTEGRATOR_P) << endl;
+      userOut() << "rx      = " << vector<double>(rx, rx+nrx_) << endl;
+      userOut() << "rp      = " << input(INTEGRATOR_RP) << endl;
     }
 
-    // Evaluate
-    g_.evaluate();
-
-    // Save to output
-    g_.getOutputNZ(rqdot, RDAE_QUAD);
+    // Evaluate, writing directly to the result
+    evalG(t, x, 0, rx, 0, 0, 0, rqdot);
 
     if (monitor_rhsB_) {
-      userOut() << "qdotB = " << g_.output(RDAE_QUAD) << endl;
+      userOut() << "qdotB = " << vector<double>(rqdot, rqdot+nrq_) << endl;
     }
 
     // Negate (note definition of g)
@@ -1084,7 +1073,7 @@ namespace casadi {
     // Pass input
     f_fwd_.setInputNZ(&t,                 DAE_T);
     f_fwd_.setInputNZ(NV_DATA_S(x),       DAE_X);
-    f_fwd_.setInput(input(INTEGRATOR_P), DAE_P);
+    f_fwd_.setInputNZ(input(INTEGRATOR_P).ptr(), DAE_P);
 
     // Pass input seeds
     f_fwd_.setInput(0.0,          DAE_NUM_IN + DAE_T);
@@ -1173,7 +1162,7 @@ namespace casadi {
     // Pass inputs to the jacobian function
     jac_.setInputNZ(&t, DAE_T);
     jac_.setInputNZ(NV_DATA_S(x), DAE_X);
-    jac_.setInput(f_.input(DAE_P), DAE_P);
+    jac_.setInputNZ(input(INTEGRATOR_P).ptr(), DAE_P);
     jac_.setInput(1.0, DAE_NUM_IN);
     jac_.setInput(0.0, DAE_NUM_IN+1);
 
@@ -1313,7 +1302,7 @@ namespace casadi {
     // Pass inputs to the jacobian function
     jac_.setInputNZ(&t, DAE_T);
     jac_.setInputNZ(NV_DATA_S(x), DAE_X);
-    jac_.setInput(f_.input(DAE_P), DAE_P);
+    jac_.setInputNZ(input(INTEGRATOR_P).ptr(), DAE_P);
     jac_.setInput(1.0, DAE_NUM_IN);
     jac_.setInput(0.0, DAE_NUM_IN+1);
 
@@ -1515,22 +1504,29 @@ namespace casadi {
     // Get time
     time1 = clock();
 
-    // Pass input to the jacobian function
-    jac_.setInputNZ(&t, DAE_T);
-    jac_.setInputNZ(NV_DATA_S(x), DAE_X);
-    jac_.setInput(input(INTEGRATOR_P), DAE_P);
-    jac_.setInput(-gamma, DAE_NUM_IN);
-    jac_.setInput(1.0, DAE_NUM_IN+1);
+    if (!jok) {
+      // Pass input to the jacobian function
+      jac_.setInputNZ(&t, DAE_T);
+      jac_.setInputNZ(NV_DATA_S(x), DAE_X);
+      jac_.setInputNZ(input(INTEGRATOR_P).ptr(), DAE_P);
+      jac_.setInput(1.0, DAE_NUM_IN);
+      jac_.setInput(0.0, DAE_NUM_IN+1);
 
-    // Evaluate jacobian
-    jac_.evaluate();
+      // Evaluate and save df/dx, on the sparsity pattern of the Newton matrix
+      jac_.evaluate();
+      jac_.getOutputNZ(getPtr(jac_nz_));
+      njac_++;
+    }
+    *jcurPtr = !jok;
 
     // Log time duration
     time2 = clock();
     t_lsetup_jac += static_cast<double>(time2-time1)/CLOCKS_PER_SEC;
 
-    // Pass non-zero elements, scaled by -gamma, to the linear solver
-    linsol_.setInput(jac_.output(), 0);
+    // Pass the non-zero elements of I-gamma*df/dx to the linear solver
+    double* M = linsol_.input(LINSOL_A).ptr();
+    for (int k=0; k<jac_nz_.size(); ++k) M[k] = -gamma*jac_nz_[k];
+    for (int k=0; k<nx_; ++k) M[jac_diag_[k]] += 1;
 
     // Prepare the solution of the linear system (e.g. factorize)
     // -- only if the linear solver inherits from LinearSolver
@@ -1550,37 +1546,43 @@ namespace casadi {
     // Get time
     time1 = clock();
 
-    // Pass inputs to the jacobian function
-    jacB_.setInputNZ(&t, RDAE_T);
-    jacB_.setInputNZ(NV_DATA_S(x), RDAE_X);
-    jacB_.setInput(input(INTEGRATOR_P), RDAE_P);
-    jacB_.setInputNZ(NV_DATA_S(xB), RDAE_RX);
-    jacB_.setInput(input(INTEGRATOR_RP), RDAE_RP);
-    jacB_.setInput(gammaB, RDAE_NUM_IN); // validated
-    jacB_.setInput(1.0, RDAE_NUM_IN+1); // validated
-
-    if (monitored("psetupB")) {
-      userOut() << "RDAE_T    = " << t << endl;
-      userOut() << "RDAE_X    = " << jacB_.input(RDAE_X) << endl;
-      userOut() << "RDAE_P    = " << jacB_.input(RDAE_P) << endl;
-      userOut() << "RDAE_RX    = " << jacB_.input(RDAE_RX) << endl;
-      userOut() << "RDAE_RP    = " << jacB_.input(RDAE_RP) << endl;
-      userOut() << "gamma = " << gammaB << endl;
-    }
+    if (!jokB) {
+      // Pass inputs to the jacobian function
+      jacB_.setInputNZ(&t, RDAE_T);
+      jacB_.setInputNZ(NV_DATA_S(x), RDAE_X);
+      jacB_.setInput(input(INTEGRATOR_P), RDAE_P);
+      jacB_.setInputNZ(NV_DATA_S(xB), RDAE_RX);
+      jacB_.setInput(input(INTEGRATOR_RP), RDAE_RP);
+      jacB_.setInput(1.0, RDAE_NUM_IN);
+      jacB_.setInput(0.0, RDAE_NUM_IN+1);
+
+      if (monitored("psetupB")) {
+        userOut() << "RDAE_T    = " << t << endl;
+        userOut() << "RDAE_X    = " << jacB_.input(RDAE_X) << endl;
+        userOut() << "RDAE_P    = " << jacB_.input(RDAE_P) << endl;
+        userOut() << "RDAE_RX    = " << jacB_.input(RDAE_RX) << endl;
+        userOut() << "RDAE_RP    = " << jacB_.input(RDAE_RP) << endl;
+      }
 
-    // Evaluate jacobian
-    jacB_.evaluate();
+      // Evaluate and save dg/drx, on the sparsity pattern of the Newton matrix
+      jacB_.evaluate();
+      jacB_.getOutputNZ(getPtr(jacB_nz_));
+      njacB_++;
 
-    if (monitored("psetupB")) {
-      userOut() << "psetupB = " << jacB_.output() << endl;
+      if (monitored("psetupB")) {
+        userOut() << "psetupB = " << jacB_.output() << endl;
+      }
     }
+    *jcurPtrB = !jokB;
 
     // Log time duration
     time2 = clock();
     t_lsetup_jac += static_cast<double>(time2-time1)/CLOCKS_PER_SEC;
 
-    // Pass non-zero elements, scaled by -gamma, to the linear solver
-    linsolB_.setInput(jacB_.output(), 0);
+    // Pass the non-zero elements of I+gamma*dg/drx to the linear solver (note definition of g)
+    double* M = linsolB_.input(LINSOL_A).ptr();
+    for (int k=0; k<jacB_nz_.size(); ++k) M[k] = gammaB*jacB_nz_[k];
+    for (int k=0; k<nrx_; ++k) M[jacB_diag_[k]] += 1;
 
     // Prepare the solution of the linear system (e.g. factorize)
     // -- only if the linear solver inherits from LinearSolver
@@ -1601,15 +1603,31 @@ namespace casadi {
     // Scaling factor before J
     double gamma = cv_mem->cv_gamma;
 
+    // Can the Jacobian of the last setup be reused?
+    booleantype jok = jacobianOk(cv_mem, convfail, nstlj_);
+
     // Call the preconditioner setup function (which sets up the linear solver)
-    psetup(t, x, xdot, FALSE, jcurPtr, gamma, vtemp1, vtemp2, vtemp3);
+    psetup(t, x, xdot, jok, jcurPtr, gamma, vtemp1, vtemp2, vtemp3);
   }
 
-  void CvodesInterface::lsetupB(double t, double gamma, int convfail,
+  void CvodesInterface::lsetupB(double t, double gamma, booleantype jok,
                                N_Vector x, N_Vector xB, N_Vector xdotB, booleantype *jcurPtr,
                                N_Vector vtemp1, N_Vector vtemp2, N_Vector vtemp3) {
     // Call the preconditioner setup function (which sets up the linear solver)
-    psetupB(t, x, xB, xdotB, FALSE, jcurPtr, gamma, vtemp1, vtemp2, vtemp3);
+    psetupB(t, x, xB, xdotB, jok, jcurPtr, gamma, vtemp1, vtemp2, vtemp3);
+  }
+
+  booleantype CvodesInterface::jacobianOk(CVodeMem cv_mem, int convfail, long& nstlj) {
+    // Same test as in the CVDENSE module: the Jacobian is reevaluated after 50 steps,
+    // after a convergence failure, or if a bad Jacobian is reported and gamma changed by
+    // less than 20 % (otherwise, refactorizing with the new gamma is tried first)
+    const long max_steps = 50;
+    const double max_dgamma = 0.2;
+    booleantype jbad = cv_mem->cv_nst==0 || cv_mem->cv_nst > nstlj + max_steps
+      || convfail==CV_FAIL_OTHER
+      || (convfail==CV_FAIL_BAD_J && fabs(cv_mem->cv_gamma/cv_mem->cv_gammap-1) < max_dgamma);
+    if (jbad) nstlj = cv_mem->cv_nst;
+    return !jbad;
   }
 
   int CvodesInterface::lsetup_wrapper(CVodeMem cv_mem, int convfail, N_Vector x, N_Vector xdot,
@@ -1641,6 +1659,9 @@ namespace casadi {
       double t = cv_mem->cv_tn; // TODO(Joel): is this correct?
       double gamma = cv_mem->cv_gamma;
 
+      // Can the Jacobian of the last setup be reused?
+      booleantype jok = this_->jacobianOk(cv_mem, convfail, this_->nstljB_);
+
       cv_mem = static_cast<CVodeMem>(cv_mem->cv_user_data);
 
       ca_mem = cv_mem->cv_adj_mem;
@@ -1650,7 +1671,7 @@ namespace casadi {
       flag = ca_mem->ca_IMget(cv_mem, t, ca_mem->ca_ytmp, NULL);
       if (flag != CV_SUCCESS) casadi_error("Could not interpolate forward states");
 
-      this_->lsetupB(t, gamma, convfail, ca_mem->ca_ytmp, x, xdot, jcurPtr, vtemp1, vtemp2, vtemp3);
+      this_->lsetupB(t, gamma, jok, ca_mem->ca_ytmp, x, xdot, jcurPtr, vtemp1, vtemp2, vtemp3);
       return 0;
     } catch(exception& e) {
       userOut<true, PL_WARN>() << "lsetupB failed: " << e.what() << endl;;
@@ -1909,6 +1930,7 @@ namespace casadi {
 
   void CvodesInterface::deepCopyMembers(std::map<SharedObjectNode*, SharedObject>& already_copied) {
     SundialsInterface::deepCopyMembers(already_copied);
+    f_fsens_ = deepcopy(f_fsens_, already_copied);
   }
 
   template<typename FunctionType>
@@ -1951,6 +1973,68 @@ namespace casadi {
     return FunctionType("jacB", jac_in, make_vector(jac));
   }
 
+  Integrator CvodesInterface::getFwdSensIntegrator(int nfwd, AugOffset& offset) {
+    // Augmented ODE if requested, for derivatives of the backward problem
+    if (!fsens_native_ || !g_.isNull() || nfwd==0) {
+      return SundialsInterface::getFwdSensIntegrator(nfwd, offset);
+    }
+
+    // Same layout as the augmented problem
+    offset = getAugOffset(nfwd, 0);
+    offset.z.resize(1);
+    for (int dir=-1; dir<nfwd; ++dir) offset.z.push_back(offset.z.back() + z0().size2());
+
+    // Integrator for the original ODE, with nfwd sensitivity directions
+    CvodesInterface* node = new CvodesInterface(f_, g_);
+    Integrator integrator;
+    integrator.assignNode(node);
+    node->nfsens_ = nfwd;
+    node->fsens_parent_ = shared_from_this<Integrator>();
+
+    // Set solver specific options
+    setDerivativeOptions(integrator, offset);
+
+    // Pass down specific options if provided
+    if (hasSetOption("augmented_options"))
+      integrator.setOption(getOption("augmented_options"));
+    return integrator;
+  }
+
+  Integrator CvodesInterface::getFsensAugmented() {
+    if (fsens_aug_.isNull()) {
+      // Augmented ODE of the integrator which created this one
+      CvodesInterface* parent = static_cast<CvodesInterface*>(fsens_parent_.get());
+      AugOffset offset;
+      fsens_aug_ = parent->SundialsInterface::getFwdSensIntegrator(nfsens_, offset);
+      fsens_aug_.init();
+    }
+    return fsens_aug_;
+  }
+
+  Function CvodesInterface::getDerForward(const std::string& name, int nfwd, Dict& opts) {
+    if (nfsens_==0) return SundialsInterface::getDerForward(name, nfwd, opts);
+    return getFsensAugmented()->getDerForward(name, nfwd, opts);
+  }
+
+  Function CvodesInterface::getDerReverse(const std::string& name, int nadj, Dict& opts) {
+    if (nfsens_==0) return SundialsInterface::getDerReverse(name, nadj, opts);
+    return getFsensAugmented()->getDerReverse(name, nadj, opts);
+  }
+
+  void CvodesInterface::spFwd(const bvec_t** arg, bvec_t** res, int* iw, bvec_t* w) {
+    if (nfsens_==0) return SundialsInterface::spFwd(arg, res, iw, w);
+
+    // Dependencies from the Jacobian sparsity pattern, which is dense
+    FunctionInternal::spFwd(arg, res, iw, w);
+  }
+
+  void CvodesInterface::spAdj(bvec_t** arg, bvec_t** res, int* iw, bvec_t* w) {
+    if (nfsens_==0) return SundialsInterface::spAdj(arg, res, iw, w);
+
+    // Dependencies from the Jacobian sparsity pattern, which is dense
+    FunctionInternal::spAdj(arg, res, iw, w);
+  }
+
   Function CvodesInterface::getJacB() {
     if (is_a<SXFunction>(g_)) {
       return getJacGenB<SXFunction>();
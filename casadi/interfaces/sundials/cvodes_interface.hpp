@@ -130,11 +130,36 @@ namespace casadi {
     /** \brief  Get the integrator Jacobian for the backward problem */
     virtual Function getJacB();
 
+    /** \brief Create an integrator for the problem and \a nfwd forward sensitivities */
+    virtual Integrator getFwdSensIntegrator(int nfwd, AugOffset& offset);
+
+    ///@{
+    /** \brief Derivatives of a forward sensitivity integrator via the augmented ODE */
+    virtual Function getDerForward(const std::string& name, int nfwd, Dict& opts);
+    virtual Function getDerReverse(const std::string& name, int nadj, Dict& opts);
+    ///@}
+
+    /** \brief  Propagate sparsity forward */
+    virtual void spFwd(const bvec_t** arg, bvec_t** res, int* iw, bvec_t* w);
+
+    /** \brief  Propagate sparsity backwards */
+    virtual void spAdj(bvec_t** arg, bvec_t** res, int* iw, bvec_t* w);
+
+    /// Is the class able to propagate seeds through the algorithm?
+    virtual bool spCanEvaluate(bool fwd) { return nfsens_==0;}
+
     /// A documentation string
     static const std::string meta_doc;
 
   protected:
 
+    // Evaluate the forward sensitivity right hand sides, starting with direction \a offset
+    void evalFsens(double t, const double* x, const double* xdot, const double* qdot,
+                   int offset, N_Vector* xF, N_Vector* xdotF, N_Vector* qdotF);
+
+    // Integrator of the equivalent augmented ODE, for derivatives of a sensitivity integrator
+    Integrator getFsensAugmented();
+
     // Sundials callback functions
     void rhs(double t, const double* x, double* xdot);
     void ehfun(int error_code, const char *module, const char *function, char *msg);
@@ -174,9 +199,11 @@ namespace casadi {
     /// <tt>M = I-gamma*df/dx</tt>, factorize
     void lsetup(CVodeMem cv_mem, int convfail, N_Vector ypred, N_Vector fpred, booleantype *jcurPtr,
                 N_Vector vtemp1, N_Vector vtemp2, N_Vector vtemp3);
-    void lsetupB(double t, double gamma, int convfail, N_Vector x, N_Vector xB, N_Vector xdotB,
-                 booleantype *jcurPtr,
+    void lsetupB(double t, double gamma, booleantype jok, N_Vector x, N_Vector xB,
+                 N_Vector xdotB, booleantype *jcurPtr,
                  N_Vector vtemp1, N_Vector vtemp2, N_Vector vtemp3);
+    /// Can the Jacobian of the last linear solver setup be reused, updates \a nstlj if not
+    static booleantype jacobianOk(CVodeMem cv_mem, int convfail, long& nstlj);
     /// <tt>b = M^(-1).b</tt>
     void lsolve(CVodeMem cv_mem, N_Vector b, N_Vector weight, N_Vector ycur, N_Vector fcur);
     void lsolveB(double t, double gamma, N_Vector b, N_Vector weight, N_Vector x,
@@ -251,6 +278,16 @@ namespace casadi {
     double t_lsetup_jac; // preconditioner/linear solver setup function, generate Jacobian
     double t_lsetup_fac; // preconditioner setup function, factorize Jacobian
 
+    // Jacobian of the last linear solver setup, on the sparsity pattern of the Newton matrix
+    std::vector<double> jac_nz_, jacB_nz_;
+
+    // Nonzero index of the diagonal entries of the Newton matrix
+    std::vector<int> jac_diag_, jacB_diag_;
+
+    // Step of the last Jacobian evaluation, number of Jacobian evaluations since reset
+    long nstlj_, nstljB_;
+    int njac_, njacB_;
+
     // N-vectors for the forward integration
     N_Vector x0_, x_, q_;
 
@@ -260,6 +297,22 @@ namespace casadi {
     // N-vectors for the forward sensitivities
     std::vector<N_Vector> xF0_, xF_, qF_;
 
+    // Number of forward sensitivity directions, stacked horizontally after the problem
+    int nfsens_;
+
+    // Directional derivatives of the ODE right hand side, fsens_batch_ directions at a time
+    Function f_fsens_;
+    int fsens_batch_;
+
+    // Integrator which created this forward sensitivity integrator
+    Integrator fsens_parent_;
+
+    // Integrator of the equivalent augmented ODE, created on demand
+    Integrator fsens_aug_;
+
+    // Integrate forward sensitivities natively rather than via the augmented ODE
+    bool fsens_native_;
+
     bool isInitAdj_;
 
     int ism_;
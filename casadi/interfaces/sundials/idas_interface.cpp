@@ -504,35 +504,25 @@ namespace casadi {
     // Get time
     time1 = clock();
 
-    // Pass input
-    f_.setInputNZ(&t, DAE_T);
-    f_.setInputNZ(xz, DAE_X);
-    f_.setInputNZ(xz+nx_, DAE_Z);
-    f_.setInput(input(INTEGRATOR_P), DAE_P);
-
     if (monitored("res")) {
       userOut() << "DAE_T    = " << t << endl;
-      userOut() << "DAE_X    = " << f_.input(DAE_X) << endl;
-      userOut() << "DAE_Z    = " << f_.input(DAE_Z) << endl;
-      userOut() << "DAE_P    = " << f_.input(DAE_P) << endl;
+      userOut() << "DAE_X    = " << vector<double>(xz, xz+nx_) << endl;
+      userOut() << "DAE_Z    = " << vector<double>(xz+nx_, xz+nx_+nz_) << endl;
+      userOut() << "DAE_P    = " << input(INTEGRATOR_P) << endl;
     }
 
-    // Evaluate
-    f_.evaluate();
-
-    // Get results
-    f_.getOutputNZ(r, DAE_ODE);
-    f_.getOutputNZ(r+nx_, DAE_ALG);
+    // Evaluate, writing directly to the residual
+    evalF(t, xz, xz+nx_, r, r+nx_, 0);
 
     if (monitored("res")) {
-      userOut() << "ODE rhs  = " << f_.output(DAE_ODE) << endl;
-      userOut() << "ALG rhs  = " << f_.output(DAE_ALG) << endl;
+      userOut() << "ODE rhs  = " << vector<double>(r, r+nx_) << endl;
+      userOut() << "ALG rhs  = " << vector<double>(r+nx_, r+nx_+nz_) << endl;
     }
 
     if (regularity_check_) {
-      casadi_assert_message(isRegular(f_.output(DAE_ODE).data()),
+      casadi_assert_message(isRegular(vector<double>(r, r+nx_)),
                             "IdasInterface::res: f.output(DAE_ODE) is not regular.");
-      casadi_assert_message(isRegular(f_.output(DAE_ALG).data()),
+      casadi_assert_message(isRegular(vector<double>(r+nx_, r+nx_+nz_)),
                             "IdasInterface::res: f.output(DAE_ALG) is not regular.");
     }
 
@@ -1176,17 +1166,8 @@ namespace casadi {
 
   void IdasInterface::rhsQ(double t, const double* xz, const double* xzdot, double* rhsQ) {
     log("IdasInterface::rhsQ", "begin");
-    // Pass input
-    f_.setInputNZ(&t, DAE_T);
-    f_.setInputNZ(xz, DAE_X);
-    f_.setInputNZ(xz+nx_, DAE_Z);
-    f_.setInput(input(INTEGRATOR_P), DAE_P);
-
-    // Evaluate
-    f_.evaluate();
-
-    // Get results
-    f_.getOutputNZ(rhsQ, DAE_QUAD);
+    // Evaluate, writing directly to the result
+    evalF(t, xz, xz+nx_, 0, 0, rhsQ);
     log("IdasInterface::rhsQ", "end");
   }
 
@@ -1240,28 +1221,19 @@ namespace casadi {
                           const double* xzdotA, double* rrA) {
     log("IdasInterface::resB", "begin");
 
-    // Pass inputs
-    g_.setInputNZ(&t, RDAE_T);
-    g_.setInputNZ(xz, RDAE_X);
-    g_.setInputNZ(xz+nx_, RDAE_Z);
-    g_.setInput(input(INTEGRATOR_P), RDAE_P);
-    g_.setInput(input(INTEGRATOR_RP), RDAE_RP);
-    g_.setInputNZ(xzA, RDAE_RX);
-    g_.setInputNZ(xzA+nrx_, RDAE_RZ);
-
     if (monitored("resB")) {
       userOut() << "RDAE_T    = " << t << endl;
-      userOut() << "RDAE_X    = " << g_.input(RDAE_X) << endl;
-      userOut() << "RDAE_Z    = " << g_.input(RDAE_Z) << endl;
-      userOut() << "RDAE_P    = " << g_.input(RDAE_P) << endl;
+      userOut() << "RDAE_X    = " << vector<double>(xz, xz+nx_) << endl;
+      userOut() << "RDAE_Z    = " << vector<double>(xz+nx_, xz+nx_+nz_) << endl;
+      userOut() << "RDAE_P    = " << input(INTEGRATOR_P) << endl;
       userOut() << "RDAE_XDOT  = ";
       for (int k=0;k<nx_;++k) {
         userOut() << xzdot[k] << " " ;
       }
       userOut() << endl;
-      userOut() << "RDAE_RX    = " << g_.input(RDAE_RX) << endl;
-      userOut() << "RDAE_RZ    = " << g_.input(RDAE_RZ) << endl;
-      userOut() << "RDAE_RP    = " << g_.input(RDAE_RP) << endl;
+      userOut() << "RDAE_RX    = " << vector<double>(xzA, xzA+nrx_) << endl;
+      userOut() << "RDAE_RZ    = " << vector<double>(xzA+nrx_, xzA+nrx_+nrz_) << endl;
+      userOut() << "RDAE_RP    = " << input(INTEGRATOR_RP) << endl;
       userOut() << "RDAE_RXDOT  = ";
       for (int k=0;k<nrx_;++k) {
         userOut() << xzdotA[k] << " " ;
@@ -1269,16 +1241,12 @@ namespace casadi {
       userOut() << endl;
     }
 
-    // Evaluate
-    g_.evaluate();
-
-    // Save to output
-    g_.getOutputNZ(rrA, RDAE_ODE);
-    g_.getOutputNZ(rrA+nrx_, RDAE_ALG);
+    // Evaluate, writing directly to the residual
+    evalG(t, xz, xz+nx_, xzA, xzA+nrx_, rrA, rrA+nrx_, 0);
 
     if (monitored("resB")) {
-      userOut() << "RDAE_ODE    = " << g_.output(RDAE_ODE) << endl;
-      userOut() << "RDAE_ALG    = " << g_.output(RDAE_ALG) << endl;
+      userOut() << "RDAE_ODE    = " << vector<double>(rrA, rrA+nrx_) << endl;
+      userOut() << "RDAE_ALG    = " << vector<double>(rrA+nrx_, rrA+nrx_+nrz_) << endl;
     }
 
     // Add state derivative to get residual (note definition of g)
@@ -1287,10 +1255,8 @@ namespace casadi {
     }
 
     if (monitored("resB")) {
-      g_.setOutputNZ(rrA, RDAE_ODE);
-      g_.setOutputNZ(rrA+nrx_, RDAE_ALG);
-      userOut() << "res ODE    = " << g_.output(RDAE_ODE) << endl;
-      userOut() << "res ALG    = " << g_.output(RDAE_ALG) << endl;
+      userOut() << "res ODE    = " << vector<double>(rrA, rrA+nrx_) << endl;
+      userOut() << "res ALG    = " << vector<double>(rrA+nrx_, rrA+nrx_+nrz_) << endl;
     }
 
 
@@ -1314,30 +1280,18 @@ namespace casadi {
                            const double* xzdotA, double *qdotA) {
     log("IdasInterface::rhsQB", "begin");
 
-    // Pass inputs
-    g_.setInputNZ(&t, RDAE_T);
-    g_.setInputNZ(xz, RDAE_X);
-    g_.setInputNZ(xz+nx_, RDAE_Z);
-    g_.setInput(input(INTEGRATOR_P), RDAE_P);
-    g_.setInput(input(INTEGRATOR_RP), RDAE_RP);
-    g_.setInputNZ(xzA, RDAE_RX);
-    g_.setInputNZ(xzA+nrx_, RDAE_RZ);
-
-    // Evaluate
-    g_.evaluate();
-
-    // Save to output
-    g_.getOutputNZ(qdotA, RDAE_QUAD);
+    // Evaluate, writing directly to the result
+    evalG(t, xz, xz+nx_, xzA, xzA+nrx_, 0, 0, qdotA);
 
     if (monitored("rhsQB")) {
       userOut() << "RDAE_T    = " << t << endl;
-      userOut() << "RDAE_X    = " << g_.input(RDAE_X) << endl;
-      userOut() << "RDAE_Z    = " << g_.input(RDAE_Z) << endl;
-      userOut() << "RDAE_P    = " << g_.input(RDAE_P) << endl;
-      userOut() << "RDAE_RX    = " << g_.input(RDAE_RX) << endl;
-      userOut() << "RDAE_RZ    = " << g_.input(RDAE_RZ) << endl;
-      userOut() << "RDAE_RP    = " << g_.input(RDAE_RP) << endl;
-      userOut() << "rhs = " << g_.output(RDAE_QUAD) << endl;
+      userOut() << "RDAE_X    = " << vector<double>(xz, xz+nx_) << endl;
+      userOut() << "RDAE_Z    = " << vector<double>(xz+nx_, xz+nx_+nz_) << endl;
+      userOut() << "RDAE_P    = " << input(INTEGRATOR_P) << endl;
+      userOut() << "RDAE_RX    = " << vector<double>(xzA, xzA+nrx_) << endl;
+      userOut() << "RDAE_RZ    = " << vector<double>(xzA+nrx_, xzA+nrx_+nrz_) << endl;
+      userOut() << "RDAE_RP    = " << input(INTEGRATOR_RP) << endl;
+      userOut() << "rhs = " << vector<double>(qdotA, qdotA+nrq_) << endl;
     }
 
     // Negate (note definition of g)
@@ -53,7 +53,10 @@ SundialsInterface::SundialsInterface(const Function& f, const Function& g)
   addOption("lower_bandwidth",             OT_INTEGER,          GenericType(),
             "Lower band-width of banded Jacobian (estimations)");
   addOption("linear_solver_type",          OT_STRING,           "dense",
-            "", "user_defined|dense|banded|iterative");
+            "Linear solver for the Newton iterations: sparse uses the sparsity pattern of "
+            "the Jacobian and the LinearSolver plugin given by linear_solver (default: csparse), "
+            "user_defined requires linear_solver to be set",
+            "user_defined|sparse|dense|banded|iterative");
   addOption("iterative_solver",            OT_STRING,           "gmres",
             "", "gmres|bcgstab|tfqmr");
   addOption("pretype",                     OT_STRING,           "none",
@@ -102,7 +105,7 @@ SundialsInterface::SundialsInterface(const Function& f, const Function& g)
             "lower band-width of banded jacobians for backward integration "
             "[default: equal to lower_bandwidth]");
   addOption("linear_solver_typeB",         OT_STRING,           GenericType(),
-            "", "user_defined|dense|banded|iterative");
+            "", "user_defined|sparse|dense|banded|iterative");
   addOption("iterative_solverB",           OT_STRING,           GenericType(),
             "", "gmres|bcgstab|tfqmr");
   addOption("pretypeB",                    OT_STRING,           GenericType(),
@@ -158,6 +161,7 @@ void SundialsInterface::init() {
       hasSetOption("max_krylovB") ? static_cast<int>(getOption("max_krylovB")): max_krylov_;
 
   // Linear solver for forward integration
+  sparse_f_ = sparse_g_ = false;
   if (getOption("linear_solver_type")=="dense") {
     linsol_f_ = SD_DENSE;
   } else if (getOption("linear_solver_type")=="banded") {
@@ -185,6 +189,9 @@ void SundialsInterface::init() {
       throw CasadiException("Unknown preconditioning type for forward integration");
   } else if (getOption("linear_solver_type")=="user_defined") {
     linsol_f_ = SD_USER_DEFINED;
+  } else if (getOption("linear_solver_type")=="sparse") {
+    linsol_f_ = SD_USER_DEFINED;
+    sparse_f_ = true;
   } else {
     throw CasadiException("Unknown linear solver for forward integration");
   }
@@ -224,6 +231,9 @@ void SundialsInterface::init() {
       throw CasadiException("Unknown preconditioning type for backward integration");
   } else if (linear_solver_typeB=="user_defined") {
     linsol_g_ = SD_USER_DEFINED;
+  } else if (linear_solver_typeB=="sparse") {
+    linsol_g_ = SD_USER_DEFINED;
+    sparse_g_ = true;
   } else {
    casadi_error("Unknown linear solver for backward integration: " << iterative_solverB);
   }
@@ -266,19 +276,22 @@ void SundialsInterface::init() {
       << jacB_.output().size2() << ")");
   }
 
-  if (hasSetOption("linear_solver") && !jac_.isNull()) {
+  if ((hasSetOption("linear_solver") || sparse_f_) && !jac_.isNull()) {
     // Options
     Dict linear_solver_options;
     if (hasSetOption("linear_solver_options")) {
       linear_solver_options = getOption("linear_solver_options");
     }
 
-    // Create a linear solver
-    linsol_ = LinearSolver("linsol", getOption("linear_solver"), jac_.output().sparsity(),
+    // Create a linear solver, the symbolic factorization is reused by all steps
+    std::string linear_solver_name =
+      hasSetOption("linear_solver") ? getOption("linear_solver").toString() : "csparse";
+    linsol_ = LinearSolver("linsol", linear_solver_name, jac_.output().sparsity(),
                            1, linear_solver_options);
   }
 
-  if ((hasSetOption("linear_solverB") || hasSetOption("linear_solver")) && !jacB_.isNull()) {
+  if ((hasSetOption("linear_solverB") || hasSetOption("linear_solver") || sparse_g_)
+      && !jacB_.isNull()) {
     // Linear solver options
     Dict opts;
     if (hasSetOption("linear_solver_optionsB")) {
@@ -288,8 +301,9 @@ void SundialsInterface::init() {
     }
 
     // Create a linear solver
-    std::string linear_solver_name =
-      hasSetOption("linear_solverB") ? getOption("linear_solverB") : getOption("linear_solver");
+    std::string linear_solver_name = hasSetOption("linear_solverB") ?
+      getOption("linear_solverB").toString() : hasSetOption("linear_solver") ?
+      getOption("linear_solver").toString() : "csparse";
     linsolB_ = LinearSolver("linsolB", linear_solver_name, jacB_.output().sparsity(),
                             1, opts);
   }
@@ -362,6 +376,48 @@ void SundialsInterface::reset() {
     return bw;
   }
 
+  void SundialsInterface::evalF(double t, const double* x, const double* z,
+                                double* ode, double* alg, double* quad) {
+    // Arguments, the first nIn() pointers are reserved for the integrator itself
+    const double** arg = getPtr(arg_tmp_) + nIn();
+    arg[DAE_X] = x;
+    arg[DAE_Z] = z;
+    arg[DAE_P] = input(INTEGRATOR_P).ptr();
+    arg[DAE_T] = &t;
+
+    // Results
+    double** res = getPtr(res_tmp_) + nOut();
+    res[DAE_ODE] = ode;
+    res[DAE_ALG] = alg;
+    res[DAE_QUAD] = quad;
+
+    // Evaluate without copying
+    f_(arg, res, getPtr(iw_tmp_), getPtr(w_tmp_));
+  }
+
+  void SundialsInterface::evalG(double t, const double* x, const double* z,
+                                const double* rx, const double* rz,
+                                double* ode, double* alg, double* quad) {
+    // Arguments, the first nIn() pointers are reserved for the integrator itself
+    const double** arg = getPtr(arg_tmp_) + nIn();
+    arg[RDAE_RX] = rx;
+    arg[RDAE_RZ] = rz;
+    arg[RDAE_RP] = input(INTEGRATOR_RP).ptr();
+    arg[RDAE_X] = x;
+    arg[RDAE_Z] = z;
+    arg[RDAE_P] = input(INTEGRATOR_P).ptr();
+    arg[RDAE_T] = &t;
+
+    // Results
+    double** res = getPtr(res_tmp_) + nOut();
+    res[RDAE_ODE] = ode;
+    res[RDAE_ALG] = alg;
+    res[RDAE_QUAD] = quad;
+
+    // Evaluate without copying
+    g_(arg, res, getPtr(iw_tmp_), getPtr(w_tmp_));
+  }
+
 } // namespace casadi
 
 
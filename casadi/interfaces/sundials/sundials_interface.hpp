@@ -86,6 +86,9 @@ public:
   /// Linear solver
   LinearSolverType linsol_f_, linsol_g_;
 
+  /// Sparse direct linear solver, user defined with csparse as default
+  bool sparse_f_, sparse_g_;
+
   /// Iterative solver
   IterativeSolverType itsol_f_, itsol_g_;
 
@@ -115,6 +118,16 @@ public:
 
   // Get bandwidth for backward problem
   std::pair<int, int> getBandwidthB() const;
+
+  /** \brief  Evaluate the forward DAE, binding the buffers directly
+      Null arguments are treated as zero, null results are not calculated */
+  void evalF(double t, const double* x, const double* z,
+             double* ode, double* alg, double* quad);
+
+  /** \brief  Evaluate the backward DAE, binding the buffers directly
+      Null arguments are treated as zero, null results are not calculated */
+  void evalG(double t, const double* x, const double* z, const double* rx, const double* rz,
+             double* ode, double* alg, double* quad);
 };
 
 } // namespace casadi
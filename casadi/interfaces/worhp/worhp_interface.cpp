@@ -215,11 +215,7 @@ namespace casadi {
     exact_hessian_ = getOption("UserHM");
 
     // Get/generate required functions
-    gradF();
-    jacG();
-    if (exact_hessian_) { // does not appear to work
-      hessLag();
-    }
+    initDerivatives(exact_hessian_); // does not appear to work
 
     // Update status?
     status_[TerminateSuccess]="TerminateSuccess";
@@ -0,0 +1,325 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#include "interior_point_qp.hpp"
+#include "casadi/core/runtime/runtime.hpp"
+#include <iomanip>
+
+using namespace std;
+namespace casadi {
+
+  InteriorPointQp::InteriorPointQp(const std::map<std::string, Sparsity> &st)
+    : QpSolverInternal(st) {
+    addOption("max_iter",               OT_INTEGER,     100,
+              "Maximum number of interior point iterations");
+    addOption("tol",                    OT_REAL,        1e-10,
+              "Stopping criterion tolerance on the primal and dual infeasibility "
+              "and on the average complementarity");
+    addOption("regularization",         OT_REAL,        1e-10,
+              "Regularization of the Newton system");
+    addOption("init_slack",             OT_REAL,        1.0,
+              "Lower bound on the initial slacks and bound multipliers. "
+              "When warm starting from x0 and lam_x0, a small value should be chosen.");
+    addOption("step_fraction",          OT_REAL,        0.995,
+              "Fraction of the step to the boundary taken in each iteration");
+    addOption("print_iteration",        OT_BOOLEAN,     false,
+              "Print information about each iteration");
+  }
+
+  InteriorPointQp::~InteriorPointQp() {
+  }
+
+  void InteriorPointQp::init() {
+    // Initialize the base classes
+    QpSolverInternal::init();
+
+    // Read options
+    max_iter_ = getOption("max_iter");
+    tol_ = getOption("tol");
+    reg_ = getOption("regularization");
+    init_slack_ = getOption("init_slack");
+    tau_ = getOption("step_fraction");
+    print_iteration_ = getOption("print_iteration");
+
+    // Allocate work vectors
+    int nw = n_ + nc_;
+    type_.resize(nw);
+    lb_.resize(nw);
+    ub_.resize(nw);
+    x_.resize(n_);
+    dx_.resize(n_);
+    rd_.resize(n_);
+    sl_.resize(nw);
+    su_.resize(nw);
+    zl_.resize(nw);
+    zu_.resize(nw);
+    lam_.resize(nw);
+    w_.resize(nw);
+    dw_.resize(nw);
+    rl_.resize(nw);
+    ru_.resize(nw);
+    rcl_.resize(nw);
+    rcu_.resize(nw);
+    d_.resize(nw);
+    dsl_.resize(nw);
+    dsu_.resize(nw);
+    dzl_.resize(nw);
+    dzu_.resize(nw);
+    dlam_.resize(nw);
+  }
+
+  void InteriorPointQp::getBounds() {
+    copy(input(QP_SOLVER_LBX).begin(), input(QP_SOLVER_LBX).end(), lb_.begin());
+    copy(input(QP_SOLVER_LBA).begin(), input(QP_SOLVER_LBA).end(), lb_.begin()+n_);
+    copy(input(QP_SOLVER_UBX).begin(), input(QP_SOLVER_UBX).end(), ub_.begin());
+    copy(input(QP_SOLVER_UBA).begin(), input(QP_SOLVER_UBA).end(), ub_.begin()+n_);
+  }
+
+  void InteriorPointQp::recoverStep() {
+    // Step in w
+    copy(dx_.begin(), dx_.end(), dw_.begin());
+    fill(dw_.begin()+n_, dw_.end(), 0);
+    casadi_mv(getPtr(input(QP_SOLVER_A).data()), input(QP_SOLVER_A).sparsity(),
+              getPtr(dx_), getPtr(dw_)+n_);
+
+    // Steps in the slacks and bound multipliers, the equality multipliers are given
+    for (int i=0; i<type_.size(); ++i) {
+      dsl_[i] = dsu_[i] = dzl_[i] = dzu_[i] = 0;
+      if (type_[i]==IP_EQUALITY) continue;
+      dlam_[i] = 0;
+      if (type_[i]==IP_LOWER || type_[i]==IP_BOTH) {
+        dsl_[i] = dw_[i] + rl_[i];
+        dzl_[i] = -(rcl_[i] + zl_[i]*dsl_[i])/sl_[i];
+      }
+      if (type_[i]==IP_UPPER || type_[i]==IP_BOTH) {
+        dsu_[i] = ru_[i] - dw_[i];
+        dzu_[i] = -(rcu_[i] + zu_[i]*dsu_[i])/su_[i];
+      }
+    }
+  }
+
+  void InteriorPointQp::maxStep(double& alpha_pr, double& alpha_du) const {
+    alpha_pr = alpha_du = numeric_limits<double>::infinity();
+    for (int i=0; i<type_.size(); ++i) {
+      if (type_[i]==IP_LOWER || type_[i]==IP_BOTH) {
+        if (dsl_[i]<0) alpha_pr = min(alpha_pr, -sl_[i]/dsl_[i]);
+        if (dzl_[i]<0) alpha_du = min(alpha_du, -zl_[i]/dzl_[i]);
+      }
+      if (type_[i]==IP_UPPER || type_[i]==IP_BOTH) {
+        if (dsu_[i]<0) alpha_pr = min(alpha_pr, -su_[i]/dsu_[i]);
+        if (dzu_[i]<0) alpha_du = min(alpha_du, -zu_[i]/dzu_[i]);
+      }
+    }
+  }
+
+  void InteriorPointQp::solveInteriorPoint() {
+    const double* h = getPtr(input(QP_SOLVER_H).data());
+    const double* g = getPtr(input(QP_SOLVER_G).data());
+    const double* a = getPtr(input(QP_SOLVER_A).data());
+    const Sparsity& sp_h = input(QP_SOLVER_H).sparsity();
+    const Sparsity& sp_a = input(QP_SOLVER_A).sparsity();
+    const vector<double>& lam_x0 = input(QP_SOLVER_LAM_X0).data();
+    int nw = n_ + nc_;
+
+    // Classify the bounds on w = [x; A*x]
+    int n_compl = 0;
+    for (int i=0; i<nw; ++i) {
+      bool has_lb = lb_[i] > -numeric_limits<double>::infinity();
+      bool has_ub = ub_[i] < numeric_limits<double>::infinity();
+      if (has_lb && has_ub) {
+        type_[i] = lb_[i]==ub_[i] ? IP_EQUALITY : IP_BOTH;
+      } else if (has_lb) {
+        type_[i] = IP_LOWER;
+      } else if (has_ub) {
+        type_[i] = IP_UPPER;
+      } else {
+        type_[i] = IP_FREE;
+      }
+      if (type_[i]==IP_LOWER || type_[i]==IP_BOTH) n_compl++;
+      if (type_[i]==IP_UPPER || type_[i]==IP_BOTH) n_compl++;
+    }
+
+    // Initial guess, slacks and multipliers are pushed away from zero
+    copy(input(QP_SOLVER_X0).begin(), input(QP_SOLVER_X0).end(), x_.begin());
+    copy(x_.begin(), x_.end(), w_.begin());
+    fill(w_.begin()+n_, w_.end(), 0);
+    casadi_mv(a, sp_a, getPtr(x_), getPtr(w_)+n_);
+    for (int i=0; i<nw; ++i) {
+      double lam0 = i<n_ ? lam_x0[i] : 0;
+      sl_[i] = su_[i] = zl_[i] = zu_[i] = lam_[i] = 0;
+      if (type_[i]==IP_EQUALITY) {
+        lam_[i] = lam0;
+        continue;
+      }
+      if (type_[i]==IP_LOWER || type_[i]==IP_BOTH) {
+        sl_[i] = max(w_[i]-lb_[i], init_slack_);
+        zl_[i] = max(-lam0, init_slack_);
+      }
+      if (type_[i]==IP_UPPER || type_[i]==IP_BOTH) {
+        su_[i] = max(ub_[i]-w_[i], init_slack_);
+        zu_[i] = max(lam0, init_slack_);
+      }
+    }
+
+    // Interior point iterations
+    int iter = 0;
+    double alpha = 0;
+    bool success = false;
+    while (true) {
+      // Constraint values and multipliers
+      copy(x_.begin(), x_.end(), w_.begin());
+      fill(w_.begin()+n_, w_.end(), 0);
+      casadi_mv(a, sp_a, getPtr(x_), getPtr(w_)+n_);
+      for (int i=0; i<nw; ++i) {
+        if (type_[i]!=IP_EQUALITY) lam_[i] = zu_[i] - zl_[i];
+      }
+
+      // Dual residual: H*x + g + lam_x + A'*lam_a
+      for (int i=0; i<n_; ++i) rd_[i] = g[i] + lam_[i];
+      casadi_mv(h, sp_h, getPtr(x_), getPtr(rd_));
+      casadi_mv_t(a, sp_a, getPtr(lam_)+n_, getPtr(rd_));
+      double du_inf = 0;
+      for (int i=0; i<n_; ++i) du_inf = max(du_inf, fabs(rd_[i]));
+
+      // Primal residuals, complementarity and barrier term
+      double pr_inf = 0, mu = 0;
+      for (int i=0; i<nw; ++i) {
+        rl_[i] = ru_[i] = d_[i] = 0;
+        if (type_[i]==IP_EQUALITY) {
+          rl_[i] = w_[i] - lb_[i];
+        } else {
+          if (type_[i]==IP_LOWER || type_[i]==IP_BOTH) {
+            rl_[i] = w_[i] - sl_[i] - lb_[i];
+            mu += sl_[i]*zl_[i];
+            d_[i] += zl_[i]/sl_[i];
+          }
+          if (type_[i]==IP_UPPER || type_[i]==IP_BOTH) {
+            ru_[i] = ub_[i] - w_[i] - su_[i];
+            mu += su_[i]*zu_[i];
+            d_[i] += zu_[i]/su_[i];
+          }
+        }
+        pr_inf = max(pr_inf, max(fabs(rl_[i]), fabs(ru_[i])));
+      }
+      if (n_compl>0) mu /= n_compl;
+
+      if (print_iteration_) {
+        if (iter % 10 == 0) printIteration(userOut());
+        double obj = 0.5*casadi_quad_form(h, sp_h, getPtr(x_))
+          + casadi_inner_prod(n_, g, getPtr(x_));
+        printIteration(userOut(), iter, obj, pr_inf, du_inf, mu, alpha);
+      }
+
+      // Check convergence
+      if (pr_inf<=tol_ && du_inf<=tol_ && mu<=tol_) {
+        success = true;
+        break;
+      }
+      if (iter>=max_iter_) break;
+      iter++;
+
+      // Factorize the Newton system, reused for the predictor and the corrector
+      factorizeKKT();
+
+      // Predictor (affine scaling) step
+      for (int i=0; i<nw; ++i) {
+        rcl_[i] = sl_[i]*zl_[i];
+        rcu_[i] = su_[i]*zu_[i];
+      }
+      double alpha_pr, alpha_du;
+      for (int pass=0; pass<2; ++pass) {
+        solveKKT();
+        recoverStep();
+        maxStep(alpha_pr, alpha_du);
+        if (pass==1 || n_compl==0) break;
+
+        // Centering parameter from the predicted complementarity
+        double mu_aff = 0;
+        for (int i=0; i<nw; ++i) {
+          if (type_[i]==IP_LOWER || type_[i]==IP_BOTH) {
+            mu_aff += (sl_[i] + min(alpha_pr, 1.)*dsl_[i])*(zl_[i] + min(alpha_du, 1.)*dzl_[i]);
+          }
+          if (type_[i]==IP_UPPER || type_[i]==IP_BOTH) {
+            mu_aff += (su_[i] + min(alpha_pr, 1.)*dsu_[i])*(zu_[i] + min(alpha_du, 1.)*dzu_[i]);
+          }
+        }
+        mu_aff /= n_compl;
+        double sigma = pow(mu_aff/mu, 3);
+
+        // Corrector step
+        for (int i=0; i<nw; ++i) {
+          rcl_[i] = sl_[i]*zl_[i] + dsl_[i]*dzl_[i] - sigma*mu;
+          rcu_[i] = su_[i]*zu_[i] + dsu_[i]*dzu_[i] - sigma*mu;
+        }
+      }
+
+      // Take a step, staying in the interior
+      alpha = min(1., tau_*min(alpha_pr, alpha_du));
+      for (int i=0; i<n_; ++i) x_[i] += alpha*dx_[i];
+      for (int i=0; i<nw; ++i) {
+        sl_[i] += alpha*dsl_[i];
+        su_[i] += alpha*dsu_[i];
+        zl_[i] += alpha*dzl_[i];
+        zu_[i] += alpha*dzu_[i];
+        lam_[i] += alpha*dlam_[i];
+      }
+    }
+
+    // Statistics
+    stats_["iter_count"] = iter;
+    stats_["return_status"] = success ? "success" : "max_iteration_reached";
+    casadi_assert_message(success, "InteriorPointQp: maximum number of iterations ("
+                          << max_iter_ << ") reached");
+
+    // Get the solution
+    copy(x_.begin(), x_.end(), output(QP_SOLVER_X).begin());
+    copy(lam_.begin(), lam_.begin()+n_, output(QP_SOLVER_LAM_X).begin());
+    copy(lam_.begin()+n_, lam_.end(), output(QP_SOLVER_LAM_A).begin());
+  }
+
+  void InteriorPointQp::printIteration(std::ostream &stream) {
+    stream << setw(5) << "iter";
+    stream << setw(14) << "objective";
+    stream << setw(10) << "inf_pr";
+    stream << setw(10) << "inf_du";
+    stream << setw(10) << "mu";
+    stream << setw(10) << "alpha";
+    stream << std::endl;
+    stream.unsetf(std::ios::floatfield);
+  }
+
+  void InteriorPointQp::printIteration(std::ostream &stream, int iter, double obj,
+                                       double pr_inf, double du_inf, double mu, double alpha) {
+    stream << setw(5) << iter;
+    stream << setw(14) << scientific << setprecision(6) << obj;
+    stream << setw(10) << scientific << setprecision(2) << pr_inf;
+    stream << setw(10) << scientific << setprecision(2) << du_inf;
+    stream << setw(10) << scientific << setprecision(2) << mu;
+    stream << setw(10) << scientific << setprecision(2) << alpha;
+    stream << std::endl;
+    stream.unsetf(std::ios::floatfield);
+  }
+
+} // namespace casadi
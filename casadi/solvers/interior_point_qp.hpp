@@ -0,0 +1,113 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#ifndef CASADI_INTERIOR_POINT_QP_HPP
+#define CASADI_INTERIOR_POINT_QP_HPP
+
+#include "casadi/core/function/qp_solver_internal.hpp"
+#include <casadi/solvers/casadi_interior_point_qp_export.h>
+
+/// \cond INTERNAL
+namespace casadi {
+
+  /** \brief Primal-dual interior point method for convex QPs
+
+      Mehrotra predictor-corrector iterations on the bounds of w = [x; A*x].
+      Components with equal lower and upper bounds are equality constraints
+      with a free multiplier, all other bounds get slacks and bound multipliers.
+      Derived classes factorize and solve the Newton system.
+  */
+  class CASADI_INTERIOR_POINT_QP_EXPORT InteriorPointQp : public QpSolverInternal {
+  public:
+    /// Constructor
+    explicit InteriorPointQp(const std::map<std::string, Sparsity> &st);
+
+    /// Destructor
+    virtual ~InteriorPointQp();
+
+    /// Clone
+    virtual InteriorPointQp* clone() const = 0;
+
+    /// Initialize
+    virtual void init();
+
+  protected:
+    /// Kind of bound on a component of w = [x; A*x]
+    enum BoundType {IP_FREE, IP_LOWER, IP_UPPER, IP_BOTH, IP_EQUALITY};
+
+    /// Get the bounds on w from the inputs
+    void getBounds();
+
+    /// Solve the QP for the bounds in lb_ and ub_, the solution is written to the outputs
+    void solveInteriorPoint();
+
+    /// Factorize the Newton system for the current barrier term d_
+    virtual void factorizeKKT() = 0;
+
+    /** \brief Solve the factorized Newton system for the current residuals
+     *
+     * Gives the primal step dx_ and the steps dlam_ of the equality multipliers
+     */
+    virtual void solveKKT() = 0;
+
+    /// Recover the slack and bound multiplier steps from dx_
+    void recoverStep();
+
+    /// Largest step keeping the slacks and bound multipliers nonnegative
+    void maxStep(double& alpha_pr, double& alpha_du) const;
+
+    /// Print iteration header
+    void printIteration(std::ostream &stream);
+
+    /// Print iteration
+    void printIteration(std::ostream &stream, int iter, double obj, double pr_inf,
+                        double du_inf, double mu, double alpha);
+
+    /// Options
+    int max_iter_;
+    double tol_, reg_, init_slack_, tau_;
+    bool print_iteration_;
+
+    /// Type of bound and bounds for each component of w
+    std::vector<BoundType> type_;
+    std::vector<double> lb_, ub_;
+
+    /// Iterate: primal variables, slacks, bound multipliers and equality multipliers
+    std::vector<double> x_, sl_, su_, zl_, zu_, lam_;
+
+    /// Current w = [x; A*x] and its step
+    std::vector<double> w_, dw_;
+
+    /// Residuals: dual, lower bound, upper bound, complementarity
+    std::vector<double> rd_, rl_, ru_, rcl_, rcu_;
+
+    /// Barrier term and steps
+    std::vector<double> d_, dx_, dsl_, dsu_, dzl_, dzu_, dlam_;
+  };
+
+} // namespace casadi
+/// \endcond
+
+#endif // CASADI_INTERIOR_POINT_QP_HPP
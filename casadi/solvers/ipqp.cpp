@@ -0,0 +1,211 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#include "ipqp.hpp"
+#include "casadi/core/runtime/runtime.hpp"
+#include "casadi/core/profiling.hpp"
+
+using namespace std;
+namespace casadi {
+
+  extern "C"
+  int CASADI_QPSOLVER_IPQP_EXPORT
+  casadi_register_qpsolver_ipqp(QpSolverInternal::Plugin* plugin) {
+    plugin->creator = Ipqp::creator;
+    plugin->name = "ipqp";
+    plugin->doc = Ipqp::meta_doc.c_str();
+    plugin->version = 23;
+    return 0;
+  }
+
+  extern "C"
+  void CASADI_QPSOLVER_IPQP_EXPORT casadi_load_qpsolver_ipqp() {
+    QpSolverInternal::registerPlugin(casadi_register_qpsolver_ipqp);
+  }
+
+  Ipqp::Ipqp(const std::map<std::string, Sparsity> &st) : InteriorPointQp(st) {
+    addOption("linear_solver",          OT_STRING,      "csparse",
+              "User-defined linear solver class for the KKT system.");
+    addOption("linear_solver_options",  OT_DICT,        GenericType(),
+              "Options to be passed to the linear solver.");
+  }
+
+  Ipqp::~Ipqp() {
+  }
+
+  void Ipqp::deepCopyMembers(std::map<SharedObjectNode*, SharedObject>& already_copied) {
+    InteriorPointQp::deepCopyMembers(already_copied);
+    linsol_ = deepcopy(linsol_, already_copied);
+  }
+
+  void Ipqp::init() {
+    // Initialize the base classes
+    InteriorPointQp::init();
+
+    // Number of components of w = [x; A*x]
+    int nw = n_ + nc_;
+
+    // Sparsity of the KKT system [H+reg*I, M'; M, -D^(-1)] with M = [I; A]
+    const Sparsity& sp_h = input(QP_SOLVER_H).sparsity();
+    const Sparsity& sp_a = input(QP_SOLVER_A).sparsity();
+    Sparsity sp_m = vertcat(Sparsity::diag(n_), sp_a);
+    kkt_ = blockcat(sp_h + Sparsity::diag(n_), sp_m.T(), sp_m, Sparsity::diag(nw));
+    int nkkt = kkt_.size1();
+
+    // Locate the nonzeros of H
+    kkt_h_.clear();
+    const int* h_colind = sp_h.colind();
+    const int* h_row = sp_h.row();
+    for (int c=0; c<n_; ++c) {
+      for (int el=h_colind[c]; el<h_colind[c+1]; ++el) {
+        kkt_h_.push_back(h_row[el] + c*nkkt);
+      }
+    }
+    kkt_.getNZ(kkt_h_);
+
+    // Locate the diagonal and the identity blocks
+    kkt_diag_.resize(nkkt);
+    for (int i=0; i<nkkt; ++i) kkt_diag_[i] = i + i*nkkt;
+    kkt_.getNZ(kkt_diag_);
+    kkt_i_.resize(n_);
+    kkt_it_.resize(n_);
+    for (int i=0; i<n_; ++i) {
+      kkt_i_[i] = n_ + i + i*nkkt;
+      kkt_it_[i] = i + (n_ + i)*nkkt;
+    }
+    kkt_.getNZ(kkt_i_);
+    kkt_.getNZ(kkt_it_);
+
+    // Locate the nonzeros of A and A^T
+    kkt_a_.clear();
+    kkt_at_.clear();
+    const int* a_colind = sp_a.colind();
+    const int* a_row = sp_a.row();
+    for (int c=0; c<n_; ++c) {
+      for (int el=a_colind[c]; el<a_colind[c+1]; ++el) {
+        kkt_a_.push_back(2*n_ + a_row[el] + c*nkkt);
+        kkt_at_.push_back(c + (2*n_ + a_row[el])*nkkt);
+      }
+    }
+    kkt_.getNZ(kkt_a_);
+    kkt_.getNZ(kkt_at_);
+
+    // Allocate the linear solver, the symbolic factorization is reused for all solves
+    Dict linear_solver_options;
+    if (hasSetOption("linear_solver_options")) {
+      linear_solver_options = getOption("linear_solver_options");
+    }
+    linsol_ = LinearSolver("linsol", getOption("linear_solver"), kkt_, 1,
+                           linear_solver_options);
+
+    // Allocate work vectors
+    sol_.resize(nkkt);
+    rhs_.resize(nkkt);
+    res_.resize(nkkt);
+  }
+
+  void Ipqp::factorizeKKT() {
+    const vector<double>& h = input(QP_SOLVER_H).data();
+    const vector<double>& a = input(QP_SOLVER_A).data();
+    const int* a_row = input(QP_SOLVER_A).row();
+    vector<double>& kkt = linsol_.input(LINSOL_A).data();
+    fill(kkt.begin(), kkt.end(), 0);
+
+    // Hessian block with primal regularization
+    for (int k=0; k<kkt_h_.size(); ++k) kkt[kkt_h_[k]] += h[k];
+    for (int i=0; i<n_; ++i) kkt[kkt_diag_[i]] += reg_;
+
+    // Constraint blocks, components without bounds are decoupled
+    for (int i=0; i<n_; ++i) {
+      kkt[kkt_i_[i]] = kkt[kkt_it_[i]] = type_[i]==IP_FREE ? 0 : 1;
+    }
+    for (int k=0; k<kkt_a_.size(); ++k) {
+      kkt[kkt_a_[k]] = kkt[kkt_at_[k]] = type_[n_+a_row[k]]==IP_FREE ? 0 : a[k];
+    }
+
+    // Barrier block
+    for (int i=0; i<type_.size(); ++i) {
+      double& kkt_ii = kkt[kkt_diag_[n_+i]];
+      switch (type_[i]) {
+      case IP_FREE: kkt_ii = -1; break;
+      case IP_EQUALITY: kkt_ii = -reg_; break;
+      default: kkt_ii = -1/d_[i];
+      }
+    }
+
+    // Numerical factorization, the symbolic factorization is reused
+    linsol_.prepare();
+  }
+
+  void Ipqp::solveKKT() {
+    // Right-hand side of the augmented system
+    for (int i=0; i<n_; ++i) sol_[i] = -rd_[i];
+    for (int i=0; i<type_.size(); ++i) {
+      double& r = sol_[n_+i];
+      switch (type_[i]) {
+      case IP_FREE: r = 0; break;
+      case IP_EQUALITY: r = -rl_[i]; break;
+      default:
+        r = 0;
+        if (type_[i]!=IP_UPPER) r += (rcl_[i] + zl_[i]*rl_[i])/sl_[i];
+        if (type_[i]!=IP_LOWER) r -= (rcu_[i] + zu_[i]*ru_[i])/su_[i];
+        r /= -d_[i];
+      }
+    }
+
+    // Solve, followed by one step of iterative refinement
+    copy(sol_.begin(), sol_.end(), rhs_.begin());
+    linsol_.solve(getPtr(sol_), 1, false);
+    fill(res_.begin(), res_.end(), 0);
+    casadi_mv(getPtr(linsol_.input(LINSOL_A).data()), kkt_, getPtr(sol_), getPtr(res_));
+    for (int i=0; i<res_.size(); ++i) res_[i] = rhs_[i] - res_[i];
+    linsol_.solve(getPtr(res_), 1, false);
+    for (int i=0; i<sol_.size(); ++i) sol_[i] += res_[i];
+
+    // Primal step and steps in the equality multipliers
+    copy(sol_.begin(), sol_.begin()+n_, dx_.begin());
+    for (int i=0; i<type_.size(); ++i) {
+      if (type_[i]==IP_EQUALITY) dlam_[i] = sol_[n_+i];
+    }
+  }
+
+  void Ipqp::evaluate() {
+    if (inputs_check_) checkInputs();
+    double time_start = getRealTime();
+
+    // Interior point iterations
+    getBounds();
+    solveInteriorPoint();
+    stats_["t_solve"] = getRealTime() - time_start;
+
+    // Optimal cost
+    output(QP_SOLVER_COST).set(
+      0.5*casadi_quad_form(getPtr(input(QP_SOLVER_H).data()), input(QP_SOLVER_H).sparsity(),
+                           getPtr(output(QP_SOLVER_X).data()))
+      + casadi_inner_prod(n_, getPtr(input(QP_SOLVER_G).data()),
+                          getPtr(output(QP_SOLVER_X).data())));
+  }
+
+} // namespace casadi
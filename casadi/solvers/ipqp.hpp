@@ -0,0 +1,116 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#ifndef CASADI_IPQP_HPP
+#define CASADI_IPQP_HPP
+
+#include "interior_point_qp.hpp"
+#include "casadi/core/function/linear_solver.hpp"
+
+#include <casadi/solvers/casadi_qpsolver_ipqp_export.h>
+
+
+/** \defgroup plugin_QpSolver_ipqp
+   Sparse primal-dual interior point method for convex QPs,
+   using Mehrotra's predictor-corrector scheme.
+
+   Simple bounds and linear constraints are treated uniformly as bounds
+   on w = [x; A*x]. In each iteration, the augmented KKT system
+
+   [ H + reg*I,  M^T;  M, -D^(-1) ],  M = [I; A]
+
+   with D the diagonal barrier term is factorized once using a LinearSolver
+   plugin and solved twice (predictor and corrector). The sparsity pattern
+   of the KKT system is fixed, so the symbolic factorization is performed
+   only once and reused in subsequent iterations and subsequent solves
+   (e.g. between SQP iterations).
+
+   Components with equal lower and upper bounds are treated as equality
+   constraints, components without finite bounds are removed from the KKT
+   system by a zero coupling.
+*/
+
+/** \pluginsection{QpSolver,ipqp} */
+
+/// \cond INTERNAL
+namespace casadi {
+
+  /** \brief \pluginbrief{QpSolver,ipqp}
+
+   @copydoc QpSolver_doc
+   @copydoc plugin_QpSolver_ipqp
+
+  */
+  class CASADI_QPSOLVER_IPQP_EXPORT Ipqp : public InteriorPointQp {
+  public:
+    /** \brief  Create a new Solver */
+    explicit Ipqp(const std::map<std::string, Sparsity> &st);
+
+    /** \brief  Destructor */
+    virtual ~Ipqp();
+
+    /** \brief  Clone */
+    virtual Ipqp* clone() const { return new Ipqp(*this);}
+
+    /** \brief  Create a new QP Solver */
+    static QpSolverInternal* creator(const std::map<std::string, Sparsity>& st) {
+      return new Ipqp(st);
+    }
+
+    /** \brief  Deep copy data members */
+    virtual void deepCopyMembers(std::map<SharedObjectNode*, SharedObject>& already_copied);
+
+    /** \brief  Initialize */
+    virtual void init();
+
+    /** \brief  Solve the QP */
+    virtual void evaluate();
+
+    /// A documentation string
+    static const std::string meta_doc;
+
+  protected:
+    /// Assemble and factorize the KKT matrix for the current iterate
+    virtual void factorizeKKT();
+
+    /// Solve the factorized KKT system, with one step of iterative refinement
+    virtual void solveKKT();
+
+    /// Linear solver for the KKT system
+    LinearSolver linsol_;
+
+    /// Sparsity pattern of the KKT system
+    Sparsity kkt_;
+
+    /// Nonzeros of the KKT matrix corresponding to H, the diagonal, I, I^T, A and A^T
+    std::vector<int> kkt_h_, kkt_diag_, kkt_i_, kkt_it_, kkt_a_, kkt_at_;
+
+    /// Right-hand side/solution of the KKT system, copy of the right-hand side and residual
+    std::vector<double> sol_, rhs_, res_;
+  };
+
+} // namespace casadi
+/// \endcond
+#endif // CASADI_IPQP_HPP
@@ -0,0 +1,123 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+      #include "ipqp.hpp"
+      #include <string>
+
+      const std::string casadi::Ipqp::meta_doc=
+      "\n"
+"Sparse primal-dual interior point method for convex QPs, using\n"
+"Mehrotra's predictor-corrector scheme.\n"
+"\n"
+"Simple bounds and linear constraints are treated uniformly as bounds on w\n"
+"= [x; A*x]. In each iteration, the augmented KKT system\n"
+"\n"
+"[ H + reg*I, M^T; M, -D^(-1) ], M = [I; A]\n"
+"\n"
+"with D the diagonal barrier term is factorized once using a LinearSolver\n"
+"plugin and solved twice (predictor and corrector). The sparsity pattern of\n"
+"the KKT system is fixed, so the symbolic factorization is performed only\n"
+"once and reused in subsequent iterations and subsequent solves (e.g.\n"
+"between SQP iterations).\n"
+"\n"
+"Components with equal lower and upper bounds are treated as equality\n"
+"constraints, components without finite bounds are removed from the KKT\n"
+"system by a zero coupling.\n"
+"\n"
+"\n"
+">List of available options\n"
+"\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
+"|       Id        |      Type       |     Default     |   Description   |\n"
+"+=================+=================+=================+=================+\n"
+"| init_slack      | OT_REAL         | 1               | Lower bound on  |\n"
+"|                 |                 |                 | the initial     |\n"
+"|                 |                 |                 | slacks and      |\n"
+"|                 |                 |                 | bound           |\n"
+"|                 |                 |                 | multipliers.    |\n"
+"|                 |                 |                 | When warm       |\n"
+"|                 |                 |                 | starting from   |\n"
+"|                 |                 |                 | x0 and lam_x0,  |\n"
+"|                 |                 |                 | a small value   |\n"
+"|                 |                 |                 | should be       |\n"
+"|                 |                 |                 | chosen.         |\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
+"| linear_solver   | OT_STRING       | \"csparse\"       | User-defined    |\n"
+"|                 |                 |                 | linear solver   |\n"
+"|                 |                 |                 | class for the   |\n"
+"|                 |                 |                 | KKT system.     |\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
+"| linear_solver_o | OT_DICT         | GenericType()   | Options to be   |\n"
+"| ptions          |                 |                 | passed to the   |\n"
+"|                 |                 |                 | linear solver.  |\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
+"| max_iter        | OT_INTEGER      | 100             | Maximum number  |\n"
+"|                 |                 |                 | of interior     |\n"
+"|                 |                 |                 | point           |\n"
+"|                 |                 |                 | iterations      |\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
+"| print_iteration | OT_BOOLEAN      | false           | Print           |\n"
+"|                 |                 |                 | information     |\n"
+"|                 |                 |                 | about each      |\n"
+"|                 |                 |                 | iteration       |\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
+"| regularization  | OT_REAL         | 0.000           | Regularization  |\n"
+"|                 |                 |                 | of the Newton   |\n"
+"|                 |                 |                 | system          |\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
+"| step_fraction   | OT_REAL         | 0.995           | Fraction of the |\n"
+"|                 |                 |                 | step to the     |\n"
+"|                 |                 |                 | boundary taken  |\n"
+"|                 |                 |                 | in each         |\n"
+"|                 |                 |                 | iteration       |\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
+"| tol             | OT_REAL         | 0.000           | Stopping        |\n"
+"|                 |                 |                 | criterion       |\n"
+"|                 |                 |                 | tolerance on    |\n"
+"|                 |                 |                 | the primal and  |\n"
+"|                 |                 |                 | dual            |\n"
+"|                 |                 |                 | infeasibility   |\n"
+"|                 |                 |                 | and on the      |\n"
+"|                 |                 |                 | average         |\n"
+"|                 |                 |                 | complementarity |\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
+"\n"
+"\n"
+">List of available stats\n"
+"\n"
+"+---------------+\n"
+"|      Id       |\n"
+"+===============+\n"
+"| iter_count    |\n"
+"+---------------+\n"
+"| return_status |\n"
+"+---------------+\n"
+"| t_solve       |\n"
+"+---------------+\n"
+"\n"
+"\n"
+"\n"
+"\n"
+;
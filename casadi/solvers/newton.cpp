@@ -29,6 +29,7 @@
 
 #include "casadi/core/profiling.hpp"
 #include "casadi/core/casadi_options.hpp"
+#include "casadi/core/runtime/runtime.hpp"
 
 #include <iomanip>
 
@@ -61,11 +62,84 @@ namespace casadi {
 
     addOption("print_iteration", OT_BOOLEAN, false,
               "Print information about each iteration");
+    addOption("jacobian_update", OT_STRING, "always",
+              "When to reevaluate and refactorize the Jacobian: at every iteration (always), "
+              "only when the residual contracts too slowly, reusing the factorization across "
+              "iterations and calls (chord), or as chord with Broyden rank-one updates of the "
+              "steps in between (broyden)", "always|chord|broyden");
+    addOption("max_contraction", OT_REAL, 0.5,
+              "Reevaluate a reused Jacobian if the maximum norm of the residual decreases "
+              "by less than this factor in one iteration");
+    addOption("max_reuse", OT_INTEGER, 20,
+              "Maximum number of iterations with the same Jacobian (chord and broyden)");
   }
 
   Newton::~Newton() {
   }
 
+  // Maximum norm of a vector
+  inline double normInf(int n, const double* x) {
+    return n==0 ? 0 : fabs(x[casadi_iamax(n, x, 1)]);
+  }
+
+  const double* Newton::evalResidual(bool with_jac) {
+    // Set up timers for profiling
+    double time_start=0;
+    double time_stop=0;
+    if (CasadiOptions::profiling) {
+      time_start = getRealTime(); // Start timer
+    }
+
+    // Residual function or Jacobian function, the inputs are the same
+    Function& fcn = with_jac ? jac_ : f_;
+    fcn.setInput(output(iout_), iin_);
+    for (int i=0; i<nIn(); ++i)
+      if (i!=iin_) fcn.setInput(input(i), i);
+    fcn.evaluate();
+
+    // Write out profiling information
+    if (CasadiOptions::profiling && !CasadiOptions::profilingBinary) {
+      time_stop = getRealTime(); // Stop timer
+      CasadiOptions::profilingLog
+          << (time_stop-time_start)*1e6 << " ns | "
+          << this << ":" << getOption("name") << ":0|" << fcn.get() << ":"
+          << fcn.getOption("name") << (with_jac ? "|evaluate jacobian" : "|evaluate residual")
+          << std::endl;
+    }
+
+    if (with_jac && monitored("J")) userOut() << "  J = " << jac_.output(0) << std::endl;
+    return with_jac ? jac_.output(1+iout_).ptr() : f_.output(iout_).ptr();
+  }
+
+  bool Newton::broydenStep(double* s) {
+    // Good Broyden update of the inverse Jacobian, applied to the chord step,
+    // cf. C.T. Kelley, Solving nonlinear equations with Newton's method, SIAM 2003
+    // The updated step is formed in the next history entry, s is kept if the update breaks down
+    std::vector<double>& s_new = hist_[nhist_];
+    std::copy(s, s+n_, s_new.begin());
+    if (nhist_>0) {
+      for (int j=0; j+1<nhist_; ++j) {
+        double c = casadi_inner_prod(n_, getPtr(hist_[j]), getPtr(s_new))/hist_norm2_[j];
+        casadi_axpy(n_, c, getPtr(hist_[j+1]), 1, getPtr(s_new), 1);
+      }
+      const std::vector<double>& s_last = hist_[nhist_-1];
+      double denom = 1 - casadi_inner_prod(n_, getPtr(s_last), getPtr(s_new))
+        /hist_norm2_[nhist_-1];
+      if (fabs(denom) < 1e-10) {
+        // Update breaks down, take the chord step and reevaluate the Jacobian in the next iteration
+        jac_valid_ = false;
+        return false;
+      }
+      casadi_scal(n_, 1/denom, getPtr(s_new), 1);
+    }
+
+    // Take and store the step
+    std::copy(s_new.begin(), s_new.end(), s);
+    hist_norm2_[nhist_] = casadi_inner_prod(n_, s, s);
+    if (hist_norm2_[nhist_]>0) nhist_++;
+    return true;
+  }
+
   void Newton::solveNonLinear() {
     casadi_msg("Newton::solveNonLinear:begin");
 
@@ -78,21 +152,27 @@ namespace casadi {
       CasadiOptions::profilingLog  << "start " << this << ":" <<getOption("name") << std::endl;
     }
 
-    // Pass the inputs to J
-    for (int i=0; i<nIn(); ++i) {
-      if (i!=iin_) jac_.setInput(input(i), i);
-    }
-
     // Aliases
     DMatrix &u = output(iout_);
     DMatrix &J = jac_.output(0);
-    DMatrix &F = jac_.output(1+iout_);
 
     // Perform the Newton iterations
     int iter=0;
 
     bool success = true;
 
+    // Residual norm of the previous iteration, for the contraction test
+    double normF_prev = -1;
+
+    // Broyden updates are not carried over from an earlier call
+    nhist_ = 0;
+
+    // Jacobian evaluations, factorizations, steps and Broyden breakdowns in this call
+    int njac = 0, nfact = 0, nstep = 0, nbreakdown = 0;
+
+    // Was the Jacobian function the last function evaluated
+    bool last_jac = false;
+
     while (true) {
       // Break if maximum number of iterations already reached
       if (iter >= max_iter_) {
@@ -114,69 +194,71 @@ namespace casadi {
         userOut() << "  u = " << u << std::endl;
       }
 
-      // Use u to evaluate J
-      jac_.setInput(u, iin_);
-      for (int i=0; i<nIn(); ++i)
-        if (i!=iin_) jac_.setInput(input(i), i);
-
-      if (CasadiOptions::profiling) {
-        time_start = getRealTime(); // Start timer
-      }
+      // Use u to evaluate F, and J for a full Newton step
+      bool new_jac = jacobian_update_==UPDATE_ALWAYS || !jac_valid_;
+      const double* F = evalResidual(new_jac);
+      last_jac = new_jac;
+      if (new_jac) njac++;
 
-      jac_.evaluate();
-
-      // Write out profiling information
-      if (CasadiOptions::profiling && !CasadiOptions::profilingBinary) {
-        time_stop = getRealTime(); // Stop timer
-        CasadiOptions::profilingLog
-            << (time_stop-time_start)*1e6 << " ns | "
-            << (time_stop-time_zero)*1e3 << " ms | "
-            << this << ":" << getOption("name") << ":0|" << jac_.get() << ":"
-            << jac_.getOption("name") << "|evaluate jacobian" << std::endl;
-      }
-
-      if (monitored("F")) userOut() << "  F = " << F << std::endl;
+      if (monitored("F")) userOut() << "  F = " << vector<double>(F, F+n_) << std::endl;
       if (monitored("normF"))
         userOut() << "  F (min, max, 1-norm, 2-norm) = "
-                  << (*std::min_element(F.data().begin(), F.data().end()))
-                  << ", " << (*std::max_element(F.data().begin(), F.data().end()))
-                  << ", " << norm_1(F) << ", " << norm_F(F) << std::endl;
-      if (monitored("J")) userOut() << "  J = " << J << std::endl;
+                  << (*std::min_element(F, F+n_))
+                  << ", " << (*std::max_element(F, F+n_))
+                  << ", " << casadi_asum(n_, F, 1) << ", " << casadi_nrm2(n_, F, 1)
+                  << std::endl;
 
       double abstol = 0;
       if (numeric_limits<double>::infinity() != abstol_) {
-        abstol = std::max((*std::max_element(F.data().begin(),
-                                                  F.data().end())),
-                               -(*std::min_element(F.data().begin(),
-                                                   F.data().end())));
+        abstol = std::max((*std::max_element(F, F+n_)),
+                               -(*std::min_element(F, F+n_)));
         if (abstol <= abstol_) {
           casadi_msg("Converged to acceptable tolerance - abstol: " << abstol_);
           break;
         }
       }
 
-      // Prepare the linear solver with J
-      linsol_.setInput(J, LINSOL_A);
-
-      if (CasadiOptions::profiling) {
-        time_start = getRealTime(); // Start timer
+      if (!new_jac) {
+        // Reevaluate the Jacobian if the residual contracts too slowly
+        double normF = normInf(n_, F);
+        if ((normF_prev>=0 && normF > max_contraction_*normF_prev) || jac_age_>=max_reuse_) {
+          F = evalResidual(true);
+          last_jac = new_jac = true;
+          njac++;
+        }
+        normF_prev = normF;
       }
-      linsol_.prepare();
-      // Write out profiling information
-      if (CasadiOptions::profiling && !CasadiOptions::profilingBinary) {
-        time_stop = getRealTime(); // Stop timer
-        CasadiOptions::profilingLog
-            << (time_stop-time_start)*1e6 << " ns | "
-            << (time_stop-time_zero)*1e3 << " ms | "
-            << this << ":" << getOption("name")
-            << ":1||prepare linear system" << std::endl;
+
+      if (new_jac) {
+        // Prepare the linear solver with J
+        linsol_.setInput(J, LINSOL_A);
+
+        if (CasadiOptions::profiling) {
+          time_start = getRealTime(); // Start timer
+        }
+        linsol_.prepare();
+        // Write out profiling information
+        if (CasadiOptions::profiling && !CasadiOptions::profilingBinary) {
+          time_stop = getRealTime(); // Stop timer
+          CasadiOptions::profilingLog
+              << (time_stop-time_start)*1e6 << " ns | "
+              << (time_stop-time_zero)*1e3 << " ms | "
+              << this << ":" << getOption("name")
+              << ":1||prepare linear system" << std::endl;
+        }
+        nfact++;
+        jac_valid_ = true;
+        jac_age_ = 0;
+        nhist_ = 0;
+        if (jacobian_update_!=UPDATE_ALWAYS) normF_prev = normInf(n_, F);
       }
 
       if (CasadiOptions::profiling) {
         time_start = getRealTime(); // Start timer
       }
       // Solve against F
-      linsol_.solve(&F.front(), 1, false);
+      std::copy(F, F+n_, step_.begin());
+      linsol_.solve(getPtr(step_), 1, false);
       if (CasadiOptions::profiling && !CasadiOptions::profilingBinary) {
         time_stop = getRealTime(); // Stop timer
         CasadiOptions::profilingLog
@@ -185,16 +267,19 @@ namespace casadi {
             << this << ":" << getOption("name") << ":2||solve linear system" << std::endl;
       }
 
+      // Correct the step with the previous steps
+      casadi_scal(n_, -1., getPtr(step_), 1);
+      if (jacobian_update_==UPDATE_BROYDEN && !broydenStep(getPtr(step_))) nbreakdown++;
+      jac_age_++;
+      nstep++;
+
       if (monitored("step")) {
-        userOut() << "  step = " << F << std::endl;
+        userOut() << "  step = " << step_ << std::endl;
       }
 
       double abstolStep=0;
       if (numeric_limits<double>::infinity() != abstolStep_) {
-        abstolStep = std::max((*std::max_element(F.data().begin(),
-                                                  F.data().end())),
-                               -(*std::min_element(F.data().begin(),
-                                                   F.data().end())));
+        abstolStep = normInf(n_, getPtr(step_));
         if (monitored("stepsize")) {
           userOut() << "  stepsize = " << abstolStep << std::endl;
         }
@@ -215,17 +300,32 @@ namespace casadi {
       }
 
       // Update Xk+1 = Xk - J^(-1) F
-      std::transform(u.begin(), u.end(), F.begin(), u.begin(), std::minus<double>());
+      std::transform(u.begin(), u.end(), step_.begin(), u.begin(), std::plus<double>());
 
     }
 
     // Get auxiliary outputs
     for (int i=0; i<nOut(); ++i) {
-      if (i!=iout_) jac_.getOutput(output(i), 1+i);
+      if (i!=iout_) {
+        if (last_jac) {
+          jac_.getOutput(output(i), 1+i);
+        } else {
+          f_.getOutput(output(i), i);
+        }
+      }
     }
 
     // Store the iteration count
-    if (gather_stats_) stats_["iter"] = iter;
+    if (gather_stats_) {
+      stats_["iter"] = iter;
+
+      // Jacobian evaluations and factorizations, and how many a full Newton method would need
+      stats_["njevals"] = njac;
+      stats_["nfactorizations"] = nfact;
+      stats_["njevals_saved"] = iter - njac;
+      stats_["nfactorizations_saved"] = nstep - nfact;
+      stats_["broyden_breakdowns"] = nbreakdown;
+    }
 
     if (success) stats_["return_status"] = "success";
 
@@ -256,6 +356,33 @@ namespace casadi {
 
     print_iteration_ = getOption("print_iteration");
 
+    // Jacobian update strategy
+    if (getOption("jacobian_update")=="always") {
+      jacobian_update_ = UPDATE_ALWAYS;
+    } else if (getOption("jacobian_update")=="chord") {
+      jacobian_update_ = UPDATE_CHORD;
+    } else if (getOption("jacobian_update")=="broyden") {
+      jacobian_update_ = UPDATE_BROYDEN;
+    } else {
+      casadi_error("Newton::init: unknown jacobian_update \"" << getOption("jacobian_update")
+                   << "\"");
+    }
+    max_contraction_ = getOption("max_contraction");
+    max_reuse_ = getOption("max_reuse");
+    casadi_assert_message(max_reuse_>0, "Newton::init: max_reuse must be positive");
+
+    // No factorization yet
+    jac_valid_ = false;
+    jac_age_ = 0;
+
+    // Work vectors
+    step_.resize(n_);
+    if (jacobian_update_==UPDATE_BROYDEN) {
+      hist_.resize(max_reuse_, std::vector<double>(n_));
+      hist_norm2_.resize(max_reuse_);
+    }
+    nhist_ = 0;
+
   }
 
   void Newton::printIteration(std::ostream &stream) {
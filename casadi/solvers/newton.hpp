@@ -34,6 +34,13 @@
 
 /** \defgroup plugin_ImplicitFunction_newton
      Implements simple newton iterations to solve an implicit function.
+
+     With the option jacobian_update set to chord, the factorized Jacobian
+     is reused by later iterations and by later calls (simplified Newton),
+     until the residual contracts by less than max_contraction in one
+     iteration or the Jacobian has been used for max_reuse iterations.
+     With broyden, the steps taken with the same factorization are in
+     addition corrected by Broyden rank-one updates of the inverse Jacobian.
 */
 
 /** \pluginsection{ImplicitFunction,newton} */
@@ -91,6 +98,36 @@ namespace casadi {
     /// If true, each iteration will be printed
     bool print_iteration_;
 
+    /// Jacobian update strategy
+    enum JacobianUpdate {UPDATE_ALWAYS, UPDATE_CHORD, UPDATE_BROYDEN};
+    JacobianUpdate jacobian_update_;
+
+    /// Residual contraction above which a reused Jacobian is reevaluated
+    double max_contraction_;
+
+    /// Maximum number of iterations with the same Jacobian
+    int max_reuse_;
+
+    /// Is the factorization valid, number of iterations since the factorization
+    bool jac_valid_;
+    int jac_age_;
+
+    /// Newton step
+    std::vector<double> step_;
+
+    /// Broyden updates: steps since the factorization and their squared norms
+    std::vector<std::vector<double> > hist_;
+    std::vector<double> hist_norm2_;
+    int nhist_;
+
+    /// Evaluate the residual at u, and the Jacobian if requested
+    const double* evalResidual(bool with_jac);
+
+    /** \brief Apply the Broyden updates to a step and append it to the history
+
+        Returns false, leaving the step unchanged, if the update breaks down */
+    bool broydenStep(double* s);
+
     /// Print iteration header
     void printIteration(std::ostream &stream);
 
@@ -0,0 +1,1053 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include "periodic_schur_dple.hpp"
+
+#include "../core/std_vector_tools.hpp"
+#include "../core/function/mx_function.hpp"
+
+#include <cmath>
+#include <ctime>
+#include <limits>
+
+INPUTSCHEME(DPLEInput)
+OUTPUTSCHEME(DPLEOutput)
+
+using namespace std;
+namespace casadi {
+
+  void periodic_schur(const std::vector< Matrix<double> > & a,
+                      std::vector< Matrix<double> > & t, std::vector< Matrix<double> > & z,
+                      std::vector< double > & eig_real, std::vector< double > & eig_imag,
+                      double num_zero);
+
+  extern "C"
+  int CASADI_DPLESOLVER_PERIODIC_SCHUR_EXPORT
+  casadi_register_dplesolver_periodic_schur(DpleInternal::Plugin* plugin) {
+    plugin->creator = PeriodicSchurDple::creator;
+    plugin->name = "periodic_schur";
+    plugin->doc = PeriodicSchurDple::meta_doc.c_str();
+    plugin->version = 23;
+    plugin->exposed.periodic_shur = periodic_schur;
+    return 0;
+  }
+
+  extern "C"
+  void CASADI_DPLESOLVER_PERIODIC_SCHUR_EXPORT casadi_load_dplesolver_periodic_schur() {
+    DpleInternal::registerPlugin(casadi_register_dplesolver_periodic_schur);
+  }
+
+  PeriodicSchurDple::PeriodicSchurDple(const std::map<std::string, std::vector<Sparsity> > & st,
+                                       int nrhs, bool transp) : DpleInternal(st, nrhs, transp) {
+
+    // set default options
+    setOption("name", "unnamed_periodic_schur_dple_solver"); // name of the function
+
+    setOption("pos_def", false);
+    setOption("const_dim", true);
+
+    addOption("psd_num_zero",             OT_REAL,         0.0,
+              "Numerical zero used in the periodic Schur decomposition: entries of the "
+              "periodic Hessenberg-triangular form smaller than this are set to zero");
+    addOption("max_iter",                 OT_INTEGER,      30,
+              "Maximum number of periodic QR iterations per eigenvalue");
+  }
+
+  PeriodicSchurDple::~PeriodicSchurDple() {
+
+  }
+
+  void PeriodicSchurDple::init() {
+
+    DpleInternal::init();
+
+    casadi_assert_message(!pos_def_,
+                          "pos_def option set to True: Solver only handles the indefinite case.");
+    casadi_assert_message(const_dim_,
+                          "const_dim option set to False: Solver only handles the True case.");
+
+    DenseIO::init();
+
+    psd_num_zero_ = getOption("psd_num_zero");
+    max_iter_ = getOption("max_iter");
+
+    n_ = A_[0].size1();
+
+    // Allocate data structures
+    S_.resize(n_*n_*K_);
+    Q_.resize(n_*n_*K_);
+    W_.resize(n_*n_*K_);
+    X_.resize(n_*n_*K_);
+    if (transp_) St_.resize(n_*n_*K_);
+    Y_.resize(2*n_*K_);
+    Z_.resize(2*n_*K_);
+    g_.resize(76*K_);
+    tmp_.resize(n_*n_);
+
+    eig_real_.resize(n_);
+    eig_imag_.resize(n_);
+
+    // There can be at most n partitions
+    part_.reserve(n_+1);
+  }
+
+  /// Element (i, j) of the column-major n-by-n matrix m
+  inline double& el(double* m, int n, int i, int j) { return m[i+j*n];}
+  inline double el(const double* m, int n, int i, int j) { return m[i+j*n];}
+
+  /** \brief Householder reflector H = I - tau*u*u' such that H*x = beta*e_1
+
+      On return, x holds u with the implicit u[0]=1 stored explicitly.
+  */
+  static void house(int m, double* x, double& tau, double& beta) {
+    double alpha = x[0];
+    double xnorm = 0;
+    for (int i=1; i<m; ++i) xnorm = std::max(xnorm, fabs(x[i]));
+    if (xnorm==0) {
+      tau = 0;
+      beta = alpha;
+      x[0] = 1;
+      return;
+    }
+    double s = 0;
+    for (int i=1; i<m; ++i) s += (x[i]/xnorm)*(x[i]/xnorm);
+    xnorm *= sqrt(s);
+    beta = alpha>=0 ? -hypot(alpha, xnorm) : hypot(alpha, xnorm);
+    tau = (beta-alpha)/beta;
+    double f = 1/(alpha-beta);
+    for (int i=1; i<m; ++i) x[i] *= f;
+    x[0] = 1;
+  }
+
+  /// M(i0:i0+m, j0:j1) <- H*M(i0:i0+m, j0:j1)
+  static void applyLeft(double* M, int n, int i0, int m, const double* u, double tau,
+                        int j0, int j1) {
+    if (tau==0) return;
+    for (int j=j0; j<j1; ++j) {
+      double* Mj = M + i0 + j*n;
+      double s = 0;
+      for (int l=0; l<m; ++l) s += u[l]*Mj[l];
+      s *= tau;
+      for (int l=0; l<m; ++l) Mj[l] -= s*u[l];
+    }
+  }
+
+  /// M(i0:i1, j0:j0+m) <- M(i0:i1, j0:j0+m)*H, w has length i1-i0
+  static void applyRight(double* M, int n, int j0, int m, const double* u, double tau,
+                         int i0, int i1, double* w) {
+    if (tau==0) return;
+    int nr = i1-i0;
+    for (int i=0; i<nr; ++i) w[i] = 0;
+    for (int l=0; l<m; ++l) {
+      const double* Ml = M + i0 + (j0+l)*n;
+      for (int i=0; i<nr; ++i) w[i] += Ml[i]*u[l];
+    }
+    for (int l=0; l<m; ++l) {
+      double* Ml = M + i0 + (j0+l)*n;
+      double f = tau*u[l];
+      for (int i=0; i<nr; ++i) Ml[i] -= f*w[i];
+    }
+  }
+
+  /** \brief Leading 2-by-2 and trailing 3-by-3 diagonal blocks of the scaled product
+
+      H = T_0*T_1*...*T_{K-1} restricted to the window [l, i], returns the entries
+      H(l:l+2, l:l+1) in lead (column-major 3-by-2) and H(i-2:i, i-2:i) in trail.
+      Each factor is scaled by the largest entry of its two blocks, which only
+      scales H since the factors T_1..T_{K-1} are upper triangular.
+  */
+  static void windowProduct(int n, int K, const double* t, int l, int i,
+                            double* lead, double* trail) {
+    int nn = n*n;
+    double Rl[4] = {1, 0, 0, 1}, Rt[9] = {1, 0, 0, 0, 1, 0, 0, 0, 1};
+    double s0 = 0;
+    for (int k=1; k<K; ++k) {
+      const double* T = t + k*nn;
+      double s = 0;
+      for (int c=0; c<2; ++c)
+        for (int r=0; r<=c; ++r) s = std::max(s, fabs(el(T, n, l+r, l+c)));
+      for (int c=0; c<3; ++c)
+        for (int r=0; r<=c; ++r) s = std::max(s, fabs(el(T, n, i-2+r, i-2+c)));
+      s = s==0 ? 1 : 1/s;
+      // Rl <- Rl*T(l:l+2, l:l+2)*s, upper triangular
+      double Rn[9];
+      for (int c=0; c<2; ++c) {
+        for (int r=0; r<=c; ++r) {
+          double v = 0;
+          for (int q=r; q<=c; ++q) v += Rl[r+2*q]*el(T, n, l+q, l+c);
+          Rn[r+2*c] = v*s;
+        }
+      }
+      Rl[0] = Rn[0]; Rl[2] = Rn[2]; Rl[3] = Rn[3];
+      for (int c=0; c<3; ++c) {
+        for (int r=0; r<=c; ++r) {
+          double v = 0;
+          for (int q=r; q<=c; ++q) v += Rt[r+3*q]*el(T, n, i-2+q, i-2+c);
+          Rn[r+3*c] = v*s;
+        }
+      }
+      for (int c=0; c<3; ++c)
+        for (int r=0; r<=c; ++r) Rt[r+3*c] = Rn[r+3*c];
+    }
+    // Scaling of the Hessenberg factor
+    for (int c=0; c<2; ++c)
+      for (int r=0; r<3; ++r) s0 = std::max(s0, fabs(el(t, n, l+r, l+c)));
+    for (int c=0; c<3; ++c)
+      for (int r=0; r<3; ++r) s0 = std::max(s0, fabs(el(t, n, i-2+r, i-2+c)));
+    s0 = s0==0 ? 1 : 1/s0;
+    // H(r, c) = sum_q T_0(r, q)*R(q, c) with T_0 Hessenberg and T_0(l, l-1) = 0
+    for (int c=0; c<2; ++c) {
+      for (int r=0; r<3; ++r) {
+        double v = 0;
+        for (int q=std::max(r-1, 0); q<=c; ++q) v += el(t, n, l+r, l+q)*Rl[q+2*c];
+        lead[r+3*c] = v*s0;
+      }
+    }
+    for (int c=0; c<3; ++c) {
+      for (int r=0; r<3; ++r) {
+        double v = 0;
+        for (int q=std::max(r-1, 0); q<=c; ++q) v += el(t, n, i-2+r, i-2+q)*Rt[q+3*c];
+        trail[r+3*c] = v*s0;
+      }
+    }
+  }
+
+  /// Periodic QR algorithm with implicit double shifts on a periodic Hessenberg form
+  static bool periodicQr(int n, int K, double* t, double* z, int max_iter, double* w) {
+    int nn = n*n;
+    const double eps = std::numeric_limits<double>::epsilon();
+    double* T0 = t;
+    int i = n-1;
+    while (i>=0) {
+      int l = 0;
+      bool converged = false;
+      for (int its=0; its<max_iter*std::max(10, n); ++its) {
+        // Look for a single small subdiagonal element of the Hessenberg factor
+        int m;
+        for (m=i; m>l; --m) {
+          double h = fabs(el(T0, n, m, m-1));
+          if (h==0) break;
+          double tst = fabs(el(T0, n, m-1, m-1)) + fabs(el(T0, n, m, m));
+          if (tst==0) {
+            if (m-2>=l) tst += fabs(el(T0, n, m-1, m-2));
+            if (m+1<=i) tst += fabs(el(T0, n, m+1, m));
+          }
+          if (h<=eps*tst) {
+            el(T0, n, m, m-1) = 0;
+            break;
+          }
+        }
+        l = m;
+
+        // A 1x1 or 2x2 block has split off
+        if (l>=i-1) {
+          converged = true;
+          break;
+        }
+
+        // Shifts from the trailing 2x2 block of the product, first column of the
+        // double shift polynomial from the leading block
+        double lead[6], trail[9];
+        windowProduct(n, K, t, l, i, lead, trail);
+        double tr, det;
+        if (its==10 || its==20) {
+          // Exceptional shift
+          double s = fabs(trail[2+3*1]) + fabs(trail[1+3*0]);
+          double h11 = 0.75*s + trail[2+3*2];
+          tr = 2*h11;
+          det = h11*h11 + 0.4375*s*s;
+        } else {
+          double h11 = trail[1+3*1], h12 = trail[1+3*2], h21 = trail[2+3*1],
+            h22 = trail[2+3*2];
+          tr = h11 + h22;
+          det = h11*h22 - h12*h21;
+        }
+        double H11 = lead[0], H21 = lead[1], H12 = lead[3], H22 = lead[4], H32 = lead[5];
+        double v[3];
+        v[0] = H11*H11 + H12*H21 - tr*H11 + det;
+        v[1] = H21*(H11 + H22 - tr);
+        v[2] = H21*H32;
+        double vs = fabs(v[0]) + fabs(v[1]) + fabs(v[2]);
+        if (vs==0) vs = 1;
+        for (int q=0; q<3; ++q) v[q] /= vs;
+
+        // Chase the bulge through all factors
+        for (int k=l; k<i; ++k) {
+          int nr = std::min(3, i-k+1);
+          if (k>l) {
+            for (int q=0; q<nr; ++q) v[q] = el(T0, n, k+q, k-1);
+          }
+          double tau, beta;
+          house(nr, v, tau, beta);
+          if (k>l) {
+            el(T0, n, k, k-1) = beta;
+            for (int q=1; q<nr; ++q) el(T0, n, k+q, k-1) = 0;
+          }
+          if (tau==0) continue;
+
+          // Z_0 acts on T_0 from the left and on T_{K-1} from the right
+          applyLeft(T0, n, k, nr, v, tau, k, n);
+          applyRight(t+(K-1)*nn, n, k, nr, v, tau, 0,
+                     K==1 ? std::min(k+3, i)+1 : k+nr, w);
+          applyRight(z, n, k, nr, v, tau, 0, n, w);
+
+          // Restore the triangular factors, Z_kk acts on T_{kk-1} from the right
+          for (int kk=K-1; kk>=1; --kk) {
+            double* T = t + kk*nn;
+            for (int c=0; c<nr-1; ++c) {
+              double u[3];
+              for (int q=c; q<nr; ++q) u[q-c] = el(T, n, k+q, k+c);
+              double tauc, betac;
+              house(nr-c, u, tauc, betac);
+              el(T, n, k+c, k+c) = betac;
+              for (int q=c+1; q<nr; ++q) el(T, n, k+q, k+c) = 0;
+              applyLeft(T, n, k+c, nr-c, u, tauc, k+c+1, n);
+              applyRight(t+(kk-1)*nn, n, k+c, nr-c, u, tauc, 0,
+                         kk==1 ? std::min(k+nr, i)+1 : k+nr, w);
+              applyRight(z+kk*nn, n, k+c, nr-c, u, tauc, 0, n, w);
+            }
+          }
+        }
+      }
+      if (!converged) return false;
+      i = l-1;
+    }
+    return true;
+  }
+
+  bool periodic_schur(int n, int K, const double* a, double* t, double* z,
+                      double* eig_real, double* eig_imag, double num_zero, int max_iter) {
+    int nn = n*n;
+    std::copy(a, a+nn*K, t);
+    std::fill(z, z+nn*K, 0.0);
+    for (int k=0; k<K; ++k)
+      for (int i=0; i<n; ++i) el(z+k*nn, n, i, i) = 1;
+    std::vector<double> u(n), w(n);
+
+    // Reduction to periodic Hessenberg-triangular form:
+    // Z_k acts on T_k from the left and on T_{k-1} from the right
+    for (int j=0; j<n; ++j) {
+      for (int k=K-1; k>=1 && j<n-1; --k) {
+        double* T = t + k*nn;
+        int m = n-j;
+        for (int q=0; q<m; ++q) u[q] = el(T, n, j+q, j);
+        double tau, beta;
+        house(m, &u[0], tau, beta);
+        el(T, n, j, j) = beta;
+        for (int q=1; q<m; ++q) el(T, n, j+q, j) = 0;
+        applyLeft(T, n, j, m, &u[0], tau, j+1, n);
+        applyRight(t+(k-1)*nn, n, j, m, &u[0], tau, 0, n, &w[0]);
+        applyRight(z+k*nn, n, j, m, &u[0], tau, 0, n, &w[0]);
+      }
+      if (j<n-2) {
+        int m = n-j-1;
+        for (int q=0; q<m; ++q) u[q] = el(t, n, j+1+q, j);
+        double tau, beta;
+        house(m, &u[0], tau, beta);
+        el(t, n, j+1, j) = beta;
+        for (int q=1; q<m; ++q) el(t, n, j+1+q, j) = 0;
+        applyLeft(t, n, j+1, m, &u[0], tau, j+1, n);
+        applyRight(t+(K-1)*nn, n, j+1, m, &u[0], tau, 0, n, &w[0]);
+        applyRight(z, n, j+1, m, &u[0], tau, 0, n, &w[0]);
+      }
+    }
+
+    // Set numerical zeros to zero
+    if (num_zero>0) {
+      for (int k=0; k<nn*K; ++k) {
+        if (fabs(t[k])<num_zero) t[k] = 0.0;
+      }
+    }
+
+    if (!periodicQr(n, K, t, z, max_iter, &w[0])) return false;
+
+    // Eigenvalues of T_0*T_1*..*T_{K-1} from its 1x1 and 2x2 diagonal blocks
+    for (int i=0; i<n; ) {
+      if (i+1<n && el(t, n, i+1, i)!=0) {
+        double B[4] = {el(t, n, i, i), el(t, n, i+1, i), el(t, n, i, i+1), el(t, n, i+1, i+1)};
+        for (int k=1; k<K; ++k) {
+          const double* T = t + k*nn;
+          double t11 = el(T, n, i, i), t12 = el(T, n, i, i+1), t22 = el(T, n, i+1, i+1);
+          double b0 = B[0]*t11, b1 = B[1]*t11;
+          B[2] = B[0]*t12 + B[2]*t22;
+          B[3] = B[1]*t12 + B[3]*t22;
+          B[0] = b0;
+          B[1] = b1;
+        }
+        double hm = (B[0]+B[3])/2;
+        double disc = hm*hm - (B[0]*B[3] - B[1]*B[2]);
+        if (disc>=0) {
+          eig_real[i] = hm + sqrt(disc);
+          eig_real[i+1] = hm - sqrt(disc);
+          eig_imag[i] = eig_imag[i+1] = 0;
+        } else {
+          eig_real[i] = eig_real[i+1] = hm;
+          eig_imag[i] = sqrt(-disc);
+          eig_imag[i+1] = -sqrt(-disc);
+        }
+        i += 2;
+      } else {
+        double p = 1;
+        for (int k=0; k<K; ++k) p *= el(t+k*nn, n, i, i);
+        eig_real[i] = p;
+        eig_imag[i] = 0;
+        i += 1;
+      }
+    }
+    return true;
+  }
+
+  void periodic_schur(const std::vector< Matrix<double> > & a,
+                      std::vector< Matrix<double> > & t, std::vector< Matrix<double> > & z,
+                      std::vector< double > & eig_real, std::vector< double > & eig_imag,
+                      double num_zero) {
+    int K = a.size();
+    int n = a[0].size1();
+    for (int k=0;k<K;++k) {
+      casadi_assert_message(a[k].issquare(), "a must be square");
+      casadi_assert_message(a[k].size1()==n, "a must be n-by-n");
+      casadi_assert_message(a[k].isdense(), "a must be dense");
+    }
+
+    std::vector<double> a_data(n*n*K);
+    // Copy data into consecutive structure
+    for (int k=0;k<K;++k) {
+      std::copy(a[k].begin(), a[k].end(), a_data.begin()+k*n*n);
+    }
+
+    std::vector<double> t_data(n*n*K);
+    std::vector<double> z_data(n*n*K);
+    eig_real.resize(n);
+    eig_imag.resize(n);
+
+    casadi_assert_message(periodic_schur(n, K, getPtr(a_data), getPtr(t_data), getPtr(z_data),
+                                         getPtr(eig_real), getPtr(eig_imag), num_zero),
+                          "periodic_schur: periodic QR algorithm failed to converge.");
+
+    t.resize(K);
+    z.resize(K);
+    for (int k=0;k<K;++k) {
+      t[k] = DMatrix::zeros(n, n);
+      std::copy(t_data.begin()+k*n*n, t_data.begin()+(k+1)*n*n, t[k].begin());
+      z[k] = DMatrix::zeros(n, n);
+      std::copy(z_data.begin()+k*n*n, z_data.begin()+(k+1)*n*n, z[k].begin());
+    }
+  }
+
+  /** \brief Solve x_{k+1} = M_k x_k + g_k, k = 0..K-1, x_K = x_0, with m <= 4 unknowns each
+
+      Gaussian elimination with partial pivoting on the block bidiagonal system with a
+      corner block, which only fills in the last block column. lu holds 52*K doubles.
+  */
+  static bool solveCyclic(int K, int m, const double* M, const double* g, double* x, double* lu) {
+    // Panel of two block rows with the columns [x_j, x_{j+1}, x_{K-1}, rhs]
+    const int ld = 2*m;
+    double pn[8*13];
+    double cur[4*4], spike[4*4], rhs[4];
+
+    // Block row 0: x_0 - M_{K-1} x_{K-1} = g_{K-1}
+    for (int q=0; q<m*m; ++q) {
+      cur[q] = 0;
+      spike[q] = -M[16*(K-1)+q];
+    }
+    for (int q=0; q<m; ++q) {
+      cur[q+m*q] = 1;
+      rhs[q] = g[4*(K-1)+q];
+    }
+    if (K==1) {
+      for (int q=0; q<m*m; ++q) {
+        cur[q] += spike[q];
+        spike[q] = 0;
+      }
+    }
+
+    for (int j=0; j<K-1; ++j) {
+      // Current block row on top, block row j+1: x_{j+1} - M_j x_j = g_j below
+      bool last = j+1==K-1;
+      for (int c=0; c<3*m+1; ++c)
+        for (int r=0; r<ld; ++r) pn[r+ld*c] = 0;
+      for (int c=0; c<m; ++c) {
+        for (int r=0; r<m; ++r) {
+          pn[r+ld*c] = cur[r+m*c];
+          pn[r+ld*(c+(last ? m : 2*m))] += spike[r+m*c];
+          pn[m+r+ld*c] = -M[16*j+r+m*c];
+        }
+        pn[m+c+ld*(m+c)] = 1;
+        pn[c+ld*3*m] = rhs[c];
+        pn[m+c+ld*3*m] = g[4*j+c];
+      }
+
+      // Eliminate x_j
+      for (int c=0; c<m; ++c) {
+        int piv = c;
+        for (int r=c+1; r<ld; ++r) if (fabs(pn[r+ld*c])>fabs(pn[piv+ld*c])) piv = r;
+        if (pn[piv+ld*c]==0) return false;
+        if (piv!=c) {
+          for (int q=c; q<3*m+1; ++q) std::swap(pn[c+ld*q], pn[piv+ld*q]);
+        }
+        for (int r=c+1; r<ld; ++r) {
+          double f = pn[r+ld*c]/pn[c+ld*c];
+          if (f==0) continue;
+          for (int q=c+1; q<3*m+1; ++q) pn[r+ld*q] -= f*pn[c+ld*q];
+        }
+      }
+
+      // Store the pivot rows [U_j, N_j, C_j, r_j], carry over the remaining rows
+      double* luj = lu + 52*j;
+      for (int c=0; c<3*m+1; ++c)
+        for (int r=0; r<m; ++r) luj[r+m*c] = pn[r+ld*c];
+      for (int c=0; c<m; ++c) {
+        for (int r=0; r<m; ++r) {
+          cur[r+m*c] = pn[m+r+ld*(m+c)];
+          spike[r+m*c] = pn[m+r+ld*(2*m+c)];
+        }
+        rhs[c] = pn[m+c+ld*3*m];
+      }
+    }
+
+    // Last block row: cur x_{K-1} = rhs
+    double* xl = x + 4*(K-1);
+    for (int c=0; c<m; ++c) {
+      int piv = c;
+      for (int r=c+1; r<m; ++r) if (fabs(cur[r+m*c])>fabs(cur[piv+m*c])) piv = r;
+      if (cur[piv+m*c]==0) return false;
+      if (piv!=c) {
+        for (int q=c; q<m; ++q) std::swap(cur[c+m*q], cur[piv+m*q]);
+        std::swap(rhs[c], rhs[piv]);
+      }
+      for (int r=c+1; r<m; ++r) {
+        double f = cur[r+m*c]/cur[c+m*c];
+        for (int q=c+1; q<m; ++q) cur[r+m*q] -= f*cur[c+m*q];
+        rhs[r] -= f*rhs[c];
+      }
+    }
+    for (int r=m-1; r>=0; --r) {
+      double v = rhs[r];
+      for (int q=r+1; q<m; ++q) v -= cur[r+m*q]*xl[q];
+      xl[r] = v/cur[r+m*r];
+    }
+
+    // Back substitution: U_j x_j = r_j - N_j x_{j+1} - C_j x_{K-1}
+    for (int j=K-2; j>=0; --j) {
+      const double* luj = lu + 52*j;
+      double* xj = x + 4*j;
+      const double* xn = x + 4*(j+1);
+      for (int r=m-1; r>=0; --r) {
+        double v = luj[r+m*3*m];
+        for (int q=0; q<m; ++q) v -= luj[r+m*(m+q)]*xn[q] + luj[r+m*(2*m+q)]*xl[q];
+        for (int q=r+1; q<m; ++q) v -= luj[r+m*q]*xj[q];
+        xj[r] = v/luj[r+m*r];
+      }
+    }
+    return true;
+  }
+
+  void PeriodicSchurDple::solveSchur(const std::vector<double>& S, std::vector<double>& W) {
+    int n = n_, nn = n*n;
+    const double* s = getPtr(S);
+    double* x = getPtr(X_);
+    double* y = getPtr(Y_);
+    double* z = getPtr(Z_);
+    double* g = getPtr(g_);
+    double* xb = g + 4*K_;
+    double* M = xb + 4*K_;
+    double* lu = M + 16*K_;
+
+    // Block partition: 2x2 blocks wherever a factor has a nonzero subdiagonal entry
+    part_.clear();
+    for (int i=0; i<n; ) {
+      part_.push_back(i);
+      bool two = false;
+      for (int k=0; k<K_ && i+1<n && !two; ++k) two = el(s+k*nn, n, i+1, i)!=0;
+      i += two ? 2 : 1;
+    }
+    part_.push_back(n);
+    int nb = part_.size()-1;
+
+    // Solve for the blocks of X_k, starting from the bottom right corner
+    for (int c=nb-1; c>=0; --c) {
+      int c0 = part_[c], c1 = part_[c+1], bc = c1-c0;
+
+      for (int k=0; k<K_; ++k) {
+        const double* Sk = s + k*nn;
+        const double* Xk = x + k*nn;
+        double* Yk = y + 2*n*k;
+        double* Zk = z + 2*n*k;
+
+        // Y_k = X_k(:, c1:n)*S_k(c0:c1, c1:n)'
+        std::fill(Yk, Yk+2*n, 0.0);
+        for (int q=c1; q<n; ++q) {
+          for (int jj=0; jj<bc; ++jj) {
+            double sv = el(Sk, n, c0+jj, q);
+            if (sv==0) continue;
+            for (int p=0; p<n; ++p) Yk[p+n*jj] += Xk[p+q*n]*sv;
+          }
+        }
+
+        // Z_k = Y_k + X_k(:, c0:c1)*S_k(c0:c1, c0:c1)' for the rows already known
+        for (int jj=0; jj<bc; ++jj) {
+          for (int p=c1; p<n; ++p) {
+            double v = Yk[p+n*jj];
+            for (int b=jj; b<bc; ++b) v += Xk[p+(c0+b)*n]*el(Sk, n, c0+jj, c0+b);
+            if (bc==2 && jj==1) v += Xk[p+c0*n]*el(Sk, n, c0+1, c0);
+            Zk[p+n*jj] = v;
+          }
+        }
+      }
+
+      for (int r=c; r>=0; --r) {
+        int r0 = part_[r], r1 = part_[r+1], br = r1-r0, m = br*bc;
+
+        // Right hand side of the periodic Sylvester equation for the block (r, c)
+        for (int k=0; k<K_; ++k) {
+          const double* Sk = s + k*nn;
+          const double* Wk = getPtr(W) + k*nn;
+          const double* Yk = y + 2*n*k;
+          const double* Zk = z + 2*n*k;
+          for (int jj=0; jj<bc; ++jj) {
+            for (int ii=0; ii<br; ++ii) {
+              double v = el(Wk, n, r0+ii, c0+jj);
+              for (int a=0; a<br; ++a) v += el(Sk, n, r0+ii, r0+a)*Yk[r0+a+n*jj];
+              for (int p=r1; p<n; ++p) v += el(Sk, n, r0+ii, p)*Zk[p+n*jj];
+              g[4*k+ii+br*jj] = v;
+            }
+          }
+        }
+
+        // x_{k+1} = M_k x_k + g_k with M_k = kron(S_k(c, c), S_k(r, r))
+        for (int k=0; k<K_; ++k) {
+          const double* Sk = s + k*nn;
+          double* Mk = M + 16*k;
+          for (int b=0; b<bc; ++b)
+            for (int a=0; a<br; ++a)
+              for (int jj=0; jj<bc; ++jj)
+                for (int ii=0; ii<br; ++ii)
+                  Mk[ii+br*jj + m*(a+br*b)] =
+                    el(Sk, n, r0+ii, r0+a)*el(Sk, n, c0+jj, c0+b);
+        }
+        casadi_assert_message(solveCyclic(K_, m, M, g, xb, lu),
+                              "PeriodicSchurDple: the periodic Lyapunov equation is singular, "
+                              "the monodromy matrix has eigenvalues with product one.");
+
+        // Store the block and its transpose
+        for (int k=0; k<K_; ++k) {
+          double* Xk = x + k*nn;
+          for (int jj=0; jj<bc; ++jj) {
+            for (int ii=0; ii<br; ++ii) {
+              el(Xk, n, r0+ii, c0+jj) = xb[4*k+ii+br*jj];
+              el(Xk, n, c0+jj, r0+ii) = xb[4*k+ii+br*jj];
+            }
+          }
+        }
+
+        // Z_k(r0:r1, :) = Y_k(r0:r1, :) + X_k(r0:r1, c0:c1)*S_k(c0:c1, c0:c1)'
+        for (int k=0; k<K_; ++k) {
+          const double* Sk = s + k*nn;
+          const double* Xk = x + k*nn;
+          const double* Yk = y + 2*n*k;
+          double* Zk = z + 2*n*k;
+          for (int jj=0; jj<bc; ++jj) {
+            for (int ii=r0; ii<r1; ++ii) {
+              double v = Yk[ii+n*jj];
+              for (int b=0; b<bc; ++b) v += el(Xk, n, ii, c0+b)*el(Sk, n, c0+jj, c0+b);
+              Zk[ii+n*jj] = v;
+            }
+          }
+        }
+      }
+    }
+
+    std::copy(X_.begin(), X_.end(), W.begin());
+  }
+
+  // C = A*B, all n-by-n
+  static void dense_mul_nn(int n, const double* A, const double* B, double* C) {
+    std::fill(C, C+n*n, 0.0);
+    for (int j=0; j<n; ++j) {
+      for (int l=0; l<n; ++l) {
+        double b = B[l+j*n];
+        if (b==0) continue;
+        for (int i=0; i<n; ++i) C[i+j*n] += A[i+l*n]*b;
+      }
+    }
+  }
+
+  // C = A'*B, all n-by-n
+  static void dense_mul_tn(int n, const double* A, const double* B, double* C) {
+    for (int j=0; j<n; ++j) {
+      for (int i=0; i<n; ++i) {
+        double v = 0;
+        for (int l=0; l<n; ++l) v += A[l+i*n]*B[l+j*n];
+        C[i+j*n] = v;
+      }
+    }
+  }
+
+  // C = A*B', all n-by-n
+  static void dense_mul_nt(int n, const double* A, const double* B, double* C) {
+    std::fill(C, C+n*n, 0.0);
+    for (int l=0; l<n; ++l) {
+      for (int j=0; j<n; ++j) {
+        double b = B[j+l*n];
+        if (b==0) continue;
+        for (int i=0; i<n; ++i) C[i+j*n] += A[i+l*n]*b;
+      }
+    }
+  }
+
+  void PeriodicSchurDple::evaluate() {
+    DenseIO::readInputs();
+
+    double t_psd = 0;          // Time spent in periodic Schur decomposition
+    double t_solve = 0;        // Time spent in the block back-substitution
+    double time_total_start = clock();
+
+    int n = n_, nn = n*n;
+    const std::vector<double>& A = inputD(DPLE_A).data();
+
+    // Periodic Schur form of C_j = A_{K-1-j}, Z_j' C_j Z_{j+1} = T_j. Then
+    // S_k = Q_{k+1}' A_k Q_k holds with S_k = T_{K-1-k} and Q_k = Z_{(K-k)%K}
+    for (int k=0; k<K_; ++k) {
+      std::copy(A.begin()+(K_-1-k)*nn, A.begin()+(K_-k)*nn, X_.begin()+k*nn);
+    }
+    double time_psd_start = clock();
+    bool ret = periodic_schur(n, K_, getPtr(X_), getPtr(S_), getPtr(Q_),
+                              getPtr(eig_real_), getPtr(eig_imag_), psd_num_zero_, max_iter_);
+    casadi_assert_message(ret, "PeriodicSchurDple: periodic QR algorithm failed to converge. "
+                          "Consider increasing 'max_iter' or setting 'psd_num_zero'.");
+    for (int k=0; k<K_/2; ++k) {
+      std::swap_ranges(S_.begin()+k*nn, S_.begin()+(k+1)*nn, S_.begin()+(K_-1-k)*nn);
+    }
+    for (int k=1; k<(K_+1)/2; ++k) {
+      std::swap_ranges(Q_.begin()+k*nn, Q_.begin()+(k+1)*nn, Q_.begin()+(K_-k)*nn);
+    }
+    t_psd += (clock()-time_psd_start)/CLOCKS_PER_SEC;
+
+    if (error_unstable_) {
+      for (int i=0;i<n;++i) {
+        double modulus = sqrt(eig_real_[i]*eig_real_[i]+eig_imag_[i]*eig_imag_[i]);
+        casadi_assert_message(modulus+eps_unstable_ <= 1,
+          "PeriodicSchurDple: system is unstable."
+          "Found an eigenvalue " << eig_real_[i] << " + " <<
+          eig_imag_[i] << "j, with modulus " << modulus <<
+          " (corresponding eps= " << 1-modulus << ")." <<
+          std::endl << "Use options and 'error_unstable'"
+          "and 'eps_unstable' to influence this message.");
+      }
+    }
+
+    // Transposed equation: with U_k = Q_{k+1}' P_k Q_{k+1}, U_{k-1} = S_k' U_k S_k + G_k.
+    // Reversing the ordering of rows, columns and period gives the form of the
+    // non-transposed equation, with factors J*S_{K-1-m}'*J
+    if (transp_) {
+      for (int m=0; m<K_; ++m) {
+        const double* Sk = getPtr(S_) + (K_-1-m)*nn;
+        double* Stm = getPtr(St_) + m*nn;
+        for (int j=0; j<n; ++j)
+          for (int i=0; i<n; ++i) Stm[i+j*n] = Sk[(n-1-j)+(n-1-i)*n];
+      }
+    }
+
+    for (int d=0; d<nrhs_; ++d) {
+      const std::vector<double>& V = inputD(1+d).data();
+      std::vector<double>& P = outputD(d).data();
+
+      // Transform the right hand sides to Schur coordinates, symmetrized
+      for (int k=0; k<K_; ++k) {
+        int kq = transp_ ? k : (k+1)%K_;
+        const double* Qk = getPtr(Q_) + kq*nn;
+        dense_mul_nn(n, getPtr(V)+k*nn, Qk, getPtr(tmp_));
+        double* Wk = getPtr(W_) + (transp_ ? K_-1-k : k)*nn;
+        dense_mul_tn(n, Qk, getPtr(tmp_), getPtr(X_));
+        for (int j=0; j<n; ++j) {
+          for (int i=0; i<n; ++i) {
+            double v = (X_[i+j*n]+X_[j+i*n])/2;
+            if (transp_) {
+              Wk[(n-1-i)+(n-1-j)*n] = v;
+            } else {
+              Wk[i+j*n] = v;
+            }
+          }
+        }
+      }
+
+      double time_solve_start = clock();
+      solveSchur(transp_ ? St_ : S_, W_);
+      t_solve += (clock()-time_solve_start)/CLOCKS_PER_SEC;
+
+      // Transform back: P_k = Q_k X_k Q_k' or P_k = Q_{k+1} U_k Q_{k+1}'
+      for (int k=0; k<K_; ++k) {
+        const double* Xk = getPtr(W_) + k*nn;
+        if (transp_) {
+          const double* Um = getPtr(W_) + (K_-1-k)*nn;
+          for (int j=0; j<n; ++j)
+            for (int i=0; i<n; ++i) X_[i+j*n] = Um[(n-1-i)+(n-1-j)*n];
+          Xk = getPtr(X_);
+        }
+        const double* Qk = getPtr(Q_) + (transp_ ? (k+1)%K_ : k)*nn;
+        dense_mul_nt(n, Xk, Qk, getPtr(tmp_));
+        dense_mul_nn(n, Qk, getPtr(tmp_), getPtr(P)+k*nn);
+      }
+    }
+
+    if (gather_stats_) {
+      stats_["t_psd"] = t_psd;
+      stats_["t_solve"] = t_solve;
+      stats_["t_total"] = (clock()-time_total_start)/CLOCKS_PER_SEC;
+    }
+
+    DenseIO::writeOutputs();
+  }
+
+  Function PeriodicSchurDple
+  ::getDerForward(const std::string& name, int nfwd, Dict& opts) {
+
+    // Base:
+    // P_0 P_1 P_2 .. P_{nrhs-1} = f( A Q_0 Q_1 Q_2 .. Q_{nrhs-1})
+
+    /* Allocate output list for derivative
+    *
+    * Structute:
+    *    [P_0^f0 .. P_{nrhs-1}^f0] ...
+    *       [P_0^f{nfwd-1} .. P_{nrhs-1}^f{nfwd-1}]
+    */
+
+    std::vector<MX> outs_new(nrhs_*nfwd, 0);
+
+    /* Allocate input list for derivative and populate with symbolics
+    * Three parts:
+    *
+    * 1)  [A Q_0 .. Q_{nrhs-1}]
+    * 2)  [P P_0 .. P_{nrhs-1}]
+    * 3)  [A^f0 Q_0^f0 .. Q_{nrhs-1}^f0] ...
+    *       [A^f{nfwd-1} Q_0^f{nfwd-1} .. Q_{nrhs-1}^f{nfwd-1}]
+    */
+    std::vector<MX> ins_new(2*nrhs_+1 + (nrhs_+1)*nfwd, 0);
+
+    // Part 1
+    ins_new[0] = MX::sym("A", input(DPLE_A).sparsity());
+    for (int i=0; i<nrhs_; ++i) {
+      ins_new[i+1] = MX::sym("Q", input(DPLE_V).sparsity());
+    }
+
+    // Part 2
+    for (int i=0; i<nrhs_; ++i) {
+      ins_new[nrhs_+i+1] = MX::sym("P", output(DPLE_P).sparsity());
+    }
+
+    // Part 3
+    for (int q=0; q<nrhs_; ++q) {
+      for (int k=0;k<nfwd;++k) {
+        MX& Qf  = ins_new.at(2*nrhs_+1 + (nrhs_+1)*k+q+1);
+        MX& Af  = ins_new.at(2*nrhs_+1 + (nrhs_+1)*k);
+
+        Qf = MX::sym("Qf", input(DPLE_V).sparsity());
+        Af = MX::sym("Af", input(DPLE_A).sparsity());
+      }
+    }
+
+    // Prepare a solver for forward seeds
+    std::map<std::string, std::vector<Sparsity> > tmp;
+    tmp["a"] = st_[Dple_STRUCT_A];
+    tmp["v"] = st_[Dple_STRUCT_V];
+    PeriodicSchurDple* node = new PeriodicSchurDple(tmp, nfwd, transp_);
+    node->setOption(dictionary());
+
+    DpleSolver f;
+    f.assignNode(node);
+    f.init();
+
+    for (int q=0; q<nrhs_; ++q) {
+
+      // Forward
+      /* P_q^f0 .. P_q^f{nfwd-1} = f(A,
+      *          Q_q^f0 + A P_q (A^f0)^T + A^f0 P_q A^T,
+      *          ...
+      *          Q_q^f{nfwd-1} + A P_q (A^f{nfwd-1})^T + A^f{nfwd-1} P_q A^T)
+      */
+      std::vector<MX> ins_f;
+      const MX& A  = ins_new[0];
+      std::vector<MX> As = horzsplit(A, n_);
+      const MX& P  = ins_new[nrhs_+1+q];
+      std::vector<MX> Ps_ = horzsplit(P, n_);
+
+      ins_f.push_back(A);
+      for (int k=0;k<nfwd;++k) {
+        const MX& Qf  = ins_new.at(2*nrhs_+1+(nrhs_+1)*k+q+1);
+        const MX& Af  = ins_new.at(2*nrhs_+1+(nrhs_+1)*k);
+
+        std::vector<MX> Qfs = horzsplit(Qf, n_);
+        std::vector<MX> Afs = horzsplit(Af, n_);
+
+        std::vector<MX> sum(K_, 0);
+        for (int i=0;i<K_;++i) {
+          // Note: Qf is symmetrised here
+          MX temp;
+          if (transp_) {
+            temp = mul(As[i].T(), mul(Ps_[i], Afs[i])) + Qfs[i]/2;
+          } else {
+            temp = mul(As[i], mul(Ps_[i], Afs[i].T())) + Qfs[i]/2;
+          }
+          sum[i] = temp + temp.T();
+        }
+        ins_f.push_back(horzcat(sum));
+      }
+
+      std::vector<MX> outs = f(ins_f);
+      for (int i=0;i<nfwd;++i) {
+        outs_new.at(q+nrhs_*i) = outs[i];
+      }
+
+    }
+
+    return MXFunction(name, ins_new, outs_new, opts);
+  }
+
+  Function PeriodicSchurDple
+  ::getDerReverse(const std::string& name, int nadj, Dict& opts) {
+
+    // Base:
+    // P_0 P_1 P_2 .. P_{nrhs-1} = f( A Q_0 Q_1 Q_2 .. Q_{nrhs-1})
+
+    /* Allocate output list for derivative
+    *
+    * Structure:
+    *
+    * [A^b0 Q_0^b0 .. Q_{nrhs-1}^b0] ...
+    *       [A^b{nadj-1} Q_0^b{nadj-1} .. Q_{nrhs-1}^b{nadj-1}]
+    */
+
+    std::vector<MX> outs_new((nrhs_+1)*nadj, 0);
+
+    /* Allocate input list for derivative and populate with symbolics
+    * Three parts:
+    *
+    * 1)  [A Q_0 .. Q_{nrhs-1}]
+    * 2)  [P P_0 .. P_{nrhs-1}]
+    * 3)  [P_0^b0 .. P_{nrhs-1}^b0] ...
+    *       [P_0^b{nadj-1} .. P_{nrhs-1}^b{nadj-1}]
+    */
+    std::vector<MX> ins_new(2*nrhs_+1 + nrhs_*nadj, 0);
+
+    // Part 1
+    ins_new[0] = MX::sym("A", input(DPLE_A).sparsity());
+    for (int i=0; i<nrhs_; ++i) {
+      ins_new[i+1] = MX::sym("Q", input(DPLE_V).sparsity());
+    }
+
+    // Part 2
+    for (int i=0; i<nrhs_; ++i) {
+      ins_new[nrhs_+i+1] = MX::sym("P", output(DPLE_P).sparsity());
+    }
+
+    // Part 3
+    for (int q=0; q<nrhs_; ++q) {
+      for (int k=0;k<nadj;++k) {
+          MX& Pb  = ins_new.at(2*nrhs_+1+nrhs_*k+q);
+
+          Pb = MX::sym("Pb", output(DPLE_P).sparsity());
+      }
+    }
+
+    // Prepare a solver for adjoint seeds
+    std::map<std::string, std::vector<Sparsity> > tmp;
+    tmp["a"] = st_[Dple_STRUCT_A];
+    tmp["v"] = st_[Dple_STRUCT_V];
+    PeriodicSchurDple* node2 = new PeriodicSchurDple(tmp, nadj, !transp_);
+    node2->setOption(dictionary());
+
+    DpleSolver b;
+    b.assignNode(node2);
+    b.init();
+
+    for (int q=0; q<nrhs_; ++q) {
+
+      std::vector<MX> ins_f;
+      const MX& A  = ins_new[0];
+      std::vector<MX> As = horzsplit(A, n_);
+      const MX& P  = ins_new[nrhs_+1+q];
+      std::vector<MX> Ps_ = horzsplit(P, n_);
+
+      // Adjoint
+      /* rev(Q_b^b0) .. rev(Q_b^b{nadj-1}) += f(rev(A),
+      *          rev(P_q^b0) ... rev(P_q^b{nadj-1})
+      *         )
+      *
+      *  A^b0 += 2 Q_q^b0 A P_q
+      *   ....
+      *  A^b{nadj-1} += 2 Q_q^b{nadj-1} A P_q
+      */
+      std::vector<MX> ins_b;
+      ins_b.push_back(A);
+      for (int k=0;k<nadj;++k) {
+        const MX& Pb  = ins_new.at(2*nrhs_+1+nrhs_*k+q);
+        // Symmetrise P_q^bk
+        std::vector<MX> Pbs = horzsplit(Pb, n_);
+        for (int i=0;i<K_;++i) {
+          Pbs[i]+= Pbs[i].T();
+        }
+
+        ins_b.push_back(horzcat(Pbs)/2);
+      }
+
+      std::vector<MX> outs = b(ins_b);
+      for (int i=0;i<nadj;++i) {
+        MX& Qb = outs_new.at((nrhs_+1)*i+q+1);
+
+        Qb += outs[i];
+        std::vector<MX> Qbs = horzsplit(Qb, n_);
+        MX& Ab = outs_new.at((nrhs_+1)*i);
+
+        std::vector<MX> sum(K_, 0);
+        for (int j=0;j<K_;++j) {
+          if (transp_) {
+            sum[j]+= (2*mul(Ps_[j], mul(As[j], Qbs[j])));
+          } else {
+            sum[j]+= 2*mul(Qbs[j], mul(As[j], Ps_[j]));
+          }
+        }
+        Ab += horzcat(sum);
+      }
+
+    }
+
+    return MXFunction(name, ins_new, outs_new, opts);
+  }
+
+  void PeriodicSchurDple::deepCopyMembers(
+      std::map<SharedObjectNode*, SharedObject>& already_copied) {
+    DpleInternal::deepCopyMembers(already_copied);
+  }
+
+  PeriodicSchurDple* PeriodicSchurDple::clone() const {
+    // Return a deep copy
+    std::map<std::string, std::vector<Sparsity> > tmp;
+    tmp["a"] = st_[Dple_STRUCT_A];
+    tmp["v"] = st_[Dple_STRUCT_V];
+    PeriodicSchurDple* node = new PeriodicSchurDple(tmp, nrhs_, transp_);
+    node->setOption(dictionary());
+    return node;
+  }
+
+} // namespace casadi
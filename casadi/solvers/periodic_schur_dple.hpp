@@ -0,0 +1,155 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#ifndef CASADI_PERIODIC_SCHUR_DPLE_HPP
+#define CASADI_PERIODIC_SCHUR_DPLE_HPP
+
+#include "../core/function/dple_internal.hpp"
+#include "../core/function/dense_io.hpp"
+#include <casadi/solvers/casadi_dplesolver_periodic_schur_export.h>
+
+/** \defgroup plugin_DpleSolver_periodic_schur
+
+   Native solver for Discrete Periodic Lyapunov Equations, using a periodic
+   Schur decomposition and a Bartels-Stewart type block back-substitution.
+
+   The matrices A_k are first reduced to periodic Hessenberg-triangular form
+   with Householder reflections, after which the periodic QR algorithm with
+   implicit double shifts brings the Hessenberg factor to quasi-upper
+   triangular form. In the transformed coordinates, the 1x1 and 2x2 diagonal
+   blocks of P_k are obtained one by one from small periodic Sylvester
+   equations. The cost is O(n^3 K) and no external libraries are needed.
+   Use the DleSolver plugin 'dple' to solve DLEs (K=1) with this solver.
+*/
+
+/** \pluginsection{DpleSolver,periodic_schur} */
+
+/// \cond INTERNAL
+namespace casadi {
+
+  /** \brief \pluginbrief{DpleSolver,periodic_schur}
+
+   @copydoc DPLE_doc
+   @copydoc plugin_DpleSolver_periodic_schur
+
+  */
+  class CASADI_DPLESOLVER_PERIODIC_SCHUR_EXPORT PeriodicSchurDple : public DpleInternal,
+    public DenseIO<PeriodicSchurDple> {
+  public:
+    /** \brief  Constructor
+     * \param st \structargument{Dple}
+     */
+    PeriodicSchurDple(const std::map<std::string, std::vector<Sparsity> > & st,
+                      int nrhs=1, bool transp=false);
+
+    /** \brief  Destructor */
+    virtual ~PeriodicSchurDple();
+
+    /** \brief  Clone */
+    virtual PeriodicSchurDple* clone() const;
+
+    /** \brief  Deep copy data members */
+    virtual void deepCopyMembers(std::map<SharedObjectNode*, SharedObject>& already_copied);
+
+    /** \brief  Create a new solver */
+    virtual PeriodicSchurDple* create(const std::map<std::string,
+                                      std::vector<Sparsity> > & st) const {
+      return new PeriodicSchurDple(st);
+    }
+
+    /** \brief  Create a new DPLE Solver */
+    static DpleInternal* creator(const std::map<std::string, std::vector<Sparsity> > & st) {
+      return new PeriodicSchurDple(st);
+    }
+
+    /** \brief  evaluate */
+    virtual void evaluate();
+
+    /** \brief  Initialize */
+    virtual void init();
+
+    ///@{
+    /** \brief Generate a function that calculates \a nfwd forward derivatives */
+    virtual Function getDerForward(const std::string& name, int nfwd, Dict& opts);
+    virtual int numDerForward() const { return 64;}
+    ///@}
+
+    ///@{
+    /** \brief Generate a function that calculates \a nadj adjoint derivatives */
+    virtual Function getDerReverse(const std::string& name, int nadj, Dict& opts);
+    virtual int numDerReverse() const { return 64;}
+    ///@}
+
+    /// A documentation string
+    static const std::string meta_doc;
+
+  protected:
+    /** \brief Solve X_{k+1} = S_k X_k S_k' + W_k for symmetric X_k, in-place in W
+
+        The S_k are quasi-upper triangular with the block partition part_,
+        all matrices are dense, column-major and stored one after the other.
+    */
+    void solveSchur(const std::vector<double>& S, std::vector<double>& W);
+
+    /// Dimension of state-space
+    int n_;
+
+    /// Periodic Schur form: S_k = Q_{k+1}' A_k Q_k, quasi-upper triangular
+    std::vector<double> S_, Q_;
+
+    /// Factors in the ordering of the transposed equation
+    std::vector<double> St_;
+
+    /// Start of each 1x1 or 2x2 diagonal block of S, n_ appended
+    std::vector<int> part_;
+
+    /// Right hand sides and solution in Schur coordinates
+    std::vector<double> W_, X_;
+
+    /// Work vectors: block sweeps, small periodic Sylvester equations, dense products
+    std::vector<double> Y_, Z_, g_, tmp_;
+
+    /// Eigenvalues of the monodromy matrix A_{K-1}...A_0
+    std::vector<double> eig_real_, eig_imag_;
+
+    /// Numerical zero, used in periodic Schur form
+    double psd_num_zero_;
+
+    /// Maximum number of periodic QR iterations per eigenvalue
+    int max_iter_;
+  };
+
+  /** \brief Periodic Schur decomposition, with the conventions of DpleSolver::periodic_schur
+
+      a, t and z hold K dense, column-major n-by-n matrices one after the other.
+      Returns false if the periodic QR algorithm did not converge.
+  */
+  bool CASADI_DPLESOLVER_PERIODIC_SCHUR_EXPORT
+  periodic_schur(int n, int K, const double* a, double* t, double* z,
+                 double* eig_real, double* eig_imag, double num_zero=0, int max_iter=30);
+
+} // namespace casadi
+/// \endcond
+#endif // CASADI_PERIODIC_SCHUR_DPLE_HPP
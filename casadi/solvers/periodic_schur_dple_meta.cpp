@@ -0,0 +1,69 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+      #include "periodic_schur_dple.hpp"
+      #include <string>
+
+      const std::string casadi::PeriodicSchurDple::meta_doc=
+      "\n"
+"Native solver for Discrete Periodic Lyapunov Equations, using a periodic\n"
+"Schur decomposition and a Bartels-Stewart type block back-substitution.\n"
+"\n"
+"The matrices A_k are first reduced to periodic Hessenberg-triangular form\n"
+"with Householder reflections, after which the periodic QR algorithm with\n"
+"implicit double shifts brings the Hessenberg factor to quasi-upper\n"
+"triangular form. In the transformed coordinates, the 1x1 and 2x2 diagonal\n"
+"blocks of P_k are obtained one by one from small periodic Sylvester\n"
+"equations. The cost is O(n^3 K) and no external libraries are needed. Use\n"
+"the DleSolver plugin 'dple' to solve DLEs (K=1) with this solver.\n"
+"\n"
+"\n"
+">List of available options\n"
+"\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
+"|       Id        |      Type       |     Default     |   Description   |\n"
+"+=================+=================+=================+=================+\n"
+"| max_iter        | OT_INTEGER      | 30              | Maximum number  |\n"
+"|                 |                 |                 | of periodic QR  |\n"
+"|                 |                 |                 | iterations per  |\n"
+"|                 |                 |                 | eigenvalue      |\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
+"| psd_num_zero    | OT_REAL         | 0               | Numerical zero  |\n"
+"|                 |                 |                 | used in the     |\n"
+"|                 |                 |                 | periodic Schur  |\n"
+"|                 |                 |                 | decomposition:  |\n"
+"|                 |                 |                 | entries of the  |\n"
+"|                 |                 |                 | periodic        |\n"
+"|                 |                 |                 | Hessenberg-     |\n"
+"|                 |                 |                 | triangular form |\n"
+"|                 |                 |                 | smaller than    |\n"
+"|                 |                 |                 | this are set to |\n"
+"|                 |                 |                 | zero            |\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
+"\n"
+"\n"
+"\n"
+"\n"
+;
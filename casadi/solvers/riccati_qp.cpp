@@ -0,0 +1,771 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#include "riccati_qp.hpp"
+#include "casadi/core/runtime/runtime.hpp"
+#include "casadi/core/profiling.hpp"
+
+using namespace std;
+namespace casadi {
+
+  extern "C"
+  int CASADI_QPSOLVER_RICCATI_EXPORT
+  casadi_register_qpsolver_riccati(QpSolverInternal::Plugin* plugin) {
+    plugin->creator = RiccatiQp::creator;
+    plugin->name = "riccati";
+    plugin->doc = RiccatiQp::meta_doc.c_str();
+    plugin->version = 23;
+    return 0;
+  }
+
+  extern "C"
+  void CASADI_QPSOLVER_RICCATI_EXPORT casadi_load_qpsolver_riccati() {
+    QpSolverInternal::registerPlugin(casadi_register_qpsolver_riccati);
+  }
+
+  namespace {
+    // Dense kernels for the (small) row-major stage blocks
+
+    /// Cholesky factorization, lower triangle in-place, false if not positive definite
+    bool chol(int n, double* A) {
+      for (int j=0; j<n; ++j) {
+        double d = A[j*n+j];
+        for (int k=0; k<j; ++k) d -= A[j*n+k]*A[j*n+k];
+        if (!(d>0)) return false;
+        d = sqrt(d);
+        A[j*n+j] = d;
+        for (int i=j+1; i<n; ++i) {
+          double v = A[i*n+j];
+          for (int k=0; k<j; ++k) v -= A[i*n+k]*A[j*n+k];
+          A[i*n+j] = v/d;
+        }
+      }
+      return true;
+    }
+
+    /// Solve L*L'*x = b in-place
+    void cholSolve(int n, const double* L, double* b) {
+      for (int i=0; i<n; ++i) {
+        for (int k=0; k<i; ++k) b[i] -= L[i*n+k]*b[k];
+        b[i] /= L[i*n+i];
+      }
+      for (int i=n-1; i>=0; --i) {
+        for (int k=i+1; k<n; ++k) b[i] -= L[k*n+i]*b[k];
+        b[i] /= L[i*n+i];
+      }
+    }
+
+    /// LU factorization with partial pivoting in-place, false if singular
+    bool lu(int n, double* A, int* piv) {
+      for (int j=0; j<n; ++j) {
+        int p = j;
+        for (int i=j+1; i<n; ++i) if (fabs(A[i*n+j])>fabs(A[p*n+j])) p = i;
+        piv[j] = p;
+        if (A[p*n+j]==0) return false;
+        if (p!=j) for (int k=0; k<n; ++k) swap(A[j*n+k], A[p*n+k]);
+        for (int i=j+1; i<n; ++i) {
+          A[i*n+j] /= A[j*n+j];
+          for (int k=j+1; k<n; ++k) A[i*n+k] -= A[i*n+j]*A[j*n+k];
+        }
+      }
+      return true;
+    }
+
+    /// Solve A*x = b or A'*x = b in-place, given the LU factorization of A
+    void luSolve(int n, const double* LU, const int* piv, double* b, bool tr) {
+      if (!tr) {
+        for (int j=0; j<n; ++j) swap(b[j], b[piv[j]]);
+        for (int i=0; i<n; ++i) {
+          for (int k=0; k<i; ++k) b[i] -= LU[i*n+k]*b[k];
+        }
+        for (int i=n-1; i>=0; --i) {
+          for (int k=i+1; k<n; ++k) b[i] -= LU[i*n+k]*b[k];
+          b[i] /= LU[i*n+i];
+        }
+      } else {
+        for (int i=0; i<n; ++i) {
+          for (int k=0; k<i; ++k) b[i] -= LU[k*n+i]*b[k];
+          b[i] /= LU[i*n+i];
+        }
+        for (int i=n-1; i>=0; --i) {
+          for (int k=i+1; k<n; ++k) b[i] -= LU[k*n+i]*b[k];
+        }
+        for (int j=n-1; j>=0; --j) swap(b[j], b[piv[j]]);
+      }
+    }
+  } // namespace
+
+  RiccatiQp::RiccatiQp(const std::map<std::string, Sparsity> &st) : InteriorPointQp(st) {
+    addOption("nx",                     OT_INTEGERVECTOR, GenericType(),
+              "Number of states in each stage k=0..N. A single entry means constant "
+              "dimensions, with the horizon length derived from the number of variables.");
+    addOption("nu",                     OT_INTEGERVECTOR, GenericType(),
+              "Number of controls in each stage k=0..N-1");
+    addOption("condensing",             OT_BOOLEAN,     false,
+              "Eliminate the states and solve the dense condensed QP with qp_solver");
+    addOption("qp_solver",              OT_STRING,      GenericType(),
+              "The QP solver used for the condensed QP");
+    addOption("qp_solver_options",      OT_DICT,        GenericType(),
+              "Options to be passed to the QP solver for the condensed QP");
+  }
+
+  RiccatiQp::~RiccatiQp() {
+  }
+
+  void RiccatiQp::deepCopyMembers(std::map<SharedObjectNode*, SharedObject>& already_copied) {
+    InteriorPointQp::deepCopyMembers(already_copied);
+    qp_solver_ = deepcopy(qp_solver_, already_copied);
+  }
+
+  void RiccatiQp::init() {
+    // Initialize the base classes
+    InteriorPointQp::init();
+
+    // Stage dimensions
+    casadi_assert_message(hasSetOption("nx") && hasSetOption("nu"),
+                          "RiccatiQp: the options nx and nu must be set");
+    nx_ = getOption("nx").toIntVector();
+    nu_ = getOption("nu").toIntVector();
+    if (nx_.size()==1 && nu_.size()==1) {
+      int nz = nx_[0] + nu_[0];
+      casadi_assert_message(nz>0 && n_>=nx_[0] && (n_-nx_[0]) % nz == 0,
+                            "RiccatiQp: " << n_ << " variables cannot be divided into stages "
+                            "with nx=" << nx_[0] << " and nu=" << nu_[0]);
+      N_ = (n_-nx_[0])/nz;
+      nx_.resize(N_+1, nx_[0]);
+      nu_.resize(N_, nu_[0]);
+    } else {
+      N_ = nu_.size();
+      casadi_assert_message(nx_.size()==N_+1, "RiccatiQp: nx must have one entry more than nu, "
+                            "got " << nx_.size() << " and " << nu_.size());
+    }
+    nu_.push_back(0);
+
+    // Offset of each stage
+    offset_.resize(N_+2);
+    offset_[0] = 0;
+    for (int k=0; k<=N_; ++k) offset_[k+1] = offset_[k] + nx_[k] + nu_[k];
+    casadi_assert_message(offset_.back()==n_, "RiccatiQp: the stage dimensions add up to "
+                          << offset_.back() << " variables, but the QP has " << n_);
+    var_stage_.resize(n_);
+    for (int k=0; k<=N_; ++k) {
+      for (int i=offset_[k]; i<offset_[k+1]; ++i) var_stage_[i] = k;
+    }
+
+    // The Hessian must be block diagonal
+    const Sparsity& sp_h = input(QP_SOLVER_H).sparsity();
+    const int* h_colind = sp_h.colind();
+    const int* h_row = sp_h.row();
+    h_dest_.resize(sp_h.nnz());
+    for (int c=0; c<n_; ++c) {
+      int k = var_stage_[c];
+      int nz = nx_[k] + nu_[k];
+      for (int el=h_colind[c]; el<h_colind[c+1]; ++el) {
+        int r = h_row[el];
+        casadi_assert_message(var_stage_[r]==k, "RiccatiQp: H must be block diagonal with respect "
+                              "to the stages, but H(" << r << ", " << c << ") couples stage "
+                              << var_stage_[r] << " and stage " << k);
+        h_dest_[el] = (r-offset_[k])*nz + (c-offset_[k]);
+      }
+    }
+
+    // Classify the rows of A: dynamics or single-stage constraints
+    const Sparsity& sp_a = input(QP_SOLVER_A).sparsity();
+    const int* a_colind = sp_a.colind();
+    const int* a_row = sp_a.row();
+    vector<int> smin(nc_, N_+1), smax(nc_, -1);
+    for (int c=0; c<n_; ++c) {
+      for (int el=a_colind[c]; el<a_colind[c+1]; ++el) {
+        smin[a_row[el]] = min(smin[a_row[el]], var_stage_[c]);
+        smax[a_row[el]] = max(smax[a_row[el]], var_stage_[c]);
+      }
+    }
+    row_stage_.resize(nc_);
+    dyn_pos_.resize(nc_);
+    dyn_rows_.assign(N_, vector<int>());
+    for (int r=0; r<nc_; ++r) {
+      dyn_pos_[r] = -1;
+      if (smax[r]<0) {
+        row_stage_[r] = 0;
+      } else if (smin[r]==smax[r]) {
+        row_stage_[r] = smin[r];
+      } else {
+        casadi_assert_message(smax[r]==smin[r]+1, "RiccatiQp: row " << r << " of A couples the "
+                              "non-adjacent stages " << smin[r] << " and " << smax[r]);
+        row_stage_[r] = smin[r];
+        dyn_pos_[r] = dyn_rows_[smin[r]].size();
+        dyn_rows_[smin[r]].push_back(r);
+      }
+    }
+    for (int k=0; k<N_; ++k) {
+      casadi_assert_message(dyn_rows_[k].size()==nx_[k+1], "RiccatiQp: " << dyn_rows_[k].size()
+                            << " rows of A couple stage " << k << " and stage " << k+1
+                            << ", but there are " << nx_[k+1] << " states in stage " << k+1);
+    }
+
+    // Destination of the nonzeros of A in the dense stage blocks
+    a_dest_.resize(sp_a.nnz());
+    a_kind_.resize(sp_a.nnz());
+    for (int c=0; c<n_; ++c) {
+      for (int el=a_colind[c]; el<a_colind[c+1]; ++el) {
+        int r = a_row[el];
+        int k = row_stage_[r];
+        if (dyn_pos_[r]<0) {
+          a_kind_[el] = 2;
+          a_dest_[el] = c - offset_[k];
+        } else if (var_stage_[c]==k+1) {
+          casadi_assert_message(c-offset_[k+1] < nx_[k+1], "RiccatiQp: the dynamics of stage "
+                                << k << " may not depend on the controls of stage " << k+1);
+          a_kind_[el] = 0;
+          a_dest_[el] = dyn_pos_[r]*nx_[k+1] + c - offset_[k+1];
+        } else {
+          a_kind_[el] = 1;
+          a_dest_[el] = dyn_pos_[r]*(nx_[k]+nu_[k]) + c - offset_[k];
+        }
+      }
+    }
+
+    // Allocate the stage blocks
+    int nz_max = 0;
+    Q_.resize(N_+1);
+    M_.resize(N_+1);
+    P_.resize(N_+1);
+    p_.resize(N_+1);
+    q_.resize(N_+1);
+    E_.resize(N_);
+    E_lu_.resize(N_);
+    E_piv_.resize(N_);
+    F_.resize(N_);
+    Abar_.resize(N_);
+    abar_.resize(N_);
+    K_.resize(N_);
+    kff_.resize(N_);
+    Luu_.resize(N_);
+    for (int k=0; k<=N_; ++k) {
+      int nz = nx_[k] + nu_[k];
+      nz_max = max(nz_max, nz);
+      Q_[k].resize(nz*nz);
+      M_[k].resize(nz*nz);
+      P_[k].resize(nx_[k]*nx_[k]);
+      p_[k].resize(nx_[k]);
+      q_[k].resize(nz);
+      if (k==N_) break;
+      E_[k].resize(nx_[k+1]*nx_[k+1]);
+      E_lu_[k].resize(nx_[k+1]*nx_[k+1]);
+      E_piv_[k].resize(nx_[k+1]);
+      F_[k].resize(nx_[k+1]*nz);
+      Abar_[k].resize(nx_[k+1]*nz);
+      abar_[k].resize(nx_[k+1]);
+      K_[k].resize(nu_[k]*nx_[k]);
+      kff_[k].resize(nu_[k]);
+      Luu_[k].resize(nu_[k]*nu_[k]);
+    }
+    L0_.resize(nx_[0]*nx_[0]);
+    work_.resize(max(nz_max*nz_max, 2*nz_max));
+    C_.resize(nc_);
+    for (int r=0; r<nc_; ++r) {
+      int k = row_stage_[r];
+      C_[r].resize(dyn_pos_[r]<0 ? nx_[k]+nu_[k] : 0);
+    }
+
+    // Allocate work vectors
+    e_.resize(n_ + nc_);
+
+    // Condensing
+    qp_solver_ = QpSolver();
+    if (getOption("condensing")) {
+      casadi_assert_message(hasSetOption("qp_solver"),
+                            "RiccatiQp: the option qp_solver is required for condensing");
+
+      // Free variables: initial state and controls
+      v_ind_.clear();
+      st_ind_.clear();
+      for (int k=0; k<=N_; ++k) {
+        for (int i=0; i<nx_[k]; ++i) (k==0 ? v_ind_ : st_ind_).push_back(offset_[k]+i);
+        for (int i=0; i<nu_[k]; ++i) v_ind_.push_back(offset_[k]+nx_[k]+i);
+      }
+      path_rows_.clear();
+      for (int r=0; r<nc_; ++r) if (dyn_pos_[r]<0) path_rows_.push_back(r);
+      int nv = v_ind_.size();
+      S_.resize(n_*nv);
+      s_.resize(n_);
+
+      Dict qp_solver_options;
+      if (hasSetOption("qp_solver_options")) {
+        qp_solver_options = getOption("qp_solver_options");
+      }
+      qp_solver_ = QpSolver("qp_solver", getOption("qp_solver"),
+                            make_map("h", Sparsity::dense(nv, nv),
+                                     "a", Sparsity::dense(st_ind_.size()+path_rows_.size(), nv)),
+                            qp_solver_options);
+    }
+  }
+
+  void RiccatiQp::getStageData() {
+    const vector<double>& h = input(QP_SOLVER_H).data();
+    const vector<double>& a = input(QP_SOLVER_A).data();
+    const int* h_colind = input(QP_SOLVER_H).colind();
+    const int* a_colind = input(QP_SOLVER_A).colind();
+    const int* a_row = input(QP_SOLVER_A).row();
+
+    // Stage Hessians
+    for (int k=0; k<=N_; ++k) fill(Q_[k].begin(), Q_[k].end(), 0);
+    for (int c=0; c<n_; ++c) {
+      for (int el=h_colind[c]; el<h_colind[c+1]; ++el) Q_[var_stage_[c]][h_dest_[el]] = h[el];
+    }
+
+    // Dynamics and single-stage constraints
+    for (int k=0; k<N_; ++k) {
+      fill(E_[k].begin(), E_[k].end(), 0);
+      fill(F_[k].begin(), F_[k].end(), 0);
+    }
+    for (int r=0; r<nc_; ++r) fill(C_[r].begin(), C_[r].end(), 0);
+    for (int c=0; c<n_; ++c) {
+      for (int el=a_colind[c]; el<a_colind[c+1]; ++el) {
+        int r = a_row[el];
+        switch (a_kind_[el]) {
+        case 0: E_[row_stage_[r]][a_dest_[el]] = a[el]; break;
+        case 1: F_[row_stage_[r]][a_dest_[el]] = a[el]; break;
+        default: C_[r][a_dest_[el]] = a[el];
+        }
+      }
+    }
+
+    // Explicit form of the dynamics, x_{k+1} = Abar_k*[x_k; u_k] + E_k^(-1)*b_k
+    for (int k=0; k<N_; ++k) {
+      int nx1 = nx_[k+1], nz = nx_[k] + nu_[k];
+      copy(E_[k].begin(), E_[k].end(), E_lu_[k].begin());
+      casadi_assert_message(lu(nx1, getPtr(E_lu_[k]), getPtr(E_piv_[k])),
+                            "RiccatiQp: the dynamics of stage " << k << " cannot be solved "
+                            "for the states of stage " << k+1);
+      for (int j=0; j<nz; ++j) {
+        for (int i=0; i<nx1; ++i) work_[i] = -F_[k][i*nz+j];
+        luSolve(nx1, getPtr(E_lu_[k]), getPtr(E_piv_[k]), getPtr(work_), false);
+        for (int i=0; i<nx1; ++i) Abar_[k][i*nz+j] = work_[i];
+      }
+    }
+  }
+
+  void RiccatiQp::evaluate() {
+    if (inputs_check_) checkInputs();
+    double time_start = getRealTime();
+
+    // Bounds on [x; A*x], the dynamics must be equality constraints
+    getBounds();
+    for (int r=0; r<nc_; ++r) {
+      casadi_assert_message(dyn_pos_[r]<0 || lb_[n_+r]==ub_[n_+r], "RiccatiQp: row " << r
+                            << " of A couples stage " << row_stage_[r] << " and stage "
+                            << row_stage_[r]+1 << " and must be an equality constraint");
+    }
+
+    // Dense stage data
+    getStageData();
+
+    if (qp_solver_.isNull()) {
+      solveInteriorPoint();
+    } else {
+      solveCondensing();
+    }
+    stats_["t_solve"] = getRealTime() - time_start;
+
+    // Optimal cost
+    output(QP_SOLVER_COST).set(
+      0.5*casadi_quad_form(getPtr(input(QP_SOLVER_H).data()), input(QP_SOLVER_H).sparsity(),
+                           getPtr(output(QP_SOLVER_X).data()))
+      + casadi_inner_prod(n_, getPtr(input(QP_SOLVER_G).data()),
+                          getPtr(output(QP_SOLVER_X).data())));
+  }
+
+  void RiccatiQp::factorize() {
+    // Stage Hessians with the barrier and equality terms
+    for (int k=0; k<=N_; ++k) {
+      int nz = nx_[k] + nu_[k];
+      copy(Q_[k].begin(), Q_[k].end(), M_[k].begin());
+      for (int j=0; j<nz; ++j) M_[k][j*nz+j] += hessWeight(offset_[k]+j);
+    }
+    for (int r=0; r<nc_; ++r) {
+      double d = hessWeight(n_+r);
+      if (dyn_pos_[r]>=0 || d==0) continue;
+      int k = row_stage_[r];
+      int nz = nx_[k] + nu_[k];
+      const vector<double>& C = C_[r];
+      for (int i=0; i<nz; ++i) {
+        if (C[i]==0) continue;
+        for (int j=0; j<nz; ++j) M_[k][i*nz+j] += d*C[i]*C[j];
+      }
+    }
+
+    // Backward Riccati recursion
+    P_[N_] = M_[N_];
+    for (int k=N_-1; k>=0; --k) {
+      int nx = nx_[k], nu = nu_[k], nz = nx + nu, nx1 = nx_[k+1];
+      const vector<double>& Abar = Abar_[k];
+      const vector<double>& P1 = P_[k+1];
+      vector<double>& M = M_[k];
+
+      // M += Abar'*P_{k+1}*Abar
+      for (int i=0; i<nx1; ++i) {
+        for (int j=0; j<nz; ++j) {
+          double v = 0;
+          for (int l=0; l<nx1; ++l) v += P1[i*nx1+l]*Abar[l*nz+j];
+          work_[i*nz+j] = v;
+        }
+      }
+      for (int i=0; i<nz; ++i) {
+        for (int j=0; j<nz; ++j) {
+          double v = 0;
+          for (int l=0; l<nx1; ++l) v += Abar[l*nz+i]*work_[l*nz+j];
+          M[i*nz+j] += v;
+        }
+      }
+
+      // Feedback K = -Muu^(-1)*Mux
+      vector<double>& Luu = Luu_[k];
+      vector<double>& K = K_[k];
+      for (int i=0; i<nu; ++i) {
+        for (int j=0; j<nu; ++j) Luu[i*nu+j] = M[(nx+i)*nz+nx+j];
+        Luu[i*nu+i] += reg_;
+      }
+      casadi_assert_message(chol(nu, getPtr(Luu)), "RiccatiQp: the reduced Hessian of stage "
+                            << k << " is not positive definite, is the QP convex?");
+      for (int j=0; j<nx; ++j) {
+        for (int i=0; i<nu; ++i) work_[i] = -M[(nx+i)*nz+j];
+        cholSolve(nu, getPtr(Luu), getPtr(work_));
+        for (int i=0; i<nu; ++i) K[i*nx+j] = work_[i];
+      }
+
+      // Cost-to-go P_k = Mxx + Mxu*K
+      vector<double>& P = P_[k];
+      for (int i=0; i<nx; ++i) {
+        for (int j=0; j<nx; ++j) {
+          double v = M[i*nz+j];
+          for (int l=0; l<nu; ++l) v += M[i*nz+nx+l]*K[l*nx+j];
+          P[i*nx+j] = v;
+        }
+      }
+    }
+
+    // Initial state
+    int nx0 = nx_[0];
+    copy(P_[0].begin(), P_[0].end(), L0_.begin());
+    for (int i=0; i<nx0; ++i) L0_[i*nx0+i] += reg_;
+    casadi_assert_message(chol(nx0, getPtr(L0_)), "RiccatiQp: the reduced Hessian of the initial "
+                          "state is not positive definite, is the QP convex?");
+  }
+
+  void RiccatiQp::backsolve() {
+    double* t = getPtr(work_);
+    double* m = t + work_.size()/2;
+
+    // Backward recursion for the linear terms
+    p_[N_] = q_[N_];
+    for (int k=N_-1; k>=0; --k) {
+      int nx = nx_[k], nu = nu_[k], nz = nx + nu, nx1 = nx_[k+1];
+      const vector<double>& Abar = Abar_[k];
+      const vector<double>& P1 = P_[k+1];
+      const vector<double>& M = M_[k];
+
+      // m = q_k + Abar'*(P_{k+1}*abar_k + p_{k+1})
+      for (int i=0; i<nx1; ++i) {
+        t[i] = p_[k+1][i];
+        for (int l=0; l<nx1; ++l) t[i] += P1[i*nx1+l]*abar_[k][l];
+      }
+      for (int j=0; j<nz; ++j) {
+        m[j] = q_[k][j];
+        for (int i=0; i<nx1; ++i) m[j] += Abar[i*nz+j]*t[i];
+      }
+
+      // Feedforward term kff = -Muu^(-1)*mu and p_k = mx + Mxu*kff
+      for (int i=0; i<nu; ++i) kff_[k][i] = -m[nx+i];
+      cholSolve(nu, getPtr(Luu_[k]), getPtr(kff_[k]));
+      for (int i=0; i<nx; ++i) {
+        p_[k][i] = m[i];
+        for (int l=0; l<nu; ++l) p_[k][i] += M[i*nz+nx+l]*kff_[k][l];
+      }
+    }
+
+    // Initial state
+    for (int i=0; i<nx_[0]; ++i) dx_[i] = -p_[0][i];
+    cholSolve(nx_[0], getPtr(L0_), getPtr(dx_));
+
+    // Forward simulation
+    for (int k=0; k<N_; ++k) {
+      int nx = nx_[k], nu = nu_[k], nz = nx + nu, nx1 = nx_[k+1];
+      double* z = getPtr(dx_) + offset_[k];
+      double* x1 = getPtr(dx_) + offset_[k+1];
+      for (int i=0; i<nu; ++i) {
+        z[nx+i] = kff_[k][i];
+        for (int j=0; j<nx; ++j) z[nx+i] += K_[k][i*nx+j]*z[j];
+      }
+      for (int i=0; i<nx1; ++i) {
+        x1[i] = abar_[k][i];
+        for (int j=0; j<nz; ++j) x1[i] += Abar_[k][i*nz+j]*z[j];
+      }
+
+      // Multipliers of the dynamics, E_k'*dlam_k = -(P_{k+1}*dx_{k+1} + p_{k+1})
+      for (int i=0; i<nx1; ++i) {
+        t[i] = p_[k+1][i];
+        for (int l=0; l<nx1; ++l) t[i] += P_[k+1][i*nx1+l]*x1[l];
+      }
+      luSolve(nx1, getPtr(E_lu_[k]), getPtr(E_piv_[k]), t, true);
+      for (int i=0; i<nx1; ++i) dlam_[n_+dyn_rows_[k][i]] = -t[i];
+    }
+  }
+
+  bool RiccatiQp::isPathEquality(int i) const {
+    return type_[i]==IP_EQUALITY && (i<n_ || dyn_pos_[i-n_]<0);
+  }
+
+  double RiccatiQp::hessWeight(int i) const {
+    // Barrier term for the inequalities. For the equality constraints G*dx = -rl, a term
+    // G'*G in the Hessian, balanced by G'*rl in the gradient, leaves the step unchanged
+    return isPathEquality(i) ? 1 : d_[i];
+  }
+
+  void RiccatiQp::addEqualityRow(int i, double c) {
+    if (i<n_) {
+      int k = var_stage_[i];
+      q_[k][i-offset_[k]] += c;
+    } else {
+      int r = i-n_;
+      vector<double>& q = q_[row_stage_[r]];
+      for (int j=0; j<C_[r].size(); ++j) q[j] += c*C_[r][j];
+    }
+  }
+
+  double RiccatiQp::equalityRowProd(int i, const double* v) const {
+    if (i<n_) return v[i];
+    int r = i-n_;
+    const double* v_k = v + offset_[row_stage_[r]];
+    double ret = 0;
+    for (int j=0; j<C_[r].size(); ++j) ret += C_[r][j]*v_k[j];
+    return ret;
+  }
+
+  void RiccatiQp::factorizeKKT() {
+    // Factorize the Newton system by a backward Riccati recursion
+    factorize();
+
+    // Equality constraints other than the dynamics
+    eq_ind_.clear();
+    for (int i=0; i<n_+nc_; ++i) {
+      if (isPathEquality(i)) eq_ind_.push_back(i);
+    }
+    int neq = eq_ind_.size();
+    if (neq==0) return;
+
+    // Solve the Newton system for each of their rows, without dynamics residual
+    eq_dx_.resize(neq*n_);
+    eq_dlam_.resize(neq*nc_);
+    for (int k=0; k<N_; ++k) fill(abar_[k].begin(), abar_[k].end(), 0);
+    for (int j=0; j<neq; ++j) {
+      for (int k=0; k<=N_; ++k) fill(q_[k].begin(), q_[k].end(), 0);
+      addEqualityRow(eq_ind_[j], 1);
+      backsolve();
+      copy(dx_.begin(), dx_.end(), eq_dx_.begin()+j*n_);
+      copy(dlam_.begin()+n_, dlam_.end(), eq_dlam_.begin()+j*nc_);
+    }
+
+    // Schur complement, positive definite unless the rows are linearly dependent
+    eq_schur_.resize(neq*neq);
+    eq_nu_.resize(neq);
+    for (int i=0; i<neq; ++i) {
+      for (int j=0; j<neq; ++j) {
+        eq_schur_[i*neq+j] = -equalityRowProd(eq_ind_[i], getPtr(eq_dx_)+j*n_);
+      }
+    }
+    casadi_assert_message(chol(neq, getPtr(eq_schur_)), "RiccatiQp: the equality constraints "
+                          "other than the dynamics are linearly dependent");
+  }
+
+  void RiccatiQp::solveKKT() {
+    // Contribution of the bounds to the stage gradients
+    for (int i=0; i<n_+nc_; ++i) {
+      e_[i] = 0;
+      if (type_[i]==IP_EQUALITY) {
+        if (isPathEquality(i)) e_[i] = rl_[i];
+        continue;
+      }
+      if (type_[i]==IP_LOWER || type_[i]==IP_BOTH) {
+        e_[i] += (rcl_[i] + zl_[i]*rl_[i])/sl_[i];
+      }
+      if (type_[i]==IP_UPPER || type_[i]==IP_BOTH) {
+        e_[i] -= (rcu_[i] + zu_[i]*ru_[i])/su_[i];
+      }
+    }
+    for (int k=0; k<=N_; ++k) {
+      for (int j=0; j<q_[k].size(); ++j) q_[k][j] = rd_[offset_[k]+j] + e_[offset_[k]+j];
+    }
+    for (int r=0; r<nc_; ++r) {
+      if (e_[n_+r]==0) continue;
+      for (int j=0; j<C_[r].size(); ++j) q_[row_stage_[r]][j] += e_[n_+r]*C_[r][j];
+    }
+
+    // Offset of the linearized dynamics
+    for (int k=0; k<N_; ++k) {
+      for (int i=0; i<nx_[k+1]; ++i) abar_[k][i] = -rl_[n_+dyn_rows_[k][i]];
+      luSolve(nx_[k+1], getPtr(E_lu_[k]), getPtr(E_piv_[k]), getPtr(abar_[k]), false);
+    }
+
+    // Solve with the equality multipliers fixed at zero
+    backsolve();
+
+    // Equality multipliers such that the equality constraints hold
+    int neq = eq_ind_.size();
+    for (int j=0; j<neq; ++j) {
+      eq_nu_[j] = rl_[eq_ind_[j]] + equalityRowProd(eq_ind_[j], getPtr(dx_));
+    }
+    if (neq>0) cholSolve(neq, getPtr(eq_schur_), getPtr(eq_nu_));
+    for (int j=0; j<neq; ++j) {
+      double nu = eq_nu_[j];
+      dlam_[eq_ind_[j]] = nu;
+      const double* eq_dx = getPtr(eq_dx_) + j*n_;
+      for (int i=0; i<n_; ++i) dx_[i] += nu*eq_dx[i];
+      const double* eq_dlam = getPtr(eq_dlam_) + j*nc_;
+      for (int k=0; k<N_; ++k) {
+        for (int i=0; i<nx_[k+1]; ++i) {
+          int r = dyn_rows_[k][i];
+          dlam_[n_+r] += nu*eq_dlam[r];
+        }
+      }
+    }
+  }
+
+  void RiccatiQp::solveCondensing() {
+    const double* h = getPtr(input(QP_SOLVER_H).data());
+    const double* g = getPtr(input(QP_SOLVER_G).data());
+    const double* a = getPtr(input(QP_SOLVER_A).data());
+    const Sparsity& sp_h = input(QP_SOLVER_H).sparsity();
+    const Sparsity& sp_a = input(QP_SOLVER_A).sparsity();
+    int nv = v_ind_.size(), nst = st_ind_.size(), nrow = nst + path_rows_.size();
+
+    // Eliminate the states, x = S*v + s
+    fill(S_.begin(), S_.end(), 0);
+    fill(s_.begin(), s_.end(), 0);
+    for (int j=0; j<nv; ++j) S_[v_ind_[j] + j*n_] = 1;
+    for (int k=0; k<N_; ++k) {
+      int nz = nx_[k] + nu_[k], nx1 = nx_[k+1], off = offset_[k], off1 = offset_[k+1];
+      const vector<double>& Abar = Abar_[k];
+      for (int i=0; i<nx1; ++i) work_[i] = lb_[n_+dyn_rows_[k][i]];
+      luSolve(nx1, getPtr(E_lu_[k]), getPtr(E_piv_[k]), getPtr(work_), false);
+      for (int i=0; i<nx1; ++i) {
+        s_[off1+i] = work_[i];
+        for (int j=0; j<nz; ++j) s_[off1+i] += Abar[i*nz+j]*s_[off+j];
+      }
+      for (int c=0; c<nv; ++c) {
+        double* S_c = getPtr(S_) + c*n_;
+        for (int i=0; i<nx1; ++i) {
+          double v = 0;
+          for (int j=0; j<nz; ++j) v += Abar[i*nz+j]*S_c[off+j];
+          S_c[off1+i] = v;
+        }
+      }
+    }
+
+    // Condensed Hessian S'*H*S and gradient S'*(H*s + g)
+    vector<double>& Hc = qp_solver_.input(QP_SOLVER_H).data();
+    vector<double>& gc = qp_solver_.input(QP_SOLVER_G).data();
+    vector<double>& Ac = qp_solver_.input(QP_SOLVER_A).data();
+    for (int c=0; c<nv; ++c) {
+      const double* S_c = getPtr(S_) + c*n_;
+      fill(rd_.begin(), rd_.end(), 0);
+      casadi_mv(h, sp_h, S_c, getPtr(rd_));
+      for (int r=0; r<nv; ++r) Hc[r + c*nv] = casadi_inner_prod(n_, getPtr(S_) + r*n_, getPtr(rd_));
+
+      // Condensed constraints: states and single-stage rows of A
+      for (int j=0; j<nst; ++j) Ac[j + c*nrow] = S_c[st_ind_[j]];
+      fill(w_.begin(), w_.end(), 0);
+      casadi_mv(a, sp_a, S_c, getPtr(w_));
+      for (int j=0; j<path_rows_.size(); ++j) Ac[nst + j + c*nrow] = w_[path_rows_[j]];
+    }
+    copy(g, g+n_, rd_.begin());
+    casadi_mv(h, sp_h, getPtr(s_), getPtr(rd_));
+    for (int r=0; r<nv; ++r) gc[r] = casadi_inner_prod(n_, getPtr(S_) + r*n_, getPtr(rd_));
+
+    // Condensed bounds
+    fill(w_.begin(), w_.end(), 0);
+    casadi_mv(a, sp_a, getPtr(s_), getPtr(w_));
+    vector<double>& lbx_c = qp_solver_.input(QP_SOLVER_LBX).data();
+    vector<double>& ubx_c = qp_solver_.input(QP_SOLVER_UBX).data();
+    vector<double>& lba_c = qp_solver_.input(QP_SOLVER_LBA).data();
+    vector<double>& uba_c = qp_solver_.input(QP_SOLVER_UBA).data();
+    vector<double>& x0_c = qp_solver_.input(QP_SOLVER_X0).data();
+    vector<double>& lam_x0_c = qp_solver_.input(QP_SOLVER_LAM_X0).data();
+    for (int j=0; j<nv; ++j) {
+      lbx_c[j] = lb_[v_ind_[j]];
+      ubx_c[j] = ub_[v_ind_[j]];
+      x0_c[j] = input(QP_SOLVER_X0).at(v_ind_[j]);
+      lam_x0_c[j] = input(QP_SOLVER_LAM_X0).at(v_ind_[j]);
+    }
+    for (int j=0; j<nst; ++j) {
+      lba_c[j] = lb_[st_ind_[j]] - s_[st_ind_[j]];
+      uba_c[j] = ub_[st_ind_[j]] - s_[st_ind_[j]];
+    }
+    for (int j=0; j<path_rows_.size(); ++j) {
+      lba_c[nst+j] = lb_[n_+path_rows_[j]] - w_[path_rows_[j]];
+      uba_c[nst+j] = ub_[n_+path_rows_[j]] - w_[path_rows_[j]];
+    }
+
+    // Solve the condensed QP
+    qp_solver_.evaluate();
+    stats_["qp_solver_stats"] = qp_solver_.getStats();
+
+    // Expand the solution
+    const vector<double>& v = qp_solver_.output(QP_SOLVER_X).data();
+    const vector<double>& lam_x_c = qp_solver_.output(QP_SOLVER_LAM_X).data();
+    const vector<double>& lam_a_c = qp_solver_.output(QP_SOLVER_LAM_A).data();
+    vector<double>& x = output(QP_SOLVER_X).data();
+    vector<double>& lam_x = output(QP_SOLVER_LAM_X).data();
+    vector<double>& lam_a = output(QP_SOLVER_LAM_A).data();
+    copy(s_.begin(), s_.end(), x.begin());
+    for (int c=0; c<nv; ++c) {
+      for (int i=0; i<n_; ++i) x[i] += S_[i + c*n_]*v[c];
+    }
+    for (int j=0; j<nv; ++j) lam_x[v_ind_[j]] = lam_x_c[j];
+    for (int j=0; j<nst; ++j) lam_x[st_ind_[j]] = lam_a_c[j];
+    fill(lam_a.begin(), lam_a.end(), 0);
+    for (int j=0; j<path_rows_.size(); ++j) lam_a[path_rows_[j]] = lam_a_c[nst+j];
+
+    // Multipliers of the dynamics from stationarity with respect to the states
+    copy(g, g+n_, rd_.begin());
+    for (int i=0; i<n_; ++i) rd_[i] += lam_x[i];
+    casadi_mv(h, sp_h, getPtr(x), getPtr(rd_));
+    casadi_mv_t(a, sp_a, getPtr(lam_a), getPtr(rd_));
+    for (int k=N_-1; k>=0; --k) {
+      int nx1 = nx_[k+1];
+      for (int i=0; i<nx1; ++i) work_[i] = rd_[offset_[k+1]+i];
+      if (k+1<N_) {
+        int nz1 = nx1 + nu_[k+1];
+        for (int j=0; j<nx_[k+2]; ++j) {
+          double lam_j = lam_a[dyn_rows_[k+1][j]];
+          for (int i=0; i<nx1; ++i) work_[i] += F_[k+1][j*nz1+i]*lam_j;
+        }
+      }
+      luSolve(nx1, getPtr(E_lu_[k]), getPtr(E_piv_[k]), getPtr(work_), true);
+      for (int i=0; i<nx1; ++i) lam_a[dyn_rows_[k][i]] = -work_[i];
+    }
+  }
+
+} // namespace casadi
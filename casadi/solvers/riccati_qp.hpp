@@ -0,0 +1,197 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#ifndef CASADI_RICCATI_QP_HPP
+#define CASADI_RICCATI_QP_HPP
+
+#include "interior_point_qp.hpp"
+#include "casadi/core/function/qp_solver.hpp"
+
+#include <casadi/solvers/casadi_qpsolver_riccati_export.h>
+
+
+/** \defgroup plugin_QpSolver_riccati
+   Structure-exploiting QP solver for optimal control problems.
+
+   The decision variables are assumed to be ordered by stage,
+   x = [x_0; u_0; x_1; u_1; ...; x_{N-1}; u_{N-1}; x_N], with the state
+   and control dimensions of each stage given by the options nx and nu.
+   The Hessian must be block diagonal with respect to the stages.
+   Rows of A that couple stage k and stage k+1 are the dynamics and must be
+   equality constraints, exactly nx_{k+1} of them per stage, with an
+   invertible block with respect to x_{k+1}. All other rows of A must
+   involve a single stage only.
+
+   The QP is solved with a primal-dual interior point method (Mehrotra
+   predictor-corrector) in which each Newton system is solved by a Riccati
+   recursion, so that the cost grows linearly with the horizon length N.
+   Other equality constraints, i.e. equal bounds on a variable or on a
+   single-stage row of A, keep their own multipliers, which are obtained
+   from a Schur complement at the cost of one extra Riccati solve per
+   equality constraint and iteration.
+   Alternatively, with the option condensing, the states are eliminated
+   using the dynamics and the resulting dense QP in the initial state and
+   the controls is solved with the QpSolver given by the option qp_solver.
+*/
+
+/** \pluginsection{QpSolver,riccati} */
+
+/// \cond INTERNAL
+namespace casadi {
+
+  /** \brief \pluginbrief{QpSolver,riccati}
+
+   @copydoc QpSolver_doc
+   @copydoc plugin_QpSolver_riccati
+
+  */
+  class CASADI_QPSOLVER_RICCATI_EXPORT RiccatiQp : public InteriorPointQp {
+  public:
+    /** \brief  Create a new Solver */
+    explicit RiccatiQp(const std::map<std::string, Sparsity> &st);
+
+    /** \brief  Destructor */
+    virtual ~RiccatiQp();
+
+    /** \brief  Clone */
+    virtual RiccatiQp* clone() const { return new RiccatiQp(*this);}
+
+    /** \brief  Create a new QP Solver */
+    static QpSolverInternal* creator(const std::map<std::string, Sparsity>& st) {
+      return new RiccatiQp(st);
+    }
+
+    /** \brief  Deep copy data members */
+    virtual void deepCopyMembers(std::map<SharedObjectNode*, SharedObject>& already_copied);
+
+    /** \brief  Initialize */
+    virtual void init();
+
+    /** \brief  Solve the QP */
+    virtual void evaluate();
+
+    /// A documentation string
+    static const std::string meta_doc;
+
+  protected:
+    /// Copy the numerical values of H and A into the stage-wise dense blocks
+    void getStageData();
+
+    /// Solve by condensing and calling qp_solver_
+    void solveCondensing();
+
+    /// Factorize the stage-wise Newton system for the current barrier term
+    void factorize();
+
+    /// Solve the factorized Newton system for the stage gradients in q_ and dynamics residual
+    void backsolve();
+
+    /// Factorize the Newton system and the Schur complement of the equality constraints
+    virtual void factorizeKKT();
+
+    /// Solve the Newton system for the current residuals
+    virtual void solveKKT();
+
+    /// Weight of a component of w in the stage Hessians
+    double hessWeight(int i) const;
+
+    /// Equality constraint i that is not part of the dynamics
+    bool isPathEquality(int i) const;
+
+    /// Add c times the row of equality constraint i to the stage gradients q_
+    void addEqualityRow(int i, double c);
+
+    /// Product of the row of equality constraint i with a vector
+    double equalityRowProd(int i, const double* v) const;
+
+    /// Number of stages (horizon length)
+    int N_;
+
+    /// State and control dimensions, offset of each stage in x
+    std::vector<int> nx_, nu_, offset_;
+
+    /// Stage index of each variable and of each row of A
+    std::vector<int> var_stage_, row_stage_;
+
+    /// Rows of A defining the dynamics from stage k to stage k+1
+    std::vector<std::vector<int> > dyn_rows_;
+
+    /// Position of each row of A in dyn_rows_, -1 for single-stage rows
+    std::vector<int> dyn_pos_;
+
+    /// Destination of each nonzero of H in the stage Hessian blocks (-1: none)
+    std::vector<int> h_dest_;
+
+    /// Destination of each nonzero of A in the dynamics blocks E, F or the path rows
+    std::vector<int> a_dest_;
+    std::vector<char> a_kind_;
+
+    /// Dense stage Hessians and dynamics blocks E_k x_{k+1} + F_k [x_k; u_k] = b_k
+    std::vector<std::vector<double> > Q_, E_, F_;
+
+    /// Dense coefficients of the single-stage rows of A, indexed by row
+    std::vector<std::vector<double> > C_;
+
+    /// LU factorization of E_k, and Abar_k = -E_k^(-1) F_k
+    std::vector<std::vector<double> > E_lu_, Abar_;
+    std::vector<std::vector<int> > E_piv_;
+
+    /// Riccati recursion: cost-to-go, feedback, factorized control Hessian
+    std::vector<std::vector<double> > P_, K_, M_, Luu_;
+
+    /// Riccati recursion: factorized cost-to-go of the initial state
+    std::vector<double> L0_;
+
+    /// Riccati recursion: linear terms
+    std::vector<std::vector<double> > q_, p_, kff_, abar_;
+
+    /// Work vector for the stage-wise operations
+    std::vector<double> work_;
+
+    /// Contribution of the bounds to the stage gradients
+    std::vector<double> e_;
+
+    /// Equality constraints that are not part of the dynamics, as components of w
+    std::vector<int> eq_ind_;
+
+    /// Solutions of the Newton system for the rows of eq_ind_: steps in x and in lam_a
+    std::vector<double> eq_dx_, eq_dlam_;
+
+    /// Factorized Schur complement of the equality constraints and work vector
+    std::vector<double> eq_schur_, eq_nu_;
+
+    /// Condensing: QP solver for the condensed problem
+    QpSolver qp_solver_;
+
+    /// Condensing: x = S*v + s with v = [x_0; u_0; ...; u_{N-1}], dense, column-major
+    std::vector<double> S_, s_;
+
+    /// Condensing: indices of v and of the eliminated states in x, single-stage rows of A
+    std::vector<int> v_ind_, st_ind_, path_rows_;
+  };
+
+} // namespace casadi
+/// \endcond
+#endif // CASADI_RICCATI_QP_HPP
@@ -0,0 +1,151 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+      #include "riccati_qp.hpp"
+      #include <string>
+
+      const std::string casadi::RiccatiQp::meta_doc=
+      "\n"
+"Structure-exploiting QP solver for optimal control problems.\n"
+"\n"
+"The decision variables are assumed to be ordered by stage, x = [x_0; u_0;\n"
+"x_1; u_1; ...; x_{N-1}; u_{N-1}; x_N], with the state and control\n"
+"dimensions of each stage given by the options nx and nu. The Hessian must\n"
+"be block diagonal with respect to the stages. Rows of A that couple stage k\n"
+"and stage k+1 are the dynamics and must be equality constraints, exactly\n"
+"nx_{k+1} of them per stage, with an invertible block with respect to\n"
+"x_{k+1}. All other rows of A must involve a single stage only.\n"
+"\n"
+"The QP is solved with a primal-dual interior point method (Mehrotra\n"
+"predictor-corrector) in which each Newton system is solved by a Riccati\n"
+"recursion, so that the cost grows linearly with the horizon length N.\n"
+"Other equality constraints, i.e. equal bounds on a variable or on a\n"
+"single-stage row of A, keep their own multipliers, which are obtained from\n"
+"a Schur complement at the cost of one extra Riccati solve per equality\n"
+"constraint and iteration.\n"
+"Alternatively, with the option condensing, the states are eliminated using\n"
+"the dynamics and the resulting dense QP in the initial state and the\n"
+"controls is solved with the QpSolver given by the option qp_solver.\n"
+"\n"
+"\n"
+">List of available options\n"
+"\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
+"|       Id        |      Type       |     Default     |   Description   |\n"
+"+=================+=================+=================+=================+\n"
+"| condensing      | OT_BOOLEAN      | false           | Eliminate the   |\n"
+"|                 |                 |                 | states and      |\n"
+"|                 |                 |                 | solve the dense |\n"
+"|                 |                 |                 | condensed QP    |\n"
+"|                 |                 |                 | with qp_solver  |\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
+"| init_slack      | OT_REAL         | 1               | Lower bound on  |\n"
+"|                 |                 |                 | the initial     |\n"
+"|                 |                 |                 | slacks and      |\n"
+"|                 |                 |                 | bound           |\n"
+"|                 |                 |                 | multipliers.    |\n"
+"|                 |                 |                 | When warm       |\n"
+"|                 |                 |                 | starting from   |\n"
+"|                 |                 |                 | x0 and lam_x0,  |\n"
+"|                 |                 |                 | a small value   |\n"
+"|                 |                 |                 | should be       |\n"
+"|                 |                 |                 | chosen.         |\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
+"| max_iter        | OT_INTEGER      | 100             | Maximum number  |\n"
+"|                 |                 |                 | of interior     |\n"
+"|                 |                 |                 | point           |\n"
+"|                 |                 |                 | iterations      |\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
+"| nu              | OT_INTEGERVECTO | GenericType()   | Number of       |\n"
+"|                 | R               |                 | controls in     |\n"
+"|                 |                 |                 | each stage      |\n"
+"|                 |                 |                 | k=0..N-1        |\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
+"| nx              | OT_INTEGERVECTO | GenericType()   | Number of       |\n"
+"|                 | R               |                 | states in each  |\n"
+"|                 |                 |                 | stage k=0..N. A |\n"
+"|                 |                 |                 | single entry    |\n"
+"|                 |                 |                 | means constant  |\n"
+"|                 |                 |                 | dimensions,     |\n"
+"|                 |                 |                 | with the        |\n"
+"|                 |                 |                 | horizon length  |\n"
+"|                 |                 |                 | derived from    |\n"
+"|                 |                 |                 | the number of   |\n"
+"|                 |                 |                 | variables.      |\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
+"| print_iteration | OT_BOOLEAN      | false           | Print           |\n"
+"|                 |                 |                 | information     |\n"
+"|                 |                 |                 | about each      |\n"
+"|                 |                 |                 | iteration       |\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
+"| qp_solver       | OT_STRING       | GenericType()   | The QP solver   |\n"
+"|                 |                 |                 | used for the    |\n"
+"|                 |                 |                 | condensed QP    |\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
+"| qp_solver_optio | OT_DICT         | GenericType()   | Options to be   |\n"
+"| ns              |                 |                 | passed to the   |\n"
+"|                 |                 |                 | QP solver for   |\n"
+"|                 |                 |                 | the condensed   |\n"
+"|                 |                 |                 | QP              |\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
+"| regularization  | OT_REAL         | 0.000           | Regularization  |\n"
+"|                 |                 |                 | of the Newton   |\n"
+"|                 |                 |                 | system          |\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
+"| step_fraction   | OT_REAL         | 0.995           | Fraction of the |\n"
+"|                 |                 |                 | step to the     |\n"
+"|                 |                 |                 | boundary taken  |\n"
+"|                 |                 |                 | in each         |\n"
+"|                 |                 |                 | iteration       |\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
+"| tol             | OT_REAL         | 0.000           | Stopping        |\n"
+"|                 |                 |                 | criterion       |\n"
+"|                 |                 |                 | tolerance on    |\n"
+"|                 |                 |                 | the primal and  |\n"
+"|                 |                 |                 | dual            |\n"
+"|                 |                 |                 | infeasibility   |\n"
+"|                 |                 |                 | and on the      |\n"
+"|                 |                 |                 | average         |\n"
+"|                 |                 |                 | complementarity |\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
+"\n"
+"\n"
+">List of available stats\n"
+"\n"
+"+-----------------+\n"
+"|        Id       |\n"
+"+=================+\n"
+"| iter_count      |\n"
+"+-----------------+\n"
+"| qp_solver_stats |\n"
+"+-----------------+\n"
+"| return_status   |\n"
+"+-----------------+\n"
+"| t_solve         |\n"
+"+-----------------+\n"
+"\n"
+"\n"
+"\n"
+;
@@ -24,6 +24,8 @@
 
 
 #include "rk_integrator.hpp"
+#include "casadi/core/function/sx_function_internal.hpp"
+#include "casadi/core/std_vector_tools.hpp"
 
 using namespace std;
 namespace casadi {
@@ -45,23 +47,123 @@ namespace casadi {
 
   RkIntegrator::RkIntegrator(const Function& f, const Function& g) :
       FixedStepIntegrator(f, g) {
+    addOption("ensemble_size",       OT_INTEGER,  1,
+              "Number of trajectories integrated simultaneously. Inputs and outputs "
+              "are stacked horizontally, one block of columns per trajectory.");
+    addOption("ensemble_block_size", OT_INTEGER,  64,
+              "Number of trajectories evaluated together in one batched call "
+              "in ensemble mode");
   }
 
   void RkIntegrator::deepCopyMembers(
       std::map<SharedObjectNode*, SharedObject>& already_copied) {
     FixedStepIntegrator::deepCopyMembers(already_copied);
+    F_ens_ = deepcopy(F_ens_, already_copied);
   }
 
   RkIntegrator::~RkIntegrator() {
   }
 
   void RkIntegrator::init() {
+    // Number of trajectories, needed to allocate inputs and outputs
+    ensemble_ = getOption("ensemble_size");
+
     // Call the base class init
     FixedStepIntegrator::init();
 
     // Algebraic variables not (yet?) supported
     casadi_assert_message(nz_==0 && nrz_==0,
                           "Explicit Runge-Kutta integrators do not support algebraic variables");
+
+    // Setup ensemble mode
+    if (ensemble_>1) {
+      casadi_assert_message(nrx_==0, "Backward integration not supported in ensemble mode");
+      ensemble_block_ = getOption("ensemble_block_size");
+      casadi_assert(ensemble_block_>0);
+
+      // Discrete time dynamics, without the intermediate variables only needed for G
+      vector<MX> F_arg(DAE_NUM_IN);
+      F_arg[DAE_T] = MX::sym("t", F_.input(DAE_T).sparsity());
+      F_arg[DAE_X] = MX::sym("x0", F_.input(DAE_X).sparsity());
+      F_arg[DAE_Z] = MX::zeros(F_.input(DAE_Z).sparsity());
+      F_arg[DAE_P] = MX::sym("p", F_.input(DAE_P).sparsity());
+      vector<MX> F_res = F_(F_arg);
+      vector<MX> arg(3), res(2);
+      arg[0] = F_arg[DAE_T];
+      arg[1] = F_arg[DAE_X];
+      arg[2] = F_arg[DAE_P];
+      res[0] = F_res[DAE_ODE];
+      res[1] = F_res[DAE_QUAD];
+
+      // Expand into scalar operations so that it can be evaluated in batches
+      F_ens_ = MXFunction("ensemble_step", arg, res).expand();
+
+      // Work vector: t, x, xf, p, q, qf and the work vector of F_ens_ for each trajectory
+      int nblock = (ensemble_ + ensemble_block_ - 1) / ensemble_block_;
+      int nt = F_ens_.input(0).nnz();
+      ens_work_.resize(nblock * ensemble_block_ * (nt + 2*nx_ + np_ + 2*nq_ + F_ens_.sz_w()));
+    }
+  }
+
+  void RkIntegrator::integrate(double t_out) {
+    if (ensemble_==1) return FixedStepIntegrator::integrate(t_out);
+
+    // Get discrete time sought
+    int k_out = std::ceil((t_out-t0_)/h_);
+    k_out = std::min(k_out, nk_); //  make sure that rounding errors does not result in k_out>nk_
+    casadi_assert(k_out>=0);
+
+    // Problem dimensions
+    int N = ensemble_, B = ensemble_block_, nblock = (N + B - 1) / B;
+    int nt = F_ens_.input(0).nnz(), sz_w = F_ens_.sz_w();
+    int sz_block = B * (nt + 2*nx_ + np_ + 2*nq_ + sz_w);
+    const double* x0 = xf().ptr();
+    const double* p0 = p().ptr();
+    double* xf0 = xf().ptr();
+    double* qf0 = qf().ptr();
+    SXFunctionInternal* F = F_ens_.operator->();
+    int k0 = k_;
+
+    // Integrate each block of trajectories over all time steps
+#ifdef WITH_OPENMP
+#pragma omp parallel for
+#endif // WITH_OPENMP
+    for (int b=0; b<nblock; ++b) {
+      // Trajectories in the block
+      int j0 = b*B, nb = std::min(B, N-j0);
+
+      // Segments of the work vector
+      double *t = getPtr(ens_work_) + b*sz_block;
+      double *x = t + nt*B, *xn = x + nx_*B, *p = xn + nx_*B;
+      double *q = p + np_*B, *dq = q + nq_*B, *w = dq + nq_*B;
+
+      // Transpose states, parameters and quadratures to structure-of-arrays
+      for (int j=0; j<nb; ++j) {
+        for (int i=0; i<nx_; ++i) x[i*nb+j] = x0[(j0+j)*nx_+i];
+        for (int i=0; i<np_; ++i) p[i*nb+j] = p0[(j0+j)*np_+i];
+        for (int i=0; i<nq_; ++i) q[i*nb+j] = qf0[(j0+j)*nq_+i];
+      }
+
+      // Take time steps until end time has been reached
+      const double* arg[3] = {t, x, p};
+      double* res[2] = {xn, dq};
+      for (int k=k0; k<k_out; ++k) {
+        std::fill(t, t+nt*nb, t0_ + k*h_);
+        F->evalBatch(arg, res, nb, w);
+        std::copy(xn, xn+nx_*nb, x);
+        for (int i=0; i<nq_*nb; ++i) q[i] += dq[i];
+      }
+
+      // Transpose back
+      for (int j=0; j<nb; ++j) {
+        for (int i=0; i<nx_; ++i) xf0[(j0+j)*nx_+i] = x[i*nb+j];
+        for (int i=0; i<nq_; ++i) qf0[(j0+j)*nq_+i] = q[i*nb+j];
+      }
+    }
+
+    // Advance time
+    k_ = std::max(k_, k_out);
+    t_ = t0_ + k_*h_;
   }
 
   void RkIntegrator::setupFG() {
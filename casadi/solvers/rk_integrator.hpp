@@ -27,12 +27,20 @@
 #define CASADI_RK_INTEGRATOR_HPP
 
 #include "fixed_step_integrator.hpp"
+#include "casadi/core/function/sx_function.hpp"
 #include <casadi/solvers/casadi_integrator_rk_export.h>
 
 /** \defgroup plugin_Integrator_rk
       Fixed-step explicit Runge-Kutta integrator for ODEs
       Currently implements RK4.
 
+      With the option ensemble_size set to N>1, the integrator advances N
+      trajectories of the same ODE in lockstep. The initial states, parameters
+      and results of the different trajectories are stacked horizontally.
+      The discrete time dynamics are expanded into scalar operations and
+      evaluated for blocks of trajectories at once in a structure-of-arrays
+      layout.
+
       The method is still under development
 */
 /** \pluginsection{Integrator,rk} */
@@ -78,6 +86,18 @@ namespace casadi {
     /// Setup F and G
     virtual void setupFG();
 
+    ///  Integrate until a specified time point
+    virtual void integrate(double t_out);
+
+    /// Discrete time dynamics for the ensemble mode: (t, x, p) -> (xf, qf)
+    SXFunction F_ens_;
+
+    /// Number of trajectories per batched evaluation
+    int ensemble_block_;
+
+    /// Work vector for the ensemble mode, one segment per block of trajectories
+    std::vector<double> ens_work_;
+
     /// A documentation string
     static const std::string meta_doc;
 
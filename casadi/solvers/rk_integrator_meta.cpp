@@ -31,6 +31,13 @@
 "Fixed-step explicit Runge-Kutta integrator for ODEs Currently\n"
 "implements RK4.\n"
 "\n"
+"With the option ensemble_size set to N>1, the integrator advances N\n"
+"trajectories of the same ODE in lockstep. The initial states,\n"
+"parameters and results of the different trajectories are stacked\n"
+"horizontally. The discrete time dynamics are expanded into scalar\n"
+"operations and evaluated for blocks of trajectories at once in a\n"
+"structure-of-arrays layout.\n"
+"\n"
 "The method is still under development\n"
 "\n"
 "\n"
@@ -39,6 +46,25 @@
 "+-----------------+-----------------+-----------------+-----------------+\n"
 "|       Id        |      Type       |     Default     |   Description   |\n"
 "+=================+=================+=================+=================+\n"
+"| ensemble_block_ | OT_INTEGER      | 64              | Number of       |\n"
+"| size            |                 |                 | trajectories    |\n"
+"|                 |                 |                 | evaluated       |\n"
+"|                 |                 |                 | together in one |\n"
+"|                 |                 |                 | batched call in |\n"
+"|                 |                 |                 | ensemble mode   |\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
+"| ensemble_size   | OT_INTEGER      | 1               | Number of       |\n"
+"|                 |                 |                 | trajectories    |\n"
+"|                 |                 |                 | integrated simu |\n"
+"|                 |                 |                 | ltaneously.     |\n"
+"|                 |                 |                 | Inputs and      |\n"
+"|                 |                 |                 | outputs are     |\n"
+"|                 |                 |                 | stacked         |\n"
+"|                 |                 |                 | horizontally,   |\n"
+"|                 |                 |                 | one block of    |\n"
+"|                 |                 |                 | columns per     |\n"
+"|                 |                 |                 | trajectory.     |\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
 "| number_of_finit | OT_INTEGER      | 20              | Number of       |\n"
 "| e_elements      |                 |                 | finite elements |\n"
 "+-----------------+-----------------+-----------------+-----------------+\n"
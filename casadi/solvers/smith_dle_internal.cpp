@@ -0,0 +1,396 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#include "smith_dle_internal.hpp"
+#include "../core/std_vector_tools.hpp"
+#include "../core/function/mx_function.hpp"
+#include "casadi/core/runtime/runtime.hpp"
+
+#include <cmath>
+
+INPUTSCHEME(DLEInput)
+OUTPUTSCHEME(DLEOutput)
+
+using namespace std;
+namespace casadi {
+
+  extern "C"
+  int CASADI_DLESOLVER_SMITH_EXPORT
+  casadi_register_dlesolver_smith(DleInternal::Plugin* plugin) {
+    plugin->creator = SmithDleInternal::creator;
+    plugin->name = "smith";
+    plugin->doc = SmithDleInternal::meta_doc.c_str();
+    plugin->version = 23;
+    return 0;
+  }
+
+  extern "C"
+  void CASADI_DLESOLVER_SMITH_EXPORT casadi_load_dlesolver_smith() {
+    DleInternal::registerPlugin(casadi_register_dlesolver_smith);
+  }
+
+  SmithDleInternal::SmithDleInternal(const std::map<std::string, Sparsity>& st,
+                                     int nrhs, bool transp) : DleInternal(st, nrhs, transp) {
+
+    // Set default options
+    setOption("name", "unnamed_smith_dle_solver"); // name of the function
+    addOption("tol", OT_REAL, 1e-12,
+              "Stop when the last update is smaller than tol times the iterate, "
+              "in the largest absolute entry");
+    addOption("max_iter", OT_INTEGER, 100, "Maximum number of Smith iterations");
+    addOption("freq_doubling", OT_BOOLEAN, true,
+              "Use frequency doubling (squared Smith iterations)");
+  }
+
+  SmithDleInternal::~SmithDleInternal() {
+
+  }
+
+  void SmithDleInternal::init() {
+    tol_ = getOption("tol");
+    max_iter_ = getOption("max_iter");
+    freq_doubling_ = getOption("freq_doubling");
+
+    DleInternal::init();
+
+    casadi_assert_message(!pos_def_,
+      "pos_def option set to True: Solver only handles the indefinite case.");
+
+    DenseIO::init();
+
+    n_ = A_.size1();
+    int nn = n_*n_;
+
+    // Allocate work vectors
+    Ak_.resize(nn);
+    Akt_.resize(nn);
+    X_.resize(nn*nrhs_);
+    V_sym_.resize(freq_doubling_ ? 0 : nn*nrhs_);
+    tmp_.resize(nn);
+    D_.resize(nn);
+    converged_.resize(nrhs_);
+  }
+
+  void SmithDleInternal::evaluate() {
+    DenseIO::readInputs();
+
+    int n = n_, nn = n*n;
+
+    // The adjoint equation X = A' X A + V is iterated with A'
+    const std::vector<double>& A = inputD(DLE_A).data();
+    for (int j=0; j<n; ++j) {
+      for (int i=0; i<n; ++i) {
+        Akt_[j+i*n] = Ak_[i+j*n] = transp_ ? A[j+i*n] : A[i+j*n];
+      }
+    }
+
+    // Start from the symmetrized right hand sides
+    for (int d=0; d<nrhs_; ++d) {
+      const std::vector<double>& V = inputD(1+d).data();
+      double* X = getPtr(X_) + d*nn;
+      for (int j=0; j<n; ++j) {
+        for (int i=0; i<n; ++i) X[i+j*n] = (V[i+j*n]+V[j+i*n])/2;
+      }
+      if (!freq_doubling_) std::copy(X, X+nn, V_sym_.begin()+d*nn);
+      converged_[d] = false;
+    }
+
+    int iter = 0;
+    double rel_change = 0;
+    bool success = false;
+    while (true) {
+      // Check if all right hand sides have converged
+      success = true;
+      for (int d=0; d<nrhs_; ++d) success = success && converged_[d];
+      if (success) break;
+
+      // Break if maximum number of iterations already reached
+      if (iter >= max_iter_) {
+        log("evaluate", "Max. iterations reached.");
+        break;
+      }
+      iter++;
+
+      rel_change = 0;
+      for (int d=0; d<nrhs_; ++d) {
+        if (converged_[d]) continue;
+        double* X = getPtr(X_) + d*nn;
+
+        // D = A_k X_k A_k'
+        std::fill(tmp_.begin(), tmp_.end(), 0);
+        casadi_mm_dense(getPtr(Ak_), n, n, X, n, getPtr(tmp_));
+        std::fill(D_.begin(), D_.end(), 0);
+        casadi_mm_dense(getPtr(tmp_), n, n, getPtr(Akt_), n, getPtr(D_));
+
+        // Squared Smith: X_{k+1} = X_k + D, plain Smith: X_{k+1} = D + V
+        double change = 0, xnorm = 0;
+        if (freq_doubling_) {
+          for (int i=0; i<nn; ++i) {
+            X[i] += D_[i];
+            change = std::max(change, fabs(D_[i]));
+            xnorm = std::max(xnorm, fabs(X[i]));
+          }
+        } else {
+          const double* V = getPtr(V_sym_) + d*nn;
+          for (int i=0; i<nn; ++i) {
+            double x = D_[i] + V[i];
+            change = std::max(change, fabs(x-X[i]));
+            xnorm = std::max(xnorm, fabs(x));
+            X[i] = x;
+          }
+        }
+        double xsum = casadi_asum(nn, X, 1);
+        casadi_assert_message(!isnan(xsum) && !isinf(xsum),
+          "SmithDleInternal: iterations diverged after " << iter << " steps. "
+          "The Smith iterations require A to be stable.");
+        if (change <= tol_*xnorm) converged_[d] = true;
+        if (xnorm>0) rel_change = std::max(rel_change, change/xnorm);
+      }
+
+      // Frequency doubling: A_{k+1} = A_k A_k
+      if (freq_doubling_) {
+        std::fill(tmp_.begin(), tmp_.end(), 0);
+        casadi_mm_dense(getPtr(Ak_), n, n, getPtr(Ak_), n, getPtr(tmp_));
+        for (int j=0; j<n; ++j) {
+          for (int i=0; i<n; ++i) {
+            Akt_[j+i*n] = Ak_[i+j*n] = tmp_[i+j*n];
+          }
+        }
+      }
+    }
+
+    if (error_unstable_) {
+      casadi_assert_message(success,
+        "SmithDleInternal: no convergence after " << iter << " iterations, "
+        "the system is unstable or close to it (relative change " << rel_change << ")."
+        << std::endl << "Use options 'error_unstable' and 'max_iter' to influence this message.");
+    }
+
+    // Store the iteration count
+    if (gather_stats_) {
+      stats_["iter"] = iter;
+      stats_["rel_change"] = rel_change;
+    }
+    stats_["return_status"] = success ? "success" : "max_iteration_reached";
+
+    for (int d=0; d<nrhs_; ++d) {
+      std::copy(X_.begin()+d*nn, X_.begin()+(d+1)*nn, outputD(d).begin());
+    }
+
+    DenseIO::writeOutputs();
+  }
+
+  Function SmithDleInternal
+  ::getDerForward(const std::string& name, int nfwd, Dict& opts) {
+
+    // Base:
+    // P_0 P_1 P_2 .. P_{nrhs-1} = f( A Q_0 Q_1 Q_2 .. Q_{nrhs-1})
+
+    /* Allocate output list for derivative
+    *
+    * Structure:
+    *    [P_0^f0 .. P_{nrhs-1}^f0] ...
+    *       [P_0^f{nfwd-1} .. P_{nrhs-1}^f{nfwd-1}]
+    */
+    std::vector<MX> outs_new(nrhs_*nfwd, 0);
+
+    /* Allocate input list for derivative and populate with symbolics
+    * Three parts:
+    *
+    * 1)  [A Q_0 .. Q_{nrhs-1}]
+    * 2)  [P_0 .. P_{nrhs-1}]
+    * 3)  [A^f0 Q_0^f0 .. Q_{nrhs-1}^f0] ...
+    *       [A^f{nfwd-1} Q_0^f{nfwd-1} .. Q_{nrhs-1}^f{nfwd-1}]
+    */
+    std::vector<MX> ins_new(2*nrhs_+1 + (nrhs_+1)*nfwd, 0);
+
+    // Part 1
+    ins_new[0] = MX::sym("A", input(DLE_A).sparsity());
+    for (int i=0; i<nrhs_; ++i) {
+      ins_new[i+1] = MX::sym("Q", input(DLE_V).sparsity());
+    }
+
+    // Part 2
+    for (int i=0; i<nrhs_; ++i) {
+      ins_new[nrhs_+i+1] = MX::sym("P", output(DLE_P).sparsity());
+    }
+
+    // Part 3
+    for (int k=0; k<nfwd; ++k) {
+      ins_new.at(2*nrhs_+1 + (nrhs_+1)*k) = MX::sym("Af", input(DLE_A).sparsity());
+      for (int q=0; q<nrhs_; ++q) {
+        ins_new.at(2*nrhs_+1 + (nrhs_+1)*k+q+1) = MX::sym("Qf", input(DLE_V).sparsity());
+      }
+    }
+
+    // Prepare a solver for forward seeds
+    SmithDleInternal* node = new SmithDleInternal(make_map("a", st_[Dle_STRUCT_A],
+                                                           "v", st_[Dle_STRUCT_V]),
+                                                  nfwd, transp_);
+    node->setOption(dictionary());
+
+    DleSolver f;
+    f.assignNode(node);
+    f.init();
+
+    const MX& A = ins_new[0];
+    for (int q=0; q<nrhs_; ++q) {
+
+      // Forward
+      /* P_q^f0 .. P_q^f{nfwd-1} = f(A,
+      *          Q_q^f0 + A P_q (A^f0)^T + A^f0 P_q A^T,
+      *          ...
+      *          Q_q^f{nfwd-1} + A P_q (A^f{nfwd-1})^T + A^f{nfwd-1} P_q A^T)
+      */
+      const MX& P = ins_new[nrhs_+1+q];
+      std::vector<MX> ins_f;
+      ins_f.push_back(A);
+      for (int k=0; k<nfwd; ++k) {
+        const MX& Qf = ins_new.at(2*nrhs_+1+(nrhs_+1)*k+q+1);
+        const MX& Af = ins_new.at(2*nrhs_+1+(nrhs_+1)*k);
+
+        // Note: Qf is symmetrised here
+        MX temp;
+        if (transp_) {
+          temp = mul(A.T(), mul(P, Af)) + Qf/2;
+        } else {
+          temp = mul(A, mul(P, Af.T())) + Qf/2;
+        }
+        ins_f.push_back(temp + temp.T());
+      }
+
+      std::vector<MX> outs = f(ins_f);
+      for (int i=0; i<nfwd; ++i) {
+        outs_new.at(q+nrhs_*i) = outs[i];
+      }
+    }
+
+    return MXFunction(name, ins_new, outs_new, opts);
+  }
+
+  Function SmithDleInternal
+  ::getDerReverse(const std::string& name, int nadj, Dict& opts) {
+
+    // Base:
+    // P_0 P_1 P_2 .. P_{nrhs-1} = f( A Q_0 Q_1 Q_2 .. Q_{nrhs-1})
+
+    /* Allocate output list for derivative
+    *
+    * Structure:
+    *
+    * [A^b0 Q_0^b0 .. Q_{nrhs-1}^b0] ...
+    *       [A^b{nadj-1} Q_0^b{nadj-1} .. Q_{nrhs-1}^b{nadj-1}]
+    */
+    std::vector<MX> outs_new((nrhs_+1)*nadj, 0);
+
+    /* Allocate input list for derivative and populate with symbolics
+    * Three parts:
+    *
+    * 1)  [A Q_0 .. Q_{nrhs-1}]
+    * 2)  [P_0 .. P_{nrhs-1}]
+    * 3)  [P_0^b0 .. P_{nrhs-1}^b0] ...
+    *       [P_0^b{nadj-1} .. P_{nrhs-1}^b{nadj-1}]
+    */
+    std::vector<MX> ins_new(2*nrhs_+1 + nrhs_*nadj, 0);
+
+    // Part 1
+    ins_new[0] = MX::sym("A", input(DLE_A).sparsity());
+    for (int i=0; i<nrhs_; ++i) {
+      ins_new[i+1] = MX::sym("Q", input(DLE_V).sparsity());
+    }
+
+    // Part 2
+    for (int i=0; i<nrhs_; ++i) {
+      ins_new[nrhs_+i+1] = MX::sym("P", output(DLE_P).sparsity());
+    }
+
+    // Part 3
+    for (int k=0; k<nadj; ++k) {
+      for (int q=0; q<nrhs_; ++q) {
+        ins_new.at(2*nrhs_+1+nrhs_*k+q) = MX::sym("Pb", output(DLE_P).sparsity());
+      }
+    }
+
+    // Prepare a solver for adjoint seeds: the adjoint Lyapunov equation
+    SmithDleInternal* node = new SmithDleInternal(make_map("a", st_[Dle_STRUCT_A],
+                                                           "v", st_[Dle_STRUCT_V]),
+                                                  nadj, !transp_);
+    node->setOption(dictionary());
+
+    DleSolver b;
+    b.assignNode(node);
+    b.init();
+
+    const MX& A = ins_new[0];
+    for (int q=0; q<nrhs_; ++q) {
+      const MX& P = ins_new[nrhs_+1+q];
+
+      // Adjoint
+      /* Q_q^b0 .. Q_q^b{nadj-1} += f(A, P_q^b0 ... P_q^b{nadj-1})
+      *  with the transposed equation, and
+      *
+      *  A^b0 += 2 Q_q^b0 A P_q
+      *   ....
+      *  A^b{nadj-1} += 2 Q_q^b{nadj-1} A P_q
+      */
+      std::vector<MX> ins_b;
+      ins_b.push_back(A);
+      for (int k=0; k<nadj; ++k) {
+        // Symmetrise P_q^bk
+        const MX& Pb = ins_new.at(2*nrhs_+1+nrhs_*k+q);
+        ins_b.push_back((Pb + Pb.T())/2);
+      }
+
+      std::vector<MX> outs = b(ins_b);
+      for (int i=0; i<nadj; ++i) {
+        MX& Qb = outs_new.at((nrhs_+1)*i+q+1);
+        Qb += outs[i];
+        MX& Ab = outs_new.at((nrhs_+1)*i);
+        if (transp_) {
+          Ab += 2*mul(P, mul(A, outs[i]));
+        } else {
+          Ab += 2*mul(outs[i], mul(A, P));
+        }
+      }
+    }
+
+    return MXFunction(name, ins_new, outs_new, opts);
+  }
+
+  void SmithDleInternal::deepCopyMembers(
+      std::map<SharedObjectNode*, SharedObject>& already_copied) {
+    DleInternal::deepCopyMembers(already_copied);
+  }
+
+  SmithDleInternal* SmithDleInternal::clone() const {
+    // Return a deep copy
+    SmithDleInternal* node =
+      new SmithDleInternal(make_map("a", st_[Dle_STRUCT_A],
+                                    "v", st_[Dle_STRUCT_V]), nrhs_, transp_);
+    node->setOption(dictionary());
+    return node;
+  }
+
+} // namespace casadi
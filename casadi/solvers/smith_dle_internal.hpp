@@ -0,0 +1,149 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#ifndef CASADI_SMITH_DLE_INTERNAL_HPP
+#define CASADI_SMITH_DLE_INTERNAL_HPP
+
+#include "../core/function/dle_internal.hpp"
+#include "../core/function/dense_io.hpp"
+#include <casadi/solvers/casadi_dlesolver_smith_export.h>
+
+/** \defgroup plugin_DleSolver_smith
+ Solving the Discrete Lyapunov Equations
+ with numeric Smith iterations until convergence.
+
+ Unlike the fixed_smith plugin, no symbolic expression graph is built:
+ the iterations are carried out numerically on dense matrices and stop
+ as soon as the relative size of the last update drops below 'tol'.
+ With frequency doubling (the default), the squared Smith iterations
+
+ \verbatim
+
+ X_0 = V
+ A_0 = A
+ k = 0
+ while ||A_k X_k A_k^T|| > tol ||X_k|| do
+   X_{k+1} = A_k X_k A_k^T + X_k
+   A_{k+1} = A_k A_k
+   k += 1
+ end
+
+ P = X_k
+ \endverbatim
+
+ converge quadratically. Sensitivities are obtained by solving the
+ forward and adjoint Lyapunov equations with the same iterations.
+ The number of iterations is available in the statistics as 'iter'.
+
+*/
+/** \pluginsection{DleSolver,smith} */
+
+/// \cond INTERNAL
+namespace casadi {
+
+  /** \brief \pluginbrief{DleSolver,smith}
+
+   @copydoc DLE_doc
+   @copydoc plugin_DleSolver_smith
+
+  */
+  class CASADI_DLESOLVER_SMITH_EXPORT SmithDleInternal : public DleInternal,
+    public DenseIO<SmithDleInternal> {
+  public:
+    /** \brief  Constructor
+     * \param st \structargument{Dle}
+     */
+    SmithDleInternal(const std::map<std::string, Sparsity>& st,
+                     int nrhs=1, bool transp=false);
+
+    /** \brief  Destructor */
+    virtual ~SmithDleInternal();
+
+    /** \brief  Clone */
+    virtual SmithDleInternal* clone() const;
+
+    /** \brief  Deep copy data members */
+    virtual void deepCopyMembers(std::map<SharedObjectNode*, SharedObject>& already_copied);
+
+    /** \brief  Create a new solver */
+    virtual SmithDleInternal* create(const std::map<std::string, Sparsity>& st) const {
+        return new SmithDleInternal(st);}
+
+    /** \brief  Create a new DLE Solver */
+    static DleInternal* creator(const std::map<std::string, Sparsity>& st) {
+      return new SmithDleInternal(st);
+    }
+
+    /** \brief  evaluate */
+    virtual void evaluate();
+
+    ///@{
+    /** \brief Generate a function that calculates \a nfwd forward derivatives */
+    virtual Function getDerForward(const std::string& name, int nfwd, Dict& opts);
+    virtual int numDerForward() const { return 64;}
+    ///@}
+
+    ///@{
+    /** \brief Generate a function that calculates \a nadj adjoint derivatives */
+    virtual Function getDerReverse(const std::string& name, int nadj, Dict& opts);
+    virtual int numDerReverse() const { return 64;}
+    ///@}
+
+    /** \brief  Initialize */
+    virtual void init();
+
+    /// A documentation string
+    static const std::string meta_doc;
+
+  private:
+
+    /// Dimension of state-space
+    int n_;
+
+    /// Stopping tolerance on the relative size of the last update
+    double tol_;
+
+    /// Maximum number of Smith iterations
+    int max_iter_;
+
+    /// Frequency doubling?
+    bool freq_doubling_;
+
+    /// Iteration matrix A_k and its transpose
+    std::vector<double> Ak_, Akt_;
+
+    /// Iterates for all right hand sides, the symmetrized right hand sides
+    std::vector<double> X_, V_sym_;
+
+    /// Work vectors for the dense products
+    std::vector<double> tmp_, D_;
+
+    /// Convergence of each right hand side
+    std::vector<bool> converged_;
+  };
+
+} // namespace casadi
+/// \endcond
+#endif // CASADI_SMITH_DLE_INTERNAL_HPP
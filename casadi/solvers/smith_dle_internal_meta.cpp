@@ -0,0 +1,101 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+      #include "smith_dle_internal.hpp"
+      #include <string>
+
+      const std::string casadi::SmithDleInternal::meta_doc=
+      "\n"
+"Solving the Discrete Lyapunov Equations with numeric Smith iterations\n"
+"until convergence.\n"
+"\n"
+"Unlike the fixed_smith plugin, no symbolic expression graph is built: the\n"
+"iterations are carried out numerically on dense matrices and stop as soon\n"
+"as the relative size of the last update drops below 'tol'. With frequency\n"
+"doubling (the default), the squared Smith iterations\n"
+"\n"
+"\n"
+"\n"
+"::\n"
+"\n"
+"  X_0 = V\n"
+"  A_0 = A\n"
+"  k = 0\n"
+"  while ||A_k X_k A_k^T|| > tol ||X_k|| do\n"
+"    X_{k+1} = A_k X_k A_k^T + X_k\n"
+"    A_{k+1} = A_k A_k\n"
+"    k += 1\n"
+"  end\n"
+"  \n"
+"  P = X_k\n"
+"  \n"
+"\n"
+"\n"
+"\n"
+"converge quadratically. Sensitivities are obtained by solving the forward\n"
+"and adjoint Lyapunov equations with the same iterations. The number of\n"
+"iterations is available in the statistics as 'iter'.\n"
+"\n"
+"\n"
+">List of available options\n"
+"\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
+"|       Id        |      Type       |     Default     |   Description   |\n"
+"+=================+=================+=================+=================+\n"
+"| freq_doubling   | OT_BOOLEAN      | true            | Use frequency   |\n"
+"|                 |                 |                 | doubling        |\n"
+"|                 |                 |                 | (squared Smith  |\n"
+"|                 |                 |                 | iterations)     |\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
+"| max_iter        | OT_INTEGER      | 100             | Maximum number  |\n"
+"|                 |                 |                 | of Smith        |\n"
+"|                 |                 |                 | iterations      |\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
+"| tol             | OT_REAL         | 0.000           | Stop when the   |\n"
+"|                 |                 |                 | last update is  |\n"
+"|                 |                 |                 | smaller than    |\n"
+"|                 |                 |                 | tol times the   |\n"
+"|                 |                 |                 | iterate, in the |\n"
+"|                 |                 |                 | largest         |\n"
+"|                 |                 |                 | absolute entry  |\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
+"\n"
+"\n"
+">List of available stats\n"
+"\n"
+"+---------------+\n"
+"|      Id       |\n"
+"+===============+\n"
+"| iter          |\n"
+"+---------------+\n"
+"| rel_change    |\n"
+"+---------------+\n"
+"| return_status |\n"
+"+---------------+\n"
+"\n"
+"\n"
+"\n"
+"\n"
+;
@@ -113,11 +113,7 @@ namespace casadi {
     min_step_size_ = getOption("min_step_size");
 
     // Get/generate required functions
-    gradF();
-    jacG();
-    if (exact_hessian_) {
-      hessLag();
-    }
+    initDerivatives(exact_hessian_);
 
     // Allocate a QP solver
     Sparsity H_sparsity = exact_hessian_ ? hessLag().output().sparsity()
@@ -174,6 +170,11 @@ namespace casadi {
     // Gradient of the objective
     gf_.resize(nx_);
 
+    // Work vectors for evaluating the NLP functions without copying
+    alloc(nlp_);
+    if (!jacG().isNull()) alloc(jacG());
+    alloc();
+
     // Create Hessian update function
     if (!exact_hessian_) {
       // Create expressions corresponding to Bk, x, x_old, gLag and gLag_old
@@ -767,20 +768,19 @@ namespace casadi {
       // Quick return if no constraints
       if (ng_==0) return;
 
-      // Pass the argument to the function
-      nlp_.setInputNZ(x, NL_X);
-      nlp_.setInput(input(NLP_SOLVER_P), NL_P);
-
-      // Evaluate the function and tape
-      nlp_.evaluate();
-
-      // Ge the result
-      nlp_.output(NL_G).get(g);
+      // Evaluate the function, binding the arguments and result directly
+      const double** arg = getPtr(arg_tmp_) + nIn();
+      arg[NL_X] = getPtr(x);
+      arg[NL_P] = input(NLP_SOLVER_P).ptr();
+      double** res = getPtr(res_tmp_) + nOut();
+      res[NL_F] = 0;
+      res[NL_G] = getPtr(g);
+      nlp_(arg, res, getPtr(iw_tmp_), getPtr(w_tmp_));
 
       // Printing
       if (monitored("eval_g")) {
-        userOut() << "x = " << nlp_.input(NL_X) << endl;
-        userOut() << "g = " << nlp_.output(NL_G) << endl;
+        userOut() << "x = " << x << endl;
+        userOut() << "g = " << g << endl;
       }
 
       double time2 = clock();
@@ -803,16 +803,15 @@ namespace casadi {
       // Get function
       Function& jacG = this->jacG();
 
-      // Pass the argument to the function
-      jacG.setInputNZ(x, NL_X);
-      jacG.setInput(input(NLP_SOLVER_P), NL_P);
-
-      // Evaluate the function
-      jacG.evaluate();
-
-      // Get the output
-      jacG.output(1+NL_G).get(g);
-      jacG.output().get(J);
+      // Evaluate the function, binding the arguments and results directly
+      const double** arg = getPtr(arg_tmp_) + nIn();
+      arg[NL_X] = getPtr(x);
+      arg[NL_P] = input(NLP_SOLVER_P).ptr();
+      double** res = getPtr(res_tmp_) + nOut();
+      res[0] = J.ptr();
+      res[1+NL_F] = 0;
+      res[1+NL_G] = getPtr(g);
+      jacG(arg, res, getPtr(iw_tmp_), getPtr(w_tmp_));
 
       if (monitored("eval_jac_g")) {
         userOut() << "x = " << x << endl;
@@ -875,19 +874,19 @@ namespace casadi {
        // Log time
       double time1 = clock();
 
-      // Pass the argument to the function
-      nlp_.setInputNZ(x, NL_X);
-      nlp_.setInput(input(NLP_SOLVER_P), NL_P);
-
-      // Evaluate the function
-      nlp_.evaluate();
-
-      // Get the result
-      nlp_.getOutput(f, NL_F);
+      // Evaluate the function, binding the arguments and result directly
+      const double** arg = getPtr(arg_tmp_) + nIn();
+      arg[NL_X] = getPtr(x);
+      arg[NL_P] = input(NLP_SOLVER_P).ptr();
+      double** res = getPtr(res_tmp_) + nOut();
+      f = 0; // in case the objective is structurally zero
+      res[NL_F] = &f;
+      res[NL_G] = 0;
+      nlp_(arg, res, getPtr(iw_tmp_), getPtr(w_tmp_));
 
       // Printing
       if (monitored("eval_f")) {
-        userOut() << "x = " << nlp_.input(NL_X) << endl;
+        userOut() << "x = " << x << endl;
         userOut() << "f = " << f << endl;
       }
       double time2 = clock();
@@ -161,11 +161,7 @@ namespace casadi {
     gamma3_ = getOption("gamma3");
 
     // Get/generate required functions
-    gradF();
-    jacG();
-    if (exact_hessian_) {
-      hessLag();
-    }
+    initDerivatives(exact_hessian_);
 
     // QP solver options
     Dict stabilized_qp_solver_options;
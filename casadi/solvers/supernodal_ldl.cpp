@@ -0,0 +1,610 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#include "supernodal_ldl.hpp"
+#include "casadi/core/matrix/sparsity_internal.hpp"
+#include "casadi/core/profiling.hpp"
+#include <numeric>
+#include <limits>
+
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif // WITH_OPENMP
+
+using namespace std;
+namespace casadi {
+
+  extern "C"
+  int CASADI_LINEARSOLVER_LDL_EXPORT
+  casadi_register_linearsolver_ldl(LinearSolverInternal::Plugin* plugin) {
+    plugin->creator = SupernodalLdl::creator;
+    plugin->name = "ldl";
+    plugin->doc = SupernodalLdl::meta_doc.c_str();
+    plugin->version = 23;
+    return 0;
+  }
+
+  extern "C"
+  void CASADI_LINEARSOLVER_LDL_EXPORT casadi_load_linearsolver_ldl() {
+    LinearSolverInternal::registerPlugin(casadi_register_linearsolver_ldl);
+  }
+
+  SupernodalLdl::SupernodalLdl(const Sparsity& sparsity, int nrhs)
+      : LinearSolverInternal(sparsity, nrhs) {
+    addOption("ordering",         OT_STRING,  "amd",
+              "Fill-reducing ordering", "amd|natural");
+    addOption("relaxation",       OT_REAL,    0.1,
+              "Supernode amalgamation: maximum fraction of explicitly stored zeros "
+              "when merging a column into its parent supernode");
+    addOption("static_pivoting",  OT_REAL,    1e-8,
+              "Numerically zero pivots are replaced by this value times the largest entry "
+              "in the pivot column");
+    addOption("max_refinement",   OT_INTEGER, 3,
+              "Maximum number of iterative refinement steps after a perturbed factorization");
+    addOption("parallelization",  OT_STRING,  "serial",
+              "Computational strategy for parallelization", "serial|openmp");
+  }
+
+  SupernodalLdl::~SupernodalLdl() {
+  }
+
+  void SupernodalLdl::init() {
+    // Call the base class initializer
+    LinearSolverInternal::init();
+
+    // Read options
+    relaxation_ = getOption("relaxation");
+    static_pivoting_ = getOption("static_pivoting");
+    max_refinement_ = getOption("max_refinement");
+    parallel_ = getOption("parallelization") == "openmp";
+#ifndef WITH_OPENMP
+    if (parallel_) {
+      casadi_warning("CasADi was not compiled with OpenMP. Falling back to serial mode.");
+      parallel_ = false;
+    }
+#endif // WITH_OPENMP
+
+    // Symmetric sparsity pattern
+    const Sparsity& sp = input(LINSOL_A).sparsity();
+    casadi_assert_message(sp.issquare(), "SupernodalLdl: the matrix must be square");
+    int n = sp.size2();
+    Sparsity sp_sym = sp + sp.T();
+    const int* sym_colind = sp_sym.colind();
+    const int* sym_row = sp_sym.row();
+
+    // Fill-reducing ordering
+    vector<int> order;
+    if (getOption("ordering") == "amd" && n>2) {
+      order = sp_sym->approximateMinimumDegree(1);
+      order.resize(n);
+    } else {
+      order = range(n);
+    }
+
+    // Permuted pattern, elimination tree and postorder
+    vector<int> iperm(n), tr_row, tr_col;
+    tr_row.reserve(sp_sym.nnz());
+    tr_col.reserve(sp_sym.nnz());
+    for (int k=0; k<n; ++k) iperm[order[k]] = k;
+    for (int c=0; c<n; ++c) {
+      for (int el=sym_colind[c]; el<sym_colind[c+1]; ++el) {
+        tr_row.push_back(iperm[sym_row[el]]);
+        tr_col.push_back(iperm[c]);
+      }
+    }
+    Sparsity sp_perm = Sparsity::triplet(n, n, tr_row, tr_col);
+    vector<int> parent = sp_perm->eliminationTree(false);
+    vector<int> post = SparsityInternal::postorder(parent, n);
+
+    // Final ordering, with subtrees of the elimination tree contiguous
+    perm_.resize(n);
+    for (int k=0; k<n; ++k) perm_[k] = order[post[k]];
+    for (int k=0; k<n; ++k) iperm[perm_[k]] = k;
+    tr_row.clear();
+    tr_col.clear();
+    for (int c=0; c<n; ++c) {
+      for (int el=sym_colind[c]; el<sym_colind[c+1]; ++el) {
+        tr_row.push_back(iperm[sym_row[el]]);
+        tr_col.push_back(iperm[c]);
+      }
+    }
+    sp_perm = Sparsity::triplet(n, n, tr_row, tr_col);
+    parent = sp_perm->eliminationTree(false);
+    const int* p_colind = sp_perm.colind();
+    const int* p_row = sp_perm.row();
+
+    // Column counts of L, traversing the row subtrees
+    vector<int> colcount(n, 1), mark(n, -1);
+    for (int i=0; i<n; ++i) {
+      mark[i] = i;
+      for (int el=p_colind[i]; el<p_colind[i+1]; ++el) {
+        for (int k=p_row[el]; k<i && mark[k]!=i; k=parent[k]) {
+          colcount[k]++;
+          mark[k] = i;
+        }
+      }
+    }
+
+    // Supernodes: chains in the elimination tree, relaxed by allowing some explicit zeros
+    sfirst_.clear();
+    sfirst_.push_back(0);
+    long actual = 0;
+    for (int j=0; j<n; ++j) {
+      if (j>sfirst_.back() && parent[j-1]==j) {
+        // Storage for the supernode [sfirst_.back(), j]
+        long w = j - sfirst_.back() + 1;
+        long nr = w + colcount[j] - 1;
+        long stored_new = w*nr - w*(w-1)/2;
+        long actual_new = actual + colcount[j];
+        if (colcount[j-1]==colcount[j]+1 || stored_new-actual_new <= relaxation_*stored_new) {
+          actual = actual_new;
+          continue;
+        }
+      }
+      if (j>0) sfirst_.push_back(j);
+      actual = colcount[j];
+    }
+    sfirst_.push_back(n);
+    int ns = sfirst_.size()-1;
+    snode_.resize(n);
+    for (int s=0; s<ns; ++s) {
+      for (int j=sfirst_[s]; j<sfirst_[s+1]; ++j) snode_[j] = s;
+    }
+
+    // Supernodal elimination tree and levels
+    vector<int> sparent(ns, -1), level(ns, 0);
+    for (int s=0; s<ns; ++s) {
+      int p = parent[sfirst_[s+1]-1];
+      if (p>=0) {
+        sparent[s] = snode_[p];
+        level[sparent[s]] = max(level[sparent[s]], level[s]+1);
+      }
+    }
+
+    // Row structure of the supernodes, children before parents
+    vector<int> head(ns, -1), next(ns, -1);
+    fill(mark.begin(), mark.end(), -1);
+    srow_ptr_.resize(ns+1);
+    srow_ptr_[0] = 0;
+    srow_.clear();
+    lptr_.resize(ns+1);
+    lptr_[0] = 0;
+    for (int s=0; s<ns; ++s) {
+      int f = sfirst_[s], l = sfirst_[s+1];
+      for (int j=f; j<l; ++j) srow_.push_back(j);
+      int off = srow_.size();
+
+      // Rows of the matrix
+      for (int j=f; j<l; ++j) {
+        for (int el=p_colind[j]; el<p_colind[j+1]; ++el) {
+          int r = p_row[el];
+          if (r>=l && mark[r]!=s) {
+            mark[r] = s;
+            srow_.push_back(r);
+          }
+        }
+      }
+
+      // Rows of the children
+      for (int c=head[s]; c>=0; c=next[c]) {
+        for (int k=srow_ptr_[c]; k<srow_ptr_[c+1]; ++k) {
+          int r = srow_[k];
+          if (r>=l && mark[r]!=s) {
+            mark[r] = s;
+            srow_.push_back(r);
+          }
+        }
+      }
+      sort(srow_.begin()+off, srow_.end());
+      srow_ptr_[s+1] = srow_.size();
+      casadi_assert(srow_ptr_[s+1]-srow_ptr_[s] == l-f+colcount[l-1]-1);
+      lptr_[s+1] = lptr_[s] + (srow_ptr_[s+1]-srow_ptr_[s])*(l-f);
+
+      // Register with the parent
+      if (sparent[s]>=0) {
+        next[s] = head[sparent[s]];
+        head[sparent[s]] = s;
+      }
+    }
+
+    // Destination of the nonzeros of A in the supernodal storage
+    const int* colind = sp.colind();
+    const int* row = sp.row();
+    Sparsity spT = sp.T();
+    const int* t_colind = spT.colind();
+    const int* t_row = spT.row();
+    vector<int> map(n);
+    a_dest_.resize(sp.nnz());
+    fill(mark.begin(), mark.end(), -1);
+    for (int c=0; c<n; ++c) {
+      // Mark the rows r such that A(c, r) is structurally nonzero
+      for (int el=t_colind[c]; el<t_colind[c+1]; ++el) mark[t_row[el]] = c;
+      for (int el=colind[c]; el<colind[c+1]; ++el) {
+        int r = row[el];
+        if (r<c && mark[r]==c) {
+          // Upper triangular entry, the lower triangular one is used instead
+          a_dest_[el] = -1;
+          continue;
+        }
+        int i = iperm[r], j = iperm[c];
+        if (i<j) swap(i, j);
+        int s = snode_[j];
+        const int* R = getPtr(srow_) + srow_ptr_[s];
+        const int* R_end = getPtr(srow_) + srow_ptr_[s+1];
+        int pos = lower_bound(R, R_end, i) - R;
+        a_dest_[el] = lptr_[s] + (j-sfirst_[s])*(srow_ptr_[s+1]-srow_ptr_[s]) + pos;
+      }
+    }
+
+    // Descendants updating each supernode: one entry per block of rows in the target
+    upd_ptr_.assign(ns+1, 0);
+    for (int d=0; d<ns; ++d) {
+      int t = -1;
+      for (int k=srow_ptr_[d] + sfirst_[d+1]-sfirst_[d]; k<srow_ptr_[d+1]; ++k) {
+        if (snode_[srow_[k]]!=t) {
+          t = snode_[srow_[k]];
+          upd_ptr_[t+1]++;
+        }
+      }
+    }
+    for (int s=0; s<ns; ++s) upd_ptr_[s+1] += upd_ptr_[s];
+    upd_snode_.resize(upd_ptr_[ns]);
+    upd_start_.resize(upd_ptr_[ns]);
+    vector<int> upd_pos(upd_ptr_.begin(), upd_ptr_.end()-1);
+    for (int d=0; d<ns; ++d) {
+      int t = -1;
+      for (int k=srow_ptr_[d] + sfirst_[d+1]-sfirst_[d]; k<srow_ptr_[d+1]; ++k) {
+        if (snode_[srow_[k]]!=t) {
+          t = snode_[srow_[k]];
+          upd_snode_[upd_pos[t]] = d;
+          upd_start_[upd_pos[t]] = k - srow_ptr_[d];
+          upd_pos[t]++;
+        }
+      }
+    }
+
+    // Supernodes sorted by level
+    int nlevel = ns==0 ? 0 : *max_element(level.begin(), level.end()) + 1;
+    level_ptr_.assign(nlevel+1, 0);
+    for (int s=0; s<ns; ++s) level_ptr_[level[s]+1]++;
+    for (int l=0; l<nlevel; ++l) level_ptr_[l+1] += level_ptr_[l];
+    level_snode_.resize(ns);
+    vector<int> level_pos(level_ptr_.begin(), level_ptr_.end()-1);
+    for (int s=0; s<ns; ++s) level_snode_[level_pos[level[s]]++] = s;
+
+    // Allocate the factorization
+    lval_.resize(lptr_[ns]);
+    d_.resize(n);
+    dsub_.resize(n);
+    lperm_.resize(n);
+    s_neig_.resize(ns);
+    s_n2x2_.resize(ns);
+    s_npert_.resize(ns);
+    a_last_.clear();
+
+    // Work vectors, one block for each thread
+    int max_nr = 0, max_w = 0;
+    for (int s=0; s<ns; ++s) {
+      max_nr = max(max_nr, srow_ptr_[s+1]-srow_ptr_[s]);
+      max_w = max(max_w, sfirst_[s+1]-sfirst_[s]);
+    }
+    nthreads_ = 1;
+#ifdef WITH_OPENMP
+    if (parallel_) nthreads_ = omp_get_max_threads();
+#endif // WITH_OPENMP
+    work_size_ = max_nr + max_w*max_w;
+    map_.resize(n*nthreads_);
+    work_.resize(work_size_*nthreads_);
+    t_.resize(n);
+    y_.resize(max_w);
+    r_.resize(n);
+    b_.resize(n);
+
+    stats_["n_supernodes"] = ns;
+    stats_["nnz_l"] = accumulate(colcount.begin(), colcount.end(), 0);
+    stats_["nnz_stored"] = lptr_[ns];
+  }
+
+  void SupernodalLdl::prepare() {
+    double time_start = getRealTime();
+    prepared_ = false;
+
+    // Get a reference to the nonzeros of the linear system
+    const vector<double>& a = input(LINSOL_A).data();
+
+    // Make sure that all entries of the linear system are valid
+    double amax = 0;
+    for (int k=0; k<a.size(); ++k) {
+      casadi_assert_message(!isnan(a[k]), "Nonzero " << k << " is not-a-number");
+      casadi_assert_message(!isinf(a[k]), "Nonzero " << k << " is infinite");
+      amax = max(amax, fabs(a[k]));
+    }
+
+    // Reuse the numeric factorization if the matrix did not change
+    if (a==a_last_) {
+      stats_["factorization_reused"] = true;
+      prepared_ = true;
+      return;
+    }
+    stats_["factorization_reused"] = false;
+    a_last_ = a;
+
+    // Scatter the nonzeros into the supernodal storage
+    fill(lval_.begin(), lval_.end(), 0);
+    for (int k=0; k<a.size(); ++k) {
+      if (a_dest_[k]>=0) lval_[a_dest_[k]] += a[k];
+    }
+    for (int j=0; j<lperm_.size(); ++j) lperm_[j] = j;
+
+    // Factorize level by level, the supernodes within a level are independent
+    int nlevel = level_ptr_.size()-1;
+    for (int l=0; l<nlevel; ++l) {
+      int n_l = level_ptr_[l+1]-level_ptr_[l];
+      int nchunk = min(nthreads_, n_l);
+#ifdef WITH_OPENMP
+#pragma omp parallel for if (nchunk>1)
+#endif // WITH_OPENMP
+      for (int c=0; c<nchunk; ++c) {
+        int* map = getPtr(map_) + c*lperm_.size();
+        double* work = getPtr(work_) + c*work_size_;
+        for (int k=level_ptr_[l] + c; k<level_ptr_[l+1]; k+=nchunk) {
+          int s = level_snode_[k];
+          s_npert_[s] = factorizeSupernode(s, map, work, amax);
+        }
+      }
+    }
+
+    // Statistics
+    n_perturbed_ = accumulate(s_npert_.begin(), s_npert_.end(), 0);
+    stats_["neig"] = accumulate(s_neig_.begin(), s_neig_.end(), 0);
+    stats_["n_2x2"] = accumulate(s_n2x2_.begin(), s_n2x2_.end(), 0);
+    stats_["n_perturbed"] = n_perturbed_;
+    stats_["t_factorize"] = getRealTime() - time_start;
+    prepared_ = true;
+  }
+
+  int SupernodalLdl::factorizeSupernode(int s, int* map, double* work, double amax) {
+    int f = sfirst_[s], w = sfirst_[s+1]-f;
+    const int* R = getPtr(srow_) + srow_ptr_[s];
+    int nr = srow_ptr_[s+1]-srow_ptr_[s];
+    double* L = getPtr(lval_) + lptr_[s];
+    for (int i=0; i<nr; ++i) map[R[i]] = i;
+
+    // Updates from the descendants (left-looking)
+    double* tmp = work;
+    double* W = work + nr;
+    for (int u=upd_ptr_[s]; u<upd_ptr_[s+1]; ++u) {
+      int d = upd_snode_[u], p = upd_start_[u];
+      int df = sfirst_[d], dw = sfirst_[d+1]-df;
+      const int* dR = getPtr(srow_) + srow_ptr_[d];
+      int dnr = srow_ptr_[d+1]-srow_ptr_[d];
+      const double* dL = getPtr(lval_) + lptr_[d];
+      int q = p;
+      while (q<dnr && dR[q]<f+w) q++;
+
+      // W(:, jj) = D_d*L_d(p+jj, :)'
+      for (int jj=0; jj<q-p; ++jj) {
+        const double* Lj = dL + p + jj;
+        double* Wj = W + jj*dw;
+        for (int k=0; k<dw; ++k) {
+          if (dsub_[df+k]!=0) {
+            double b = dsub_[df+k];
+            Wj[k] = d_[df+k]*Lj[k*dnr] + b*Lj[(k+1)*dnr];
+            Wj[k+1] = b*Lj[k*dnr] + d_[df+k+1]*Lj[(k+1)*dnr];
+            k++;
+          } else {
+            Wj[k] = d_[df+k]*Lj[k*dnr];
+          }
+        }
+      }
+
+      // Subtract L_d(j:end, :)*W(:, j) from the corresponding column of the supernode
+      for (int jj=0; jj<q-p; ++jj) {
+        int j = p + jj;
+        fill(tmp, tmp+dnr-j, 0);
+        for (int k=0; k<dw; ++k) {
+          double c = W[k+jj*dw];
+          if (c==0) continue;
+          const double* Lk = dL + k*dnr;
+          for (int i=j; i<dnr; ++i) tmp[i-j] += Lk[i]*c;
+        }
+        double* Lc = L + (dR[j]-f)*nr;
+        for (int i=j; i<dnr; ++i) Lc[map[dR[i]]] -= tmp[i-j];
+      }
+    }
+
+    // Dense LDL' factorization of the panel, Bunch-Kaufman pivoting within the supernode
+    const double alpha = (1+sqrt(17.))/8;
+    int neig = 0, n2x2 = 0, npert = 0;
+    for (int k=0; k<w; ) {
+      // Largest off-diagonal entry in column k
+      double absakk = fabs(L[k+k*nr]), colmax = 0;
+      int imax = k;
+      for (int i=k+1; i<w; ++i) {
+        if (fabs(L[i+k*nr])>colmax) {
+          colmax = fabs(L[i+k*nr]);
+          imax = i;
+        }
+      }
+
+      // Pivot tolerance relative to the largest entry in the column, including the rows below
+      double colnorm = max(absakk, colmax);
+      for (int i=w; i<nr; ++i) colnorm = max(colnorm, fabs(L[i+k*nr]));
+      if (colnorm==0) colnorm = amax>0 ? amax : 1;
+
+      // Choose the pivot
+      int kp = k, kstep = 1;
+      if (max(absakk, colmax) < 100*numeric_limits<double>::epsilon()*colnorm) {
+        // Numerically zero pivot: static pivot perturbation
+        L[k+k*nr] = L[k+k*nr]<0 ? -static_pivoting_*colnorm : static_pivoting_*colnorm;
+        npert++;
+      } else if (absakk<alpha*colmax) {
+        // Largest off-diagonal entry in row/column imax
+        double rowmax = 0;
+        for (int j=k; j<imax; ++j) rowmax = max(rowmax, fabs(L[imax+j*nr]));
+        for (int j=imax+1; j<w; ++j) rowmax = max(rowmax, fabs(L[j+imax*nr]));
+        if (absakk*rowmax>=alpha*colmax*colmax) {
+          // 1x1 pivot, no interchange
+        } else if (fabs(L[imax+imax*nr])>=alpha*rowmax) {
+          kp = imax;
+        } else {
+          kp = imax;
+          kstep = 2;
+        }
+      }
+
+      // Symmetric interchange of rows and columns p and kp
+      int p = k + kstep - 1;
+      if (kp!=p) {
+        for (int c=0; c<p; ++c) swap(L[p+c*nr], L[kp+c*nr]);
+        swap(L[p+p*nr], L[kp+kp*nr]);
+        for (int i=p+1; i<kp; ++i) swap(L[i+p*nr], L[kp+i*nr]);
+        for (int i=kp+1; i<nr; ++i) swap(L[i+p*nr], L[i+kp*nr]);
+        swap(lperm_[f+p], lperm_[f+kp]);
+      }
+
+      double* Lk = L + k*nr;
+      if (kstep==1) {
+        // Rank-1 update of the trailing columns, then scale
+        double dk = Lk[k];
+        for (int j=k+1; j<w; ++j) {
+          double c = Lk[j]/dk;
+          if (c==0) continue;
+          double* Lj = L + j*nr;
+          for (int i=j; i<nr; ++i) Lj[i] -= Lk[i]*c;
+        }
+        for (int i=k+1; i<nr; ++i) Lk[i] /= dk;
+        d_[f+k] = dk;
+        dsub_[f+k] = 0;
+        if (dk<0) neig++;
+      } else {
+        // Rank-2 update of the trailing columns, then scale
+        double* Lk1 = L + (k+1)*nr;
+        double a = Lk[k], b = Lk[k+1], c = Lk1[k+1];
+        double det = a*c - b*b;
+        for (int j=k+2; j<w; ++j) {
+          double l0 = (c*Lk[j] - b*Lk1[j])/det, l1 = (a*Lk1[j] - b*Lk[j])/det;
+          double* Lj = L + j*nr;
+          for (int i=j; i<nr; ++i) Lj[i] -= Lk[i]*l0 + Lk1[i]*l1;
+        }
+        for (int i=k+2; i<nr; ++i) {
+          double u = Lk[i], v = Lk1[i];
+          Lk[i] = (c*u - b*v)/det;
+          Lk1[i] = (a*v - b*u)/det;
+        }
+        Lk[k+1] = 0;
+        d_[f+k] = a;
+        d_[f+k+1] = c;
+        dsub_[f+k] = b;
+        dsub_[f+k+1] = 0;
+        neig += det<0 ? 1 : a+c<0 ? 2 : 0;
+        n2x2++;
+      }
+      k += kstep;
+    }
+    s_neig_[s] = neig;
+    s_n2x2_[s] = n2x2;
+    return npert;
+  }
+
+  void SupernodalLdl::solveFactorized(double* x) {
+    int n = perm_.size(), ns = sfirst_.size()-1;
+    double* t = getPtr(t_);
+    double* y = getPtr(y_);
+    for (int k=0; k<n; ++k) t[k] = x[perm_[k]];
+
+    // Forward substitution and scaling with D^(-1)
+    for (int s=0; s<ns; ++s) {
+      int f = sfirst_[s], w = sfirst_[s+1]-f;
+      const int* R = getPtr(srow_) + srow_ptr_[s];
+      int nr = srow_ptr_[s+1]-srow_ptr_[s];
+      const double* L = getPtr(lval_) + lptr_[s];
+      for (int k=0; k<w; ++k) y[k] = t[lperm_[f+k]];
+      for (int k=0; k<w; ++k) {
+        const double* Lk = L + k*nr;
+        for (int i=k+1; i<w; ++i) y[i] -= Lk[i]*y[k];
+        for (int i=w; i<nr; ++i) t[R[i]] -= Lk[i]*y[k];
+      }
+      for (int k=0; k<w; ++k) {
+        if (dsub_[f+k]!=0) {
+          double a = d_[f+k], b = dsub_[f+k], c = d_[f+k+1], det = a*c - b*b;
+          double u = y[k], v = y[k+1];
+          y[k] = (c*u - b*v)/det;
+          y[k+1] = (a*v - b*u)/det;
+          k++;
+        } else {
+          y[k] /= d_[f+k];
+        }
+      }
+      for (int k=0; k<w; ++k) t[lperm_[f+k]] = y[k];
+    }
+
+    // Backward substitution
+    for (int s=ns-1; s>=0; --s) {
+      int f = sfirst_[s], w = sfirst_[s+1]-f;
+      const int* R = getPtr(srow_) + srow_ptr_[s];
+      int nr = srow_ptr_[s+1]-srow_ptr_[s];
+      const double* L = getPtr(lval_) + lptr_[s];
+      for (int k=0; k<w; ++k) y[k] = t[lperm_[f+k]];
+      for (int k=w-1; k>=0; --k) {
+        const double* Lk = L + k*nr;
+        for (int i=w; i<nr; ++i) y[k] -= Lk[i]*t[R[i]];
+        for (int i=k+1; i<w; ++i) y[k] -= Lk[i]*y[i];
+      }
+      for (int k=0; k<w; ++k) t[lperm_[f+k]] = y[k];
+    }
+    for (int k=0; k<n; ++k) x[perm_[k]] = t[k];
+  }
+
+  void SupernodalLdl::solve(double* x, int nrhs, bool transpose) {
+    // The matrix is symmetric, transpose is ignored
+    casadi_assert(prepared_);
+    int n = perm_.size();
+    const vector<double>& a = input(LINSOL_A).data();
+    const int* colind = this->colind();
+    const int* row = this->row();
+    for (int k=0; k<nrhs; ++k) {
+      if (n_perturbed_>0) copy(x, x+n, b_.begin());
+      solveFactorized(x);
+
+      // Iterative refinement, only needed if pivots were perturbed
+      for (int iter=0; n_perturbed_>0 && iter<max_refinement_; ++iter) {
+        copy(b_.begin(), b_.end(), r_.begin());
+        for (int c=0; c<n; ++c) {
+          for (int el=colind[c]; el<colind[c+1]; ++el) {
+            if (a_dest_[el]<0) continue;
+            int r = row[el];
+            r_[r] -= a[el]*x[c];
+            if (r!=c) r_[c] -= a[el]*x[r];
+          }
+        }
+        solveFactorized(getPtr(r_));
+        for (int i=0; i<n; ++i) x[i] += r_[i];
+      }
+      x += n;
+    }
+  }
+
+} // namespace casadi
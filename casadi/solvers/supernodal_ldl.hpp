@@ -0,0 +1,150 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#ifndef CASADI_SUPERNODAL_LDL_HPP
+#define CASADI_SUPERNODAL_LDL_HPP
+
+#include "casadi/core/function/linear_solver_internal.hpp"
+#include <casadi/solvers/casadi_linearsolver_ldl_export.h>
+
+/** \defgroup plugin_LinearSolver_ldl
+
+   Supernodal sparse LDL^T factorization for symmetric, possibly indefinite
+   matrices such as KKT systems.
+
+   Only the lower triangular part of the matrix is used, entries of the
+   upper triangular part are used where the mirrored entry is not
+   structurally present. The symbolic analysis (fill-reducing ordering,
+   elimination tree, supernodes and their row structures) is performed once
+   in init, each call to prepare only performs the numeric factorization,
+   and is skipped altogether if the nonzeros did not change.
+
+   Within each supernode, Bunch-Kaufman pivoting with 1x1 and 2x2 pivots is
+   used. Pivots are not exchanged between supernodes; pivots that remain
+   too small are replaced by a static perturbation, after which the solution
+   is improved by iterative refinement. Supernodes at the same level of the
+   supernodal elimination tree are independent and can be factorized in
+   parallel.
+*/
+
+/** \pluginsection{LinearSolver,ldl} */
+
+/// \cond INTERNAL
+
+namespace casadi {
+
+  /** \brief \pluginbrief{LinearSolver,ldl}
+
+      @copydoc LinearSolver_doc
+      @copydoc plugin_LinearSolver_ldl
+  */
+  class CASADI_LINEARSOLVER_LDL_EXPORT SupernodalLdl : public LinearSolverInternal {
+  public:
+    // Constructor
+    SupernodalLdl(const Sparsity& sparsity, int nrhs);
+
+    // Destructor
+    virtual ~SupernodalLdl();
+
+    /** \brief  Clone */
+    virtual SupernodalLdl* clone() const { return new SupernodalLdl(*this);}
+
+    /** \brief  Create a new LinearSolver */
+    static LinearSolverInternal* creator(const Sparsity& sp, int nrhs)
+    { return new SupernodalLdl(sp, nrhs);}
+
+    // Initialize
+    virtual void init();
+
+    // Prepare the factorization
+    virtual void prepare();
+
+    // Solve the system of equations
+    virtual void solve(double* x, int nrhs, bool transpose);
+
+    /// A documentation string
+    static const std::string meta_doc;
+
+  protected:
+    /// Numeric factorization of a supernode, returns the number of perturbed pivots
+    int factorizeSupernode(int s, int* map, double* work, double amax);
+
+    /// Solve with the factorization for a single right-hand side, in-place
+    void solveFactorized(double* x);
+
+    /// Options
+    double relaxation_, static_pivoting_;
+    int max_refinement_;
+    bool parallel_;
+
+    /// Fill-reducing ordering: row/column k of the factorized matrix is perm_[k] of A
+    std::vector<int> perm_;
+
+    /// Supernode of each column, first column of each supernode
+    std::vector<int> snode_, sfirst_;
+
+    /// Row structure of each supernode, starting with its own columns
+    std::vector<int> srow_ptr_, srow_;
+
+    /// Offset of the dense column-major block of each supernode in lval_
+    std::vector<int> lptr_;
+
+    /// Nonzeros of the factor L, the diagonal pivot blocks in the diagonal positions
+    std::vector<double> lval_;
+
+    /// Block diagonal D: diagonal and subdiagonal entries, nonzero subdiagonal for 2x2 pivots
+    std::vector<double> d_, dsub_;
+
+    /// Pivoting within the supernodes: position k holds column lperm_[k] of the ordering
+    std::vector<int> lperm_;
+
+    /// Destination of each nonzero of A in lval_, -1 if mirrored by another nonzero
+    std::vector<int> a_dest_;
+
+    /// Descendant supernodes updating each supernode, and the first row they update
+    std::vector<int> upd_ptr_, upd_snode_, upd_start_;
+
+    /// Supernodes grouped by their level in the supernodal elimination tree
+    std::vector<int> level_ptr_, level_snode_;
+
+    /// Per-supernode statistics: negative eigenvalues, 2x2 pivots, perturbed pivots
+    std::vector<int> s_neig_, s_n2x2_, s_npert_;
+
+    /// Work vectors: per thread row map and dense update, solve and refinement
+    std::vector<int> map_;
+    std::vector<double> work_, t_, y_, r_, b_;
+    int nthreads_, work_size_;
+
+    /// Nonzeros of the last factorized matrix
+    std::vector<double> a_last_;
+
+    /// Number of perturbed pivots in the current factorization
+    int n_perturbed_;
+  };
+
+} // namespace casadi
+
+/// \endcond
+#endif // CASADI_SUPERNODAL_LDL_HPP
@@ -0,0 +1,116 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+      #include "supernodal_ldl.hpp"
+      #include <string>
+
+      const std::string casadi::SupernodalLdl::meta_doc=
+      "\n"
+"Supernodal sparse LDL^T factorization for symmetric, possibly indefinite\n"
+"matrices such as KKT systems.\n"
+"\n"
+"Only the lower triangular part of the matrix is used, entries of the upper\n"
+"triangular part are used where the mirrored entry is not structurally\n"
+"present. The symbolic analysis (fill-reducing ordering, elimination tree,\n"
+"supernodes and their row structures) is performed once in init, each call\n"
+"to prepare only performs the numeric factorization, and is skipped\n"
+"altogether if the nonzeros did not change.\n"
+"\n"
+"Within each supernode, Bunch-Kaufman pivoting with 1x1 and 2x2 pivots is\n"
+"used. Pivots are not exchanged between supernodes; pivots that remain too\n"
+"small are replaced by a static perturbation, after which the solution is\n"
+"improved by iterative refinement. Supernodes at the same level of the\n"
+"supernodal elimination tree are independent and can be factorized in\n"
+"parallel.\n"
+"\n"
+"\n"
+">List of available options\n"
+"\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
+"|       Id        |      Type       |     Default     |   Description   |\n"
+"+=================+=================+=================+=================+\n"
+"| max_refinement  | OT_INTEGER      | 3               | Maximum number  |\n"
+"|                 |                 |                 | of iterative    |\n"
+"|                 |                 |                 | refinement      |\n"
+"|                 |                 |                 | steps after a   |\n"
+"|                 |                 |                 | perturbed       |\n"
+"|                 |                 |                 | factorization   |\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
+"| ordering        | OT_STRING       | \"amd\"           | Fill-reducing   |\n"
+"|                 |                 |                 | ordering        |\n"
+"|                 |                 |                 | (amd|natural)   |\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
+"| parallelization | OT_STRING       | \"serial\"        | Computational   |\n"
+"|                 |                 |                 | strategy for    |\n"
+"|                 |                 |                 | parallelization |\n"
+"|                 |                 |                 | (serial|openmp) |\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
+"| relaxation      | OT_REAL         | 0.100           | Supernode       |\n"
+"|                 |                 |                 | amalgamation:   |\n"
+"|                 |                 |                 | maximum         |\n"
+"|                 |                 |                 | fraction of     |\n"
+"|                 |                 |                 | explicitly      |\n"
+"|                 |                 |                 | stored zeros    |\n"
+"|                 |                 |                 | when merging a  |\n"
+"|                 |                 |                 | column into its |\n"
+"|                 |                 |                 | parent          |\n"
+"|                 |                 |                 | supernode       |\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
+"| static_pivoting | OT_REAL         | 0.000           | Numerically     |\n"
+"|                 |                 |                 | zero pivots are |\n"
+"|                 |                 |                 | replaced by     |\n"
+"|                 |                 |                 | this value      |\n"
+"|                 |                 |                 | times the       |\n"
+"|                 |                 |                 | largest entry   |\n"
+"|                 |                 |                 | in the pivot    |\n"
+"|                 |                 |                 | column          |\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
+"\n"
+"\n"
+">List of available stats\n"
+"\n"
+"+----------------------+\n"
+"|          Id          |\n"
+"+======================+\n"
+"| factorization_reused |\n"
+"+----------------------+\n"
+"| n_2x2                |\n"
+"+----------------------+\n"
+"| n_perturbed          |\n"
+"+----------------------+\n"
+"| n_supernodes         |\n"
+"+----------------------+\n"
+"| neig                 |\n"
+"+----------------------+\n"
+"| nnz_l                |\n"
+"+----------------------+\n"
+"| nnz_stored           |\n"
+"+----------------------+\n"
+"| t_factorize          |\n"
+"+----------------------+\n"
+"\n"
+"\n"
+"\n"
+;
@@ -0,0 +1,69 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            K.U. Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+/** \brief Test of the sparsity pattern cache with several threads
+ * The threads build and release the same sparsity patterns, so that the last
+ * reference to a cached pattern is often released by one thread while another
+ * thread finds the pattern in the cache.
+ */
+
+#include "casadi/casadi.hpp"
+#include <thread>
+#include <atomic>
+
+using namespace casadi;
+using namespace std;
+
+// Number of threads and repetitions
+const int n_threads = 8;
+const int n_rep = 2000;
+
+// Number of incorrect patterns obtained
+atomic<int> n_fail(0);
+
+void work(int offset) {
+  for (int rep=0; rep<n_rep; ++rep) {
+    int n = 2 + (rep + offset) % 10;
+
+    // Dense column, released immediately
+    Sparsity d = Sparsity::dense(n, 1);
+    if (d.size1()!=n || d.size2()!=1 || d.nnz()!=n) n_fail++;
+
+    // Diagonal, kept while another copy is obtained from the cache
+    Sparsity s = Sparsity::diag(n);
+    Sparsity s2 = Sparsity::diag(n);
+    if (s.nnz()!=n || !s.isEqual(s2)) n_fail++;
+  }
+}
+
+int main() {
+  vector<thread> threads;
+  for (int i=0; i<n_threads; ++i) threads.push_back(thread(work, i));
+  for (int i=0; i<n_threads; ++i) threads[i].join();
+
+  Dict stats = Sparsity::cacheStats();
+  cout << "cache statistics: " << stats << endl;
+  cout << "incorrect patterns: " << n_fail << endl;
+  return n_fail==0 ? 0 : 1;
+}
@@ -0,0 +1,60 @@
+#
+#     This file is part of CasADi.
+#
+#     CasADi -- A symbolic framework for dynamic optimization.
+#     Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+#                             K.U. Leuven. All rights reserved.
+#     Copyright (C) 2011-2014 Greg Horn
+#
+#     CasADi is free software; you can redistribute it and/or
+#     modify it under the terms of the GNU Lesser General Public
+#     License as published by the Free Software Foundation; either
+#     version 3 of the License, or (at your option) any later version.
+#
+#     CasADi is distributed in the hope that it will be useful,
+#     but WITHOUT ANY WARRANTY; without even the implied warranty of
+#     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+#     Lesser General Public License for more details.
+#
+#     You should have received a copy of the GNU Lesser General Public
+#     License along with CasADi; if not, write to the Free Software
+#     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+#
+#
+# Benchmark of the fusion of elementwise operations in MXFunction:
+# chains of elementwise operations on large vectors, evaluated with
+# and without the option fuse_elementwise
+from casadi import *
+from time import time
+import numpy as np
+
+def workloads(n):
+  a = MX.sym("a",n)
+  b = MX.sym("b",n)
+  c = MX.sym("c",n)
+  d = MX.sym("d",n)
+  s = MX.sym("s")
+  yield "exp(a*b+c)-d", [a,b,c,d], [exp(a*b+c)-d]
+  yield "axpy chain", [a,b,s], [s*(s*(s*a+b)+b)+b]
+  yield "sqrt(a^2+b^2)*sin(c)", [a,b,c], [sqrt(a**2+b**2)*sin(c)]
+  x = a
+  for k in range(10):
+    x = tanh(x*s+b)
+  yield "10 x tanh(x*s+b)", [a,b,s], [x]
+
+nrep = 20
+for n in [10**3, 10**5, 10**6]:
+  print("n = %d" % n)
+  for name, ins, outs in workloads(n):
+    t = {}
+    for fuse in [False, True]:
+      f = MXFunction("f", ins, outs, {"fuse_elementwise":fuse})
+      for i in range(f.nIn()):
+        f.setInput(np.random.rand(f.input(i).nnz()),i)
+      f.evaluate()
+      t0 = time()
+      for r in range(nrep):
+        f.evaluate()
+      t[fuse] = (time()-t0)/nrep
+    print("  %-24s unfused %8.3f ms, fused %8.3f ms, speedup %.2f" %
+          (name, t[False]*1e3, t[True]*1e3, t[False]/t[True]))
@@ -0,0 +1,81 @@
+#
+#     This file is part of CasADi.
+#
+#     CasADi -- A symbolic framework for dynamic optimization.
+#     Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+#                             K.U. Leuven. All rights reserved.
+#     Copyright (C) 2011-2014 Greg Horn
+#
+#     CasADi is free software; you can redistribute it and/or
+#     modify it under the terms of the GNU Lesser General Public
+#     License as published by the Free Software Foundation; either
+#     version 3 of the License, or (at your option) any later version.
+#
+#     CasADi is distributed in the hope that it will be useful,
+#     but WITHOUT ANY WARRANTY; without even the implied warranty of
+#     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+#     Lesser General Public License for more details.
+#
+#     You should have received a copy of the GNU Lesser General Public
+#     License along with CasADi; if not, write to the Free Software
+#     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+#
+#
+# Benchmark of linear solvers on KKT matrices [H A'; A -reg*I] of
+# optimal control problems in multiple shooting form
+from casadi import *
+import time
+import random
+
+def ocp_kkt(N, nx, nu, reg=1e-8):
+  random.seed(1)
+  nz = nx+nu
+  n = N*nz+nx
+  m = N*nx
+  r, c, v = [], [], []
+  def add(i,j,x):
+    r.append(i); c.append(j); v.append(x)
+    if i!=j:
+      r.append(j); c.append(i); v.append(x)
+  for k in range(N+1):
+    o = k*nz
+    w = nz if k<N else nx
+    for i in range(w):
+      add(o+i,o+i,random.uniform(2,4))
+      for j in range(i):
+        add(o+i,o+j,random.uniform(-0.5,0.5))
+  for k in range(N):
+    o, o1 = k*nz, (k+1)*nz
+    for i in range(nx):
+      row = n+k*nx+i
+      add(row,o1+i,-1)
+      for j in range(nz):
+        add(row,o+j,random.uniform(-0.5,0.5)+(i==j))
+      add(row,row,-reg)
+  return DMatrix.triplet(r,c,v,n+m,n+m)
+
+problems = [(200,4,2),(2000,4,2),(500,20,10),(100,60,30)]
+solvers = [s for s in ["csparse","ldl","lapacklu"] if LinearSolver.hasPlugin(s)]
+
+nrep = 5
+for N, nx, nu in problems:
+  K = ocp_kkt(N, nx, nu)
+  b = DMatrix([sin(i) for i in range(K.size1())])
+  print("N=%d, nx=%d, nu=%d: n=%d, nnz=%d" % (N, nx, nu, K.size1(), K.nnz()))
+  for name in solvers:
+    t0 = time.time()
+    S = LinearSolver("S", name, K.sparsity(), 1)
+    t_init = time.time()-t0
+    S.setInput(K,"A")
+    t0 = time.time()
+    for i in range(nrep):
+      S.input("A")[0] = K[0,0] + 1e-12*i # force a numeric refactorization
+      S.prepare()
+    t_fact = (time.time()-t0)/nrep
+    S.setInput(b,"B")
+    t0 = time.time()
+    S.evaluate()
+    t_solve = time.time()-t0
+    res = float(norm_inf(mul(K,S.getOutput("X"))-b))
+    print("  %-10s init = %.3g s, factorize = %.3g s, solve = %.3g s, residual = %.2e"
+          % (name, t_init, t_fact, t_solve, res))
@@ -0,0 +1,95 @@
+#
+#     This file is part of CasADi.
+#
+#     CasADi -- A symbolic framework for dynamic optimization.
+#     Copyright (C) 2010-2014 Joel Andersson, Joris Gillis, Moritz Diehl,
+#                             K.U. Leuven. All rights reserved.
+#     Copyright (C) 2011-2014 Greg Horn
+#
+#     CasADi is free software; you can redistribute it and/or
+#     modify it under the terms of the GNU Lesser General Public
+#     License as published by the Free Software Foundation; either
+#     version 3 of the License, or (at your option) any later version.
+#
+#     CasADi is distributed in the hope that it will be useful,
+#     but WITHOUT ANY WARRANTY; without even the implied warranty of
+#     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+#     Lesser General Public License for more details.
+#
+#     You should have received a copy of the GNU Lesser General Public
+#     License along with CasADi; if not, write to the Free Software
+#     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+#
+#
+# Benchmark of QP solvers on QPs extracted from NLPs:
+# the first SQP subproblem (exact Hessian of the Lagrangian, linearized constraints)
+# of a number of test NLPs is solved repeatedly with each available QP solver.
+from casadi import *
+import time
+
+def chained_rosenbrock(N):
+  x = SX.sym("x",N)
+  f = sum([100*(x[i+1]-x[i]**2)**2 + (1-x[i])**2 for i in range(N-1)])
+  g = vertcat([x[i]**2 + x[i+1]**2 for i in range(0,N-1,2)])
+  return x, f, g, [-0.5]*N, [-inf]*N, [inf]*N, [-inf]*g.nnz(), [4]*g.nnz()
+
+def vdp_multiple_shooting(N):
+  # Van der Pol oscillator, RK4 discretization
+  nx, nu, h = 2, 1, 10.0/N
+  X = SX.sym("X",nx,N+1)
+  U = SX.sym("U",nu,N)
+  def ode(x,u):
+    return vertcat([(1-x[1]**2)*x[0] - x[1] + u[0], x[0]])
+  f = 0
+  g = [X[:,0]-DMatrix([0,1])]
+  for k in range(N):
+    x, u = X[:,k], U[:,k]
+    k1 = ode(x,u)
+    k2 = ode(x+h/2*k1,u)
+    k3 = ode(x+h/2*k2,u)
+    k4 = ode(x+h*k3,u)
+    g.append(X[:,k+1] - (x + h/6*(k1+2*k2+2*k3+k4)))
+    f += h*(inner_prod(x,x) + u[0]**2)
+  g = vertcat(g)
+  w = vertcat([vec(X),vec(U)])
+  lbw = [-inf]*X.nnz() + [-0.75]*U.nnz()
+  ubw = [inf]*X.nnz() + [1.0]*U.nnz()
+  return w, f, g, [0]*w.nnz(), lbw, ubw, [0]*g.nnz(), [0]*g.nnz()
+
+def extract_qp(w, f, g, w0, lbw, ubw, lbg, ubg):
+  lam = SX.sym("lam",g.nnz())
+  lag = f + inner_prod(lam,g)
+  fcn = SXFunction("qp_data",[w,lam],[hessian(lag,w)[0],gradient(f,w),jacobian(g,w),g])
+  fcn.setInput(w0,0)
+  fcn.setInput(0,1)
+  fcn.evaluate()
+  H, G, A, g0 = [fcn.getOutput(i) for i in range(4)]
+  w0 = DMatrix(w0)
+  return dict(h=H, g=G, a=A, lbx=DMatrix(lbw)-w0, ubx=DMatrix(ubw)-w0,
+              lba=DMatrix(lbg)-g0, uba=DMatrix(ubg)-g0)
+
+problems = [("chained_rosenbrock(100)",chained_rosenbrock(100)),
+            ("chained_rosenbrock(1000)",chained_rosenbrock(1000)),
+            ("vdp_multiple_shooting(20)",vdp_multiple_shooting(20)),
+            ("vdp_multiple_shooting(200)",vdp_multiple_shooting(200))]
+
+qpsolvers = [(name,opts) for name,opts in [("ipqp",{}),("qpoases",{"printLevel":"none"}),
+                                          ("nlp.ipopt",{"nlp_solver_options":{"print_level":0,"print_time":False}})]
+             if QpSolver.hasPlugin(name)]
+
+nrep = 5
+for pname, nlp in problems:
+  qp = extract_qp(*nlp)
+  print("%s: n=%d, nc=%d" % (pname, qp["a"].size2(), qp["a"].size1()))
+  for name, opts in qpsolvers:
+    solver = QpSolver("solver",name,{'h':qp["h"].sparsity(),'a':qp["a"].sparsity()},opts)
+    for k,v in qp.items():
+      solver.setInput(v,k)
+    try:
+      t0 = time.time()
+      for i in range(nrep):
+        solver.evaluate()
+      t = (time.time()-t0)/nrep
+      print("  %-10s cost = %.10g, time = %.3g s" % (name, float(solver.getOutput("cost")), t))
+    except Exception as e:
+      print("  %-10s failed: %s" % (name, str(e).splitlines()[0]))
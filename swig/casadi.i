@@ -4054,6 +4054,7 @@ namespace casadi {
 %include <casadi/core/function/qcqp_solver.hpp>
 %include <casadi/core/function/sdqp_solver.hpp>
 %include <casadi/core/function/external_function.hpp>
+%include <casadi/core/function/binary_function.hpp>
 %include <casadi/core/function/switch.hpp>
 %include <casadi/core/function/custom_function.hpp>
 %include <casadi/core/function/callback.hpp>
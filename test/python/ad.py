@@ -407,6 +407,69 @@ class ADtests(casadiTestCase):
     #print array(JT.getOutput())
     #print array(H.getOutput())
     
+  def test_bidirectional(self):
+    self.message("Jacobian with bidirectional partition")
+    x0=DMatrix(range(20))/10.0+0.3
+    for opts in [{}, {"bidirectional_coloring": True},
+                 {"bidirectional_coloring": True, "coloring_ordering": "smallest_last"}]:
+      for Fun, X in [(SXFunction, SX.sym("x",20)), (MXFunction, MX.sym("x",20))]:
+        # Dense first row and column
+        e=vertcat([sumAll(X**2)]+[X[0]*sin(X[i]) for i in range(1,20)])
+        f=Fun("f",[X],[e],opts)
+        J=f.jacobian()
+        J.setInput(x0)
+        J.evaluate()
+        ref=Fun("ref",[X],[jacobian(e,X)])
+        ref.setInput(x0)
+        ref.evaluate()
+        self.checkarray(J.getOutput(),ref.getOutput())
+        if "bidirectional_coloring" in opts:
+          c=f.getStats()["coloring"]["bidirectional"]
+          self.assertTrue(c["fwd"]+c["adj"]<=4)
+
+  def test_jacobian_plan(self):
+    self.message("Jacobian with a reused plan")
+    x0=DMatrix(range(20))/10.0+0.3
+    for Fun, X in [(SXFunction, SX.sym("x",20)), (MXFunction, MX.sym("x",20))]:
+      e=vertcat([sumAll(X**2)]+[X[0]*sin(X[i]) for i in range(1,20)])
+      f=Fun("f",[X],[e],{"bidirectional_coloring": True})
+      plan=f.getJacobianPlan()
+      g=Fun("g",[X],[cos(e)],{"bidirectional_coloring": True})
+      g.setJacobianPlan(plan)
+      J=g.jacobian()
+      J.setInput(x0)
+      J.evaluate()
+      ref=Fun("ref",[X],[jacobian(cos(e),X)])
+      ref.setInput(x0)
+      ref.evaluate()
+      self.checkarray(J.getOutput(),ref.getOutput())
+      h=Fun("h",[X],[X**2])
+      self.assertRaises(Exception, lambda: h.setJacobianPlan(plan))
+
+  def test_derivative_cache(self):
+    self.message("Global cache of derivative functions")
+    x=SX.sym("x",3)
+    f=SXFunction("f",[x],[sin(x)])
+    CasadiOptions.setDerivativeCacheSize(2)
+    try:
+      f.jacobian()
+      self.assertTrue(f.jacobian().getOutput().size1()==3)
+      f.derForward(1)
+
+      # The derivatives stay alive without references from the user
+      J = f.jacobian()
+      h = J.__hash__()
+      w = WeakRef(J)
+      del J
+      self.assertTrue(w.alive())
+      self.assertEqual(f.jacobian().__hash__(),h)
+
+      # They are dropped from the cache when the function is released
+      del f
+      self.assertFalse(w.alive())
+    finally:
+      CasadiOptions.setDerivativeCacheSize(0)
+
   def test_bugshape(self):
     self.message("shape bug")
     x=SX.sym("x")
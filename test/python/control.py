@@ -51,6 +51,9 @@ if LinearSolver.hasPlugin("csparse") and DleSolver.hasPlugin("simple"):
 if LinearSolver.hasPlugin("csparse") and DleSolver.hasPlugin("dple.slicot"):
   dlesolvers.append(("dple.slicot",{"dple_solver_options": {"linear_solver": "csparse"}}))
 
+if DleSolver.hasPlugin("dple.periodic_schur"):
+  dlesolvers.append(("dple.periodic_schur",{}))
+
 """
 if DleSolver.hasPlugin("lrdle.smith"):
   dlesolvers.append(("lrdle.smith",{"lrdle_solver_options": {"max_iter":100,"tol": 1e-13}}))
@@ -64,6 +67,10 @@ if DleSolver.hasPlugin("fixed_smith"):
   dlesolvers.append(("fixed_smith",{"iter":100, "freq_doubling": False}))
   dlesolvers.append(("fixed_smith",{"iter":100, "freq_doubling": True}))
 
+if DleSolver.hasPlugin("smith"):
+  dlesolvers.append(("smith",{}))
+  dlesolvers.append(("smith",{"freq_doubling": False, "max_iter": 1000}))
+
 lrdlesolvers = []
 
 """
@@ -103,6 +110,9 @@ dplesolvers = []
 
 if LinearSolver.hasPlugin("csparse") and DpleSolver.hasPlugin("slicot"):
   dplesolvers.append(("slicot",{"linear_solver": "csparse"}))
+
+if DpleSolver.hasPlugin("periodic_schur"):
+  dplesolvers.append(("periodic_schur",{}))
   
 if LinearSolver.hasPlugin("csparse") and DpleSolver.hasPlugin("simple"):
   dplesolvers.append(("simple",{"linear_solver": "csparse"}))
@@ -429,6 +439,35 @@ class ControlTests(casadiTestCase):
             else:
               raise e
        
+  @requiresPlugin(DleSolver,"smith")
+  def test_smith_convergence(self):
+    numpy.random.seed(1)
+    n = 5
+    A_ = DMatrix(numpy.random.random((n,n)))
+    v = DMatrix(numpy.random.random((n,n)))
+    V_ = mul(v,v.T)
+    for rho, fd in [(0.5,True),(0.9,True),(0.5,False)]:
+      A = A_*rho/max(abs(numpy.linalg.eigvals(numpy.array(A_))))
+      solver = DleSolver("solver","smith",{'a':Sparsity.dense(n,n),'v':Sparsity.dense(n,n)},
+                         {"freq_doubling": fd, "max_iter": 1000, "gather_stats": True})
+      solver.setInput(A,"a")
+      solver.setInput(V_,"v")
+      solver.evaluate()
+      P = solver.getOutput()
+      self.checkarray(mul([A,P,A.T])+V_,P,digits=10)
+      stats = solver.getStats()
+      self.assertEqual(stats["return_status"],"success")
+      # The squared Smith iterations need O(log(1/tol)/log(1/rho)) doublings only
+      if fd:
+        self.assertTrue(stats["iter"]<=12)
+
+    # An unstable system does not converge
+    solver = DleSolver("solver","smith",{'a':Sparsity.dense(n,n),'v':Sparsity.dense(n,n)},
+                       {"max_iter": 5, "error_unstable": True})
+    solver.setInput(A_*2,"a")
+    solver.setInput(V_,"v")
+    self.assertRaises(Exception, lambda : solver.evaluate())
+
   @skip(not scipy_available)
   @memory_heavy()
   def test_cle_small(self):
@@ -604,7 +643,40 @@ class ControlTests(casadiTestCase):
         for z in Z:
           self.checkarray(mul(z,z.T),DMatrix.eye(n))
           self.checkarray(mul(z.T,z),DMatrix.eye(n))
-          
+
+  @requiresPlugin(DpleSolver,"periodic_schur")
+  def test_periodic_schur(self):
+    for K in [1,2,3,5]:
+      for n in [1,2,3,4,8,16]:
+        numpy.random.seed(1)
+        A = [DMatrix(numpy.random.random((n,n))) for i in range(K)]
+        T,Z,er,ec = DpleSolver.periodic_schur('periodic_schur',A)
+        def sigma(a):
+          return a[1:] + [a[0]]
+
+        for z,zp,a,t in zip(Z,sigma(list(Z)),A,T):
+          self.checkarray(mul([z.T,a,zp]),t,digits=10)
+
+        # T[0] quasi-upper triangular: no two consecutive nonzero subdiagonal entries
+        hess = Sparsity.band(n,1)+Sparsity.upper(n)
+        self.checkarray(T[0][hess.patternInverse()],DMatrix.zeros(n,n),digits=12)
+        for i in range(n-2):
+          self.assertTrue(T[0][i+1,i]==0 or T[0][i+2,i+1]==0)
+
+        # remainder of T is upper triangular
+        for t in T[1:]:
+          self.checkarray(t[Sparsity.upper(n).patternInverse()],DMatrix.zeros(n,n),digits=12)
+
+        for z in Z:
+          self.checkarray(mul(z,z.T),DMatrix.eye(n))
+
+        # Eigenvalues of the monodromy matrix
+        M = DMatrix.eye(n)
+        for a in A:
+          M = mul(M,a)
+        ev = numpy.linalg.eigvals(numpy.array(M))
+        self.checkarray(DMatrix(sorted(numpy.abs(ev))),DMatrix(sorted(numpy.hypot(er,ec))),digits=8)
+
 if __name__ == '__main__':
     print(sys.argv)
     unittest.main()
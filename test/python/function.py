@@ -29,6 +29,7 @@ from types import *
 from helpers import *
 
 import os
+import struct
 has_opencl = os.path.exists("/etc/OpenCL/vendors/pocl.icd") or os.path.exists("/etc/OpenCL/vendors/nvidia.icd") or os.path.exists("/etc/OpenCL/vendors/intel-beignet-x86_64-linux-gnu.icd")
 
 class Functiontests(casadiTestCase):
@@ -1803,6 +1804,75 @@ class Functiontests(casadiTestCase):
 
     self.checkfunction(F,Fref)
 
+  def test_codegen_static(self):
+    x = MX.sym("x",3,3)
+    y = MX.sym("y",Sparsity.lower(3))
+    g = SXFunction("g",[SX.sym("z",2)],[SX.sym("z",2)**2])
+    z = g([x[:2,0]])[0]
+    F = MXFunction("f",[x,y],[x+y,project(x,Sparsity.lower(3)),z,det(x)])
+
+    x0 = DMatrix([[1,2,3],[4,5,7],[9,3,1]])
+    y0 = DMatrix(Sparsity.lower(3),range(6))
+    F.setInput(x0,0)
+    F.setInput(y0,1)
+
+    cg = CodeGenerator({"static_memory":True,"specialize":True,"unroll_max":4})
+    cg.add(F)
+    cg.add(g)
+    stats = cg.getStats()
+    self.assertTrue("f" in stats)
+    self.assertEqual(stats["f"]["sz_arg"],F.sz_arg())
+    self.assertEqual(stats["f"]["sz_w"],F.sz_w())
+    self.assertTrue(stats["f"]["stack_bytes"]>=stats["g"]["stack_bytes"])
+    self.assertTrue(stats["f"]["n_op"]>=stats["g"]["n_op"])
+
+    code = cg.generate()
+    self.assertTrue("f_static" in code)
+    self.assertTrue("project(" not in code)
+
+    if args.run_slow:
+      F.generate("codegen_static",{"static_memory":True,"specialize":True})
+      import subprocess
+      p = subprocess.Popen("gcc -fPIC -shared -O3 codegen_static.c -o codegen_static.so",
+                           shell=True).wait()
+      F2 = ExternalFunction("codegen_static")
+      for i in range(F.nIn()):
+        F2.setInput(F.getInput(i),i)
+      F.evaluate()
+      F2.evaluate()
+      for i in range(F.nOut()):
+        self.checkarray(F2.getOutput(i),F.getOutput(i))
+
+      # Call the static entry point from a C driver
+      driver = "#include <stdio.h>\n"
+      driver+= "int codegen_static_static(const double** arg, double** res);\n"
+      driver+= "int main() {\n"
+      for i in range(F.nIn()):
+        driver+= "  const double a%d[] = {%s};\n" % (i,", ".join(repr(v) for v in F.getInput(i).nonzeros()))
+      for i in range(F.nOut()):
+        driver+= "  double r%d[%d];\n" % (i,max(F.getOutput(i).nnz(),1))
+      driver+= "  const double* arg[] = {%s};\n" % ", ".join("a%d" % i for i in range(F.nIn()))
+      driver+= "  double* res[] = {%s};\n" % ", ".join("r%d" % i for i in range(F.nOut()))
+      driver+= "  int i;\n"
+      driver+= "  if (codegen_static_static(arg, res)) return 1;\n"
+      for i in range(F.nOut()):
+        driver+= "  for (i=0; i<%d; ++i) printf(\"%%.16e\\n\", r%d[i]);\n" % (F.getOutput(i).nnz(),i)
+      driver+= "  return 0;\n}\n"
+      with open("codegen_static_driver.c","w") as f:
+        f.write(driver)
+      p = subprocess.Popen("gcc -O3 codegen_static.c codegen_static_driver.c -o codegen_static_driver -lm",
+                           shell=True).wait()
+      self.assertEqual(p,0)
+      out = subprocess.Popen("./codegen_static_driver",stdout=subprocess.PIPE).communicate()[0]
+      out = [float(v) for v in out.split()]
+      for i in range(F.nOut()):
+        n = F.getOutput(i).nnz()
+        self.checkarray(DMatrix(F.getOutput(i).sparsity(),out[:n]),F.getOutput(i))
+        out = out[n:]
+      self.assertEqual(len(out),0)
+      for f in ["codegen_static_driver.c","codegen_static_driver"]:
+        os.remove(f)
+
   @memory_heavy()
   def test_mapaccum(self):
   
@@ -1878,6 +1948,49 @@ class Functiontests(casadiTestCase):
         self.checkfunction(f,Fref)
         self.check_codegen(f)
 
+  def test_binaryfunction(self):
+    x = SX.sym("x",2)
+    y = SX.sym("y",Sparsity.lower(2))
+    fs = SXFunction("f",[x,y],[mul(y,x)+sin(x[0])*3.2,x[1]**2],{"input_scheme":["x","y"]})
+    xm = MX.sym("x",2)
+    ym = MX.sym("y",Sparsity.lower(2))
+    fm = MXFunction("f",[xm,ym],[mul(ym,xm)+sin(xm[0])*3.2,xm[1]**2])
+    for f in [fs,fm]:
+      f.save("binaryfunction.casadi")
+      F = BinaryFunction("F","binaryfunction.casadi")
+      self.assertEqual(F.getNumInputs(),2)
+      self.assertTrue(F.getInput(1).sparsity()==y.sparsity())
+      S = F.symbolic()
+      for i,e in enumerate([DMatrix([1.2,0.3]),DMatrix(Sparsity.lower(2),[0.1,0.7,-1.1])]):
+        F.setInput(e,i)
+        S.setInput(e,i)
+        f.setInput(e,i)
+      self.checkfunction(F,f,sparsity_mod=False)
+      self.checkfunction(S,f,sparsity_mod=False)
+    os.remove("binaryfunction.casadi")
+
+    with open("binaryfunction.casadi","wb") as f:
+      f.write(b"garbage")
+    with self.assertRaises(Exception):
+      BinaryFunction("F","binaryfunction.casadi")
+    os.remove("binaryfunction.casadi")
+
+    # Operations that cannot be evaluated from the tape are rejected on load
+    fs.save("binaryfunction.casadi")
+    with open("binaryfunction.casadi","rb") as f:
+      data = bytearray(f.read())
+    sz_el = struct.unpack("i",bytes(data[16:20]))[0]
+    n_alg = struct.unpack("i",bytes(data[32:36]))[0]
+    for k in range(len(data)-n_alg*sz_el,len(data),sz_el):
+      if struct.unpack("i",bytes(data[k:k+4]))[0] not in [OP_CONST,OP_INPUT,OP_OUTPUT]:
+        data[k:k+4] = struct.pack("i",OP_CALL)
+        break
+    with open("binaryfunction.casadi","wb") as f:
+      f.write(data)
+    with self.assertRaises(Exception):
+      BinaryFunction("F","binaryfunction.casadi")
+    os.remove("binaryfunction.casadi")
+
   # @requiresPlugin(Compiler,"clang")
   # def test_jitfunction_clang(self):
   #   x = MX.sym("x")
@@ -1940,7 +2053,8 @@ class Functiontests(casadiTestCase):
         options_fasteval = {"compiler": "shell", "jit": True, "jit_options": {"compiler": "gcc","flags": ["-Ofast","-lOpenCL"]}}
       else:
         options_fasteval = {"compiler": "shell", "jit": True, "jit_options": {"compiler": "gcc","flags": ["-Ofast"]}}
-      for par,options in [("serial",{}),("opencl",options_fasteval)]:
+      # Without WITH_OPENMP, "openmp" falls back to the serial class with a warning
+      for par,options in [("serial",{}),("openmp",{}),("opencl",options_fasteval)]:
         if "opencl"==par and not has_opencl:
           continue      
         for z, z_options in [(Z,{}),(pt,{"pointer_input": True,"image_type":32})]:
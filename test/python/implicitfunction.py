@@ -44,6 +44,8 @@ except:
 try:
   LinearSolver.loadPlugin("csparse")
   solvers.append(("newton",{"linear_solver": "csparse"}))
+  solvers.append(("newton",{"linear_solver": "csparse", "jacobian_update": "chord"}))
+  solvers.append(("newton",{"linear_solver": "csparse", "jacobian_update": "broyden"}))
 except:
   pass
 
@@ -298,6 +300,40 @@ class ImplicitFunctiontests(casadiTestCase):
     a = SX.sym("a",2)
     f = SXFunction("f", [x,a],[tan(x)-a,sqrt(a)*x**2 ])
 
+  def test_newton_jacobian_reuse(self):
+    self.message("newton jacobian reuse")
+    x = SX.sym("x",3)
+    p = SX.sym("p")
+    f = SXFunction("f", [x,p],[vertcat([4*x[0]-x[1]+0.1*x[0]**3-p, 4*x[1]-x[0]-x[2]+sin(x[1])-2*p, 4*x[2]-x[1]+0.1*x[2]**3-3*p]), sum_square(x)])
+    ref = ImplicitFunction("ref", "newton", f, {"linear_solver": "csparse"})
+    for update in ["chord", "broyden"]:
+      solver = ImplicitFunction("solver", "newton", f, {"linear_solver": "csparse", "jacobian_update": update, "gather_stats": True})
+      njevals = 0
+      for k in range(10):
+        for F in [ref, solver]:
+          F.setInput(0,0)
+          F.setInput(1+0.05*k,1)
+          F.evaluate()
+        self.checkarray(solver.getOutput(0),ref.getOutput(0),digits=10)
+        self.checkarray(solver.getOutput(1),ref.getOutput(1),digits=10)
+        stats = solver.getStats()
+        njevals += stats["njevals"]
+        self.assertEqual(stats["njevals"]+stats["njevals_saved"],stats["iter"])
+      # The factorization is reused across calls
+      self.assertTrue(njevals<10)
+
+  def test_broyden_breakdown(self):
+    self.message("newton broyden breakdown")
+    # From x=1, the first step leads to x=-1 with the same residual, so that the second
+    # chord step equals the first and the Broyden update breaks down
+    x = SX.sym("x")
+    f = SXFunction("f", [x],[x**3-x+4])
+    solver = ImplicitFunction("solver", "newton", f, {"linear_solver": "csparse", "jacobian_update": "broyden", "max_contraction": 2., "gather_stats": True})
+    solver.setInput(1,0)
+    solver.evaluate()
+    self.assertEqual(solver.getStats()["broyden_breakdowns"],1)
+    self.checkarray(f([solver.getOutput(0)])[0],DMatrix([0]),digits=10)
+
 if __name__ == '__main__':
     unittest.main()
 
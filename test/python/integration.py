@@ -243,6 +243,8 @@ class Integrationtests(casadiTestCase):
               if "banded" in allowedOpts:
                   yield {"linear_solver_type" +post: "banded" }
               yield {"linear_solver_type" +post: "user_defined", "linear_solver"+post: "csparse" }
+              if "sparse" in allowedOpts:
+                  yield {"linear_solver_type" +post: "sparse" }
                 
             for a_options in solveroptions("B"):
               for f_options in solveroptions():
@@ -1101,6 +1103,57 @@ class Integrationtests(casadiTestCase):
 
     integrator.evaluate()
     
+  def test_rk_ensemble(self):
+    self.message("rk ensemble mode")
+    t=SX.sym("t")
+    x=SX.sym("x",2)
+    p=SX.sym("p")
+    f=SXFunction("f", daeIn(t=t,x=x,p=p),daeOut(ode=vertcat([x[1],-p*sin(x[0])+t]),quad=x[0]**2))
+    N = 5
+    opts = {"number_of_finite_elements": 50, "tf": 1.3}
+    single = Integrator("single", "rk", f, opts)
+    opts["ensemble_size"] = N
+    opts["ensemble_block_size"] = 2
+    ensemble = Integrator("ensemble", "rk", f, opts)
+    self.assertEqual(ensemble.getInput("x0").shape,(2,N))
+    self.assertEqual(ensemble.getOutput("qf").shape,(1,N))
+
+    X0 = DMatrix([[0.1*k+0.2,0.3-0.05*k] for k in range(N)]).T
+    P = DMatrix([[0.5+0.2*k for k in range(N)]])
+    ensemble.setInput(X0,"x0")
+    ensemble.setInput(P,"p")
+    ensemble.evaluate()
+    for k in range(N):
+      single.setInput(X0[:,k],"x0")
+      single.setInput(P[:,k],"p")
+      single.evaluate()
+      self.checkarray(ensemble.getOutput("xf")[:,k],single.getOutput("xf"),"xf %d" % k)
+      self.checkarray(ensemble.getOutput("qf")[:,k],single.getOutput("qf"),"qf %d" % k)
+
+  def test_cvodes_fsens(self):
+    self.message("cvodes native forward sensitivities")
+    t=SX.sym("t")
+    x=SX.sym("x",2)
+    p=SX.sym("p",2)
+    f=SXFunction("f", daeIn(t=t,x=x,p=p),daeOut(ode=vertcat([x[1],-p[0]*sin(x[0])+p[1]*t]),quad=x[0]**2*p[1]))
+    opts = {"tf": 1.3, "abstol": 1e-12, "reltol": 1e-12}
+    for method, all_at_once in [("simultaneous", True), ("staggered", True), ("staggered", False)]:
+      opts["sensitivity_method"] = method
+      opts["fsens_all_at_once"] = all_at_once
+      opts["fsens_native"] = True
+      native = Integrator("native", "cvodes", f, opts)
+      opts["fsens_native"] = False
+      augmented = Integrator("augmented", "cvodes", f, opts)
+      for i in ["x0","p"]:
+        for o in ["xf","qf"]:
+          J = native.jacobian(i,o)
+          Jref = augmented.jacobian(i,o)
+          for F in [J, Jref]:
+            F.setInput([0.3,0.2],"x0")
+            F.setInput([0.7,0.4],"p")
+            F.evaluate()
+          self.checkarray(J.getOutput(),Jref.getOutput(),"%s %s %s %d" % (method, i, o, all_at_once),digits=7)
+
   def test_collocationPoints(self):
     self.message("collocation points")
     with self.assertRaises(Exception):
@@ -481,5 +481,35 @@ class LinearSolverTests(casadiTestCase):
 
         self.checkarray(mul(A_,f.getOutput()),b)
       
+  @requiresPlugin(LinearSolver,"ldl")
+  def test_ldl(self):
+    numpy.random.seed(0)
+    n = 12
+    m = 5
+    H = self.randDMatrix(n,n,sparsity=0.3)
+    H = mul(H,H.T) + DMatrix.eye(n)
+    A = self.randDMatrix(m,n,sparsity=0.4) + horzcat([DMatrix.eye(m),DMatrix.zeros(m,n-m)])
+    K = blockcat(H,A.T,A,DMatrix.zeros(m,m))
+    b = self.randDMatrix(n+m,2)
+
+    for options in [{},{"ordering":"natural"},{"relaxation":1.0}]:
+      S = LinearSolver("S", "ldl", K.sparsity(), 2, options)
+      S.setInput(K,"A")
+      S.setInput(b,"B")
+      S.evaluate()
+      self.checkarray(mul(K,S.getOutput("X")),b)
+
+      # Inertia of the KKT matrix
+      self.assertEqual(S.getStat("neig"),m)
+
+      # Same matrix, no refactorization
+      S.prepare()
+      self.assertTrue(S.getStat("factorization_reused"))
+
+    # 2x2 pivot
+    P = DMatrix([[0,1],[1,0]])
+    C = solve(P,DMatrix([1,2]),"ldl")
+    self.checkarray(C,DMatrix([2,1]))
+
 if __name__ == '__main__':
     unittest.main()
@@ -2571,5 +2571,98 @@ class MXtests(casadiTestCase):
 
         self.checkfunction(f,fr)
 
+  def test_fuse_elementwise(self):
+    a = MX.sym("a",5)
+    b = MX.sym("b",5)
+    s = MX.sym("s")
+    e = exp(a*b+s)-a
+    outs = [e, sin(s*e)+2*e+sqrt(fabs(b))/s, fmin(a,s)+cos(b), e+1, sqrt(a**2+b**2)]
+    f = MXFunction("f", [a,b,s],outs)
+    fr = MXFunction("fr", [a,b,s],outs,{"fuse_elementwise":False})
+    for i, v in enumerate([DMatrix(range(5))*0.3, DMatrix(range(5,0,-1))*0.2, 1.7]):
+      f.setInput(v,i)
+      fr.setInput(v,i)
+    self.checkfunction(f,fr)
+    self.check_codegen(f)
+
+    # Same number of nonzeros, different sparsity patterns
+    x = MX.sym("x",Sparsity.diag(3))
+    y = MX.sym("y",Sparsity.triplet(3,3,[0,1,2],[0,0,0]))
+    z = MX.sym("z",Sparsity.triplet(3,3,[1],[2]))
+    outs = [sin(x)*2+cos(y)*3, exp(x)*z+x, (y+1)*(y-2)+z]
+    f = MXFunction("f", [x,y,z],outs)
+    fr = MXFunction("fr", [x,y,z],outs,{"fuse_elementwise":False})
+    for i, v in enumerate([DMatrix(x.sparsity(),[0.1,0.2,0.3]),
+                           DMatrix(y.sparsity(),[0.4,0.5,0.6]),DMatrix(z.sparsity(),[0.7])]):
+      f.setInput(v,i)
+      fr.setInput(v,i)
+    self.checkfunction(f,fr)
+    self.check_codegen(f)
+
+  def test_dense_kernels(self):
+    n = 6
+    random.seed(0)
+    A_ = DMatrix(random.rand(n,n))
+    B_ = DMatrix(random.rand(n,n))
+    C_ = DMatrix(Sparsity.banded(n,1),random.rand(Sparsity.banded(n,1).nnz()))
+    for A, B, C in [(MX.sym("A",n,n),MX.sym("B",n,n),MX.sym("C",Sparsity.banded(n,1)))]:
+      f = MXFunction("f", [A,B,C],[mul(A,B),inv(A),det(A),mul(A,C),inv(C),det(C)])
+      f.setInput(A_,0)
+      f.setInput(B_,1)
+      f.setInput(C_,2)
+      f.evaluate()
+      self.checkarray(f.getOutput(0),mul(A_,B_),"mul")
+      self.checkarray(mul(f.getOutput(1),A_),DMatrix.eye(n),"inv")
+      self.checkarray(f.getOutput(2),linalg.det(A_),"det")
+      self.checkarray(f.getOutput(3),mul(A_,C_),"mul")
+      self.checkarray(mul(f.getOutput(4),C_),DMatrix.eye(n),"inv")
+      self.checkarray(f.getOutput(5),linalg.det(densify(C_)),"det")
+      self.check_codegen(f)
+
+  def test_structured_kernels(self):
+    n = 8
+    sp = Sparsity.triplet(n,5,[0,3,5,1,7,2,4,6],[0,0,1,2,2,3,4,4])
+    blockdiag = diagcat([Sparsity.dense(3,3),Sparsity.dense(2,4),Sparsity.dense(3,1)])
+    cases = [(Sparsity.diag(n),sp),
+             (Sparsity.diag(n),Sparsity.dense(n,3)),
+             (sp,Sparsity.diag(5)),
+             (Sparsity.dense(4,n),sp),
+             (Sparsity.banded(n,1),Sparsity.dense(n,3)),
+             (blockdiag,Sparsity.dense(8,2)),
+             (sp,sp.T)]
+    random.seed(1)
+    for spx, spy in cases:
+      x = MX.sym("x",spx)
+      y = MX.sym("y",spy)
+      f = MXFunction("f",[x,y],[mul(x,y),mul(y.T,x.T),densify(x),project(densify(y),spy)])
+      x_ = DMatrix(spx,random.rand(spx.nnz()))
+      y_ = DMatrix(spy,random.rand(spy.nnz()))
+      f.setInput(x_,0)
+      f.setInput(y_,1)
+      f.evaluate()
+      self.checkarray(f.getOutput(0),mul(x_,y_),"mul")
+      self.checkarray(f.getOutput(1),mul(y_.T,x_.T),"mul")
+      self.checkarray(f.getOutput(2),densify(x_),"densify")
+      self.checkarray(f.getOutput(3),y_,"project")
+      self.check_codegen(f)
+
+  def test_parallel_eval(self):
+    n = 5
+    A = MX.sym("A",n,n)
+    x = MX.sym("x",n)
+    w = SX.sym("w",n)
+    g = SXFunction("g",[w],[sin(w)])
+    y = [mul(A+i,x) for i in range(4)]
+    z = [g([yi])[0] for yi in y]
+    outs = [sum(z[i]*(i+1) for i in range(4)), mul(A,A)+inv(A), det(A)*z[0]]
+    fr = MXFunction("fr",[A,x],outs)
+    for opts in [{"parallelization":"openmp"},{"parallelization":"openmp","parallel_min_cost":0}]:
+      f = MXFunction("f",[A,x],outs,opts)
+      for F in [f,fr]:
+        F.setInput(DMatrix(Sparsity.dense(n,n),[sin(i)+2*(i%(n+1)==0) for i in range(n*n)]),0)
+        F.setInput(DMatrix(range(n)),1)
+      self.checkfunction(f,fr)
+      self.check_codegen(f)
+
 if __name__ == '__main__':
     unittest.main()
@@ -1286,7 +1286,119 @@ class NLPtests(casadiTestCase):
       self.checkarray(solver.getOutput("f"),DMatrix([0]),digits=7)
       self.checkarray(solver.getOutput("x"),DMatrix([0]),digits=7)
       self.checkarray(solver.getOutput("lam_x"),DMatrix([0]),digits=7)
-      
+
+  def test_parallel_derivatives(self):
+    self.message("parallel construction of the derivative functions")
+    N = 10
+    x=SX.sym("x",N)
+    obj = sum([(1-x[i])**2+100*(x[i+1]-x[i]**2)**2 for i in range(N-1)])
+    g = vertcat([x[i]*x[i+1] for i in range(N-1)])
+    nlp=SXFunction("nlp", nlpIn(x=x),nlpOut(f=obj,g=g))
+
+    for Solver, solver_options in solvers:
+      self.message(str(Solver))
+      sol = []
+      # Without WITH_OPENMP, parallel_derivatives falls back to the serial construction
+      for parallel in [False, True]:
+        options = dict(solver_options)
+        options["parallel_derivatives"] = parallel
+        solver = NlpSolver("mysolver", Solver, nlp, options)
+        stats = solver.getStats()
+        # snopt uses the objective Jacobian instead of the gradient
+        self.assertTrue(("t_init_jac_f" if Solver=="snopt" else "t_init_grad_f") in stats)
+        self.assertTrue("t_init_jac_g" in stats)
+        solver.setInput([0.5]*N,"x0")
+        solver.setInput([-10]*N,"lbx")
+        solver.setInput([10]*N,"ubx")
+        solver.setInput([0]*(N-1),"lbg")
+        solver.setInput([1]*(N-1),"ubg")
+        solver.evaluate()
+        sol.append(solver.getOutput("x"))
+      self.checkarray(sol[0],sol[1],str(Solver),digits=10)
+
+  def test_parseNL(self):
+    self.message("NL-file parser, text and binary format")
+    import tempfile, os, struct
+    # Depth of the nested sum in the second constraint
+    depth = 100000
+
+    # Write a small model in the text ('g') or binary ('b') format
+    def writeNL(binary):
+      out = [(b"b3 1 1 0\n" if binary else b"g3 1 1 0\n"), b" 3 2 1 0 2 0\n"]
+      out += [b" 0 0 0\n"]*8
+      def key(c): out.append(c.encode("ascii"))
+      def num(i): out.append(struct.pack("i",i) if binary else ("%d\n" % i).encode("ascii"))
+      def dbl(d): out.append(struct.pack("d",d) if binary else ("%.17g\n" % d).encode("ascii"))
+      def btype(t): out.append(("%d" % t).encode("ascii") if binary else ("%d " % t).encode("ascii"))
+      # g0 = x0*x1 + sin(x2), plus a linear term below
+      key('C'); num(0)
+      key('o'); num(0); key('o'); num(2); key('v'); num(0); key('v'); num(1)
+      key('o'); num(41); key('v'); num(2)
+      # g1 = x0 + (x1 + (x2 + (x0 + ... + 1)))
+      key('C'); num(1)
+      for k in range(depth):
+        key('o'); num(0); key('v'); num(k % 3)
+      key('n'); dbl(1.)
+      # f = (x0-1)^2 + x1^2
+      key('O'); num(0); num(0)
+      key('o'); num(0)
+      key('o'); num(5); key('o'); num(1); key('v'); num(0); key('n'); dbl(1.); key('n'); dbl(2.)
+      key('o'); num(5); key('v'); num(1); key('n'); dbl(2.)
+      # Initial guess
+      key('x'); num(3)
+      for i, x0 in enumerate([0.5, -0.5, 1.5]):
+        num(i); dbl(x0)
+      # Constraint bounds: equality and range
+      key('r')
+      btype(4); dbl(0.)
+      btype(0); dbl(-1.); dbl(float(depth))
+      # Variable bounds: range, upper bound only, free
+      key('b')
+      btype(0); dbl(-10.); dbl(10.)
+      btype(1); dbl(2.)
+      btype(3)
+      # Jacobian column counts and linear terms
+      key('k'); num(2); num(2); num(4)
+      key('J'); num(0); num(1); num(2); dbl(0.5)
+      key('J'); num(1); num(1); num(0); dbl(0.)
+      fd, filename = tempfile.mkstemp(suffix='.nl')
+      os.write(fd, b"".join(out))
+      os.close(fd)
+      return filename
+
+    nl = []
+    for binary in [False, True]:
+      filename = writeNL(binary)
+      try:
+        b = NlpBuilder()
+        b.parseNL(filename)
+      finally:
+        os.remove(filename)
+      nl.append(b)
+
+    xv = [0.3, -0.7, 1.1]
+    g1 = sum(xv[k % 3] for k in range(depth)) + 1
+    res = []
+    for b in nl:
+      self.assertEqual(b.x.size(), 3)
+      F = SXFunction("F", [b.x], [b.f, b.g])
+      F.setInput(xv)
+      F.evaluate()
+      self.checkarray(F.getOutput(0), DMatrix((xv[0]-1)**2 + xv[1]**2))
+      self.checkarray(F.getOutput(1), DMatrix([xv[0]*xv[1] + sin(xv[2]) + 0.5*xv[2], g1]))
+      self.checkarray(DMatrix(b.x_init), DMatrix([0.5, -0.5, 1.5]))
+      self.checkarray(DMatrix(b.g_lb), DMatrix([0., -1.]))
+      self.checkarray(DMatrix(b.g_ub), DMatrix([0., depth]))
+      self.assertEqual(b.x_lb[0], -10)
+      self.assertEqual(b.x_ub[0], 10)
+      self.assertEqual(b.x_ub[1], 2)
+      res.append([list(F.getOutput(i).nonzeros()) for i in range(2)])
+
+    # Text and binary format give the same problem
+    self.assertEqual(res[0], res[1])
+    for attr in ["x_init", "x_lb", "x_ub", "g_lb", "g_ub"]:
+      self.assertEqual(list(getattr(nl[0], attr)), list(getattr(nl[1], attr)))
+
 if __name__ == '__main__':
     unittest.main()
     print(solvers)
@@ -184,7 +184,6 @@ class OCPtests(casadiTestCase):
     self.assertAlmostEqual(fmax(-solver.getOutput("lam_x"),0)[0],0,8,"Constraint is supposed to be unactive")
     self.assertAlmostEqual(fmax(-solver.getOutput("lam_x"),0)[1],0,8,"Constraint is supposed to be unactive") 
     
-  @requiresPlugin(XmlFile,"tinyxml")
   def test_XML(self):
     self.message("JModelica XML parsing")
     ivp = DaeBuilder()
@@ -236,6 +235,31 @@ class OCPtests(casadiTestCase):
     
     mystates = []
 
+  def test_XML_section_order(self):
+    self.message("FMI/XML parsing with equations before the variables")
+    xml = open('data/cstr.xml').read()
+    start = xml.index('<ModelVariables>')
+    stop = xml.index('</ModelVariables>') + len('</ModelVariables>')
+    modvars = xml[start:stop]
+    xml = xml[:start] + xml[stop:]
+    end = xml.rindex('</jmodelicaModelDescription>')
+    xml = xml[:end] + modvars + xml[end:]
+    import tempfile, os
+    fd, filename = tempfile.mkstemp(suffix='.xml')
+    os.write(fd, xml.encode('utf-8'))
+    os.close(fd)
+    try:
+      ivp = DaeBuilder()
+      ivp.parseFMI(filename)
+    finally:
+      os.remove(filename)
+    ref = DaeBuilder()
+    ref.parseFMI('data/cstr.xml')
+    self.assertEqual(str(ivp.dae), str(ref.dae))
+    self.assertEqual(str(ivp.ddef), str(ref.ddef))
+    self.assertEqual(str(ivp.init), str(ref.init))
+    self.assertEqual(ivp.nominal("cstr.c"),1000)
+
   # @requiresPlugin(NlpSolver,"ipopt")
   # def testMSclass_prim(self):
   #   self.message("CasADi multiple shooting class")
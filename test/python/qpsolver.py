@@ -35,6 +35,9 @@ if NlpSolver.hasPlugin("ipopt"):
 if NlpSolver.hasPlugin("ipopt"):
   qpsolvers.append(("nlp.ipopt",{"nlp_solver_options": {"tol": 1e-12}},{}))
 
+if QpSolver.hasPlugin("ipqp"):
+  qpsolvers.append(("ipqp",{},{}))
+
 # if NlpSolver.hasPlugin("worhp") and not args.ignore_memory_heavy:
 #   qpsolvers.append(("nlp",{"nlp_solver": "worhp", "nlp_solver_options": {"TolOpti": 1e-12}},{}))
 
@@ -749,5 +752,103 @@ class QpSolverTests(casadiTestCase):
       
       self.assertAlmostEqual(solver.getOutput("cost")[0],7,max(1,5-less_digits),str(qpsolver))
       
+  @requiresPlugin(QpSolver,"qpoases")
+  def test_qpoases_workingset(self):
+    H = DMatrix([[1,-1],[-1,2]])
+    G = DMatrix([-2,-6])
+    A =  DMatrix([[1, 1],[-1, 2],[2, 1]])
+    LBA = DMatrix([-inf]*3)
+    UBA = DMatrix([2, 2, 3])
+    LBX = DMatrix([0]*2)
+    UBX = DMatrix([inf]*2)
+
+    solvers = [QpSolver("solver%d" % i,"qpoases",{'h':H.sparsity(),'a':A.sparsity()}) for i in range(2)]
+    for solver in solvers:
+      solver.setInput(H,"h")
+      solver.setInput(G,"g")
+      solver.setInput(A,"a")
+      solver.setInput(LBX,"lbx")
+      solver.setInput(UBX,"ubx")
+      solver.setInput(LBA,"lba")
+      solver.setInput(UBA,"uba")
+
+    solvers[0].evaluate()
+    ws = solvers[0].getWorkingSet()
+    self.assertEqual(len(ws),5)
+    self.assertEqual(list(ws),[0,0,1,1,0])
+
+    # Same matrices: the factorization is reused
+    solvers[0].evaluate()
+    self.assertTrue(solvers[0].getStat("factorization_reused"))
+
+    # Hot-start another instance from the stored working set
+    solvers[1].setWorkingSet(ws)
+    solvers[1].evaluate()
+    self.assertTrue(solvers[1].getStat("working_set_guess"))
+    self.assertEqual(solvers[1].getStat("nWSR"),0)
+    self.checkarray(solvers[1].getOutput("x"),solvers[0].getOutput("x"))
+    self.checkarray(solvers[1].getOutput("x"),DMatrix([2.0/3,4.0/3]))
+
+  @requiresPlugin(QpSolver,"riccati")
+  @requiresPlugin(QpSolver,"ipqp")
+  def test_riccati(self):
+    # Double integrator, x = [x_0; u_0; x_1; u_1; ...; x_N]
+    N, nx, nu, h = 10, 2, 1, 0.1
+    n = N*(nx+nu)+nx
+    H = DMatrix.zeros(n,n)
+    A = DMatrix.zeros(N*nx+N,n)
+    LBA = DMatrix.zeros(N*nx+N)
+    UBA = DMatrix.zeros(N*nx+N)
+    LBX = DMatrix([-inf]*n)
+    UBX = DMatrix([inf]*n)
+    for k in range(N+1):
+      o = k*(nx+nu)
+      H[o,o] = 1
+      H[o+1,o+1] = 0.5
+      if k<N:
+        H[o+2,o+2] = 0.1
+        LBX[o+2] = -1
+        UBX[o+2] = 1
+        # Dynamics, with a non-identity block for x_{k+1}
+        A[k*nx,o+3] = 2
+        A[k*nx,o] = -2
+        A[k*nx,o+1] = -2*h
+        A[k*nx+1,o+4] = 1
+        A[k*nx+1,o+3] = 0.05
+        A[k*nx+1,o+1] = -1
+        A[k*nx+1,o+2] = -h
+        # Path constraint
+        A[N*nx+k,o] = 1
+        A[N*nx+k,o+1] = 1
+        LBA[N*nx+k] = -10
+        UBA[N*nx+k] = 2
+    LBX[0] = UBX[0] = 2.5
+    LBX[1] = UBX[1] = -1
+    # Equality constraints other than the dynamics: a path row and a control
+    LBA[N*nx+3] = UBA[N*nx+3] = 0.8
+    LBX[(N-2)*(nx+nu)+2] = UBX[(N-2)*(nx+nu)+2] = 0.2
+    H = sparsify(H)
+    A = sparsify(A)
+    G = DMatrix([0.1*(i%3) for i in range(n)])
+
+    options = [("ipqp",{}),
+               ("riccati",{"nx":[nx],"nu":[nu]}),
+               ("riccati",{"nx":[nx]*(N+1),"nu":[nu]*N,"condensing":True,"qp_solver":"ipqp"})]
+    sol = []
+    for name, opts in options:
+      solver = QpSolver("solver",name,{'h':H.sparsity(),'a':A.sparsity()},opts)
+      solver.setInput(H,"h")
+      solver.setInput(G,"g")
+      solver.setInput(A,"a")
+      solver.setInput(LBX,"lbx")
+      solver.setInput(UBX,"ubx")
+      solver.setInput(LBA,"lba")
+      solver.setInput(UBA,"uba")
+      solver.evaluate()
+      sol.append([solver.getOutput(i) for i in ["x","cost","lam_x","lam_a"]])
+    for s in sol[1:]:
+      for i in range(4):
+        self.checkarray(s[i],sol[0][i],digits=6)
+
 if __name__ == '__main__':
     unittest.main()
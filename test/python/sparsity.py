@@ -552,7 +552,70 @@ class Sparsitytests(casadiTestCase):
     self.assertEqual(c_.nnz(),a.nnz()*b.nnz())
     
     self.checkarray(IMatrix(c_,1),IMatrix(c.kron(a,b).sparsity(),1))
-    
+
+  def test_pattern_ops(self):
+    random.seed(1)
+    def rand_sp(n,m):
+      nz = [(random.randrange(n),random.randrange(m)) for k in range(random.randrange(n*m+1))]
+      return Sparsity.triplet(n,m,[i for i,j in nz],[j for i,j in nz])
+    def dense(sp):
+      return 1*(numpy.array(DMatrix(sp,1))!=0)
+    for k in range(20):
+      n, m, p = [random.randrange(1,10) for i in range(3)]
+      a, b = rand_sp(n,m), rand_sp(m,p)
+      A, B = dense(a), dense(b)
+      # Transpose, nonzeros are permuted with the mapping
+      self.checkarray(dense(a.T()),A.T)
+      X = DMatrix(a,range(1,a.nnz()+1))
+      self.checkarray(numpy.array(X.T),numpy.array(X).T)
+      # Product
+      self.checkarray(dense(a.patternProduct(b)),1*(numpy.dot(A,B)>0))
+      # Erase every other row and column
+      e = Sparsity(a)
+      e.erase(range(0,n,2),range(0,m,2))
+      E = A.copy()
+      E[0::2,0::2] = 0
+      self.checkarray(dense(e),E)
+
+  def test_cache(self):
+    with internalAPI():
+      a = Sparsity.dense(7,3)
+      s0 = Sparsity.cacheStats()
+      b = Sparsity.dense(7,3)
+      s1 = Sparsity.cacheStats()
+      self.assertTrue(a.isEqual(b))
+      self.assertTrue(s1["hits"]>s0["hits"])
+      self.assertTrue(s1["entries"]>=1)
+      c = Sparsity.banded(17,2)
+      s2 = Sparsity.cacheStats()
+      self.assertTrue(s2["misses"]>s1["misses"])
+
+  def test_coloring(self):
+    self.message("Graph coloring orderings and bidirectional partitions")
+    random.seed(2)
+    n = 40
+    A = Sparsity.triplet(n,n,[random.randrange(n) for i in range(4*n)],[i//4 for i in range(4*n)])
+    # Arrow: dense first row and column
+    arrow = Sparsity.diag(n) + Sparsity.triplet(n,n,[0]*n,range(n)) + Sparsity.triplet(n,n,range(n),[0]*n)
+    for sp in [A, arrow]:
+      J = numpy.array(DMatrix.ones(sp))
+      self.checkarray(sorted(sp.smallestLastOrdering()),range(n))
+      self.checkarray(sorted(sp.incidenceDegreeOrdering()),range(n))
+      for ordering in range(4):
+        D = numpy.array(DMatrix.ones(sp.unidirectionalColoring(Sparsity(),n,ordering)))
+        # Each column has one color, at most one column per row and color
+        self.checkarray(D.sum(1),numpy.ones(n))
+        self.assertTrue(numpy.dot(J,D).max()<=1)
+      D1, D2 = sp.bidirectionalColoring()
+      # All nonzeros determined directly in forward or adjoint mode
+      C1 = numpy.array(DMatrix.ones(D1)) if D1.nnz()>0 else numpy.zeros((n,0))
+      C2 = numpy.array(DMatrix.ones(D2)) if D2.nnz()>0 else numpy.zeros((n,0))
+      fwd = numpy.dot(numpy.dot(J,C1),C1.T)==1
+      adj = numpy.dot(C2,numpy.dot(C2.T,J))==1
+      self.assertTrue(((J==0) | fwd | adj).all())
+    D1, D2 = arrow.bidirectionalColoring()
+    self.assertTrue(D1.size2()+D2.size2()<=4)
+
 if __name__ == '__main__':
     unittest.main()
 